@@ -0,0 +1,522 @@
+#include <benchmark/benchmark.h>
+#include "Animation.h"
+#include "Mesh.h"
+#include "MeshLod.h"
+#include "MeshPacking.h"
+#include "MotorTransforms.h"
+#include "InstanceCulling.h"
+#include "InstancePacking.h"
+#include "TextureCache.h"
+#include "TextureMips.h"
+#include "VirtualTexture.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Mesh processing throughput. Every mesh benchmark reports "triangles/s" so a regression
+// shows up as a drop in one column regardless of mesh size:
+//   ./build/bin/FlyTracer_Bench --benchmark_filter=BuildBVH
+
+namespace {
+
+// Vertex and triangle arrays for a bumpy grid with ~targetTris triangles.
+// Cached so every benchmark at a given size starts from identical geometry.
+struct GridGeometry {
+    std::vector<Vertex> vertices;
+    std::vector<Triangle> triangles;
+};
+
+const GridGeometry& gridGeometry(int64_t targetTris) {
+    static std::map<int64_t, GridGeometry> cache;
+    auto [it, inserted] = cache.try_emplace(targetTris);
+    if (!inserted) return it->second;
+
+    const auto resolution = static_cast<uint32_t>(std::max(1.0, std::sqrt(targetTris / 2.0)));
+    const uint32_t stride = resolution + 1;
+    const float step = 1.0f / static_cast<float>(resolution);
+
+    GridGeometry& grid = it->second;
+    grid.vertices.resize(static_cast<size_t>(stride) * stride);
+    for (uint32_t z = 0; z < stride; ++z) {
+        for (uint32_t x = 0; x < stride; ++x) {
+            const float u = static_cast<float>(x) * step;
+            const float v = static_cast<float>(z) * step;
+            Vertex& vertex = grid.vertices[static_cast<size_t>(z) * stride + x];
+            vertex.position = TriVector(u * 100.0f - 50.0f,
+                                        std::sin(u * 37.0f) * std::cos(v * 23.0f) * 2.0f,
+                                        v * 100.0f - 50.0f, 1.0f);
+            vertex.normal = Vector(0.0f, 0.0f, 1.0f, 0.0f);
+            vertex.texCoord[0] = u;
+            vertex.texCoord[1] = v;
+        }
+    }
+
+    grid.triangles.reserve(static_cast<size_t>(resolution) * resolution * 2);
+    for (uint32_t z = 0; z < resolution; ++z) {
+        for (uint32_t x = 0; x < resolution; ++x) {
+            const uint32_t a = z * stride + x;
+            const uint32_t b = a + 1;
+            const uint32_t c = a + stride;
+            const uint32_t d = c + 1;
+            grid.triangles.push_back(Triangle{{a, b, c}, 0});
+            grid.triangles.push_back(Triangle{{b, d, c}, 0});
+        }
+    }
+    return grid;
+}
+
+std::unique_ptr<Mesh> makeGridMesh(int64_t targetTris) {
+    const GridGeometry& grid = gridGeometry(targetTris);
+    auto mesh = std::make_unique<Mesh>();
+    mesh->SetVertices(std::vector<Vertex>(grid.vertices));
+    mesh->SetTriangles(std::vector<Triangle>(grid.triangles));
+    mesh->AddMaterial(Material::Lambert(0.8f, 0.8f, 0.8f));
+    return mesh;
+}
+
+void setTriangleThroughput(benchmark::State& state, size_t triangles) {
+    state.counters["triangles"] = static_cast<double>(triangles);
+    state.counters["triangles/s"] = benchmark::Counter(
+        static_cast<double>(triangles) * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+
+// Placements for count instances: a random yaw and a random spot on the ground within extent
+// of the origin. Every value is drawn into a local first - the evaluation order of function
+// arguments is unspecified, so draws inside one call could differ between compilers.
+std::vector<Motor> makeRandomInstances(size_t count, uint32_t seed, float extent = 100.0f) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    std::uniform_real_distribution<float> position(-extent, extent);
+    const BiVector yAxis(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    std::vector<Motor> motors;
+    motors.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const float degrees = angle(rng);
+        const float x = position(rng);
+        const float z = position(rng);
+        const Motor translation(1.0f, x * 0.5f, 0.0f, z * 0.5f, 0.0f, 0.0f, 0.0f, 0.0f);
+        motors.push_back(translation * Motor::Rotation(degrees, yAxis));
+    }
+    return motors;
+}
+
+// 10K -> 10M triangles
+void meshSizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(10'000, 10'000'000)->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+static void BM_LoadFromFile(benchmark::State& state) {
+    const std::string path = std::string(FLYTRACER_RESOURCE_DIR) + "/pheasant.obj";
+    size_t triangles = 0;
+    for (auto _ : state) {
+        Mesh mesh;
+        if (!mesh.LoadFromFile(path)) {
+            state.SkipWithError("Failed to load pheasant.obj");
+            return;
+        }
+        triangles = mesh.TriangleCount();
+        benchmark::DoNotOptimize(mesh.Vertices().data());
+    }
+    setTriangleThroughput(state, triangles);
+}
+BENCHMARK(BM_LoadFromFile)->Unit(benchmark::kMillisecond);
+
+static void BM_BuildBVH(benchmark::State& state) {
+    auto mesh = makeGridMesh(state.range(0));
+    for (auto _ : state) {
+        mesh->BuildBVH();
+        benchmark::DoNotOptimize(mesh->BVHNodes().data());
+    }
+    setTriangleThroughput(state, mesh->TriangleCount());
+}
+BENCHMARK(BM_BuildBVH)->Apply(meshSizes);
+
+static void BM_ComputeNormals(benchmark::State& state) {
+    auto mesh = makeGridMesh(state.range(0));
+    for (auto _ : state) {
+        mesh->ComputeNormals();
+        benchmark::DoNotOptimize(mesh->Vertices().data());
+    }
+    setTriangleThroughput(state, mesh->TriangleCount());
+}
+BENCHMARK(BM_ComputeNormals)->Apply(meshSizes);
+
+static void BM_Decimate(benchmark::State& state) {
+    const size_t triangles = gridGeometry(state.range(0)).triangles.size();
+    for (auto _ : state) {
+        // Decimation is destructive - restore the full mesh outside the timed region
+        state.PauseTiming();
+        auto mesh = makeGridMesh(state.range(0));
+        state.ResumeTiming();
+
+        mesh->Decimate(0.5f);
+        benchmark::DoNotOptimize(mesh->Triangles().data());
+
+        state.PauseTiming();
+        mesh.reset();
+        state.ResumeTiming();
+    }
+    setTriangleThroughput(state, triangles);
+}
+BENCHMARK(BM_Decimate)->Apply(meshSizes);
+
+static void BM_ComputePhysicsData(benchmark::State& state) {
+    auto mesh = makeGridMesh(state.range(0));
+    for (auto _ : state) {
+        mesh->ComputePhysicsData();
+        benchmark::DoNotOptimize(mesh->FaceNormals().data());
+    }
+    setTriangleThroughput(state, mesh->TriangleCount());
+}
+BENCHMARK(BM_ComputePhysicsData)->Apply(meshSizes);
+
+static void BM_GenerateCylindricalUVs(benchmark::State& state) {
+    auto mesh = makeGridMesh(state.range(0));
+    for (auto _ : state) {
+        mesh->GenerateCylindricalUVs();
+        benchmark::DoNotOptimize(mesh->Vertices().data());
+    }
+    setTriangleThroughput(state, mesh->TriangleCount());
+}
+BENCHMARK(BM_GenerateCylindricalUVs)->Apply(meshSizes);
+
+// GPU packing done by VulkanRenderer::UploadMeshes, split across four meshes
+// so the per-mesh index rebasing is exercised. "compact" is the 16-byte quantized
+// vertex path (VulkanRenderer::EnableCompactVertices).
+static void BM_PackMeshes(benchmark::State& state, bool compactVertices) {
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    size_t triangles = 0;
+    for (int i = 0; i < 4; ++i) {
+        meshes.push_back(makeGridMesh(state.range(0) / 4));
+        meshes.back()->BuildBVH();
+        triangles += meshes.back()->TriangleCount();
+    }
+
+    for (auto _ : state) {
+        MeshPacking::PackedMeshes packed = MeshPacking::PackMeshes(meshes, compactVertices);
+        benchmark::DoNotOptimize(packed.vertices.data());
+        benchmark::DoNotOptimize(packed.compactVertices.data());
+        benchmark::DoNotOptimize(packed.bvhNodes.data());
+    }
+    setTriangleThroughput(state, triangles);
+}
+BENCHMARK_CAPTURE(BM_PackMeshes, full, false)->Apply(meshSizes);
+BENCHMARK_CAPTURE(BM_PackMeshes, compact, true)->Apply(meshSizes);
+
+// Per-frame instance conversion done by UploadInstances, 1K -> 1M instances
+static void BM_PackInstances(benchmark::State& state, bool batched) {
+    const auto count = static_cast<size_t>(state.range(0));
+    InstanceStore store;
+    const std::vector<Motor> motors = makeRandomInstances(count, 1);
+    for (size_t i = 0; i < count; ++i) {
+        (void)store.Create(static_cast<uint32_t>(i % 4), motors[i]);
+    }
+    const InstanceArrays& instances = store.Arrays();
+
+    std::vector<Scene::GPUMeshInstance> out(count);
+    for (auto _ : state) {
+        if (batched) {
+            InstancePacking::PackInstances(instances, out.data());
+        } else {
+            InstancePacking::PackInstancesScalar(instances, out.data());
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["instances/s"] = benchmark::Counter(
+        static_cast<double>(count) * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BM_PackInstances, scalar, false)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_PackInstances, batched, true)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+
+// Per-frame frustum culling done before UploadInstances: world bounds, then the plane test
+static void BM_CullInstances(benchmark::State& state, bool batched) {
+    const auto count = static_cast<size_t>(state.range(0));
+    InstanceStore store;
+    const std::vector<Motor> motors = makeRandomInstances(count, 1);
+    for (size_t i = 0; i < count; ++i) {
+        (void)store.Create(static_cast<uint32_t>(i % 4), motors[i]);
+    }
+    const InstanceArrays& instances = store.Arrays();
+
+    Scene::BVHNode root;
+    for (int a = 0; a < 3; ++a) {
+        root.minBounds[a] = -1.0f;
+        root.maxBounds[a] = 1.0f;
+    }
+    const std::vector<InstanceCulling::LocalBounds> meshBounds(4, InstanceCulling::LocalBounds::FromBVHRoot(root));
+    const float rotation[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    const float eye[3] = {0, 5, 0};
+    const auto frustum = InstanceCulling::Frustum::FromCamera(rotation, eye, 60.0f, 16.0f / 9.0f);
+
+    InstanceCulling::WorldBounds bounds;
+    std::vector<uint32_t> visible;
+    visible.reserve(count);
+    for (auto _ : state) {
+        InstanceCulling::ComputeWorldBounds(instances, meshBounds, bounds);
+        if (batched) {
+            InstanceCulling::CullInstances(instances, bounds, frustum, visible);
+        } else {
+            InstanceCulling::CullInstancesScalar(instances, bounds, frustum, visible);
+        }
+        benchmark::DoNotOptimize(visible.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["visible"] = static_cast<double>(visible.size());
+    state.counters["instances/s"] = benchmark::Counter(
+        static_cast<double>(count) * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BM_CullInstances, scalar, false)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_CullInstances, batched, true)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+
+// Per-publish LOD selection for a crowd spread out to 500 units from the camera. "triangles"
+// is the fraction of the full-detail triangle count the selected levels trace.
+static void BM_SelectMeshLods(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    InstanceStore store;
+    for (const Motor& motor : makeRandomInstances(count, 1, 500.0f)) {
+        (void)store.Create(0, motor);
+    }
+
+    Scene::BVHNode root;
+    for (int a = 0; a < 3; ++a) {
+        root.minBounds[a] = -1.0f;
+        root.maxBounds[a] = 1.0f;
+    }
+    MeshLod::LodTable table;
+    const uint32_t chain[] = {0, 1, 2, 3};
+    table.Add(chain, MeshLod::kDefaultRatios, root);
+    const float eye[3] = {0, 2, 0};
+
+    // Base mesh IDs are copied back in every iteration, as PublishRenderSnapshot does
+    InstanceArrays instances = store.Arrays();
+    std::vector<uint8_t> levels;
+    for (auto _ : state) {
+        instances.meshIds = store.Arrays().meshIds;
+        benchmark::DoNotOptimize(MeshLod::SelectLevels(table, instances, eye, 60.0f, MeshLod::kDefaultHysteresis, levels));
+        benchmark::ClobberMemory();
+    }
+    double triangles = 0.0;
+    for (const uint32_t mesh : instances.meshIds) {
+        triangles += MeshLod::kDefaultRatios[mesh];
+    }
+    state.counters["triangles"] = triangles / static_cast<double>(count);
+    state.counters["instances/s"] = benchmark::Counter(
+        static_cast<double>(count) * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SelectMeshLods)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+
+// Per-frame keyframe evaluation done by GameScene::UpdateAnimations: four-key motor tracks
+// on a clock advancing by one 60 Hz frame per iteration
+static void BM_EvaluateAnimations(benchmark::State& state, bool batched) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const std::vector<Motor> placements = makeRandomInstances(count * 4, 1);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> phase(0.0f, 6.0f);
+    AnimationTracks tracks;
+    for (size_t i = 0; i < count; ++i) {
+        MotorKey keys[4];
+        for (size_t k = 0; k < 4; ++k) {
+            keys[k] = {static_cast<float>(k), placements[i * 4 + k]};
+        }
+        (void)tracks.AddMotorTrack(keys, AnimationWrap::Loop, phase(rng));
+    }
+
+    std::vector<Motor> motors;
+    float time = 0.0f;
+    for (auto _ : state) {
+        time += 1.0f / 60.0f;
+        if (batched) {
+            tracks.EvaluateMotors(time, motors);
+        } else {
+            tracks.EvaluateMotorsScalar(time, motors);
+        }
+        benchmark::DoNotOptimize(motors.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["tracks/s"] = benchmark::Counter(
+        static_cast<double>(count) * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BM_EvaluateAnimations, scalar, false)->RangeMultiplier(10)->Range(1'000, 100'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_EvaluateAnimations, batched, true)->RangeMultiplier(10)->Range(1'000, 100'000)->Unit(benchmark::kMicrosecond);
+
+// One motor applied to many points: the FlyFish sandwich product per point vs. the batch
+// kernel (matrix form, eight points per iteration with AVX2)
+static void BM_TransformPoints(benchmark::State& state, bool batched) {
+    const auto count = static_cast<size_t>(state.range(0));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::vector<TriVector> points(count);
+    for (TriVector& p : points) {
+        const float x = position(rng);
+        const float y = position(rng);
+        const float z = position(rng);
+        p = TriVector(x, y, z);
+    }
+    const BiVector yAxis(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    const Motor motor = Motor(1.0f, 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f) * Motor::Rotation(0.5f, yAxis);
+
+    for (auto _ : state) {
+        if (batched) {
+            MotorTransforms::TransformPoints(motor, points);
+        } else {
+            for (TriVector& p : points) {
+                p = (motor * p * ~motor).Grade3();
+            }
+        }
+        benchmark::DoNotOptimize(points.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["points/s"] = benchmark::Counter(
+        static_cast<double>(count) * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BM_TransformPoints, sandwich, false)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_TransformPoints, batched, true)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+
+// Mesh::Transform on the benchmark grid (positions and normals)
+static void BM_TransformVertices(benchmark::State& state) {
+    std::vector<Vertex> vertices = gridGeometry(state.range(0)).vertices;
+    const BiVector yAxis(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    const Motor motor = Motor::Rotation(0.5f, yAxis);
+    for (auto _ : state) {
+        MotorTransforms::TransformVertices(motor, vertices);
+        benchmark::DoNotOptimize(vertices.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["vertices/s"] = benchmark::Counter(
+        static_cast<double>(vertices.size()) * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TransformVertices)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+
+// Texel copy done for every texture in UploadMeshes, straight into staging memory
+static void BM_WriteTexels(benchmark::State& state) {
+    const auto side = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> rgba(static_cast<size_t>(side) * side * 4);
+    for (size_t i = 0; i < rgba.size(); ++i) {
+        rgba[i] = static_cast<uint8_t>(i * 31);
+    }
+    const MeshPacking::TexelSource sources[] = {{rgba.data(), side, side, Scene::TextureFormat::RGBA8}};
+
+    std::vector<Scene::GPUTextureInfo> infos;
+    std::vector<uint32_t> staging(MeshPacking::LayoutTextures(sources, infos));
+    for (auto _ : state) {
+        MeshPacking::WriteTexels(sources, infos, staging.data());
+        benchmark::DoNotOptimize(staging.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["texels/s"] = benchmark::Counter(
+        static_cast<double>(side) * side * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+    state.counters["MB"] = static_cast<double>(staging.size() * sizeof(uint32_t)) / (1 << 20);
+}
+BENCHMARK(BM_WriteTexels)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMillisecond);
+
+// Mip chain of a square RGBA8 texture, as built for EnableSampledTextures
+static void BM_GenerateMipChain(benchmark::State& state, bool batched) {
+    const auto side = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> rgba(static_cast<size_t>(side) * side * 4);
+    for (size_t i = 0; i < rgba.size(); ++i) {
+        rgba[i] = static_cast<uint8_t>(i * 31);
+    }
+    const auto levels = TextureMips::LayoutMipChain(side, side);
+    std::vector<uint8_t> chain(TextureMips::ChainTexels(levels) * 4);
+
+    for (auto _ : state) {
+        if (batched) {
+            TextureMips::GenerateMipChain(rgba.data(), levels, chain.data());
+        } else {
+            std::copy(rgba.begin(), rgba.end(), chain.begin());
+            for (size_t i = 1; i < levels.size(); ++i) {
+                TextureMips::DownsampleScalar(chain.data() + levels[i - 1].offset * 4, levels[i - 1].width,
+                                              levels[i - 1].height, chain.data() + levels[i].offset * 4);
+            }
+        }
+        benchmark::DoNotOptimize(chain.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["texels/s"] = benchmark::Counter(
+        static_cast<double>(side) * side * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BM_GenerateMipChain, scalar, false)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_GenerateMipChain, batched, true)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMillisecond);
+
+enum class TextureLoadMode { Serial, Parallel, Cached };
+
+// The resource textures, decoded on one thread, on all of them, or mapped from a warm cache
+static void BM_LoadTextures(benchmark::State& state, TextureLoadMode mode) {
+    const std::string dir = FLYTRACER_RESOURCE_DIR;
+    const std::vector<std::string> paths = {dir + "/pheasant.png", dir + "/teapot.png"};
+    TextureCache::Options options;
+    options.generateMips = true;
+    options.threadCount = mode == TextureLoadMode::Serial ? 1 : 0;
+    const auto cacheDir = std::filesystem::temp_directory_path() /
+                          ("flytracer_bench_texture_cache_" + std::to_string(std::random_device{}()));
+    if (mode == TextureLoadMode::Cached) {
+        options.cacheDirectory = cacheDir.string();
+        (void)TextureCache::LoadTextures(paths, options);
+    }
+
+    size_t texels = 0;
+    for (auto _ : state) {
+        const auto loaded = TextureCache::LoadTextures(paths, options);
+        texels = 0;
+        for (const auto& texture : loaded.textures) {
+            if (texture.contentHash == 0) {
+                state.SkipWithError("Failed to load the resource textures");
+                return;
+            }
+            texels += static_cast<size_t>(texture.source.width) * texture.source.height;
+        }
+        benchmark::DoNotOptimize(loaded.textures.data());
+    }
+    state.counters["texels/s"] = benchmark::Counter(
+        static_cast<double>(texels) * static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    if (mode == TextureLoadMode::Cached) {
+        std::filesystem::remove_all(cacheDir);
+    }
+}
+BENCHMARK_CAPTURE(BM_LoadTextures, serial, TextureLoadMode::Serial)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadTextures, parallel, TextureLoadMode::Parallel)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadTextures, cached, TextureLoadMode::Cached)->Unit(benchmark::kMillisecond);
+
+// Every tile of a square RGBA8 level cut into bordered pages, as the virtual texture worker does
+static void BM_ExtractTiles(benchmark::State& state) {
+    const auto side = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> rgba(static_cast<size_t>(side) * side * 4);
+    for (size_t i = 0; i < rgba.size(); ++i) {
+        rgba[i] = static_cast<uint8_t>(i * 31);
+    }
+    const uint32_t tilesPerSide = (side + VirtualTexture::kTileSize - 1) / VirtualTexture::kTileSize;
+    std::vector<uint32_t> page(VirtualTexture::kPageTexels);
+
+    for (auto _ : state) {
+        for (uint32_t y = 0; y < tilesPerSide; ++y) {
+            for (uint32_t x = 0; x < tilesPerSide; ++x) {
+                VirtualTexture::ExtractTile(rgba.data(), side, side, x, y, page.data());
+                benchmark::DoNotOptimize(page.data());
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.counters["tiles/s"] = benchmark::Counter(
+        static_cast<double>(tilesPerSide) * tilesPerSide * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ExtractTiles)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "FlyFish.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// What a track does outside its first and last key
+enum class AnimationWrap : uint8_t {
+    Clamp,  // Hold the end keys
+    Loop,   // Repeat from the first key (make the last key equal the first for a seamless loop)
+};
+
+struct MotorKey {
+    float time{0.0f};
+    Motor motor;
+};
+
+struct ScalarKey {
+    float time{0.0f};
+    float value{0.0f};
+};
+
+// Keyframed tracks evaluated together at one clock time. Motor tracks interpolate by normalized
+// lerp of the motor components (a screw-like path, exact at the keys), taking the short way
+// round between keys; scalar tracks interpolate linearly. Tracks only produce values - binding
+// them to instances, spheres or lights is up to the caller (see GameScene::UpdateAnimations).
+//
+// Keys of all tracks share flat arrays and every track keeps a cursor to its current segment,
+// so evaluating a clock that moves forward is O(1) per track whatever its key count. With AVX2
+// both the segment lookup and the motor blend run eight tracks at a time.
+class AnimationTracks {
+public:
+    // Keys must be non-empty with strictly increasing times (std::invalid_argument otherwise).
+    // timeOffset is added to the clock, e.g. to desynchronize copies of one clip. Returns the
+    // track's index in the Evaluate outputs.
+    uint32_t AddMotorTrack(std::span<const MotorKey> keys, AnimationWrap wrap = AnimationWrap::Loop,
+                           float timeOffset = 0.0f);
+    uint32_t AddScalarTrack(std::span<const ScalarKey> keys, AnimationWrap wrap = AnimationWrap::Loop,
+                            float timeOffset = 0.0f);
+    void Clear();
+
+    [[nodiscard]] size_t MotorTrackCount() const noexcept { return m_motorClocks.Size(); }
+    [[nodiscard]] size_t ScalarTrackCount() const noexcept { return m_scalarClocks.Size(); }
+
+    // One motor per motor track, normalized. One track at a time - the reference for EvaluateMotors.
+    void EvaluateMotorsScalar(float time, std::vector<Motor>& out);
+    // Same result, eight tracks per iteration with AVX2 when the build targets it
+    void EvaluateMotors(float time, std::vector<Motor>& out);
+    void EvaluateScalars(float time, std::vector<float>& out);
+
+private:
+    // Timing of every track of one kind, SoA. Each track's keys are [firstKey, lastKey]; a
+    // single key is stored twice so that every track has a segment [from, from + 1].
+    struct TrackClocks {
+        std::vector<float> offset;
+        std::vector<float> start;
+        std::vector<float> end;
+        std::vector<float> length;
+        std::vector<float> invLength;  // 0 for AnimationWrap::Clamp, so the wrap is a no-op
+        std::vector<uint32_t> firstKey;
+        std::vector<uint32_t> lastKey;
+        std::vector<uint32_t> cursor;  // Key starting the segment of the last evaluation
+
+        std::vector<float> keyTimes;
+        std::vector<float> keyInvSpan;  // 1 / duration of the segment starting at the key
+
+        // Segment of the last Locate, per track
+        std::vector<uint32_t> from;
+        std::vector<float> weight;
+
+        [[nodiscard]] size_t Size() const noexcept { return offset.size(); }
+        void Add(std::span<const float> times, AnimationWrap wrap, float timeOffset);
+        void Clear();
+        void LocateScalar(float time) noexcept;
+        void Locate(float time) noexcept;  // Same result, eight tracks at a time with AVX2
+
+    private:
+        [[nodiscard]] float wrap(size_t track, float time) const noexcept;
+        void relocate(size_t track, float t) noexcept;
+        void locateOne(size_t track, float time) noexcept;
+    };
+
+    TrackClocks m_motorClocks;
+    // Components s, e01, e02, e03, e23, e31, e12, e0123 per key, each key on the same side of
+    // the rotor double cover as the key before it
+    std::vector<float> m_motorKeys;
+
+    TrackClocks m_scalarClocks;
+    std::vector<float> m_scalarKeys;
+
+    std::vector<float> m_keyTimes;  // Scratch for Add
+};
@@ -1,15 +1,21 @@
 #pragma once
 
 #include <SDL3/SDL.h>
+#include <imgui.h>
 #include <array>
+#include <atomic>
+#include <exception>
 #include <vector>
 #include <string>
 #include <memory>
+#include <thread>
 
 #include "Scene.h"
 #include "FlyFish.h"
+#include "Benchmark.h"
 #include "GameScene.h"  // For MeshInstance definition
 #include "VulkanRenderer.h"  // Vulkan rendering abstraction
+#include "SpscQueue.h"
 
 class Mesh;
 
@@ -26,12 +32,25 @@ public:
     Application(Application&&) = delete;
     Application& operator=(Application&&) = delete;
 
+    // How run() paces simulation against rendering. See "Render Thread" in getting-started.md
+    // for the latency/throughput trade-off of each setting.
+    struct FrameLoopConfig {
+        bool renderThread{false};     // Acquire, record, submit and present on a dedicated thread
+        uint32_t queuedFrames{1};     // Frames the game thread may get ahead of the render thread
+        float simulationRate{0.0f};   // Fixed update rate in Hz; 0 = one variable-step update per frame
+    };
+    void setFrameLoop(const FrameLoopConfig& config) { m_frameLoop = config; }
+
     void run();
 
+    // Deterministic playback for performance measurement: fixed timestep, scripted
+    // camera path and no user input. Collects CPU and GPU frame times.
+    [[nodiscard]] FlyTracer::BenchmarkReport runBenchmark(const FlyTracer::BenchmarkSpec& spec);
+
     // Scene management
     void setScene(const Scene::SceneData& scene);
-    Scene::SceneData& getScene() { return m_sceneData; }
-    const Scene::SceneData& getScene() const { return m_sceneData; }
+    Scene::SceneData& getScene() { return m_gameScene->GetSceneData(); }
+    const Scene::SceneData& getScene() const { return m_gameScene->GetSceneData(); }
 
     // Camera control using three PGA points (TriVectors)
     // eye: camera position, target: look-at point, up: point above eye defining up direction
@@ -49,6 +68,34 @@ private:
     void processInput(float deltaTime);
     void update(float deltaTime);
     void render();
+    void updateCameraRotation();
+    void uploadInstances(const RenderSnapshot& scene, InstanceRange changed, const float cameraRotation[9],
+                         const float cameraPosition[3], float cameraFov, float cameraAspect);
+    void buildUi();
+    void waitRendererIdle();
+
+    // Render thread (FrameLoopConfig::renderThread). Everything the render thread reads for a
+    // frame is copied into a QueuedFrame; scene code only ever runs on the game thread.
+    struct QueuedFrame {
+        RenderSnapshot scene;
+        std::array<float, 9> cameraRotation{};
+        std::array<float, 3> cameraPosition{};
+        float time{0.0f};
+        float cameraFov{45.0f};
+        float cameraAspect{1.0f};  // Width over height, for instance culling
+        bool requestPick{false};
+        float pickX{0.0f};
+        float pickY{0.0f};
+        bool waitIdle{false};  // Window visibility or focus changed (see handleEvents)
+        bool quit{false};      // The render thread exits after this frame
+        ImDrawData ui;                                     // Lists point into uiLists
+        std::vector<std::unique_ptr<ImDrawList>> uiLists;  // Copied ImGui output, reused
+    };
+    void runThreaded();
+    void publishFrame();
+    void stopRenderThread();
+    void renderThreadMain();
+    void renderQueuedFrame(QueuedFrame& frame);
 
     // Cleanup
     void cleanup();
@@ -65,10 +112,6 @@ private:
     // Vulkan rendering (all Vulkan code now in VulkanRenderer)
     std::unique_ptr<VulkanRenderer> m_renderer;
 
-    // Scene data (owned by GameScene, cached here for rendering)
-    Scene::SceneData m_sceneData;
-    std::vector<MeshInstance> m_meshInstances;
-
     // Game scene
     std::unique_ptr<GameScene> m_gameScene;
 
@@ -80,6 +123,7 @@ private:
     TriVector m_cameraEye{0.0f, 3.5f, 8.0f};     // Camera position
     TriVector m_cameraTarget{0.0f, 1.5f, 0.0f};  // Look-at point
     TriVector m_cameraUp{0.0f, 4.5f, 8.0f};      // Point above eye (defines up direction)
+    const std::vector<FlyTracer::CameraKeyframe>* m_cameraPath{nullptr};  // Scripted camera (benchmark runs)
 
     // Input state - passed to GameScene for handling
     bool m_rightMouseDown{false};
@@ -118,8 +162,29 @@ private:
     float m_fpsAccumulator{0.0f};
     uint32_t m_fpsFrameCount{0};
 
+    // Frame loop and render thread state
+    FrameLoopConfig m_frameLoop;
+    std::unique_ptr<SpscQueue<QueuedFrame>> m_frameQueue;  // Game thread -> render thread
+    std::unique_ptr<SpscQueue<PickResult>> m_pickQueue;    // Render thread -> game thread
+    std::jthread m_renderThread;
+    std::exception_ptr m_renderError;        // Set by the render thread, read after join
+    std::atomic<bool> m_renderFailed{false};
+    std::atomic<uint32_t> m_renderedFrames{0};
+    float m_renderFps{0.0f};
+    float m_simulationAccumulator{0.0f};     // Unsimulated time with a fixed simulationRate
+    bool m_pendingWaitIdle{false};
+    PickResult m_lastPick;
+
     // Camera rotation matrix (row-major 3x3) and FOV for rendering
     // Row 0: right vector, Row 1: up vector, Row 2: forward vector (-Z)
     std::array<float, 9> m_cameraRotation{1, 0, 0, 0, 1, 0, 0, 0, 1};  // Identity rotation
     float m_cameraFov{45.0f};
+
+    // Instance culling (RenderSnapshot::cullMode), run by whichever thread renders
+    std::vector<InstanceCulling::LocalBounds> m_meshBounds;  // By mesh ID, from the BVH roots
+    InstanceCulling::WorldBounds m_instanceBounds;
+    std::vector<uint32_t> m_visibleInstances;
+    std::atomic<uint32_t> m_uploadedInstances{0};            // For the UI
+    InstanceRange m_instanceChanges;  // Published since the last frame was handed to the renderer
+    InstanceRange m_droppedInstanceChanges;  // Render thread: from queued frames that failed to start
 };
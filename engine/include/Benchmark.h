@@ -0,0 +1,243 @@
+#pragma once
+
+#include "Json.h"
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace FlyTracer {
+
+// Camera pose at a point in benchmark time - up is a direction, matching GameScene::SetCamera
+struct CameraKeyframe {
+    float time{0.0f};
+    std::array<float, 3> eye{0.0f, 3.5f, 8.0f};
+    std::array<float, 3> target{0.0f, 1.5f, 0.0f};
+    std::array<float, 3> up{0.0f, 1.0f, 0.0f};
+};
+
+// Piecewise-linear camera path; times outside the keyframe range clamp to the ends
+[[nodiscard]] inline CameraKeyframe SampleCameraPath(const std::vector<CameraKeyframe>& path, float time) noexcept {
+    if (path.empty()) return CameraKeyframe{};
+    if (time <= path.front().time) return path.front();
+    if (time >= path.back().time) return path.back();
+
+    const auto next = std::upper_bound(path.begin(), path.end(), time,
+        [](float t, const CameraKeyframe& key) { return t < key.time; });
+    const auto& b = *next;
+    const auto& a = *(next - 1);
+    const float span = b.time - a.time;
+    const float s = span > 0.0f ? (time - a.time) / span : 0.0f;
+
+    CameraKeyframe result;
+    result.time = time;
+    for (int i = 0; i < 3; ++i) {
+        result.eye[i] = a.eye[i] + (b.eye[i] - a.eye[i]) * s;
+        result.target[i] = a.target[i] + (b.target[i] - a.target[i]) * s;
+        result.up[i] = a.up[i] + (b.up[i] - a.up[i]) * s;
+    }
+    return result;
+}
+
+// Summary statistics of a set of frame times (milliseconds)
+struct FrameTimeStats {
+    size_t samples{0};
+    double mean{0.0};
+    double p50{0.0};
+    double p95{0.0};
+    double p99{0.0};
+    double min{0.0};
+    double max{0.0};
+
+    // Nearest-rank percentiles, so every reported value is an actual sample
+    [[nodiscard]] static FrameTimeStats Compute(std::vector<double> times) {
+        FrameTimeStats stats;
+        stats.samples = times.size();
+        if (times.empty()) return stats;
+
+        std::sort(times.begin(), times.end());
+        auto percentile = [&](double p) {
+            const auto rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(times.size())));
+            return times[std::clamp<size_t>(rank, 1, times.size()) - 1];
+        };
+
+        double sum = 0.0;
+        for (const double t : times) sum += t;
+        stats.mean = sum / static_cast<double>(times.size());
+        stats.p50 = percentile(50.0);
+        stats.p95 = percentile(95.0);
+        stats.p99 = percentile(99.0);
+        stats.min = times.front();
+        stats.max = times.back();
+        return stats;
+    }
+
+    [[nodiscard]] JsonValue ToJson() const {
+        if (samples == 0) return JsonValue{};
+        JsonValue json = JsonValue::Object();
+        json.Set("samples", JsonValue::Number(static_cast<double>(samples)));
+        json.Set("mean", JsonValue::Number(mean));
+        json.Set("p50", JsonValue::Number(p50));
+        json.Set("p95", JsonValue::Number(p95));
+        json.Set("p99", JsonValue::Number(p99));
+        json.Set("min", JsonValue::Number(min));
+        json.Set("max", JsonValue::Number(max));
+        return json;
+    }
+};
+
+// Benchmark description loaded from `--bench <file>.json`:
+// {
+//   "scene": "testbox", "width": 1280, "height": 720,
+//   "warmup_frames": 60, "frames": 600, "timestep": 0.016666,
+//   "output": "bench_report.json",
+//   "baseline": "baseline.json", "max_regression": 0.10,
+//   "camera_path": [ { "time": 0.0, "eye": [0, 3, 8], "target": [0, 1, 0], "up": [0, 1, 0] }, ... ]
+// }
+struct BenchmarkSpec {
+    std::string scene{"debug"};
+    int width{1280};
+    int height{720};
+    int warmupFrames{60};
+    int frames{600};
+    float timestep{1.0f / 60.0f};            // Fixed simulation step - wall clock is never used
+    std::string outputPath{"bench_report.json"};
+    std::string baselinePath;                // Optional report to compare against
+    double maxRegression{0.10};              // Allowed relative p50/p95 slowdown vs baseline
+    std::vector<CameraKeyframe> cameraPath;  // Empty = scene-driven camera
+
+    [[nodiscard]] bool loadFromJson(const JsonValue& json) {
+        if (!json.IsObject()) return false;
+
+        if (json["scene"].IsString()) scene = json["scene"].AsString();
+        width = static_cast<int>(json["width"].AsNumber(width));
+        height = static_cast<int>(json["height"].AsNumber(height));
+        warmupFrames = std::max(0, static_cast<int>(json["warmup_frames"].AsNumber(warmupFrames)));
+        frames = std::max(1, static_cast<int>(json["frames"].AsNumber(frames)));
+        timestep = static_cast<float>(json["timestep"].AsNumber(timestep));
+        if (json["output"].IsString()) outputPath = json["output"].AsString();
+        if (json["baseline"].IsString()) baselinePath = json["baseline"].AsString();
+        maxRegression = json["max_regression"].AsNumber(maxRegression);
+
+        cameraPath.clear();
+        const JsonValue& path = json["camera_path"];
+        for (size_t i = 0; i < (path.IsArray() ? path.Size() : 0); ++i) {
+            const JsonValue& key = path[i];
+            CameraKeyframe frame;
+            frame.time = static_cast<float>(key["time"].AsNumber(0.0));
+            readVec3(key["eye"], frame.eye);
+            readVec3(key["target"], frame.target);
+            readVec3(key["up"], frame.up);
+            cameraPath.push_back(frame);
+        }
+        std::stable_sort(cameraPath.begin(), cameraPath.end(),
+            [](const CameraKeyframe& a, const CameraKeyframe& b) { return a.time < b.time; });
+
+        return timestep > 0.0f && width > 0 && height > 0;
+    }
+
+    [[nodiscard]] bool loadFromFile(const std::string& filename) {
+        JsonValue json;
+        if (!JsonValue::ParseFile(filename, json) || !loadFromJson(json)) {
+            std::cerr << "Benchmark: Could not load spec " << filename << "\n";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static void readVec3(const JsonValue& value, std::array<float, 3>& out) noexcept {
+        if (!value.IsArray() || value.Size() != 3) return;
+        for (size_t i = 0; i < 3; ++i) {
+            out[i] = static_cast<float>(value[i].AsNumber(out[i]));
+        }
+    }
+};
+
+// Results of one benchmark run
+struct BenchmarkReport {
+    std::string scene;
+    int width{0};
+    int height{0};
+    int frames{0};
+    float timestep{0.0f};
+    FrameTimeStats cpu;   // Update + record + submit, per frame
+    FrameTimeStats gpu;   // Raytracing dispatch from timestamp queries (empty if unsupported)
+
+    [[nodiscard]] JsonValue ToJson() const {
+        JsonValue json = JsonValue::Object();
+        json.Set("scene", JsonValue::String(scene));
+        json.Set("width", JsonValue::Number(width));
+        json.Set("height", JsonValue::Number(height));
+        json.Set("frames", JsonValue::Number(frames));
+        json.Set("timestep", JsonValue::Number(timestep));
+        json.Set("cpu_frame_ms", cpu.ToJson());
+        json.Set("gpu_frame_ms", gpu.ToJson());
+        return json;
+    }
+
+    [[nodiscard]] bool saveToFile(const std::string& filename) const {
+        std::ofstream file(filename);
+        if (!file) {
+            std::cerr << "Benchmark: Could not write to " << filename << "\n";
+            return false;
+        }
+        ToJson().Write(file);
+        file << "\n";
+        std::cout << "Benchmark: Report written to " << filename << "\n";
+        return true;
+    }
+
+    // Compare p50/p95 of each timing group against a stored report of the same scene, size,
+    // frame count and timestep.
+    // Returns false if the runs are not comparable, a group the baseline measured is missing, or
+    // any metric is slower than baseline * (1 + maxRegression).
+    [[nodiscard]] bool compareToBaseline(const JsonValue& baseline, double maxRegression,
+                                         std::ostream& log) const {
+        const std::string baselineScene = baseline["scene"].IsString() ? baseline["scene"].AsString() : std::string{};
+        const int baselineWidth = static_cast<int>(baseline["width"].AsNumber(-1.0));
+        const int baselineHeight = static_cast<int>(baseline["height"].AsNumber(-1.0));
+        const int baselineFrames = static_cast<int>(baseline["frames"].AsNumber(-1.0));
+        const auto baselineTimestep = static_cast<float>(baseline["timestep"].AsNumber(-1.0));
+        if (baselineScene != scene || baselineWidth != width || baselineHeight != height ||
+            baselineFrames != frames || baselineTimestep != timestep) {
+            log << "  baseline is " << baselineScene << " at " << baselineWidth << "x" << baselineHeight
+                << ", " << baselineFrames << " frames of " << baselineTimestep << "s; run is " << scene
+                << " at " << width << "x" << height << ", " << frames << " frames of " << timestep
+                << "s  MISMATCH\n";
+            return false;
+        }
+
+        const JsonValue current = ToJson();
+        bool passed = true;
+        for (const char* group : {"cpu_frame_ms", "gpu_frame_ms"}) {
+            const JsonValue& before = baseline[group];
+            const JsonValue& after = current[group];
+            if (!before.IsObject()) continue;
+            if (!after.IsObject()) {
+                log << "  " << group << ": missing from this run  MISSING\n";
+                passed = false;
+                continue;
+            }
+
+            for (const char* metric : {"p50", "p95"}) {
+                const double reference = before[metric].AsNumber();
+                const double measured = after[metric].AsNumber();
+                if (reference <= 0.0) continue;
+
+                const double change = measured / reference - 1.0;
+                const bool regressed = change > maxRegression;
+                log << "  " << group << "." << metric << ": " << reference << " -> " << measured
+                    << " (" << (change >= 0.0 ? "+" : "") << change * 100.0 << "%)"
+                    << (regressed ? "  REGRESSION" : "") << "\n";
+                passed = passed && !regressed;
+            }
+        }
+        return passed;
+    }
+};
+
+} // namespace FlyTracer
@@ -53,6 +53,11 @@ struct AppConfig {
     bool fullscreen{false};
     bool vsync{true};
 
+    // Frame loop (see Application::FrameLoopConfig)
+    bool renderThread{false};
+    int queuedFrames{1};
+    float simulationRate{0.0f};
+
     // Raytracing settings
     int maxRayBounces{3};
     int samplesPerPixel{1};
@@ -115,6 +120,10 @@ struct AppConfig {
              << "window_title=" << windowTitle << "\n"
              << "fullscreen=" << (fullscreen ? "true" : "false") << "\n"
              << "vsync=" << (vsync ? "true" : "false") << "\n\n"
+             << "# Frame Loop\n"
+             << "render_thread=" << (renderThread ? "true" : "false") << "\n"
+             << "queued_frames=" << queuedFrames << "\n"
+             << "simulation_rate=" << simulationRate << "\n\n"
              << "# Raytracing Settings\n"
              << "max_ray_bounces=" << maxRayBounces << "\n"
              << "samples_per_pixel=" << samplesPerPixel << "\n"
@@ -146,6 +155,14 @@ private:
         } else if (key == "vsync") {
             vsync = (value == "true" || value == "1");
         }
+        // Frame loop
+        else if (key == "render_thread") {
+            renderThread = (value == "true" || value == "1");
+        } else if (key == "queued_frames") {
+            detail::parseNumber(value, queuedFrames);
+        } else if (key == "simulation_rate") {
+            detail::parseFloat(value, simulationRate);
+        }
         // Raytracing settings
         else if (key == "max_ray_bounces") {
             detail::parseNumber(value, maxRayBounces);
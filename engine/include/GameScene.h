@@ -3,11 +3,16 @@
 #include "Scene.h"
 #include "FlyFish.h"
 #include "Mesh.h"
+#include "InstanceStore.h"
+#include "InstanceCulling.h"
+#include "Animation.h"
+#include "MeshLod.h"
+#include <array>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
-#include <unordered_map>
 #include <cstdint>
 #include <cmath>
 
@@ -28,12 +33,32 @@ struct DebugSphere {
     float color[3];
 };
 
-struct MeshInstance {
-    uint32_t meshId;
-    Motor transform;
-    float scale{1.0f};
-    bool visible{true};
-    std::string name;
+// Everything the renderer needs each frame, published by GameScene::PublishRenderSnapshot.
+// Plain data: after the first few frames publishing reuses vector capacity and never allocates.
+struct RenderSnapshot {
+    std::vector<Scene::GPUSphere> spheres;
+    std::vector<Scene::GPUPlane> planes;
+    InstanceArrays instances;
+    InstanceRange instancesChanged;  // Since the previous publish
+    std::vector<Scene::GPULight> lights;
+    TriVector cameraEye;
+    TriVector cameraTarget;
+    TriVector cameraUp;
+    float cameraFov{45.0f};
+    InstanceCullMode cullMode{InstanceCullMode::Off};
+    float cullMargin{0.0f};
+};
+
+// Object under a screen pixel, read back from the GPU object-ID buffer
+// Results lag the cursor by the number of frames in flight
+struct PickResult {
+    bool valid{false};            // A readback has completed (false until picking is enabled and warmed up)
+    bool hit{false};              // Something was under the pixel
+    int32_t primitiveType{-1};    // 0 = mesh triangle, 1 = sphere, 2 = plane
+    uint32_t index{0};            // Mesh instance index, or sphere/plane index
+    uint32_t triangleIndex{0};    // Triangle within the mesh (mesh hits only)
+    uint32_t pixelX{0};           // Pixel the result was read from
+    uint32_t pixelY{0};
 };
 
 // Input state passed to OnInput
@@ -72,6 +97,9 @@ struct InputState {
     bool keyT{false};  // Toggle something
     bool keyEsc{false}; // Escape
 
+    // Object under the cursor (only filled when picking is enabled on the scene)
+    PickResult pick;
+
     float deltaTime{0.0f};
 };
 
@@ -96,8 +124,24 @@ public:
 
     [[nodiscard]] const std::vector<std::unique_ptr<Mesh>>& GetMeshes() const noexcept { return m_meshes; }
     [[nodiscard]] std::vector<std::unique_ptr<Mesh>>& GetMeshes() noexcept { return m_meshes; }
-    [[nodiscard]] const std::vector<MeshInstance>& GetMeshInstances() const noexcept { return m_meshInstances; }
-    [[nodiscard]] std::vector<MeshInstance>& GetMeshInstances() noexcept { return m_meshInstances; }
+    [[nodiscard]] const InstanceStore& GetInstances() const noexcept { return m_instances; }
+    [[nodiscard]] std::string_view GetInstanceName(InstanceHandle instance) const noexcept { return m_instances.Name(instance); }
+    // Instance at an index of the GPU instance buffer, e.g. PickResult::index
+    [[nodiscard]] InstanceHandle GetInstanceHandle(uint32_t gpuIndex) const noexcept { return m_instances.HandleAt(gpuIndex); }
+
+    // Double-buffered render state: Publish updates child world transforms, copies the current
+    // scene into the back buffer and swaps it to the front. The published snapshot stays valid
+    // until the next publish but one.
+    void PublishRenderSnapshot();
+    [[nodiscard]] const RenderSnapshot& GetRenderSnapshot() const noexcept { return m_snapshots[m_frontSnapshot]; }
+
+    // Advance the animation clock and write every keyframe track into its target (called by
+    // Application before OnUpdate, so OnUpdate can still override animated values)
+    void UpdateAnimations(float deltaTime);
+    void SetAnimationTime(float time) noexcept { m_animationTime = time; }
+    [[nodiscard]] float GetAnimationTime() const noexcept { return m_animationTime; }
+    void SetAnimationSpeed(float speed) noexcept { m_animationSpeed = speed; }  // 0 pauses
+    [[nodiscard]] float GetAnimationSpeed() const noexcept { return m_animationSpeed; }
 
     [[nodiscard]] Mesh* GetMesh(uint32_t id) noexcept {
         return id < m_meshes.size() ? m_meshes[id].get() : nullptr;
@@ -131,21 +175,111 @@ public:
     void SetDebugDrawEnabled(bool enabled) { m_debugDrawEnabled = enabled; }
     [[nodiscard]] bool IsDebugDrawEnabled() const { return m_debugDrawEnabled; }
 
+    // GPU picking - must be enabled before OnInit returns; fills InputState::pick
+    void SetPickingEnabled(bool enabled) { m_pickingEnabled = enabled; }
+    [[nodiscard]] bool IsPickingEnabled() const { return m_pickingEnabled; }
+
+    // AOV outputs (depth, normal, albedo, IDs) - must be enabled before OnInit returns
+    void SetAOVOutputEnabled(bool enabled) { m_aovOutputEnabled = enabled; }
+    [[nodiscard]] bool IsAOVOutputEnabled() const { return m_aovOutputEnabled; }
+
+    // VulkanRenderer::SubmitVisibilityQuery and RenderMultiView - must be enabled before OnInit
+    // returns. Like AOV readback they rule out --render-thread.
+    void SetVisibilityQueriesEnabled(bool enabled) { m_visibilityQueriesEnabled = enabled; }
+    [[nodiscard]] bool IsVisibilityQueriesEnabled() const { return m_visibilityQueriesEnabled; }
+    void SetMultiViewEnabled(bool enabled) { m_multiViewEnabled = enabled; }
+    [[nodiscard]] bool IsMultiViewEnabled() const { return m_multiViewEnabled; }
+
+    // 16-byte quantized GPU vertices (see GPUCompactVertex) - must be enabled before OnInit returns
+    void SetCompactVerticesEnabled(bool enabled) { m_compactVerticesEnabled = enabled; }
+    [[nodiscard]] bool IsCompactVerticesEnabled() const { return m_compactVerticesEnabled; }
+
+    // Mipmapped 8-bit textures sampled with a ray-cone LOD - must be enabled before OnInit returns.
+    // Ignored where the device cannot index sampler arrays non-uniformly.
+    void SetSampledTexturesEnabled(bool enabled) { m_sampledTexturesEnabled = enabled; }
+    [[nodiscard]] bool IsSampledTexturesEnabled() const { return m_sampledTexturesEnabled; }
+
+    // Directory for decoded textures, so later runs skip decoding - must be set before OnInit
+    // returns. Empty (the default) disables the cache.
+    void SetTextureCacheDirectory(const std::string& directory) { m_textureCacheDirectory = directory; }
+    [[nodiscard]] const std::string& GetTextureCacheDirectory() const { return m_textureCacheDirectory; }
+
+    // 8-bit textures left to the texel buffer are paged in by 64x64 tile as rays sample them -
+    // must be enabled before OnInit returns. pageCount bounds their device memory (about 17 KB
+    // per page); 0 keeps the renderer's default.
+    void SetVirtualTexturesEnabled(bool enabled, uint32_t pageCount = 0) {
+        m_virtualTexturesEnabled = enabled;
+        m_virtualTexturePages = pageCount;
+    }
+    [[nodiscard]] bool IsVirtualTexturesEnabled() const { return m_virtualTexturesEnabled; }
+    [[nodiscard]] uint32_t GetVirtualTexturePages() const { return m_virtualTexturePages; }
+
+    // Shadow rays trace low-poly proxies of the meshes (see Mesh::BuildShadowProxy) - must be
+    // enabled before OnInit returns. On upload, every mesh of at least kMinShadowProxyTriangles
+    // still holding its CPU data gets a proxy with ratio of its triangles, unless
+    // BuildMeshShadowProxy gave it one; ratio 0 leaves proxies to BuildMeshShadowProxy alone. A
+    // proxy is only used if its error is within tolerance times its mesh's bounds diagonal.
+    static constexpr size_t kMinShadowProxyTriangles = 4096;
+    static constexpr float kDefaultShadowProxyTolerance = 0.01f;
+    void SetShadowProxiesEnabled(bool enabled, float ratio = Mesh::kDefaultShadowProxyRatio,
+                                 float tolerance = kDefaultShadowProxyTolerance) {
+        m_shadowProxiesEnabled = enabled;
+        m_shadowProxyRatio = std::clamp(ratio, 0.0f, 1.0f);
+        m_shadowProxyTolerance = std::max(tolerance, 0.0f);
+    }
+    [[nodiscard]] bool IsShadowProxiesEnabled() const { return m_shadowProxiesEnabled; }
+    [[nodiscard]] float GetShadowProxyRatio() const { return m_shadowProxyRatio; }
+    [[nodiscard]] float GetShadowProxyTolerance() const { return m_shadowProxyTolerance; }
+    // Build the proxies SetShadowProxiesEnabled asks for, in parallel - called before upload
+    void BuildShadowProxies();
+
+    // CPU frustum culling of instances before upload - may change at any time. Culled instances
+    // are missing from reflections and shadows too; Padded keeps anything within margin world
+    // units of the view frustum.
+    void SetInstanceCulling(InstanceCullMode mode, float margin = 0.0f) { m_instanceCullMode = mode; m_instanceCullMargin = margin; }
+    [[nodiscard]] InstanceCullMode GetInstanceCullMode() const { return m_instanceCullMode; }
+    [[nodiscard]] float GetInstanceCullMargin() const { return m_instanceCullMargin; }
+
+    // Fraction past an LOD boundary the projected size must move before an instance switches
+    // level (see MeshLod::SelectLevels) - may change at any time
+    void SetLodHysteresis(float hysteresis) { m_lodHysteresis = std::clamp(hysteresis, 0.0f, 0.9f); }
+    [[nodiscard]] float GetLodHysteresis() const { return m_lodHysteresis; }
+
 protected:
     uint32_t LoadMesh(std::string_view objFilename, std::string_view textureFilename = {});
+    // Register a procedurally built mesh; builds its BVH if it has none yet
+    uint32_t AddMesh(std::unique_ptr<Mesh> mesh);
 
     void FreeMeshCPUData(uint32_t meshId);
     void FreeAllMeshCPUData();
     [[nodiscard]] bool IsMeshCPUDataFreed(uint32_t meshId) const noexcept;
 
-    uint32_t AddMeshInstance(uint32_t meshId, const TriVector& position, std::string_view name = {});
-    uint32_t AddMeshInstance(uint32_t meshId, const Motor& transform, std::string_view name = {});
-
-    [[nodiscard]] MeshInstance* GetInstance(uint32_t instanceId) noexcept;
-    [[nodiscard]] MeshInstance* FindInstance(std::string_view name) noexcept;
-    void SetInstanceTransform(uint32_t instanceId, const Motor& transform);
-    void SetInstancePosition(uint32_t instanceId, const TriVector& position);
-    void SetInstanceVisible(uint32_t instanceId, bool visible);
+    // Distance-based LODs: decimated copies of the mesh at each ratio below 1, added as meshes of
+    // their own. Instances of meshId are then traced with the level matching their size on
+    // screen. Needs the mesh's CPU data; returns the level mesh IDs, meshId first.
+    std::vector<uint32_t> GenerateMeshLods(uint32_t meshId, std::span<const float> ratios = MeshLod::kDefaultRatios);
+
+    // Shadow proxy of one mesh with ratio of its triangles, replacing any earlier one. Used once
+    // shadow proxies are enabled (see SetShadowProxiesEnabled); needs the mesh's CPU data.
+    void BuildMeshShadowProxy(uint32_t meshId, float ratio = Mesh::kDefaultShadowProxyRatio);
+
+    InstanceHandle AddMeshInstance(uint32_t meshId, const TriVector& position, std::string_view name = {});
+    InstanceHandle AddMeshInstance(uint32_t meshId, const Motor& transform, std::string_view name = {});
+    bool RemoveMeshInstance(InstanceHandle instance);  // O(1); the last instance takes its GPU index; children become roots
+    // Instance whose transform is relative to parent's (see "Instance Hierarchy" in meshes.md)
+    InstanceHandle AddChildInstance(InstanceHandle parent, uint32_t meshId, const Motor& localTransform, std::string_view name = {});
+    bool SetInstanceParent(InstanceHandle child, InstanceHandle parent);  // Keeps the world transform; invalid parent detaches
+    [[nodiscard]] InstanceHandle GetInstanceParent(InstanceHandle child) const noexcept { return m_instances.Parent(child); }
+
+    // References are invalidated by adding or removing instances - keep handles across frames
+    [[nodiscard]] std::optional<InstanceRef> GetInstance(InstanceHandle instance) noexcept;
+    [[nodiscard]] std::optional<InstanceRef> FindInstance(std::string_view name) noexcept;
+    [[nodiscard]] InstanceHandle FindInstanceHandle(std::string_view name) const noexcept;
+    // Relative to the parent for child instances
+    void SetInstanceTransform(InstanceHandle instance, const Motor& transform);
+    void SetInstancePosition(InstanceHandle instance, const TriVector& position);
+    void SetInstanceScale(InstanceHandle instance, float scale);
+    void SetInstanceVisible(InstanceHandle instance, bool visible);
 
     uint32_t AddSphere(const TriVector& center, float radius, const Scene::Material& material);
     uint32_t AddPlane(const Vector& plane, const Scene::Material& material);
@@ -168,6 +302,20 @@ protected:
                           const Scene::Color& color, float intensity, float angle, float range);
     [[nodiscard]] Scene::GPULight* GetLight(uint32_t id) noexcept;
 
+    // Keyframe animation (see "Keyframe Animation" in animation.md). Keys must be sorted by
+    // time; targets that no longer exist are skipped.
+    void AnimateInstance(InstanceHandle instance, std::span<const MotorKey> keys,
+                         AnimationWrap wrap = AnimationWrap::Loop, float timeOffset = 0.0f);  // Parent-relative
+    void AnimateInstanceScale(InstanceHandle instance, std::span<const ScalarKey> keys,
+                              AnimationWrap wrap = AnimationWrap::Loop, float timeOffset = 0.0f);
+    void AnimateSphere(uint32_t id, std::span<const MotorKey> keys,
+                       AnimationWrap wrap = AnimationWrap::Loop, float timeOffset = 0.0f);  // Center = motor applied to the origin
+    void AnimateSphereRadius(uint32_t id, std::span<const ScalarKey> keys,
+                             AnimationWrap wrap = AnimationWrap::Loop, float timeOffset = 0.0f);
+    void AnimateLightIntensity(uint32_t id, std::span<const ScalarKey> keys,
+                               AnimationWrap wrap = AnimationWrap::Loop, float timeOffset = 0.0f);
+    void ClearAnimations();
+
     // ========================================================================
     // Debug visualization
     // ========================================================================
@@ -195,8 +343,9 @@ protected:
     Scene::SceneData m_sceneData;
 
     std::vector<std::unique_ptr<Mesh>> m_meshes;
-    std::vector<MeshInstance> m_meshInstances;
-    std::unordered_map<std::string, uint32_t> m_namedInstances;
+    InstanceStore m_instances;
+    std::array<RenderSnapshot, 2> m_snapshots;
+    uint32_t m_frontSnapshot{0};
     std::vector<bool> m_meshCPUDataFreed;
     std::string m_textureFilename;
 
@@ -213,6 +362,45 @@ protected:
     std::vector<DebugLine> m_debugLines;
     bool m_debugDrawEnabled{true};
 
+    // GPU picking (object-ID buffer)
+    bool m_pickingEnabled{false};
+
+    // Auxiliary outputs for denoisers / ML pipelines
+    bool m_aovOutputEnabled{false};
+    bool m_visibilityQueriesEnabled{false};
+    bool m_multiViewEnabled{false};
+    bool m_compactVerticesEnabled{false};
+    bool m_sampledTexturesEnabled{false};
+    std::string m_textureCacheDirectory;
+    bool m_virtualTexturesEnabled{false};
+    uint32_t m_virtualTexturePages{0};
+    bool m_shadowProxiesEnabled{false};
+    float m_shadowProxyRatio{Mesh::kDefaultShadowProxyRatio};
+    float m_shadowProxyTolerance{kDefaultShadowProxyTolerance};
+
+    InstanceCullMode m_instanceCullMode{InstanceCullMode::Off};
+    float m_instanceCullMargin{0.0f};
+
+    // Mesh LOD chains, applied to the published instances
+    MeshLod::LodTable m_lodTable;
+    std::vector<uint8_t> m_lodLevels;  // Level of each dense instance in the last snapshot
+    float m_lodHysteresis{MeshLod::kDefaultHysteresis};
+
+    // Keyframe animation: track i of each kind writes into binding i
+    enum class AnimationTarget : uint8_t { InstanceTransform, InstanceScale, SphereCenter, SphereRadius, LightIntensity };
+    struct AnimationBinding {
+        AnimationTarget target;
+        InstanceHandle instance;  // Instance targets
+        uint32_t id{0};           // Sphere and light targets
+    };
+    AnimationTracks m_animations;
+    std::vector<AnimationBinding> m_motorBindings;
+    std::vector<AnimationBinding> m_scalarBindings;
+    std::vector<Motor> m_animatedMotors;
+    std::vector<float> m_animatedScalars;
+    float m_animationTime{0.0f};
+    float m_animationSpeed{1.0f};
+
     // Screen dimensions for debug projection (set by Application)
     int m_screenWidth{1280};
     int m_screenHeight{720};
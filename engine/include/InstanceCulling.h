@@ -0,0 +1,72 @@
+#pragma once
+
+#include "InstanceStore.h"
+#include "Scene.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Which instances Application hands to VulkanRenderer::UploadInstances each frame.
+// The ray tracer sees only uploaded instances, so anything culled also disappears from
+// reflections and shadows - hence the modes.
+enum class InstanceCullMode : uint8_t {
+    Off,      // Upload every instance
+    Frustum,  // Only instances whose bounds intersect the camera frustum (primary visibility)
+    Padded,   // Camera frustum pushed out by a margin, keeping nearby off-screen reflectors and shadow casters
+};
+
+// CPU frustum culling for mesh instances: world-space AABBs from each mesh's BVH root bounds
+// and the instance transform, tested against the camera frustum and compacted into an index
+// list for InstancePacking::PackInstances.
+namespace InstanceCulling {
+
+// Object-space box of one mesh as center and half extent
+struct LocalBounds {
+    float center[3]{0.0f, 0.0f, 0.0f};
+    float extent[3]{0.0f, 0.0f, 0.0f};
+
+    // Root node of Mesh::BVHNodes() - the box the GPU traversal starts from
+    [[nodiscard]] static LocalBounds FromBVHRoot(const Scene::BVHNode& root) noexcept;
+};
+
+// World-space AABBs of every instance, SoA (center and half extent per axis)
+struct WorldBounds {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    [[nodiscard]] size_t Size() const noexcept { return centerX.size(); }
+};
+
+// The four side planes of the camera pyramid (rays start at the eye, so there is no near
+// plane, and traceScene has no far plane). Inward unit normals: dot(n, p) + d >= 0 inside.
+struct Frustum {
+    float planes[4][4]{};
+
+    // cameraRotation rows as passed to VulkanRenderer::RenderScene (right, up, -forward);
+    // fovDegrees is vertical, as in generateCameraRay. margin moves every plane outward.
+    [[nodiscard]] static Frustum FromCamera(const float cameraRotation[9], const float cameraPosition[3],
+                                            float fovDegrees, float aspect, float margin = 0.0f) noexcept;
+};
+
+// Transform each instance's mesh box into world space (a box enclosing the rotated box).
+// meshBounds is indexed by mesh ID; instances of unknown meshes get an empty box at their origin.
+void ComputeWorldBounds(const InstanceArrays& instances, std::span<const LocalBounds> meshBounds,
+                        WorldBounds& out);
+
+// Dense indices of the visible instances whose world box touches the frustum, in ascending
+// order. One box at a time - the reference for CullInstances.
+void CullInstancesScalar(const InstanceArrays& instances, const WorldBounds& bounds,
+                         const Frustum& frustum, std::vector<uint32_t>& visibleIndices);
+
+// Same result, eight boxes per iteration with AVX2 when the build targets it
+void CullInstances(const InstanceArrays& instances, const WorldBounds& bounds,
+                   const Frustum& frustum, std::vector<uint32_t>& visibleIndices);
+
+// Triangles traceScene tests one by one (mesh 0's, untransformed) when no instance records are
+// uploaded. That fallback is for scenes without instances only; once culling has removed every
+// instance of a scene that has some, there is nothing left to trace.
+[[nodiscard]] constexpr uint32_t FallbackTriangleCount(size_t sceneInstances, uint32_t firstMeshTriangles) noexcept {
+    return sceneInstances == 0 ? firstMeshTriangles : 0;
+}
+
+} // namespace InstanceCulling
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "InstanceStore.h"
+#include "Scene.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// CPU side of VulkanRenderer::UploadInstances - converts instance motors into GPU records.
+// Writes straight to the destination (normally mapped staging memory), no allocations.
+namespace InstancePacking {
+
+// Instances per worker thread below which PackInstances stays on the calling thread
+inline constexpr size_t kInstancesPerThread = 16384;
+
+// One instance at a time via GPUMeshInstance::FromMotor - the reference for PackInstances.
+// out holds instances.Size() records; record i gets sourceIndex i.
+void PackInstancesScalar(const InstanceArrays& instances, Scene::GPUMeshInstance* out) noexcept;
+
+// Only instances[indices[i]] into out[i] (with sourceIndex indices[i]) - a culled upload.
+// out holds indices.size() records.
+void PackInstancesScalar(const InstanceArrays& instances, std::span<const uint32_t> indices,
+                         Scene::GPUMeshInstance* out) noexcept;
+
+// Eight instances per iteration with AVX2 when the build targets it (scalar otherwise),
+// split across the shared WorkerPool for large counts
+void PackInstances(const InstanceArrays& instances, Scene::GPUMeshInstance* out);
+// Only records [range.first, range.last) of the full layout - out[i] for instance i, the rest untouched
+void PackInstances(const InstanceArrays& instances, InstanceRange range, Scene::GPUMeshInstance* out);
+void PackInstances(const InstanceArrays& instances, std::span<const uint32_t> indices, Scene::GPUMeshInstance* out);
+
+} // namespace InstancePacking
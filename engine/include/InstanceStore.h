@@ -0,0 +1,159 @@
+#pragma once
+
+#include "FlyFish.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Stable reference to a mesh instance. The generation makes handles to destroyed instances
+// detectably stale, even after their slot has been reused.
+struct InstanceHandle {
+    static constexpr uint32_t kInvalidIndex = ~0u;
+
+    uint32_t index{kInvalidIndex};  // Slot in InstanceStore, not the dense/GPU index
+    uint32_t generation{0};
+
+    [[nodiscard]] bool IsValid() const noexcept { return index != kInvalidIndex; }
+    friend bool operator==(InstanceHandle, InstanceHandle) noexcept = default;
+};
+
+// Dense per-instance columns: element i of every array belongs to the same instance, and i is
+// the instance's index in pick results (and in the GPU instance buffer unless culling is on)
+struct InstanceArrays {
+    std::vector<Motor> transforms;
+    std::vector<float> scales;
+    std::vector<uint32_t> meshIds;
+    std::vector<uint8_t> visible;  // 0/1 - bytes rather than vector<bool> so it scans linearly
+
+    [[nodiscard]] size_t Size() const noexcept { return transforms.size(); }
+};
+
+// Dense indices [first, last) whose columns may have changed - what an instance upload has to
+// repack. Ranges merge by covering both, so they stay conservative.
+struct InstanceRange {
+    uint32_t first{0};
+    uint32_t last{0};
+
+    [[nodiscard]] bool Empty() const noexcept { return first >= last; }
+    void Merge(InstanceRange other) noexcept {
+        if (other.Empty()) return;
+        if (Empty()) {
+            *this = other;
+            return;
+        }
+        first = std::min(first, other.first);
+        last = std::max(last, other.last);
+    }
+};
+
+// Mutable view of one instance's columns. Like an iterator it is invalidated by Create and
+// Destroy; keep the handle, not the reference.
+struct InstanceRef {
+    Motor& transform;
+    float& scale;
+    uint8_t& visible;
+    uint32_t meshId;
+};
+
+// Instance storage for 100K+ instances: SoA columns kept dense by swap-removal, generational
+// handles with O(1) create/destroy through a slot free list, and a name table that is only
+// touched by the name functions.
+//
+// Instances can be parented. The transforms column always holds world motors; a child's is
+// its parent's world motor times its local motor, recomputed by UpdateWorldTransforms for
+// dirty subtrees only. Parented instances are walked in a flat array sorted parents-first,
+// rebuilt when the hierarchy changes. Scales are not inherited.
+class InstanceStore {
+public:
+    InstanceHandle Create(uint32_t meshId, const Motor& transform, float scale = 1.0f, bool visible = true);
+    bool Destroy(InstanceHandle handle);  // False for stale or invalid handles
+    void Clear();
+
+    [[nodiscard]] bool IsAlive(InstanceHandle handle) const noexcept;
+    [[nodiscard]] size_t Size() const noexcept { return m_arrays.Size(); }
+
+    // Dense index of a live handle (InstanceHandle::kInvalidIndex otherwise), and the reverse
+    [[nodiscard]] uint32_t DenseIndex(InstanceHandle handle) const noexcept;
+    [[nodiscard]] InstanceHandle HandleAt(uint32_t denseIndex) const noexcept;
+
+    // Writable access counts as a change to the instance (or, for MutableArrays, to all of them).
+    // Writing a child's transform this way is overwritten by the next UpdateWorldTransforms.
+    [[nodiscard]] std::optional<InstanceRef> Get(InstanceHandle handle) noexcept;
+    [[nodiscard]] const InstanceArrays& Arrays() const noexcept { return m_arrays; }
+    [[nodiscard]] InstanceArrays& MutableArrays() noexcept;  // Edit values, not sizes
+
+    // Hierarchy. SetParent keeps the child's current world transform; an invalid parent
+    // detaches it. Fails for stale handles and for parents inside the child's own subtree.
+    bool SetParent(InstanceHandle child, InstanceHandle parent);
+    [[nodiscard]] InstanceHandle Parent(InstanceHandle child) const noexcept;
+    // Parent-relative transform - for a root this is its world transform
+    bool SetLocalTransform(InstanceHandle handle, const Motor& local);
+    [[nodiscard]] std::optional<Motor> LocalTransform(InstanceHandle handle) const noexcept;
+    // Propagate changed roots and locals to the world transforms of their descendants
+    void UpdateWorldTransforms();
+
+    // Instances changed since the last call (by Create, Destroy, writable access or
+    // UpdateWorldTransforms), then reset
+    [[nodiscard]] InstanceRange TakeChangedRange() noexcept;
+
+    // Names - one per instance, unique; setting an empty name removes it
+    bool SetName(InstanceHandle handle, std::string_view name);
+    [[nodiscard]] InstanceHandle Find(std::string_view name) const noexcept;
+    [[nodiscard]] std::string_view Name(InstanceHandle handle) const noexcept;
+
+private:
+    struct Slot {
+        uint32_t dense{InstanceHandle::kInvalidIndex};  // kInvalidIndex while on the free list
+        uint32_t generation{0};
+        uint32_t nextFree{InstanceHandle::kInvalidIndex};
+    };
+
+    // Parent and sibling links between slots, kInvalidIndex where absent
+    struct Link {
+        uint32_t parent{InstanceHandle::kInvalidIndex};
+        uint32_t firstChild{InstanceHandle::kInvalidIndex};
+        uint32_t nextSibling{InstanceHandle::kInvalidIndex};
+        uint32_t prevSibling{InstanceHandle::kInvalidIndex};
+    };
+
+    // One parented instance (or root of a subtree) in update order
+    struct Node {
+        Motor local;
+        uint32_t dense;
+        uint32_t parent;  // Position in m_nodes, kInvalidIndex for subtree roots
+    };
+
+    void markChanged(uint32_t dense) noexcept;
+    void markNodeDirty(uint32_t slot) noexcept;
+    void unlink(uint32_t slot) noexcept;
+    void rebuildNodes();
+
+    // Transparent hash so Find(string_view) does not build a std::string
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const noexcept { return std::hash<std::string_view>{}(name); }
+    };
+
+    InstanceArrays m_arrays;
+    std::vector<uint32_t> m_denseToSlot;
+    std::vector<Slot> m_slots;
+    uint32_t m_freeHead{InstanceHandle::kInvalidIndex};
+
+    std::unordered_map<std::string, InstanceHandle, NameHash, std::equal_to<>> m_nameToHandle;
+    std::vector<std::string> m_slotNames;  // Indexed by slot, cold
+
+    std::vector<Link> m_links;        // Indexed by slot
+    std::vector<Motor> m_locals;      // Indexed by slot, meaningful for children only
+    std::vector<uint32_t> m_slotNode; // Slot -> position in m_nodes, kInvalidIndex if not parented
+    std::vector<Node> m_nodes;        // Parents before children (depth-first pre-order)
+    std::vector<uint8_t> m_nodeDirty;
+    std::vector<uint8_t> m_nodeChanged;  // Scratch for UpdateWorldTransforms
+    bool m_hierarchyChanged{false};   // m_nodes must be rebuilt
+
+    InstanceRange m_changed;
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+#include <ostream>
+#include <fstream>
+#include <sstream>
+
+namespace FlyTracer {
+
+// Minimal JSON document model - enough for benchmark specs and reports.
+// Numbers are stored as double; object keys keep sorted order.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue() = default;
+
+    [[nodiscard]] static JsonValue Bool(bool value) { JsonValue v; v.m_type = Type::Bool; v.m_bool = value; return v; }
+    [[nodiscard]] static JsonValue Number(double value) { JsonValue v; v.m_type = Type::Number; v.m_number = value; return v; }
+    [[nodiscard]] static JsonValue String(std::string value) { JsonValue v; v.m_type = Type::String; v.m_string = std::move(value); return v; }
+    [[nodiscard]] static JsonValue Array() { JsonValue v; v.m_type = Type::Array; return v; }
+    [[nodiscard]] static JsonValue Object() { JsonValue v; v.m_type = Type::Object; return v; }
+
+    [[nodiscard]] Type GetType() const noexcept { return m_type; }
+    [[nodiscard]] bool IsNull() const noexcept { return m_type == Type::Null; }
+    [[nodiscard]] bool IsNumber() const noexcept { return m_type == Type::Number; }
+    [[nodiscard]] bool IsString() const noexcept { return m_type == Type::String; }
+    [[nodiscard]] bool IsArray() const noexcept { return m_type == Type::Array; }
+    [[nodiscard]] bool IsObject() const noexcept { return m_type == Type::Object; }
+
+    [[nodiscard]] bool AsBool(bool fallback = false) const noexcept { return m_type == Type::Bool ? m_bool : fallback; }
+    [[nodiscard]] double AsNumber(double fallback = 0.0) const noexcept { return m_type == Type::Number ? m_number : fallback; }
+    [[nodiscard]] const std::string& AsString() const noexcept { return m_string; }
+
+    // Arrays
+    [[nodiscard]] size_t Size() const noexcept { return m_type == Type::Array ? m_array.size() : m_object.size(); }
+    [[nodiscard]] const JsonValue& operator[](size_t index) const noexcept {
+        return index < m_array.size() ? m_array[index] : null();
+    }
+    void Push(JsonValue value) { m_array.push_back(std::move(value)); }
+
+    // Objects - missing keys read as null
+    [[nodiscard]] const JsonValue& operator[](std::string_view key) const noexcept {
+        const auto it = m_object.find(key);
+        return it != m_object.end() ? it->second : null();
+    }
+    [[nodiscard]] bool Contains(std::string_view key) const noexcept { return m_object.find(key) != m_object.end(); }
+    void Set(std::string key, JsonValue value) { m_object.insert_or_assign(std::move(key), std::move(value)); }
+
+    // Parse a complete document; returns false on malformed input
+    [[nodiscard]] static bool Parse(std::string_view text, JsonValue& out) {
+        Parser parser{text};
+        parser.skipWhitespace();
+        if (!parser.parseValue(out, 0)) return false;
+        parser.skipWhitespace();
+        return parser.pos == text.size();
+    }
+
+    [[nodiscard]] static bool ParseFile(const std::string& filename, JsonValue& out) {
+        std::ifstream file(filename);
+        if (!file) return false;
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return Parse(buffer.str(), out);
+    }
+
+    void Write(std::ostream& os, int indent = 0) const {
+        switch (m_type) {
+            case Type::Null: os << "null"; break;
+            case Type::Bool: os << (m_bool ? "true" : "false"); break;
+            case Type::Number: {
+                char buffer[32];
+                const auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), m_number);
+                os << std::string_view(buffer, ec == std::errc{} ? static_cast<size_t>(ptr - buffer) : 0);
+                break;
+            }
+            case Type::String: writeString(os, m_string); break;
+            case Type::Array: {
+                os << '[';
+                for (size_t i = 0; i < m_array.size(); ++i) {
+                    if (i > 0) os << ", ";
+                    m_array[i].Write(os, indent);
+                }
+                os << ']';
+                break;
+            }
+            case Type::Object: {
+                os << "{\n";
+                size_t i = 0;
+                for (const auto& [key, value] : m_object) {
+                    os << std::string(static_cast<size_t>(indent + 2), ' ');
+                    writeString(os, key);
+                    os << ": ";
+                    value.Write(os, indent + 2);
+                    os << (++i < m_object.size() ? ",\n" : "\n");
+                }
+                os << std::string(static_cast<size_t>(indent), ' ') << '}';
+                break;
+            }
+        }
+    }
+
+private:
+    struct Parser {
+        std::string_view text;
+        size_t pos{0};
+
+        static constexpr int kMaxDepth = 64;
+
+        void skipWhitespace() noexcept {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' ||
+                                         text[pos] == '\n' || text[pos] == '\r')) {
+                ++pos;
+            }
+        }
+
+        bool consume(std::string_view literal) noexcept {
+            if (text.substr(pos, literal.size()) != literal) return false;
+            pos += literal.size();
+            return true;
+        }
+
+        bool parseValue(JsonValue& out, int depth) {
+            if (pos >= text.size() || depth > kMaxDepth) return false;
+            const char c = text[pos];
+            if (c == '{') return parseObject(out, depth);
+            if (c == '[') return parseArray(out, depth);
+            if (c == '"') {
+                out = JsonValue{};
+                out.m_type = Type::String;
+                return parseString(out.m_string);
+            }
+            if (consume("true")) { out = JsonValue::Bool(true); return true; }
+            if (consume("false")) { out = JsonValue::Bool(false); return true; }
+            if (consume("null")) { out = JsonValue{}; return true; }
+            return parseNumber(out);
+        }
+
+        bool parseNumber(JsonValue& out) noexcept {
+            double value = 0.0;
+            const auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+            if (ec != std::errc{}) return false;
+            pos = static_cast<size_t>(ptr - text.data());
+            out = JsonValue::Number(value);
+            return true;
+        }
+
+        bool parseString(std::string& out) {
+            ++pos;  // opening quote
+            out.clear();
+            while (pos < text.size()) {
+                const char c = text[pos++];
+                if (c == '"') return true;
+                if (c != '\\') { out += c; continue; }
+                if (pos >= text.size()) return false;
+                switch (text[pos++]) {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': {
+                        // Only the ASCII range is needed for specs; anything else becomes '?'
+                        unsigned code = 0;
+                        const auto [ptr, ec] = std::from_chars(text.data() + pos,
+                                                               text.data() + std::min(pos + 4, text.size()), code, 16);
+                        if (ec != std::errc{} || ptr != text.data() + pos + 4) return false;
+                        pos += 4;
+                        out += code < 0x80 ? static_cast<char>(code) : '?';
+                        break;
+                    }
+                    default: return false;
+                }
+            }
+            return false;
+        }
+
+        bool parseArray(JsonValue& out, int depth) {
+            ++pos;  // '['
+            out = JsonValue::Array();
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == ']') { ++pos; return true; }
+            while (true) {
+                skipWhitespace();
+                JsonValue element;
+                if (!parseValue(element, depth + 1)) return false;
+                out.m_array.push_back(std::move(element));
+                skipWhitespace();
+                if (pos >= text.size()) return false;
+                if (text[pos] == ',') { ++pos; continue; }
+                if (text[pos] == ']') { ++pos; return true; }
+                return false;
+            }
+        }
+
+        bool parseObject(JsonValue& out, int depth) {
+            ++pos;  // '{'
+            out = JsonValue::Object();
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == '}') { ++pos; return true; }
+            while (true) {
+                skipWhitespace();
+                if (pos >= text.size() || text[pos] != '"') return false;
+                std::string key;
+                if (!parseString(key)) return false;
+                skipWhitespace();
+                if (pos >= text.size() || text[pos] != ':') return false;
+                ++pos;
+                skipWhitespace();
+                JsonValue value;
+                if (!parseValue(value, depth + 1)) return false;
+                out.m_object.insert_or_assign(std::move(key), std::move(value));
+                skipWhitespace();
+                if (pos >= text.size()) return false;
+                if (text[pos] == ',') { ++pos; continue; }
+                if (text[pos] == '}') { ++pos; return true; }
+                return false;
+            }
+        }
+    };
+
+    static void writeString(std::ostream& os, std::string_view str) {
+        os << '"';
+        for (const char c : str) {
+            switch (c) {
+                case '"': os << "\\\""; break;
+                case '\\': os << "\\\\"; break;
+                case '\n': os << "\\n"; break;
+                case '\r': os << "\\r"; break;
+                case '\t': os << "\\t"; break;
+                default: os << c; break;
+            }
+        }
+        os << '"';
+    }
+
+    [[nodiscard]] static const JsonValue& null() noexcept {
+        static const JsonValue kNull;
+        return kNull;
+    }
+
+    Type m_type{Type::Null};
+    bool m_bool{false};
+    double m_number{0.0};
+    std::string m_string;
+    std::vector<JsonValue> m_array;
+    std::map<std::string, JsonValue, std::less<>> m_object;
+};
+
+} // namespace FlyTracer
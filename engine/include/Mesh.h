@@ -4,6 +4,10 @@
 #include <string>
 #include <cstdint>
 #include <stdexcept>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <memory>
 #include "Scene.h"
 #include "FlyFish.h"
 
@@ -84,6 +88,140 @@ struct GPUVertex {
 };
 static_assert(sizeof(GPUVertex) == 32, "GPUVertex must be exactly 32 bytes");
 
+// Compact GPU vertex (POD, 16 bytes) - decoded in traversal.glsl when COMPACT_VERTICES is set
+// Position: 16-bit unsigned per axis inside the mesh bounds (see VertexQuantization)
+// Normal: octahedral encoding, 2 x snorm16 (x in the low half)
+// UV: 2 x half float (u in the low half)
+struct GPUCompactVertex {
+    uint16_t pos[3];
+    uint16_t _pad;
+    uint32_t normal;
+    uint32_t texCoord;
+};
+static_assert(sizeof(GPUCompactVertex) == 16, "GPUCompactVertex must be exactly 16 bytes");
+
+// Per-mesh position dequantization: position = origin + quantized * scale
+struct VertexQuantization {
+    float origin[3]{0.0f, 0.0f, 0.0f};
+    float scale[3]{0.0f, 0.0f, 0.0f};
+
+    static constexpr float kMaxValue = 65535.0f;
+
+    [[nodiscard]] static VertexQuantization FromBounds(const float minBounds[3], const float maxBounds[3]) noexcept {
+        VertexQuantization q;
+        for (int a = 0; a < 3; ++a) {
+            q.origin[a] = minBounds[a];
+            q.scale[a] = std::max(maxBounds[a] - minBounds[a], 0.0f) / kMaxValue;
+        }
+        return q;
+    }
+
+    [[nodiscard]] uint16_t Encode(int axis, float value) const noexcept {
+        if (scale[axis] <= 0.0f) return 0;
+        const float q = std::round((value - origin[axis]) / scale[axis]);
+        return static_cast<uint16_t>(std::clamp(q, 0.0f, kMaxValue));
+    }
+
+    [[nodiscard]] float Decode(int axis, uint16_t value) const noexcept {
+        return origin[axis] + static_cast<float>(value) * scale[axis];
+    }
+};
+
+// Bit packing shared by GPUCompactVertex and its CPU-side error measurement
+namespace VertexPacking {
+
+// IEEE binary16, round to nearest even; matches GLSL unpackHalf2x16
+[[nodiscard]] inline uint16_t FloatToHalf(float value) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t absBits = bits & 0x7FFFFFFFu;
+
+    if (absBits >= 0x7F800000u) {  // Inf / NaN
+        return static_cast<uint16_t>(sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u));
+    }
+    if (absBits >= 0x477FF000u) {  // Rounds above the largest half
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (absBits < 0x38800000u) {   // Subnormal half (or zero)
+        float absValue;
+        std::memcpy(&absValue, &absBits, sizeof(absValue));
+        return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(absValue * 16777216.0f)));
+    }
+
+    const uint32_t mantissaOdd = (absBits >> 13) & 1u;
+    const uint32_t rounded = absBits + 0xFFFu + mantissaOdd;
+    return static_cast<uint16_t>(sign | ((rounded - 0x38000000u) >> 13));
+}
+
+[[nodiscard]] inline float HalfToFloat(uint16_t half) noexcept {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1Fu;
+    const uint32_t mantissa = half & 0x3FFu;
+
+    float magnitude;
+    if (exponent == 0) {
+        magnitude = static_cast<float>(mantissa) / 16777216.0f;
+    } else if (exponent == 31) {
+        magnitude = mantissa ? std::nanf("") : HUGE_VALF;
+    } else {
+        const uint32_t bits = ((exponent + 112u) << 23) | (mantissa << 13);
+        std::memcpy(&magnitude, &bits, sizeof(magnitude));
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+    bits |= sign;
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+[[nodiscard]] inline uint32_t PackHalf2x16(float x, float y) noexcept {
+    return static_cast<uint32_t>(FloatToHalf(x)) | (static_cast<uint32_t>(FloatToHalf(y)) << 16);
+}
+
+// Octahedral normal encoding into 2 x snorm16; matches octDecode in traversal.glsl
+[[nodiscard]] inline uint32_t PackOctahedral(float x, float y, float z) noexcept {
+    const float l1 = std::abs(x) + std::abs(y) + std::abs(z);
+    if (l1 <= 0.0f) return 0;  // Zero normal decodes to +Z
+
+    float u = x / l1;
+    float v = y / l1;
+    if (z < 0.0f) {
+        const float fu = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        const float fv = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = fu;
+        v = fv;
+    }
+
+    auto snorm16 = [](float f) {
+        const auto q = static_cast<int32_t>(std::round(std::clamp(f, -1.0f, 1.0f) * 32767.0f));
+        return static_cast<uint32_t>(static_cast<uint16_t>(static_cast<int16_t>(q)));
+    };
+    return snorm16(u) | (snorm16(v) << 16);
+}
+
+inline void UnpackOctahedral(uint32_t packed, float out[3]) noexcept {
+    auto snorm16 = [](uint32_t bits) {
+        const auto q = static_cast<int16_t>(static_cast<uint16_t>(bits & 0xFFFFu));
+        return std::max(static_cast<float>(q) / 32767.0f, -1.0f);
+    };
+    float x = snorm16(packed);
+    float y = snorm16(packed >> 16);
+    const float z = 1.0f - std::abs(x) - std::abs(y);
+    const float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    const float len = std::sqrt(x * x + y * y + z * z);
+    out[0] = x / len;
+    out[1] = y / len;
+    out[2] = z / len;
+}
+
+} // namespace VertexPacking
+
 // Vertex using PGA primitives - for CPU-side mesh processing
 struct Vertex {
     TriVector position;
@@ -97,6 +235,16 @@ struct Vertex {
             normal.e1(), normal.e2(), normal.e3(), texCoord[1]
         };
     }
+
+    [[nodiscard]] GPUCompactVertex ToGPU(const VertexQuantization& quantization) const noexcept {
+        GPUCompactVertex gpu{};
+        gpu.pos[0] = quantization.Encode(0, position.e032());
+        gpu.pos[1] = quantization.Encode(1, position.e013());
+        gpu.pos[2] = quantization.Encode(2, position.e021());
+        gpu.normal = VertexPacking::PackOctahedral(normal.e1(), normal.e2(), normal.e3());
+        gpu.texCoord = VertexPacking::PackHalf2x16(texCoord[0], texCoord[1]);
+        return gpu;
+    }
 };
 
 struct Triangle {
@@ -143,13 +291,66 @@ public:
 
     void Scale(float factor);
     void Translate(float x, float y, float z);
+    void Transform(const Motor& motor);  // Positions and normals; normalized motors only
     void CenterOnOrigin();
 
-    void Decimate(float targetRatio);
+    // Returns the square root of the largest collapse cost made (mesh units). It grows with how
+    // far the surface moved, but also counts texture stretch and feature weights - use
+    // DistanceToSurface for a geometric measure.
+    float Decimate(float targetRatio);
+
+    // Low-poly stand-in for shadow rays: a copy decimated on positions alone (UV seams and
+    // material boundaries are not kept), with its own BVH, packed after the meshes by
+    // MeshPacking::PackMeshes. Its error is the largest distance from a vertex of this mesh to
+    // the proxy's surface (mesh units).
+    static constexpr float kDefaultShadowProxyRatio = 0.1f;
+    void BuildShadowProxy(float ratio = kDefaultShadowProxyRatio);
+    void ClearShadowProxy() noexcept { m_shadowProxy.reset(); m_shadowProxyError = 0.0f; }
+    [[nodiscard]] const Mesh* ShadowProxy() const noexcept { return m_shadowProxy.get(); }
+    [[nodiscard]] float ShadowProxyError() const noexcept { return m_shadowProxyError; }
 
     void BuildBVH();
     [[nodiscard]] const std::vector<Scene::BVHNode>& BVHNodes() const noexcept { return m_bvhNodes; }
     [[nodiscard]] const std::vector<uint32_t>& BVHTriIndices() const noexcept { return m_bvhTriIndices; }
+    [[nodiscard]] size_t DegenerateTriangleCount() const noexcept { return m_degenerateTriangleCount; }
+
+    // Distance from a point to the closest triangle, found through the BVH (infinity without one)
+    [[nodiscard]] float DistanceToSurface(const TriVector& point) const;
+
+    // Traversal stack depth of traverseBVH in traversal.glsl - deeper subtrees are skipped on the GPU
+    static constexpr uint32_t kTraversalStackSize = 32;
+
+    // SAH weights used by AnalyzeBVH (relative cost of a node visit vs. a triangle test)
+    static constexpr float kSAHTraversalCost = 1.0f;
+    static constexpr float kSAHIntersectionCost = 1.0f;
+
+    // BVH quality metrics, for comparing builder changes objectively
+    struct BVHStats {
+        size_t triangleCount{0};
+        size_t nodeCount{0};
+        size_t nodeBound{0};                    // 2N-1 - the most a binary BVH over N triangles needs
+        size_t leafCount{0};
+        size_t degenerateTriangles{0};          // Zero-area triangles found by BuildBVH
+
+        float sahCost{0.0f};                    // Expected cost of a random ray that hits the root
+        uint32_t maxDepth{0};
+        float averageLeafDepth{0.0f};
+        uint32_t maxLeafSize{0};
+        float averageLeafSize{0.0f};
+        std::vector<size_t> leafSizeHistogram;  // [k] = number of leaves holding k triangles
+        float siblingOverlap{0.0f};             // Mean overlap area of sibling boxes relative to their parent
+
+        // Ray sample estimate (zero when no rays were requested)
+        size_t sampledRays{0};
+        float hitRatio{0.0f};
+        float averageNodesVisited{0.0f};
+        float averageTrianglesTested{0.0f};
+        uint32_t maxNodesVisited{0};
+    };
+
+    // Walk the BVH and collect quality metrics. With rayCount > 0 it also traces that many
+    // seeded random rays through the bounds, mirroring the shader traversal order.
+    [[nodiscard]] BVHStats AnalyzeBVH(size_t rayCount = 0, uint32_t seed = 1) const;
 
     struct BoundingBox {
         float min[3]{0.0f, 0.0f, 0.0f};
@@ -190,6 +391,7 @@ private:
     std::vector<Scene::BVHNode> m_bvhNodes;
     std::vector<uint32_t> m_bvhTriIndices;
     std::vector<float> m_triCentroids;
+    size_t m_degenerateTriangleCount{0};
 
     std::vector<Vertex> m_vertices;
     std::vector<Triangle> m_triangles;
@@ -198,4 +400,7 @@ private:
     BoundingBox m_boundingBox;
     std::vector<FaceNormal> m_faceNormals;
     bool m_hasPhysicsData{false};
+
+    std::unique_ptr<Mesh> m_shadowProxy;
+    float m_shadowProxyError{0.0f};  // Largest vertex distance to the proxy
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "InstanceStore.h"
+#include "Mesh.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Distance-based levels of detail for mesh instances. A chain is a mesh plus decimated copies
+// of it, each uploaded as a mesh of its own. Every frame each instance of the base mesh gets
+// the coarsest level that still holds enough triangles for its projected size, and its
+// GPUMeshInstance::meshId points at that level - so distant crowds trace far fewer triangles.
+namespace MeshLod {
+
+// Triangle ratios of the default chain, base mesh first
+inline constexpr std::array<float, 4> kDefaultRatios{1.0f, 0.5f, 0.25f, 0.1f};
+
+// Projected size (bounding sphere diameter over screen height) down to which the full mesh
+// is used. Triangle counts on screen scale with the projected area, so a level with ratio r
+// is used below kFullDetailScreenSize * sqrt(r).
+inline constexpr float kFullDetailScreenSize = 0.5f;
+
+// A level changes only once the projected size is this fraction past the boundary, so an
+// instance sitting on a boundary does not flip between levels every frame
+inline constexpr float kDefaultHysteresis = 0.15f;
+
+// Decimated copies of mesh, one per ratio below 1 (ratios of the base mesh, finest first),
+// each with its BVH. Levels are built in parallel on the shared WorkerPool.
+[[nodiscard]] std::vector<std::unique_ptr<Mesh>> GenerateLevels(const Mesh& mesh, std::span<const float> ratios);
+
+[[nodiscard]] float MaxScreenSize(float ratio) noexcept;
+
+// The levels of one base mesh
+struct Chain {
+    float center[3]{0.0f, 0.0f, 0.0f};  // Object-space bounding sphere of the base mesh
+    float radius{0.0f};
+    std::vector<uint32_t> meshes;        // Mesh ID per level, finest first; [0] is the base mesh
+    std::vector<float> maxScreenSizes;   // Per level: used below this projected size ([0] unbounded)
+};
+
+// Chains by base mesh ID
+class LodTable {
+public:
+    // levels[0] is the base mesh, ratios its triangle ratio per level (1 for the base);
+    // bounds is the base mesh's BVH root
+    void Add(std::span<const uint32_t> levels, std::span<const float> ratios, const Scene::BVHNode& bounds);
+
+    [[nodiscard]] const Chain* Find(uint32_t baseMesh) const noexcept {
+        return baseMesh < m_chainOfMesh.size() && m_chainOfMesh[baseMesh] != kNoChain
+                   ? &m_chains[m_chainOfMesh[baseMesh]] : nullptr;
+    }
+    [[nodiscard]] bool Empty() const noexcept { return m_chains.empty(); }
+
+private:
+    static constexpr uint32_t kNoChain = ~0u;
+
+    std::vector<uint32_t> m_chainOfMesh;
+    std::vector<Chain> m_chains;
+};
+
+// Replace the base mesh ID of every instance with a chain by the mesh ID of its level, in
+// place. levels holds each instance's level from the previous call (resized to fit) and drives
+// the hysteresis. cameraPosition and fovDegrees (vertical) are as in VulkanRenderer::RenderScene.
+// Returns the instances whose level changed since the previous call.
+InstanceRange SelectLevels(const LodTable& table, InstanceArrays& instances, const float cameraPosition[3],
+                           float fovDegrees, float hysteresis, std::vector<uint8_t>& levels);
+
+// Mirror InstanceStore::Destroy on levels: the last instance (now at instanceCount, the count
+// after removal) takes over denseIndex, history included. Call it for every removal.
+void RemoveInstance(std::vector<uint8_t>& levels, uint32_t denseIndex, uint32_t instanceCount) noexcept;
+
+} // namespace MeshLod
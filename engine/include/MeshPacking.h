@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// CPU side of VulkanRenderer::UploadMeshes - concatenates per-mesh data into the
+// flat arrays the shaders index. Kept free of Vulkan so it can be benchmarked alone.
+namespace MeshPacking {
+
+struct PackedMeshes {
+    std::vector<GPUVertex> vertices;            // Full vertices (empty when packed compact)
+    std::vector<GPUCompactVertex> compactVertices;  // Compact vertices (empty unless requested)
+    std::vector<Triangle> triangles;            // Vertex and material indices rebased to the packed arrays
+    std::vector<Scene::BVHNode> bvhNodes;       // Child / leaf indices rebased to the packed arrays
+    std::vector<uint32_t> bvhTriIndices;
+    std::vector<Scene::GPUMeshInfo> meshInfos;  // Never empty; shadow proxies follow the meshes
+    uint32_t shadowProxyCount{0};
+    std::vector<Scene::GPUMaterial> materials;  // Never empty
+    std::vector<std::string> texturePaths;      // Unique diffuse textures, indexed by GPUMaterial::diffuseTextureIndex
+};
+
+inline constexpr float kNoShadowProxies = -1.0f;
+
+// A mesh's shadow proxy, if it has one with CPU data and an error within tolerance times the
+// diagonal of the mesh's bounds
+[[nodiscard]] const Mesh* UsableShadowProxy(const Mesh& mesh, float tolerance) noexcept;
+
+// Null meshes are skipped. With compactVertices, vertices are quantized against each
+// mesh's bounds and the dequantization is stored in its GPUMeshInfo. Usable shadow proxies
+// (see UsableShadowProxy) are packed after the meshes, each mesh's GPUMeshInfo::shadowMeshId
+// pointing at its proxy; kNoShadowProxies packs none.
+[[nodiscard]] PackedMeshes PackMeshes(const std::vector<std::unique_ptr<Mesh>>& meshes,
+                                      bool compactVertices = false,
+                                      float shadowProxyTolerance = kNoShadowProxies);
+
+// Quantization bounds for a mesh's vertices
+[[nodiscard]] VertexQuantization ComputeQuantization(const Mesh& mesh) noexcept;
+
+// Worst-case round-trip error of the compact vertex format over a mesh
+struct CompactVertexError {
+    float maxPositionError{0.0f};       // World units
+    float relativePositionError{0.0f};  // maxPositionError / bounds diagonal
+    float maxNormalErrorDegrees{0.0f};
+    float maxTexCoordError{0.0f};
+};
+[[nodiscard]] CompactVertexError MeasureCompactVertexError(const Mesh& mesh);
+
+// One decoded texture, RGBA: 8 bits per channel, or floats for Scene::TextureFormat::RGBA32F.
+// SampledImage and Virtual textures are uploaded elsewhere and only get an info record.
+struct TexelSource {
+    const void* texels{nullptr};
+    uint32_t width{1};
+    uint32_t height{1};
+    Scene::TextureFormat format{Scene::TextureFormat::RGBA8};
+};
+
+// 32-bit words one texel takes in the texture buffer
+[[nodiscard]] constexpr uint32_t TexelWords(Scene::TextureFormat format) noexcept {
+    switch (format) {
+        case Scene::TextureFormat::RGBA32F: return 4u;
+        case Scene::TextureFormat::SampledImage:
+        case Scene::TextureFormat::Virtual: return 0u;
+        default: return 1u;
+    }
+}
+
+// Give each texture its offset in the texture buffer, or its sampled-image slot (in the order
+// the sampled images appear); returns the buffer size in words. Virtual textures get offset 0,
+// for the caller to replace with their first page table entry.
+[[nodiscard]] size_t LayoutTextures(std::span<const TexelSource> sources,
+                                    std::vector<Scene::GPUTextureInfo>& infos);
+
+// Copy the textures to dst (e.g. mapped staging memory) at the offsets LayoutTextures gave
+// them. RGBA8 bytes are stored as is - the word layout unpackUnorm4x8 reads.
+void WriteTexels(std::span<const TexelSource> sources, std::span<const Scene::GPUTextureInfo> infos,
+                 void* dst) noexcept;
+
+} // namespace MeshPacking
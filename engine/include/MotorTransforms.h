@@ -0,0 +1,24 @@
+#pragma once
+
+#include "FlyFish.h"
+#include "Mesh.h"
+#include "RigidTransform.h"
+#include <span>
+
+// Batch motor sandwich products. Applying one motor to many elements as M * X * ~M through
+// FlyFish costs two full geometric products each; these kernels convert the motor to a 3x4
+// matrix once and apply that instead, eight elements at a time with AVX2 when the build
+// targets it. Motors must be normalized (as built by Motor::Rotation / Translation and
+// their products); for those the results match the sandwich product.
+namespace MotorTransforms {
+
+// Points, in place. Homogeneous: ideal points (e123 = 0, directions) are only rotated.
+void TransformPoints(const Motor& motor, std::span<TriVector> points);
+
+// Planes e1*x + e2*y + e3*z + e0 = 0, in place; the normal need not be unit length
+void TransformPlanes(const Motor& motor, std::span<Vector> planes);
+
+// Vertex positions as points and normals as directions, in place
+void TransformVertices(const Motor& motor, std::span<Vertex> vertices);
+
+} // namespace MotorTransforms
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "FlyFish.h"
+
+namespace MotorTransforms {
+
+// Rotation and translation of a normalized motor. The one motor-to-matrix conversion on the
+// CPU: GPUMeshInstance::FromMotor, instance culling, LOD selection and the batch transforms
+// all start from it (detail/Simd8.h has the same for eight motors at a time).
+struct RigidTransform {
+    float rotation[3][3]{{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    float translation[3]{0.0f, 0.0f, 0.0f};
+
+    [[nodiscard]] static RigidTransform FromMotor(const Motor& m) noexcept {
+        // Motor = s + e01*d1 + e02*d2 + e03*d3 + e23*b1 + e31*b2 + e12*b3 + e0123*p
+        // PGA uses -sin(angle/2) for the bivector (see Motor::Rotation in FlyFish), so the
+        // quaternion-style rotation matrix uses the NEGATED bivector while the translation
+        // formula uses the original values
+        const float s = m.s();
+        const float b1 = -m.e23();
+        const float b2 = -m.e31();
+        const float b3 = -m.e12();
+        const float d1 = m.e01();
+        const float d2 = m.e02();
+        const float d3 = m.e03();
+        const float p = m.e0123();
+
+        // R = I - 2*b^2 + 2*s*b, valid for a normalized motor
+        RigidTransform rt;
+        rt.rotation[0][0] = 1 - 2*(b2*b2 + b3*b3);
+        rt.rotation[0][1] = 2*(b1*b2 - s*b3);
+        rt.rotation[0][2] = 2*(b1*b3 + s*b2);
+        rt.rotation[1][0] = 2*(b1*b2 + s*b3);
+        rt.rotation[1][1] = 1 - 2*(b1*b1 + b3*b3);
+        rt.rotation[1][2] = 2*(b2*b3 - s*b1);
+        rt.rotation[2][0] = 2*(b1*b3 - s*b2);
+        rt.rotation[2][1] = 2*(b2*b3 + s*b1);
+        rt.rotation[2][2] = 1 - 2*(b1*b1 + b2*b2);
+
+        // t = 2 * (s*d - d x b + p*b) with the original PGA bivector (b negated back)
+        rt.translation[0] = 2 * (d1*s + d2*b3 - d3*b2 - p*b1);
+        rt.translation[1] = 2 * (d2*s + d3*b1 - d1*b3 - p*b2);
+        rt.translation[2] = 2 * (d3*s + d1*b2 - d2*b1 - p*b3);
+        return rt;
+    }
+};
+
+} // namespace MotorTransforms
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cmath>
 #include "FlyFish.h"
+#include "RigidTransform.h"
 
 namespace Scene {
 
@@ -344,18 +345,28 @@ struct alignas(16) GPUMaterial {
     float roughness{0.5f};
 };
 
+// ============================================================================
+// Texel formats in the texture buffer
+// ============================================================================
+enum class TextureFormat : uint32_t {
+    RGBA8 = 0,        // One word per texel, unpacked with unpackUnorm4x8
+    RGBA32F = 1,      // Four words per texel - HDR textures only
+    SampledImage = 2, // Mipmapped image, not in the buffer; the offset is its sampled-image slot
+    Virtual = 3       // Paged (VirtualTexture.h), not in the buffer; the offset is its first page table entry
+};
+
 // ============================================================================
 // GPU Texture Info structure - per-texture metadata for multi-texture support (16 bytes)
 // ============================================================================
 struct alignas(16) GPUTextureInfo {
-    uint32_t offset{0};     // Offset into texture data buffer (in vec4 pixels)
+    uint32_t offset{0};     // Offset into texture data buffer (in 32-bit words), image slot or first tile
     uint32_t width{1};      // Texture width
     uint32_t height{1};     // Texture height
-    uint32_t _pad{0};       // Padding to 16 bytes
+    uint32_t format{static_cast<uint32_t>(TextureFormat::RGBA8)};
 };
 
 // ============================================================================
-// GPU Mesh Info structure - per-mesh offsets for multi-mesh support (32 bytes)
+// GPU Mesh Info structure - per-mesh offsets for multi-mesh support (64 bytes)
 // ============================================================================
 struct alignas(16) GPUMeshInfo {
     uint32_t vertexOffset{0};      // Offset into vertex buffer
@@ -364,23 +375,31 @@ struct alignas(16) GPUMeshInfo {
     uint32_t bvhTriIdxOffset{0};   // Offset into BVH triangle index buffer
     uint32_t triangleCount{0};     // Number of triangles in this mesh
     uint32_t bvhNodeCount{0};      // Number of BVH nodes in this mesh
-    uint32_t _pad[2]{0, 0};        // Padding to 32 bytes
+    uint32_t shadowMeshId{0};      // Mesh info traced by shadow rays: this mesh or its shadow proxy
+    uint32_t _pad{0};
+    float quantOrigin[3]{0.0f, 0.0f, 0.0f};  // Compact vertex dequantization (unused for full vertices)
+    float _pad1{0.0f};
+    float quantScale[3]{0.0f, 0.0f, 0.0f};
+    float _pad2{0.0f};
 };
+static_assert(sizeof(GPUMeshInfo) == 64, "GPUMeshInfo must be exactly 64 bytes");
 
 // ============================================================================
-// GPU Mesh Instance structure (144 bytes, 16-byte aligned)
+// GPU Mesh Instance structure (64 bytes, 16-byte aligned)
+// Only the world-to-object transform is stored, as the rows of a 3x4 affine matrix
+// (the bottom row is always 0 0 0 1). Rays are transformed into object space and hit
+// points are reconstructed from the world ray, so the forward transform is never needed.
 // ============================================================================
 struct alignas(16) GPUMeshInstance {
-    float transform[16];
-    float invTransform[16];
+    float invTransform[12];  // Row-major 3x4: [R^T / s | -R^T * t / s]
     uint32_t meshId{0};
     uint32_t visible{1};
-    float _pad[2]{0, 0};
+    uint32_t sourceIndex{0};  // Dense InstanceStore index, reported in picks and AOVs when culling compacts the buffer
+    float _pad{0};
 
     [[nodiscard]] static GPUMeshInstance identity(uint32_t mesh = 0) noexcept {
         GPUMeshInstance inst{};
-        for (int i = 0; i < 16; ++i) {
-            inst.transform[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+        for (int i = 0; i < 12; ++i) {
             inst.invTransform[i] = (i % 5 == 0) ? 1.0f : 0.0f;
         }
         inst.meshId = mesh;
@@ -390,15 +409,92 @@ struct alignas(16) GPUMeshInstance {
 
     [[nodiscard]] static GPUMeshInstance translation(float x, float y, float z, uint32_t mesh = 0) noexcept {
         GPUMeshInstance inst = identity(mesh);
-        inst.transform[12] = x;
-        inst.transform[13] = y;
-        inst.transform[14] = z;
-        inst.invTransform[12] = -x;
-        inst.invTransform[13] = -y;
-        inst.invTransform[14] = -z;
+        inst.invTransform[3] = -x;
+        inst.invTransform[7] = -y;
+        inst.invTransform[11] = -z;
+        return inst;
+    }
+
+    // Rigid motor followed by a uniform scale
+    [[nodiscard]] static GPUMeshInstance FromMotor(const Motor& m, float scale, uint32_t mesh, bool isVisible) noexcept {
+        const auto rigid = MotorTransforms::RigidTransform::FromMotor(m);
+        const auto& r = rigid.rotation;
+        const auto& t = rigid.translation;
+
+        // (S*R)^-1 = R^T * S^-1, inverse translation -(1/s) * R^T * t
+        const float invScale = 1.0f / scale;
+        GPUMeshInstance inst{};
+        for (int row = 0; row < 3; ++row) {
+            for (int col = 0; col < 3; ++col) {
+                inst.invTransform[row * 4 + col] = r[col][row] * invScale;
+            }
+            inst.invTransform[row * 4 + 3] = -(r[0][row]*t[0] + r[1][row]*t[1] + r[2][row]*t[2]) * invScale;
+        }
+        inst.meshId = mesh;
+        inst.visible = isVisible ? 1 : 0;
         return inst;
     }
 };
+static_assert(sizeof(GPUMeshInstance) == 64, "GPUMeshInstance must be exactly 64 bytes");
+
+// ============================================================================
+// GPU Visibility Query ray (32 bytes, 16-byte aligned)
+// ============================================================================
+struct alignas(16) GPUVisibilityRay {
+    float origin[3]{0.0f, 0.0f, 0.0f};
+    float maxDistance{0.0f};        // <= 0 means unbounded
+    float direction[3]{0.0f, 0.0f, -1.0f};
+    float _pad{0.0f};
+
+    [[nodiscard]] static GPUVisibilityRay Segment(const float from[3], const float to[3]) noexcept {
+        GPUVisibilityRay ray{};
+        const float dx = to[0] - from[0];
+        const float dy = to[1] - from[1];
+        const float dz = to[2] - from[2];
+        ray.origin[0] = from[0]; ray.origin[1] = from[1]; ray.origin[2] = from[2];
+        ray.direction[0] = dx; ray.direction[1] = dy; ray.direction[2] = dz;
+        ray.maxDistance = std::sqrt(dx * dx + dy * dy + dz * dz);
+        return ray;
+    }
+};
+
+// ============================================================================
+// GPU Visibility Query result (16 bytes)
+// ============================================================================
+struct alignas(16) GPUVisibilityResult {
+    uint32_t occluded{0};           // 1 if the ray hit something before maxDistance
+    float hitDistance{0.0f};        // Distance to the closest hit (closest-hit queries only)
+    int32_t primitiveType{-1};      // 0 = triangle, 1 = sphere, 2 = plane, -1 = none
+    uint32_t instanceIndex{0};      // Mesh instance index for triangle hits
+};
+
+// ============================================================================
+// GPU Camera view for multi-view rendering (64 bytes)
+// ============================================================================
+struct alignas(16) GPUCameraView {
+    float right[3]{1.0f, 0.0f, 0.0f};
+    float fov{45.0f};               // Vertical field of view in degrees
+    float up[3]{0.0f, 1.0f, 0.0f};
+    float _pad0{0.0f};
+    float forward[3]{0.0f, 0.0f, 1.0f};   // Camera +Z; rays travel along -forward
+    float _pad1{0.0f};
+    float position[3]{0.0f, 0.0f, 0.0f};
+    float _pad2{0.0f};
+
+    // Same inputs as VulkanRenderer::RenderScene: row-major rotation (right, up, forward rows)
+    [[nodiscard]] static GPUCameraView create(const float rotation[9], const float pos[3], float fovDegrees) noexcept {
+        GPUCameraView view{};
+        for (int i = 0; i < 3; ++i) {
+            view.right[i] = rotation[i];
+            view.up[i] = rotation[3 + i];
+            view.forward[i] = rotation[6 + i];
+            view.position[i] = pos[i];
+        }
+        view.fov = fovDegrees;
+        return view;
+    }
+};
+static_assert(sizeof(GPUCameraView) == 64, "GPUCameraView must be 64 bytes");
 
 // ============================================================================
 // Scene data container
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Slots are constructed once and reused in place: the producer fills the slot returned by
+// TryBeginPush and publishes it with EndPush, the consumer reads Front and releases it with
+// Pop. Elements that own buffers therefore keep their capacity from one lap to the next.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : m_slots(capacity > 0 ? capacity : 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    [[nodiscard]] size_t Capacity() const noexcept { return m_slots.size(); }
+
+    // Producer: slot to fill, or nullptr while the queue is full
+    [[nodiscard]] T* TryBeginPush() noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) return nullptr;
+        return &m_slots[tail % m_slots.size()];
+    }
+
+    // Producer: publish the slot from the last successful TryBeginPush
+    void EndPush() noexcept {
+        m_tail.fetch_add(1, std::memory_order_release);
+        m_tail.notify_one();
+    }
+
+    // Producer: block until TryBeginPush can succeed
+    void WaitForSpace() const noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_acquire);
+        while (tail - head == m_slots.size()) {
+            m_head.wait(head, std::memory_order_acquire);
+            head = m_head.load(std::memory_order_acquire);
+        }
+    }
+
+    // Consumer: oldest published slot, or nullptr while the queue is empty
+    [[nodiscard]] T* Front() noexcept {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return nullptr;
+        return &m_slots[head % m_slots.size()];
+    }
+
+    // Consumer: hand the slot returned by Front back to the producer
+    void Pop() noexcept {
+        m_head.fetch_add(1, std::memory_order_release);
+        m_head.notify_one();
+    }
+
+    // Consumer: block until Front returns a slot
+    void WaitForItem() const noexcept {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        while (head == tail) {
+            m_tail.wait(tail, std::memory_order_acquire);
+            tail = m_tail.load(std::memory_order_acquire);
+        }
+    }
+
+private:
+    // Head and tail on separate cache lines so the two threads do not false-share
+    static constexpr size_t kCacheLine = 64;
+
+    std::vector<T> m_slots;
+    alignas(kCacheLine) std::atomic<size_t> m_head{0};  // Next slot to pop, written by the consumer
+    alignas(kCacheLine) std::atomic<size_t> m_tail{0};  // Next slot to push, written by the producer
+};
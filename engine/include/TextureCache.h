@@ -0,0 +1,45 @@
+#pragma once
+
+#include "MeshPacking.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Texture loading for VulkanRenderer::UploadMeshes. Files are memory-mapped, hashed and decoded
+// on the shared WorkerPool; files with identical contents (same hash, then the same bytes)
+// become one texture. Decoded textures (optionally with their mip chain) can be kept in a cache
+// directory, from which later runs map them instead of decoding again. The texels are handed out in place - from the
+// decoder's buffer or the mapped cache file - ready to be copied into staging memory.
+namespace TextureCache {
+
+struct Options {
+    std::string cacheDirectory;  // Decoded textures are read from / written to here; empty: no cache
+    bool generateMips{false};    // Give 8-bit textures their full mip chain (see TextureMips)
+    unsigned threadCount{0};     // Threads of the shared WorkerPool to use; 0: all of them
+};
+
+struct Texture {
+    MeshPacking::TexelSource source;  // Base level
+    // source.texels starts a full chain laid out by TextureMips::LayoutMipChain
+    bool hasMipChain{false};
+    uint64_t contentHash{0};          // ContentHash of the encoded file; 0 for the white fallback
+    std::shared_ptr<const void> storage;  // Keeps the texels alive: decoded pixels or the mapped file
+};
+
+struct LoadedTextures {
+    std::vector<Texture> textures;       // One per distinct file content, in order of first use
+    std::vector<uint32_t> textureOfPath; // Index into textures for each requested path
+    size_t cacheHits{0};
+};
+
+// Files that cannot be read or decoded load as a white texel, with a warning
+[[nodiscard]] LoadedTextures LoadTextures(std::span<const std::string> paths, const Options& options = {});
+
+// 64-bit hash of a file's bytes, used to find deduplication candidates and, with the file size,
+// as the cache key
+[[nodiscard]] uint64_t ContentHash(std::span<const std::byte> bytes) noexcept;
+
+} // namespace TextureCache
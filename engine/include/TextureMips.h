@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Mip chains for the sampled-image texture path (VulkanRenderer::EnableSampledTextures).
+// Levels are built on the CPU from the 8-bit RGBA base level with a 2x2 box filter and
+// stored one after another, base level first.
+namespace TextureMips {
+
+struct MipLevel {
+    uint32_t width{1};
+    uint32_t height{1};
+    size_t offset{0};  // First texel of the level in the chain
+};
+
+// Every level down to 1x1, each half the size of the one before (rounded down)
+[[nodiscard]] std::vector<MipLevel> LayoutMipChain(uint32_t width, uint32_t height);
+
+// Texels in a chain laid out by LayoutMipChain
+[[nodiscard]] size_t ChainTexels(std::span<const MipLevel> levels) noexcept;
+
+// One level from the level above it, rounding to nearest. The last row / column of an odd
+// size is dropped, except that a 1-texel dimension is repeated. Scalar reference for Downsample.
+void DownsampleScalar(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst) noexcept;
+// Same result, eight output texels per iteration with AVX2 when the build targets it
+void Downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst) noexcept;
+
+// Fill dst (ChainTexels * 4 bytes, e.g. mapped staging memory) with the base level and
+// every smaller level
+void GenerateMipChain(const uint8_t* rgba, std::span<const MipLevel> levels, uint8_t* dst) noexcept;
+
+} // namespace TextureMips
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "SpscQueue.h"
+#include "TextureCache.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Paged virtual textures for VulkanRenderer::EnableVirtualTextures. Every mip level of a texture
+// is cut into kTileSize square tiles, and only the tiles the shader asks for are kept on the GPU,
+// in a fixed pool of physical pages. The page table has one entry per tile: 0 while the tile is
+// not resident, its page + 1 once it is. Shaders set a feedback bit for each tile they wanted;
+// the renderer hands those bits to a TileStreamer, which cuts the missing tiles on a background
+// thread and places them in pages, evicting the least recently used. Until a tile arrives the
+// shader samples a coarser level - at worst the single-tile level, which is always resident.
+namespace VirtualTexture {
+
+inline constexpr uint32_t kTileSize = 64;
+// A page holds a tile plus one column and row past its right and bottom edges (wrapping like
+// the texture), so bilinear filtering never needs a second page - must match shading.glsl
+inline constexpr uint32_t kPageSide = kTileSize + 1;
+inline constexpr uint32_t kPageTexels = kPageSide * kPageSide;
+
+struct TileLevel {
+    uint32_t width{1};
+    uint32_t height{1};
+    uint32_t tilesX{1};
+    uint32_t tilesY{1};
+    uint32_t firstTile{0};  // Page table entry of the level's top-left tile
+    size_t texelOffset{0};  // First texel of the level in the texture's mip chain
+};
+
+// Tiles of every texture. Levels go from the base down to the first one that fits in a single
+// tile; smaller mips are never needed, as that tile is always resident.
+class TileSet {
+public:
+    // Returns the texture's first page table entry (its GPUTextureInfo::offset)
+    uint32_t Add(uint32_t width, uint32_t height);
+
+    struct TileAddress {
+        uint32_t texture{0};
+        uint32_t level{0};
+        uint32_t x{0};
+        uint32_t y{0};
+    };
+    [[nodiscard]] TileAddress Locate(uint32_t tile) const noexcept;
+
+    [[nodiscard]] std::span<const TileLevel> Levels(uint32_t texture) const noexcept;
+    // The always-resident tile of a texture (its last level)
+    [[nodiscard]] uint32_t PinnedTile(uint32_t texture) const noexcept { return Levels(texture).back().firstTile; }
+    [[nodiscard]] uint32_t TextureCount() const noexcept { return static_cast<uint32_t>(m_firstLevel.size()); }
+    [[nodiscard]] uint32_t TileCount() const noexcept { return m_tileCount; }
+
+private:
+    std::vector<TileLevel> m_levels;
+    std::vector<uint32_t> m_firstLevel;  // Per texture, into m_levels
+    uint32_t m_tileCount{0};
+};
+
+// Copy tile (x, y) of an RGBA8 level into a kPageSide x kPageSide page, wrapping at the level edges
+void ExtractTile(const void* level, uint32_t width, uint32_t height, uint32_t x, uint32_t y,
+                 uint32_t* page) noexcept;
+
+// Which tile is in which physical page. Resident tiles are kept in least-recently-used order;
+// pinned tiles are never evicted.
+class PageCache {
+public:
+    static constexpr uint32_t kNoPage = ~0u;
+
+    PageCache(uint32_t pageCount, uint32_t tileCount);
+
+    [[nodiscard]] uint32_t PageOf(uint32_t tile) const noexcept { return m_pageOfTile[tile]; }
+    [[nodiscard]] uint32_t PageCount() const noexcept { return static_cast<uint32_t>(m_tileOfPage.size()); }
+
+    // Mark a resident tile as used in frame; false if it is not resident
+    bool Touch(uint32_t tile, uint64_t frame) noexcept;
+
+    struct Placement {
+        uint32_t page{kNoPage};
+        uint32_t evictedTile{kNoPage};  // Tile whose page was reused, if any
+    };
+    // A page for a tile that is not resident: a free one, else the least recently used. kNoPage
+    // when every unpinned page was used in this frame - evicting those would only thrash.
+    [[nodiscard]] Placement Place(uint32_t tile, uint64_t frame, bool pinned = false) noexcept;
+
+private:
+    void unlink(uint32_t page) noexcept;
+    void pushFront(uint32_t page) noexcept;
+
+    std::vector<uint32_t> m_pageOfTile;
+    std::vector<uint32_t> m_tileOfPage;  // kNoPage for free pages
+    std::vector<uint64_t> m_lastUsed;
+    std::vector<uint8_t> m_pinned;
+    // Doubly linked LRU list of unpinned resident pages, most recent at the head
+    std::vector<uint32_t> m_prev;
+    std::vector<uint32_t> m_next;
+    uint32_t m_head{kNoPage};
+    uint32_t m_tail{kNoPage};
+    uint32_t m_freePages{0};  // Pages [0, m_freePages) have been handed out
+};
+
+struct PageUpload {
+    uint32_t page{0};
+    uint32_t source{0};  // Index of the page's texels in the staging array
+};
+struct PageTableWrite {
+    uint32_t entry{0};
+    uint32_t value{0};
+};
+
+// Residency for a set of textures: owns the tiles, the page cache and the thread that cuts
+// requested tiles out of the textures' mip chains. All methods are for the render thread.
+class TileStreamer {
+public:
+    // 8-bit textures with their mip chains (TextureCache::Options::generateMips); they are read
+    // in place, so mapped cache files are only paged in for the tiles that are used
+    TileStreamer(std::vector<TextureCache::Texture> textures, uint32_t pageCount);
+    ~TileStreamer();
+
+    TileStreamer(const TileStreamer&) = delete;
+    TileStreamer& operator=(const TileStreamer&) = delete;
+
+    [[nodiscard]] const TileSet& Tiles() const noexcept { return m_tiles; }
+    [[nodiscard]] uint32_t PageCount() const noexcept { return m_cache.PageCount(); }
+
+    // Initial page pool and page table: each texture's single-tile level, pinned in page
+    // [texture]. pages holds PageCount() * kPageTexels words, pageTable TileCount() entries.
+    void WriteInitialPages(uint32_t* pages, uint32_t* pageTable) const noexcept;
+
+    // Feedback bits (one per tile, 32 per word) of a finished frame: touches the resident tiles
+    // and requests the others
+    void ProcessFeedback(std::span<const uint32_t> feedback, uint64_t frame);
+
+    // Put up to maxTiles arrived tiles into pages: their texels go to staging (maxTiles *
+    // kPageTexels words), then the copies and page table changes to record are appended
+    size_t PlaceArrivedTiles(uint64_t frame, size_t maxTiles, uint32_t* staging,
+                             std::vector<PageUpload>& uploads, std::vector<PageTableWrite>& tableWrites);
+
+    [[nodiscard]] size_t PendingTiles() const noexcept { return m_pendingCount; }
+
+private:
+    struct Request {
+        uint32_t tile{0};
+    };
+    struct ArrivedTile {
+        uint32_t tile{0};
+        std::vector<uint32_t> texels;  // kPageTexels, reused from lap to lap
+    };
+    static constexpr uint32_t kStop = ~0u;
+    static constexpr uint32_t kMinStreamingPages = 16;  // Unpinned pages, whatever the page count asked for
+
+    void workerMain();
+    void cutTile(uint32_t tile, uint32_t* page) const noexcept;
+
+    std::vector<TextureCache::Texture> m_textures;
+    TileSet m_tiles;
+    PageCache m_cache;
+    std::vector<uint8_t> m_pending;  // Requested and not yet placed
+    size_t m_pendingCount{0};
+    SpscQueue<Request> m_requests;
+    SpscQueue<ArrivedTile> m_arrived;
+    std::atomic<bool> m_workerDone{false};
+    std::jthread m_worker;
+};
+
+} // namespace VirtualTexture
@@ -58,27 +58,19 @@ inline void createBuffer(
     vkBindBufferMemory(device, buffer, bufferMemory, 0);
 }
 
-// Upload data to a device-local buffer using staging
-template<typename T>
-void uploadToBuffer(
+// Upload to a device-local buffer of the given size; fill(void* mapped) writes the contents
+// straight into the staging memory, so large uploads need no intermediate copy
+template<typename Fill>
+void uploadToBufferWith(
     VkDevice device,
     VkPhysicalDevice physicalDevice,
     VkCommandPool commandPool,
     VkQueue queue,
-    const std::vector<T>& data,
+    VkDeviceSize bufferSize,
+    Fill&& fill,
     VkBuffer& buffer,
     VkDeviceMemory& bufferMemory)
 {
-    if (data.empty()) {
-        createBuffer(device, physicalDevice, sizeof(T),
-                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                    buffer, bufferMemory);
-        return;
-    }
-
-    const VkDeviceSize bufferSize = sizeof(T) * data.size();
-
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingMemory;
     createBuffer(device, physicalDevice, bufferSize,
@@ -88,7 +80,7 @@ void uploadToBuffer(
 
     void* mappedData = nullptr;
     vkMapMemory(device, stagingMemory, 0, bufferSize, 0, &mappedData);
-    std::memcpy(mappedData, data.data(), static_cast<size_t>(bufferSize));
+    std::forward<Fill>(fill)(mappedData);
     vkUnmapMemory(device, stagingMemory);
 
     createBuffer(device, physicalDevice, bufferSize,
@@ -130,6 +122,33 @@ void uploadToBuffer(
     vkFreeMemory(device, stagingMemory, nullptr);
 }
 
+// Upload data to a device-local buffer using staging
+template<typename T>
+void uploadToBuffer(
+    VkDevice device,
+    VkPhysicalDevice physicalDevice,
+    VkCommandPool commandPool,
+    VkQueue queue,
+    const std::vector<T>& data,
+    VkBuffer& buffer,
+    VkDeviceMemory& bufferMemory)
+{
+    if (data.empty()) {
+        createBuffer(device, physicalDevice, sizeof(T),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    buffer, bufferMemory);
+        return;
+    }
+
+    const VkDeviceSize bufferSize = sizeof(T) * data.size();
+    uploadToBufferWith(device, physicalDevice, commandPool, queue, bufferSize,
+                       [&data, bufferSize](void* mapped) {
+                           std::memcpy(mapped, data.data(), static_cast<size_t>(bufferSize));
+                       },
+                       buffer, bufferMemory);
+}
+
 // Update data in an existing buffer
 template<typename T>
 void updateBufferData(
@@ -202,7 +221,9 @@ inline void transitionImageLayout2(
     VkAccessFlags2 srcAccess,
     VkPipelineStageFlags2 dstStage,
     VkAccessFlags2 dstAccess,
-    PFN_vkCmdPipelineBarrier2KHR pfnCmdPipelineBarrier2KHR)
+    PFN_vkCmdPipelineBarrier2KHR pfnCmdPipelineBarrier2KHR,
+    uint32_t layerCount = 1,
+    uint32_t levelCount = 1)
 {
     VkImageMemoryBarrier2 barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
@@ -217,9 +238,9 @@ inline void transitionImageLayout2(
     barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = levelCount;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.layerCount = layerCount;
 
     VkDependencyInfo depInfo{};
     depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
@@ -286,18 +307,21 @@ struct DescriptorBinding {
     VkDevice device,
     VkImage image,
     VkFormat format,
-    VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT)
+    VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT,
+    VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D,
+    uint32_t layerCount = 1,
+    uint32_t levelCount = 1)
 {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.viewType = viewType;
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = levelCount;
     viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    viewInfo.subresourceRange.layerCount = layerCount;
 
     VkImageView imageView;
     if (vkCreateImageView(device, &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
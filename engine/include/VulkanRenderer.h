@@ -3,13 +3,23 @@
 #include <SDL3/SDL.h>
 #include <vulkan/vulkan.h>
 #include <array>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <span>
+#include <thread>
 
 class Mesh;
-struct MeshInstance;
-namespace Scene { struct SceneData; struct GPUSphere; struct GPUPlane; }
+struct InstanceArrays;
+struct InstanceRange;
+struct RenderSnapshot;
+struct PickResult;
+struct ImDrawData;
+namespace TextureCache { struct Texture; }
+namespace VirtualTexture { class TileStreamer; struct PageUpload; struct PageTableWrite; }
+namespace Scene { struct SceneData; struct GPUSphere; struct GPUPlane; struct GPUVisibilityRay; struct GPUVisibilityResult; struct GPUCameraView; }
 
 // Handles all Vulkan resources and rendering
 class VulkanRenderer {
@@ -29,21 +39,47 @@ public:
     VulkanRenderer& operator=(const VulkanRenderer&) = delete;
 
     // Rendering
-    void BeginFrame();
-    void RenderScene(const Scene::SceneData& sceneData,
+    void BeginFrame();  // AcquireFrame + BeginUiFrame
+    void RenderScene(const RenderSnapshot& snapshot,
                      const std::vector<std::unique_ptr<Mesh>>& meshes,
-                     const std::vector<MeshInstance>& instances,
                      const float cameraRotation[9],  // 3x3 rotation matrix (row-major)
                      const float cameraPosition[3],
                      float time, float cameraFov);
-    void EndFrame();
+    void EndFrame();    // ImGui::Render + SubmitFrame
+
+    // The same frame in halves for a render thread. The thread that owns the ImGui context
+    // runs BeginUiFrame and ImGui::Render; the render thread runs AcquireFrame, the uploads,
+    // RenderScene and SubmitFrame with a copy of the draw data.
+    void AcquireFrame();                       // Fence wait and swapchain acquire
+    void BeginUiFrame();                       // ImGui NewFrame, no Vulkan calls
+    void SubmitFrame(ImDrawData* uiDrawData);  // Record the UI pass, submit and present
+    [[nodiscard]] bool FrameStarted() const { return m_frameStarted; }
 
     // Resource management - Multi-mesh support
     void UploadMeshes(const std::vector<std::unique_ptr<Mesh>>& meshes);
+    void EnableCompactVertices();            // Call before UploadMeshes/CreateComputePipeline - 16-byte quantized vertices
+    [[nodiscard]] bool CompactVerticesEnabled() const { return m_compactVerticesEnabled; }
+    void EnableSampledTextures();            // Call before UploadMeshes - mipmapped 8-bit textures filtered by the sampler
+    [[nodiscard]] bool SampledTexturesEnabled() const { return m_sampledTexturesEnabled; }
+    void SetTextureCacheDirectory(const std::string& directory);  // Call before UploadMeshes - decoded textures are kept here
+    // Call before UploadMeshes - 8-bit textures not taken by the sampled path are paged in by tile
+    // as the shader asks for them, into a pool of pageCount 64x64 pages (about 17 KB each)
+    static constexpr uint32_t kDefaultVirtualTexturePages = 1024;
+    void EnableVirtualTextures(uint32_t pageCount = kDefaultVirtualTexturePages);
+    [[nodiscard]] bool VirtualTexturesEnabled() const { return m_virtualTexturesEnabled; }
+    // Call before UploadMeshes - shadow rays trace the meshes' shadow proxies whose error is within
+    // tolerance times their mesh's bounds diagonal (see MeshPacking::UsableShadowProxy)
+    void EnableShadowProxies(float tolerance);
+    [[nodiscard]] bool ShadowProxiesEnabled() const { return m_shadowProxyTolerance >= 0.0f; }
     void UploadSceneData(const Scene::SceneData& sceneData);
-    void UploadInstances(const std::vector<MeshInstance>& instances);  // Upload mesh instance transforms
+    void UploadInstances(const InstanceArrays& instances);  // Upload mesh instance transforms
+    // Repack only the changed records when the GPU buffer already holds all the others
+    void UploadInstances(const InstanceArrays& instances, InstanceRange changed);
+    // Upload only instances[visibleIndices[i]] - the frustum-culled set (see InstanceCulling)
+    void UploadInstances(const InstanceArrays& instances, std::span<const uint32_t> visibleIndices);
     void UpdateSpheres(const std::vector<Scene::GPUSphere>& spheres);  // Update sphere buffer for animation
     void UpdatePlanes(const std::vector<Scene::GPUPlane>& planes);    // Update plane buffer for animation
+    void UpdateLights(const std::vector<Scene::GPULight>& lights);    // Update light buffer for animation
     void UploadTexture(const std::string& filename);
     void WaitIdle();
 
@@ -51,6 +87,65 @@ public:
     void CreateDescriptorSet();  // Create and bind descriptor set after uploads
     void CreateComputePipeline();  // Create compute pipeline after descriptor set
 
+    // Command recording and queue submission happen on one thread: the one that created the
+    // renderer, or the render thread once it calls BindToCurrentThread (Application does this
+    // for --render-thread). The scene-facing calls below - visibility queries, AOV readback and
+    // multi-view rendering - need that thread, so Application refuses to start the render thread
+    // for a scene that enables them. Made from any other thread they warn and fail.
+    void BindToCurrentThread() noexcept { m_ownerThread.store(std::this_thread::get_id(), std::memory_order_release); }
+
+    // Asynchronous visibility queries - batched ray casts against the resident scene buffers
+    // Submit returns a query id (0 if every query slot is still in flight); poll it on later
+    // frames until it returns true. Neither call ever waits on the GPU.
+    void EnableVisibilityQueries();          // Call before CreateComputePipeline
+    [[nodiscard]] bool VisibilityQueriesEnabled() const { return m_visibilityQueriesEnabled; }
+    enum class VisibilityQueryMode : uint32_t {
+        AnyHit = 0,      // Occlusion only (spheres + mesh instances), early-out traversal
+        ClosestHit = 1   // Full traceScene: distance, primitive type and instance of the nearest hit
+    };
+    [[nodiscard]] uint32_t SubmitVisibilityQuery(const std::vector<Scene::GPUVisibilityRay>& rays,
+                                                 VisibilityQueryMode mode = VisibilityQueryMode::AnyHit);
+    [[nodiscard]] bool PollVisibilityQuery(uint32_t queryId, std::vector<Scene::GPUVisibilityResult>& results);
+    [[nodiscard]] bool IsVisibilityQueryPending(uint32_t queryId) const;
+
+    // GPU picking - primary-hit object IDs are written to an R32G32_UINT image and the
+    // requested pixel is copied back asynchronously (result is frames-in-flight old)
+    void EnableObjectIds();                  // Call before CreateDescriptorSet/CreateComputePipeline
+    [[nodiscard]] bool ObjectIdsEnabled() const { return m_objectIdsEnabled; }
+    void RequestPick(float x, float y);      // Pixel to read back with the next RenderScene
+    [[nodiscard]] bool GetPickResult(PickResult& out) const;
+
+    // AOV outputs - primary-hit auxiliary buffers written alongside the color image
+    struct AOVReadback {
+        uint32_t width{0};
+        uint32_t height{0};
+        std::vector<float> normalDepth;   // RGBA32F per pixel: world normal xyz, linear depth (0 = miss)
+        std::vector<uint8_t> albedo;      // RGBA8 per pixel
+        std::vector<uint32_t> ids;        // RG32UI per pixel: material ID (object-ID encoding), instance index
+    };
+    void EnableAOVs();                       // Call before CreateDescriptorSet/CreateComputePipeline
+    [[nodiscard]] bool AOVsEnabled() const { return m_aovsEnabled; }
+    [[nodiscard]] bool ReadbackAOVs(AOVReadback& out);  // Blocking: waits for the GPU to go idle
+
+    // Multi-view rendering - one dispatch per batch renders many cameras into an image array
+    // (z = view index) and a single copy reads every layer back. Intended for static scenes:
+    // scene counts are taken from the last RenderScene, like visibility queries.
+    struct MultiViewReadback {
+        uint32_t width{0};
+        uint32_t height{0};
+        uint32_t viewCount{0};
+        std::vector<uint8_t> pixels;      // RGBA8, view-major: pixels[(view * height + y) * width + x]
+    };
+    void EnableMultiView();                  // Call before CreateComputePipeline
+    [[nodiscard]] bool MultiViewEnabled() const { return m_multiViewEnabled; }
+    [[nodiscard]] bool RenderMultiView(const std::vector<Scene::GPUCameraView>& views,
+                                       uint32_t width, uint32_t height, MultiViewReadback& out);
+
+    // GPU frame timing - raytracing dispatch time from timestamp queries, harvested in BeginFrame
+    // once the frame's fence has signaled. Returns true once per new sample.
+    [[nodiscard]] bool GpuTimestampsSupported() const { return m_timestampQueryPool != VK_NULL_HANDLE; }
+    [[nodiscard]] bool TakeGpuFrameTime(double& milliseconds);
+
     // Memory optimization
     bool AreMeshesUploaded() const { return m_meshesUploaded; }
 
@@ -83,6 +178,65 @@ private:
         uint32_t maxBounces;
     } m_pushConstants{};
 
+    // Push constants for the visibility query shader - must match visibility.comp
+    struct VisibilityPushConstants {
+        uint32_t rayCount;
+        uint32_t queryMode;
+        uint32_t triangleCount;
+        uint32_t sphereCount;
+        uint32_t planeCount;
+        uint32_t instanceCount;
+        float planeTileScale;
+        uint32_t _pad;
+    };
+
+    // One in-flight visibility query: persistently mapped host-visible ray/result buffers
+    struct VisibilityQuerySlot {
+        VkBuffer rayBuffer{VK_NULL_HANDLE};
+        VkDeviceMemory rayBufferMemory{VK_NULL_HANDLE};
+        VkBuffer resultBuffer{VK_NULL_HANDLE};
+        VkDeviceMemory resultBufferMemory{VK_NULL_HANDLE};
+        void* mappedRays{nullptr};
+        void* mappedResults{nullptr};
+        uint32_t capacity{0};         // Rays the buffers can hold
+        uint32_t rayCount{0};         // Rays in the current query
+        uint32_t queryId{0};          // 0 = slot free
+        VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+        VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+        VkFence fence{VK_NULL_HANDLE};
+    };
+    static constexpr uint32_t kMaxVisibilityQueries = 4;
+
+    // One multi-view batch: layered output, camera records and readback for up to
+    // m_multiViewLayers views. Two slots let the CPU copy one batch out while the next renders.
+    struct MultiViewBatchSlot {
+        VkImage image{VK_NULL_HANDLE};
+        VkDeviceMemory imageMemory{VK_NULL_HANDLE};
+        VkImageView imageView{VK_NULL_HANDLE};
+        VkBuffer cameraBuffer{VK_NULL_HANDLE};
+        VkDeviceMemory cameraBufferMemory{VK_NULL_HANDLE};
+        VkBuffer readbackBuffer{VK_NULL_HANDLE};
+        VkDeviceMemory readbackBufferMemory{VK_NULL_HANDLE};
+        void* mappedCameras{nullptr};
+        const void* mappedReadback{nullptr};
+        uint32_t firstView{0};        // Views rendered by the batch in flight
+        uint32_t viewCount{0};        // 0 = slot idle
+        VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+        VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+        VkFence fence{VK_NULL_HANDLE};
+    };
+    // One mipmapped texture of the sampled-image path (binding 17)
+    struct SampledTexture {
+        VkImage image{VK_NULL_HANDLE};
+        VkDeviceMemory memory{VK_NULL_HANDLE};
+        VkImageView view{VK_NULL_HANDLE};
+    };
+    static constexpr uint32_t kMaxSampledTextures = 64;
+    static constexpr uint32_t kMaxTileUploadsPerFrame = 32;  // Virtual texture pages copied per RenderScene
+
+    static constexpr uint32_t kMultiViewBatchSlots = 2;
+    static constexpr VkDeviceSize kMultiViewBatchBytes = 256ull * 1024 * 1024;  // Per-slot image budget
+
     // Initialization
     void createInstance();
     void setupDebugMessenger();
@@ -91,6 +245,7 @@ private:
     void createSwapchain();
     void createRenderResources();
     void createSyncObjects();
+    void createTimestampQueryPool();
     void recreateSwapchain();
 
     // Resource creation helpers
@@ -102,6 +257,30 @@ private:
     void createRenderPass();
     void createFramebuffers();
     void createImGuiResources();
+    void createOutputImage(VkFormat format, uint32_t width, uint32_t height,
+                           VkImage& image, VkDeviceMemory& memory, VkImageView& view);
+    void createObjectIdImage();
+    void createAOVImages();
+    void createVisibilityResources();
+    void createVisibilityPipeline();
+    void ensureVisibilitySlotCapacity(VisibilityQuerySlot& slot, uint32_t rayCount);
+    void destroyVisibilitySlotBuffers(VisibilityQuerySlot& slot);
+    void createMultiViewResources();
+    void createMultiViewPipeline();
+    void ensureMultiViewCapacity(uint32_t width, uint32_t height, uint32_t viewCount);
+    void destroyMultiViewSlotResources(MultiViewBatchSlot& slot);
+    [[nodiscard]] bool submitMultiViewBatch(MultiViewBatchSlot& slot);
+    void ensureInstanceCapacity(uint32_t instanceCount);
+    void uploadInstanceRecords(const InstanceArrays& instances, const std::span<const uint32_t>* visibleIndices,
+                               const InstanceRange* changed);
+    void recordInstanceCopy(VkCommandBuffer cmdBuffer, uint32_t slot, uint32_t first, uint32_t instanceCount);
+    void destroyInstanceBuffers();
+    void uploadSampledTextures(const std::vector<TextureCache::Texture>& textures);
+    void destroySampledTextures();
+    void createVirtualTextures(std::vector<TextureCache::Texture> textures);
+    void recordTileUploads(VkCommandBuffer cmdBuffer);
+    void recordTileFeedbackReadback(VkCommandBuffer cmdBuffer);
+    void destroyVirtualTextures();
 
     // Cleanup
     void cleanup();
@@ -152,6 +331,8 @@ private:
     VkPipeline m_computePipeline{VK_NULL_HANDLE};
 
     // Scene buffers
+    bool m_compactVerticesEnabled{false};  // Vertex buffer holds GPUCompactVertex instead of GPUVertex
+    float m_shadowProxyTolerance{-1.0f};   // Negative: shadow rays trace the meshes themselves
     VkBuffer m_vertexBuffer{VK_NULL_HANDLE};
     VkDeviceMemory m_vertexBufferMemory{VK_NULL_HANDLE};
     VkBuffer m_indexBuffer{VK_NULL_HANDLE};
@@ -168,17 +349,117 @@ private:
     VkDeviceMemory m_planeBufferMemory{VK_NULL_HANDLE};
     VkBuffer m_lightBuffer{VK_NULL_HANDLE};
     VkDeviceMemory m_lightBufferMemory{VK_NULL_HANDLE};
+    std::vector<Scene::GPULight> m_uploadedLights;  // Last UpdateLights contents, to skip unchanged uploads
     VkBuffer m_materialBuffer{VK_NULL_HANDLE};
     VkDeviceMemory m_materialBufferMemory{VK_NULL_HANDLE};
     VkBuffer m_textureBuffer{VK_NULL_HANDLE};
     VkDeviceMemory m_textureBufferMemory{VK_NULL_HANDLE};
     VkBuffer m_textureInfoBuffer{VK_NULL_HANDLE};
     VkDeviceMemory m_textureInfoBufferMemory{VK_NULL_HANDLE};
+    // Sampled-image textures: a 1x1 placeholder once the descriptor set exists if none were uploaded
+    bool m_sampledTexturesEnabled{false};
+    bool m_nonUniformSamplingSupported{false};  // shaderSampledImageArrayNonUniformIndexing
+    uint32_t m_sampledTextureSlots{1};          // Binding 17's array size, as far as the device allows
+    std::vector<SampledTexture> m_sampledTextures;
+    VkSampler m_textureSampler{VK_NULL_HANDLE};
+    std::string m_textureCacheDirectory;        // Empty: decoded textures are not cached
+
+    // Virtual textures: page table (binding 18), page pool (19) and the tile feedback bits the
+    // shader sets (20), copied into one readback slot per frame in flight and cleared after each
+    // dispatch. Arrived tiles are staged in one persistently mapped slot per frame in flight.
+    bool m_virtualTexturesEnabled{false};
+    uint32_t m_virtualTexturePages{kDefaultVirtualTexturePages};
+    std::unique_ptr<VirtualTexture::TileStreamer> m_tileStreamer;
+    VkBuffer m_pageTableBuffer{VK_NULL_HANDLE};
+    VkDeviceMemory m_pageTableBufferMemory{VK_NULL_HANDLE};
+    VkBuffer m_pageBuffer{VK_NULL_HANDLE};
+    VkDeviceMemory m_pageBufferMemory{VK_NULL_HANDLE};
+    VkBuffer m_tileFeedbackBuffer{VK_NULL_HANDLE};
+    VkDeviceMemory m_tileFeedbackBufferMemory{VK_NULL_HANDLE};
+    VkBuffer m_tileFeedbackReadbackBuffer{VK_NULL_HANDLE};
+    VkDeviceMemory m_tileFeedbackReadbackMemory{VK_NULL_HANDLE};
+    const uint32_t* m_tileFeedbackReadbackMapped{nullptr};
+    VkBuffer m_tileStagingBuffer{VK_NULL_HANDLE};
+    VkDeviceMemory m_tileStagingMemory{VK_NULL_HANDLE};
+    uint32_t* m_tileStagingMapped{nullptr};
+    uint32_t m_tileFeedbackWords{0};
+    bool m_tileFeedbackCleared{false};          // The feedback buffer starts out undefined
+    std::vector<bool> m_tileFeedbackWritten;    // Per frame in flight: its readback slot holds feedback
+    uint64_t m_virtualTextureFrame{0};
+    std::vector<VirtualTexture::PageUpload> m_tileUploads;  // Scratch for recordTileUploads
+    std::vector<VirtualTexture::PageTableWrite> m_pageTableWrites;
     uint32_t m_textureWidth{0};
     uint32_t m_textureHeight{0};
     VkBuffer m_instanceMotorBuffer{VK_NULL_HANDLE};
     VkDeviceMemory m_instanceMotorBufferMemory{VK_NULL_HANDLE};
     uint32_t m_instanceBufferCapacity{0};  // Track allocated capacity for dynamic resize
+    // Persistently mapped staging, one capacity-sized slot per frame in flight. UploadInstances
+    // packs into the current slot and RenderScene records the copy to the device buffer.
+    VkBuffer m_instanceStagingBuffer{VK_NULL_HANDLE};
+    VkDeviceMemory m_instanceStagingMemory{VK_NULL_HANDLE};
+    Scene::GPUMeshInstance* m_instanceStagingMapped{nullptr};
+    uint32_t m_pendingInstanceCopy{0};  // Instances to copy in the next RenderScene (0 = none)
+    uint32_t m_pendingInstanceFirst{0};
+    // Thread allowed to record and submit (see BindToCurrentThread)
+    std::atomic<std::thread::id> m_ownerThread{std::this_thread::get_id()};
+    mutable std::atomic<bool> m_warnedOffThread{false};
+    [[nodiscard]] bool onOwnerThread(const char* call) const;
+
+    uint32_t m_instanceCount{0};        // Records in the last upload, traced by RenderScene
+    size_t m_sceneInstanceCount{0};     // Instances in the scene of the last upload, before culling
+    bool m_instanceBufferDense{false};  // Device buffer holds every instance at its dense index
+    uint32_t m_pendingInstanceSlot{0};
+
+    // Visibility queries
+    VkDescriptorSetLayout m_visibilityDescriptorSetLayout{VK_NULL_HANDLE};
+    VkDescriptorPool m_visibilityDescriptorPool{VK_NULL_HANDLE};
+    VkPipelineLayout m_visibilityPipelineLayout{VK_NULL_HANDLE};
+    VkPipeline m_visibilityPipeline{VK_NULL_HANDLE};
+    bool m_visibilityQueriesEnabled{false};
+    std::array<VisibilityQuerySlot, kMaxVisibilityQueries> m_visibilitySlots{};
+    uint32_t m_nextVisibilityQueryId{1};
+
+    // Multi-view batches
+    VkDescriptorSetLayout m_multiViewDescriptorSetLayout{VK_NULL_HANDLE};
+    VkDescriptorPool m_multiViewDescriptorPool{VK_NULL_HANDLE};
+    VkPipelineLayout m_multiViewPipelineLayout{VK_NULL_HANDLE};
+    VkPipeline m_multiViewPipeline{VK_NULL_HANDLE};
+    bool m_multiViewEnabled{false};
+    std::array<MultiViewBatchSlot, kMultiViewBatchSlots> m_multiViewSlots{};
+    uint32_t m_multiViewWidth{0};
+    uint32_t m_multiViewHeight{0};
+    uint32_t m_multiViewLayers{0};     // Views per batch the slot resources can hold
+
+    // Object-ID image and single-pixel pick readback (one 8-byte slot per frame in flight)
+    struct PickRequest {
+        bool pending{false};
+        uint32_t x{0};
+        uint32_t y{0};
+    };
+    bool m_objectIdsEnabled{false};
+    VkImage m_objectIdImage{VK_NULL_HANDLE};
+    VkDeviceMemory m_objectIdImageMemory{VK_NULL_HANDLE};
+    VkImageView m_objectIdImageView{VK_NULL_HANDLE};
+    VkBuffer m_pickReadbackBuffer{VK_NULL_HANDLE};
+    VkDeviceMemory m_pickReadbackBufferMemory{VK_NULL_HANDLE};
+    const uint32_t* m_pickReadbackMapped{nullptr};
+    PickRequest m_nextPick;
+    std::vector<PickRequest> m_picksInFlight;
+    PickRequest m_lastPick;
+    std::array<uint32_t, 2> m_lastPickIds{0, 0};
+    bool m_hasPickResult{false};
+
+    // AOV images (1x1 placeholders when disabled)
+    bool m_aovsEnabled{false};
+    VkImage m_aovNormalDepthImage{VK_NULL_HANDLE};
+    VkDeviceMemory m_aovNormalDepthImageMemory{VK_NULL_HANDLE};
+    VkImageView m_aovNormalDepthImageView{VK_NULL_HANDLE};
+    VkImage m_aovAlbedoImage{VK_NULL_HANDLE};
+    VkDeviceMemory m_aovAlbedoImageMemory{VK_NULL_HANDLE};
+    VkImageView m_aovAlbedoImageView{VK_NULL_HANDLE};
+    VkImage m_aovIdImage{VK_NULL_HANDLE};
+    VkDeviceMemory m_aovIdImageMemory{VK_NULL_HANDLE};
+    VkImageView m_aovIdImageView{VK_NULL_HANDLE};
 
     // Storage image layout tracking
     VkImageLayout m_storageImageLayout{VK_IMAGE_LAYOUT_UNDEFINED};
@@ -193,6 +474,14 @@ private:
     std::vector<VkFence> m_imagesInFlight;  // Track which fence is using each swapchain image
     uint32_t m_currentFrame{0};
 
+    // GPU timestamps (two queries per frame in flight: before and after the dispatch)
+    VkQueryPool m_timestampQueryPool{VK_NULL_HANDLE};
+    double m_timestampPeriodNs{1.0};
+    uint64_t m_timestampMask{~0ull};
+    std::vector<bool> m_timestampsWritten;
+    double m_lastGpuFrameMs{0.0};
+    bool m_hasNewGpuFrameTime{false};
+
     // ImGui rendering resources
     VkRenderPass m_renderPass{VK_NULL_HANDLE};
     std::vector<VkFramebuffer> m_framebuffers;
@@ -204,7 +493,7 @@ private:
     uint32_t m_imageIndex{0};
     bool m_frameStarted{false};
     bool m_meshesUploaded{false};
-    uint32_t m_uploadedMaterialCount{0};  // Material count from UploadMeshes
+    uint32_t m_uploadedMaterialCount{0};  // Materials in m_materialBuffer (UploadMeshes or UploadSceneData)
 
     // Modern Vulkan 1.3 extension function pointers (loaded dynamically for MoltenVK compatibility)
     PFN_vkQueueSubmit2KHR m_vkQueueSubmit2KHR{nullptr};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Persistent worker threads for the engine's parallel loops (texture loading, instance packing,
+// LOD and shadow proxy generation), so a loop costs a wake-up instead of a thread spawn.
+// The thread calling ParallelFor works alongside the pool. One loop runs at a time: a call made
+// while the pool is busy - from another thread, or from inside a loop body - runs serially on
+// the calling thread instead of waiting. An exception thrown by a loop body stops the loop from
+// handing out further indices and is rethrown to the caller once every thread has left it.
+class WorkerPool {
+public:
+    // threadCount counts the calling thread too; 0: one per hardware thread
+    explicit WorkerPool(unsigned threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // The pool shared by the engine, created on first use
+    [[nodiscard]] static WorkerPool& Shared();
+
+    // Threads a loop can run on, the calling thread included
+    [[nodiscard]] unsigned ThreadCount() const noexcept { return static_cast<unsigned>(m_threads.size()) + 1; }
+
+    // fn(i) for every i in [0, count), handed out one index at a time to at most maxThreads
+    // threads (0: all of them). Returns once every call has finished.
+    template<typename Fn>
+    void ParallelFor(size_t count, Fn&& fn, unsigned maxThreads = 0) {
+        using Body = std::remove_reference_t<Fn>;
+        run(count, maxThreads, &fn, [](void* body, size_t i) { (*static_cast<Body*>(body))(i); });
+    }
+
+private:
+    using Invoke = void (*)(void* body, size_t i);
+
+    void run(size_t count, unsigned maxThreads, void* body, Invoke invoke);
+    void drain();
+    void workerMain();
+
+    std::vector<std::jthread> m_threads;
+    std::atomic<bool> m_busy{false};  // Set by the thread whose loop is running
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_generation{0};  // Bumped for every loop
+    unsigned m_openSlots{0};   // Workers still allowed to join the current loop
+    unsigned m_running{0};     // Workers inside the current loop
+    bool m_stop{false};
+
+    // The current loop; written under m_mutex before the generation is bumped
+    void* m_body{nullptr};
+    Invoke m_invoke{nullptr};
+    size_t m_count{0};
+    std::atomic<size_t> m_next{0};
+    std::exception_ptr m_error;  // First exception thrown by the current loop, under m_mutex
+};
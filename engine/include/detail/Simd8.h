@@ -0,0 +1,96 @@
+#pragma once
+
+// Building blocks shared by the engine's 8-wide AVX2 kernels (instance packing and culling,
+// animation). Internal: only for translation units that check __AVX2__ themselves.
+#if defined(__AVX2__)
+#include "FlyFish.h"
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace Simd8 {
+
+// Transpose an 8x8 float block held in eight registers
+inline void Transpose8x8(__m256 r[8]) noexcept {
+    const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+// Rotation and translation of eight motors, one per lane: MotorTransforms::RigidTransform::FromMotor
+// eight at a time
+struct RigidTransform8 {
+    __m256 rotation[3][3];
+    __m256 translation[3];
+
+    // motors[indices[first + k]] in lane k, or motors[first + k] without indices. Components
+    // are gathered through the accessors, as FlyFish's storage order is not assumed.
+    [[nodiscard]] static RigidTransform8 Gather(const Motor* motors, const uint32_t* indices, size_t first) noexcept {
+        alignas(32) float lanes[8][8];
+        for (int k = 0; k < 8; ++k) {
+            const Motor& m = motors[indices ? indices[first + k] : first + k];
+            lanes[0][k] = m.s();
+            lanes[1][k] = m.e01();
+            lanes[2][k] = m.e02();
+            lanes[3][k] = m.e03();
+            lanes[4][k] = -m.e23();
+            lanes[5][k] = -m.e31();
+            lanes[6][k] = -m.e12();
+            lanes[7][k] = m.e0123();
+        }
+        const __m256 s = _mm256_load_ps(lanes[0]);
+        const __m256 d1 = _mm256_load_ps(lanes[1]);
+        const __m256 d2 = _mm256_load_ps(lanes[2]);
+        const __m256 d3 = _mm256_load_ps(lanes[3]);
+        const __m256 b1 = _mm256_load_ps(lanes[4]);
+        const __m256 b2 = _mm256_load_ps(lanes[5]);
+        const __m256 b3 = _mm256_load_ps(lanes[6]);
+        const __m256 p = _mm256_load_ps(lanes[7]);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+
+        auto mul = [](__m256 a, __m256 b) { return _mm256_mul_ps(a, b); };
+        auto add = [](__m256 a, __m256 b) { return _mm256_add_ps(a, b); };
+        auto sub = [](__m256 a, __m256 b) { return _mm256_sub_ps(a, b); };
+
+        return {
+            {
+                {sub(one, mul(two, add(mul(b2, b2), mul(b3, b3)))), mul(two, sub(mul(b1, b2), mul(s, b3))),
+                 mul(two, add(mul(b1, b3), mul(s, b2)))},
+                {mul(two, add(mul(b1, b2), mul(s, b3))), sub(one, mul(two, add(mul(b1, b1), mul(b3, b3)))),
+                 mul(two, sub(mul(b2, b3), mul(s, b1)))},
+                {mul(two, sub(mul(b1, b3), mul(s, b2))), mul(two, add(mul(b2, b3), mul(s, b1))),
+                 sub(one, mul(two, add(mul(b1, b1), mul(b2, b2))))},
+            },
+            {
+                mul(two, sub(sub(add(mul(d1, s), mul(d2, b3)), mul(d3, b2)), mul(p, b1))),
+                mul(two, sub(sub(add(mul(d2, s), mul(d3, b1)), mul(d1, b3)), mul(p, b2))),
+                mul(two, sub(sub(add(mul(d3, s), mul(d1, b2)), mul(d2, b1)), mul(p, b3))),
+            },
+        };
+    }
+};
+
+} // namespace Simd8
+#endif
@@ -26,13 +26,22 @@ const int SHADING_LAMBERT = 1; // Basic diffuse (Lambertian)
 const int SHADING_PHONG = 2;   // Diffuse + specular (Blinn-Phong)
 const int SHADING_PBR = 3;     // Full PBR (Cook-Torrance)
 
-// Vertex structure (32 bytes) - matches GPUVertex from C++
-// Optimized layout: position.xyz + u packed together, normal.xyz + v packed together
-// This saves 16 bytes per vertex (33% memory reduction)
-struct Vertex {
-    vec4 positionU;     // x, y, z, texture_u
-    vec4 normalV;       // nx, ny, nz, texture_v
-};
+// Texture formats (see TextureInfo)
+const uint TEXTURE_RGBA8 = 0;     // One word per texel
+const uint TEXTURE_RGBA32F = 1;   // Four words per texel (HDR)
+const uint TEXTURE_SAMPLED = 2;   // Mipmapped image; offset is the sampledTextures slot
+const uint TEXTURE_VIRTUAL = 3;   // Paged; offset is the first page table entry
+
+// Virtual texture pages (see VirtualTexture.h): a tile plus a border column and row
+const uint VT_TILE_SIZE = 64u;
+const uint VT_PAGE_SIDE = VT_TILE_SIZE + 1u;
+const uint VT_PAGE_TEXELS = VT_PAGE_SIDE * VT_PAGE_SIDE;
+
+// Vertices are read as raw words from the vertex buffer (see traversal.glsl), in one of two layouts:
+// GPUVertex (8 words, 32 bytes): x, y, z, u, nx, ny, nz, v
+// GPUCompactVertex (4 words, 16 bytes) when COMPACT_VERTICES is set:
+//   x | y << 16, z, octahedral normal (2 x snorm16), u | v as half floats
+// Compact positions are 16-bit fixed point inside the mesh bounds, see MeshInfo
 
 // Triangle structure
 struct Triangle {
@@ -115,24 +124,25 @@ struct Ray {
     vec3 direction;
 };
 
-// Mesh instance - transform for instanced rendering
+// Mesh instance - transform for instanced rendering (64 bytes)
+// invTransform holds the rows of the 3x4 world-to-object matrix; apply it as vec4(p, 1.0) * invTransform
 struct MeshInstance {
-    mat4 transform;       // Object-to-world transform
-    mat4 invTransform;    // World-to-object transform (for ray transformation)
+    mat3x4 invTransform;  // World-to-object transform (for ray transformation)
     uint meshId;          // Which mesh this instance uses
     uint visible;         // Visibility flag (0 or 1)
-    vec2 _pad;
+    uint sourceIndex;     // Dense scene index - differs from the buffer index once culling compacts it
+    float _pad;
 };
 
 // Texture info - per-texture metadata for multi-texture support (16 bytes)
 struct TextureInfo {
-    uint offset;            // Offset into texture data buffer (in vec4 pixels)
+    uint offset;            // Offset into texture data buffer (in 32-bit words), or image slot
     uint width;             // Texture width
     uint height;            // Texture height
-    uint _pad;              // Padding to 16 bytes
+    uint format;            // TEXTURE_RGBA8, TEXTURE_RGBA32F, TEXTURE_SAMPLED or TEXTURE_VIRTUAL
 };
 
-// Mesh info - per-mesh offsets for multi-mesh support (32 bytes)
+// Mesh info - per-mesh offsets for multi-mesh support (64 bytes)
 struct MeshInfo {
     uint vertexOffset;      // Offset into vertex buffer
     uint triangleOffset;    // Offset into triangle buffer
@@ -140,7 +150,12 @@ struct MeshInfo {
     uint bvhTriIdxOffset;   // Offset into BVH triangle index buffer
     uint triangleCount;     // Number of triangles in this mesh
     uint bvhNodeCount;      // Number of BVH nodes in this mesh
-    uvec2 _pad;             // Padding to 32 bytes
+    uint shadowMeshId;      // Mesh info traced by shadow rays: this mesh or its shadow proxy
+    uint _pad;
+    vec3 quantOrigin;       // Compact vertices: position = quantOrigin + quantized * quantScale
+    float _pad1;
+    vec3 quantScale;
+    float _pad2;            // Padding to 64 bytes
 };
 
 // Hit information
@@ -150,23 +165,11 @@ struct HitInfo {
     vec3 position;
     vec3 normal;
     vec2 uv;
+    float uvPerWorld;     // UV units per world unit along the surface (triangles only) - texture LOD
     uint triangleIndex;
     uint materialIndex;
     int primitiveType;
     uint instanceIndex;   // Which instance was hit
 };
 
-// Vertex accessor functions (optimized 32-byte layout)
-vec3 getVertexPosition(Vertex vtx) {
-    return vtx.positionU.xyz;
-}
-
-vec3 getVertexNormal(Vertex vtx) {
-    return vtx.normalV.xyz;
-}
-
-vec2 getVertexTexCoord(Vertex vtx) {
-    return vec2(vtx.positionU.w, vtx.normalV.w);
-}
-
 #endif // COMMON_GLSL
@@ -0,0 +1,436 @@
+// Surface shading and multi-bounce path tracing shared by the raytracing kernels
+// The including shader must declare a push constant block named `pc` that provides
+// the traversal.glsl fields plus lightCount, materialCount and maxBounces, and enable
+// GL_EXT_nonuniform_qualifier for the sampled texture array
+
+#ifndef SHADING_GLSL
+#define SHADING_GLSL
+
+#include "traversal.glsl"
+
+// Shading buffers (descriptor set 0, shared with the raytracer pipeline)
+layout (binding = 5) readonly buffer LightBuffer { Light lights[]; };
+layout (binding = 6) readonly buffer MaterialBuffer { Material materials[]; };
+layout (binding = 9) readonly buffer TextureBuffer { uint textureData[]; };
+layout (binding = 12) readonly buffer TextureInfoBuffer { TextureInfo textureInfos[]; };
+
+// Mipmapped textures (VulkanRenderer::EnableSampledTextures); the renderer sizes the array to
+// what the device allows and fills unused slots with a placeholder
+layout (constant_id = 3) const uint SAMPLED_TEXTURE_SLOTS = 1;
+layout (binding = 17) uniform sampler2D sampledTextures[SAMPLED_TEXTURE_SLOTS];
+
+// Virtual textures (VulkanRenderer::EnableVirtualTextures, see VirtualTexture.h): one page table
+// entry per tile (page + 1, or 0 while not resident), the physical pages, and one feedback bit
+// per tile the shader wanted, read back by the renderer after the frame
+layout (binding = 18) readonly buffer PageTableBuffer { uint pageTable[]; };
+layout (binding = 19) readonly buffer PageBuffer { uint pageData[]; };
+layout (binding = 20) buffer TileFeedbackBuffer { uint tileFeedback[]; };
+
+// ==================== Helper Structures ====================
+
+// Light sample - computed properties for a light source at a given point
+struct LightSample {
+    vec3 direction;     // Direction toward light
+    vec3 color;         // Light color * intensity
+    float attenuation;  // Distance/spot attenuation
+    float maxDist;      // Max distance for shadow ray
+    bool valid;         // Whether this light contributes
+};
+
+// Surface properties for path tracing
+struct SurfaceInfo {
+    vec3 albedo;
+    float metallic;
+    float roughness;
+    float reflectivity;
+    int shadingMode;
+    int skipInstance;
+};
+
+// ==================== Camera ====================
+
+// Pinhole camera ray - basis vectors are the rows of the camera rotation, fov in degrees
+Ray generateCameraRay(ivec2 pixel, ivec2 dims, vec3 origin, vec3 right, vec3 up, vec3 forward, float fov) {
+    vec2 uv = (vec2(pixel) + 0.5) / vec2(dims);
+    vec2 ndc = uv * 2.0 - 1.0;
+    float aspect = float(dims.x) / float(dims.y);
+    float fovScale = tan(fov * PI / 360.0);
+
+    vec3 localDir = normalize(vec3(ndc.x * aspect * fovScale, -ndc.y * fovScale, -1.0));
+    vec3 worldDir = localDir.x * right
+                  + localDir.y * up
+                  + localDir.z * forward;
+
+    Ray ray;
+    ray.origin = origin;
+    ray.direction = normalize(worldDir);
+    return ray;
+}
+
+// Angle one pixel subtends - the spread of the ray cone traced through it
+float pixelSpreadAngle(ivec2 dims, float fov) {
+    return atan(2.0 * tan(fov * PI / 360.0) / float(dims.y));
+}
+
+// ==================== Shadows ====================
+
+// Shadow ray test - returns true if point is in shadow
+bool isInShadow(vec3 position, vec3 normal, vec3 lightDir, float maxDist, int skipInstance) {
+    Ray shadowRay;
+    shadowRay.origin = position + normal * SHADOW_BIAS + lightDir * SHADOW_BIAS;
+    shadowRay.direction = lightDir;
+    return traceAnyHit(shadowRay, maxDist, skipInstance, true);
+}
+
+// ==================== Light Evaluation (Unified) ====================
+
+// Evaluate a light source at a given position
+LightSample evaluateLight(Light light, vec3 position) {
+    LightSample ls;
+    ls.valid = true;
+    ls.attenuation = 1.0;
+    ls.maxDist = MAX_DIST;
+
+    vec3 lightPos = vec3(light.position_x, light.position_y, light.position_z);
+    vec3 lightDir = vec3(light.direction_x, light.direction_y, light.direction_z);
+    ls.color = vec3(light.color_r, light.color_g, light.color_b) * light.intensity;
+
+    int lightType = int(light.type);
+    if (lightType == LIGHT_DIRECTIONAL) {
+        ls.direction = normalize(lightDir);
+    } else {
+        // Point or spot light
+        vec3 toLight = lightPos - position;
+        float dist = length(toLight);
+        if (dist < EPSILON) dist = EPSILON;
+        ls.direction = toLight / dist;
+        ls.maxDist = dist;
+        ls.attenuation = 1.0 / (1.0 + dist * dist / (light.range * light.range));
+
+        if (lightType == LIGHT_SPOT) {
+            float spotCos = dot(-ls.direction, normalize(lightDir));
+            float spotAngleCos = cos(light.spotAngle);
+            float spotEdge = cos(light.spotAngle * (1.0 - light.spotSoftness));
+            float spotDenom = spotEdge - spotAngleCos;
+            float spotAtten = (abs(spotDenom) > EPSILON)
+                ? clamp((spotCos - spotAngleCos) / spotDenom, 0.0, 1.0)
+                : (spotCos >= spotAngleCos ? 1.0 : 0.0);
+            ls.attenuation *= spotAtten;
+        }
+    }
+
+    return ls;
+}
+
+// ==================== Texture Sampling ====================
+
+// Texel i of a texture: packed RGBA8 unless the texture is HDR
+vec4 fetchTexel(TextureInfo info, uint i) {
+    if (info.format == TEXTURE_RGBA32F) {
+        uint word = info.offset + i * 4;
+        return uintBitsToFloat(uvec4(textureData[word], textureData[word + 1],
+                                     textureData[word + 2], textureData[word + 3]));
+    }
+    return unpackUnorm4x8(textureData[info.offset + i]);
+}
+
+uint virtualTilesOf(uint size) {
+    return (size + VT_TILE_SIZE - 1u) / VT_TILE_SIZE;
+}
+
+// Bilinear sample of a virtual texture at the level the footprint asks for, or the finest
+// coarser level that is resident. Pages carry a wrapped border column and row, so all four
+// texels come from one page; the filtering matches the texture buffer path.
+vec3 sampleVirtualTexture(TextureInfo info, vec2 uv, float uvFootprint) {
+    float lod = log2(max(uvFootprint * sqrt(float(info.width) * float(info.height)), 1e-6));
+    uint wanted = uint(clamp(lod + 0.5, 0.0, 31.0));
+
+    uint w = info.width;
+    uint h = info.height;
+    uint firstTile = info.offset;
+    uint level = 0u;
+    // Levels end at the first single-tile one, which is always resident
+    while (level < wanted && (w > VT_TILE_SIZE || h > VT_TILE_SIZE)) {
+        firstTile += virtualTilesOf(w) * virtualTilesOf(h);
+        w = max(w / 2u, 1u);
+        h = max(h / 2u, 1u);
+        ++level;
+    }
+
+    uv = fract(uv);
+    bool requested = false;
+    while (true) {
+        vec2 texel = uv * vec2(w, h);
+        uvec2 t0 = min(uvec2(floor(texel)), uvec2(w - 1u, h - 1u));
+        uvec2 tile = t0 / VT_TILE_SIZE;
+        uint entry = firstTile + tile.y * virtualTilesOf(w) + tile.x;
+
+        // Only the wanted tile is requested; the levels below are fallbacks
+        if (!requested) {
+            uint bit = 1u << (entry & 31u);
+            if ((tileFeedback[entry >> 5u] & bit) == 0u) {
+                atomicOr(tileFeedback[entry >> 5u], bit);
+            }
+            requested = true;
+        }
+
+        uint page = pageTable[entry];
+        if (page != 0u) {
+            uvec2 local = t0 - tile * VT_TILE_SIZE;
+            uint base = (page - 1u) * VT_PAGE_TEXELS + local.y * VT_PAGE_SIDE + local.x;
+            vec2 f = fract(texel);
+            vec4 c00 = unpackUnorm4x8(pageData[base]);
+            vec4 c10 = unpackUnorm4x8(pageData[base + 1u]);
+            vec4 c01 = unpackUnorm4x8(pageData[base + VT_PAGE_SIDE]);
+            vec4 c11 = unpackUnorm4x8(pageData[base + VT_PAGE_SIDE + 1u]);
+            return mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y).rgb;
+        }
+        if (w <= VT_TILE_SIZE && h <= VT_TILE_SIZE) return vec3(1.0);  // Not reached: pinned
+        firstTile += virtualTilesOf(w) * virtualTilesOf(h);
+        w = max(w / 2u, 1u);
+        h = max(h / 2u, 1u);
+    }
+    return vec3(1.0);
+}
+
+// Sample texture by index, using texture info for offset and dimensions. uvFootprint is the
+// width of the ray cone in UV units; only sampled images and virtual textures have mips to
+// pick with it.
+vec3 sampleTextureByIndex(vec2 uv, int texIndex, float uvFootprint) {
+    if (texIndex < 0) return vec3(1.0);  // No texture, return white
+
+    TextureInfo info = textureInfos[texIndex];
+    if (info.width == 0 || info.height == 0) return vec3(1.0);
+
+    if (info.format == TEXTURE_SAMPLED) {
+        float lod = log2(max(uvFootprint * sqrt(float(info.width) * float(info.height)), 1e-6));
+        return textureLod(sampledTextures[nonuniformEXT(info.offset)], uv, lod).rgb;
+    }
+    if (info.format == TEXTURE_VIRTUAL) {
+        return sampleVirtualTexture(info, uv, uvFootprint);
+    }
+
+    uv = fract(uv);
+    float fx = uv.x * float(info.width);
+    float fy = uv.y * float(info.height);
+    int x0 = int(floor(fx)), y0 = int(floor(fy));
+    int x1 = (x0 + 1) % int(info.width);
+    int y1 = (y0 + 1) % int(info.height);
+    float fracX = fract(fx), fracY = fract(fy);
+    int w = int(info.width);
+
+    vec4 c00 = fetchTexel(info, uint(y0 * w + x0));
+    vec4 c10 = fetchTexel(info, uint(y0 * w + x1));
+    vec4 c01 = fetchTexel(info, uint(y1 * w + x0));
+    vec4 c11 = fetchTexel(info, uint(y1 * w + x1));
+
+    return mix(mix(c00, c10, fracX), mix(c01, c11, fracX), fracY).rgb;
+}
+
+// Legacy function for backwards compatibility (uses first texture)
+vec3 sampleTexture(vec2 uv) {
+    return sampleTextureByIndex(uv, 0, 0.0);
+}
+
+// ==================== PBR Functions ====================
+
+float distributionGGX(vec3 N, vec3 H, float roughness) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float NdotH = max(dot(N, H), 0.0);
+    float denom = NdotH * NdotH * (a2 - 1.0) + 1.0;
+    return a2 / max(PI * denom * denom, EPSILON);
+}
+
+float geometrySchlickGGX(float NdotV, float roughness) {
+    float r = roughness + 1.0;
+    float k = (r * r) / 8.0;
+    return NdotV / (NdotV * (1.0 - k) + k);
+}
+
+float geometrySmith(vec3 N, vec3 V, vec3 L, float roughness) {
+    return geometrySchlickGGX(max(dot(N, V), 0.0), roughness)
+         * geometrySchlickGGX(max(dot(N, L), 0.0), roughness);
+}
+
+vec3 fresnelSchlick(float cosTheta, vec3 F0) {
+    return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+// ==================== Shading Functions ====================
+
+// Lambert diffuse lighting
+vec3 shadeLambert(vec3 position, vec3 N, vec3 albedo, int skipInstance) {
+    vec3 result = vec3(0.0);
+    for (uint i = 0; i < pc.lightCount; i++) {
+        LightSample ls = evaluateLight(lights[i], position);
+        float NdotL = dot(N, ls.direction);
+        if (NdotL <= 0.0) continue;
+        if (isInShadow(position, N, ls.direction, ls.maxDist, skipInstance)) continue;
+        result += (albedo / PI) * ls.color * ls.attenuation * NdotL;
+    }
+    return result;
+}
+
+// Blinn-Phong lighting
+vec3 shadePhong(vec3 position, vec3 N, vec3 albedo, float shininess, vec3 V, int skipInstance) {
+    vec3 result = vec3(0.0);
+    for (uint i = 0; i < pc.lightCount; i++) {
+        LightSample ls = evaluateLight(lights[i], position);
+        float NdotL = dot(N, ls.direction);
+        if (NdotL <= 0.0) continue;
+
+        vec3 diffuse = albedo * NdotL;
+        vec3 H = normalize(ls.direction + V);
+        vec3 specular = vec3(0.5) * pow(max(dot(N, H), 0.0), shininess);
+
+        result += (diffuse + specular) * ls.color * ls.attenuation;
+    }
+    return result;
+}
+
+// PBR Cook-Torrance lighting
+vec3 shadePBR(vec3 position, vec3 N, vec3 albedo, float metallic, float roughness, vec3 V, int skipInstance) {
+    vec3 F0 = mix(vec3(0.04), albedo, metallic);
+    vec3 result = vec3(0.0);
+
+    for (uint i = 0; i < pc.lightCount; i++) {
+        LightSample ls = evaluateLight(lights[i], position);
+        float NdotL = max(dot(N, ls.direction), 0.0);
+        if (NdotL <= 0.0) continue;
+        if (isInShadow(position, N, ls.direction, ls.maxDist, skipInstance)) continue;
+
+        vec3 H = normalize(V + ls.direction);
+        float D = distributionGGX(N, H, roughness);
+        float G = geometrySmith(N, V, ls.direction, roughness);
+        vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+
+        vec3 specular = (D * G * F) / max(4.0 * max(dot(N, V), 0.0) * NdotL, EPSILON);
+        vec3 kD = (1.0 - F) * (1.0 - metallic);
+        vec3 radiance = ls.color * ls.attenuation;
+
+        result += (kD * albedo / PI + specular) * radiance * NdotL;
+    }
+    return result;
+}
+
+// ==================== Surface Properties ====================
+
+// uvFootprint: ray cone width at the hit in UV units (see tracePath)
+SurfaceInfo getSurfaceInfo(HitInfo hit, float uvFootprint) {
+    SurfaceInfo surf;
+    surf.albedo = vec3(1.0);
+    surf.metallic = 0.0;
+    surf.roughness = 0.5;
+    surf.reflectivity = 0.0;
+    surf.shadingMode = SHADING_PBR;
+    surf.skipInstance = -1;
+
+    if (hit.primitiveType == PRIMITIVE_SPHERE) {
+        Sphere s = spheres[hit.materialIndex];
+        surf.albedo = vec3(s.color_r, s.color_g, s.color_b);
+        surf.roughness = 1.0 - (s.shininess / 128.0);
+        surf.metallic = s.reflectivity;
+        surf.reflectivity = s.reflectivity;
+        surf.shadingMode = s.shadingMode;
+    } else if (hit.primitiveType == PRIMITIVE_PLANE) {
+        Plane p = planes[hit.materialIndex];
+        surf.albedo = vec3(p.color_r, p.color_g, p.color_b);
+        surf.roughness = 0.8;
+        surf.metallic = p.reflectivity * 0.5;
+        surf.reflectivity = p.reflectivity;
+        surf.shadingMode = p.shadingMode;
+    } else {
+        // Triangle mesh
+        surf.skipInstance = int(hit.instanceIndex);
+        if (hit.materialIndex < pc.materialCount) {
+            Material mat = materials[hit.materialIndex];
+            vec3 texColor = sampleTextureByIndex(hit.uv, mat.diffuseTextureIndex, uvFootprint);
+            vec3 matDiffuse = vec3(mat.diffuse_r, mat.diffuse_g, mat.diffuse_b);
+            surf.albedo = texColor * matDiffuse;
+            surf.roughness = 1.0 - (mat.shininess / 128.0);
+            surf.reflectivity = 0.1;
+            surf.shadingMode = mat.shadingMode;
+        } else {
+            surf.albedo = sampleTextureByIndex(hit.uv, 0, uvFootprint);  // Fallback to first texture
+            surf.reflectivity = 0.1;
+        }
+    }
+    return surf;
+}
+
+// Compute direct lighting using appropriate shading model
+vec3 computeDirectLighting(HitInfo hit, SurfaceInfo surf, vec3 viewDir) {
+    if (surf.shadingMode == SHADING_FLAT) return surf.albedo;
+    if (pc.lightCount == 0) {
+        // Fallback simple directional
+        vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
+        return surf.albedo * max(dot(hit.normal, lightDir), 0.0);
+    }
+
+    vec3 V = -viewDir;
+    if (surf.shadingMode == SHADING_LAMBERT) {
+        return shadeLambert(hit.position, hit.normal, surf.albedo, surf.skipInstance);
+    } else if (surf.shadingMode == SHADING_PHONG) {
+        return shadePhong(hit.position, hit.normal, surf.albedo, 32.0, V, surf.skipInstance);
+    } else {
+        return shadePBR(hit.position, hit.normal, surf.albedo, surf.metallic, surf.roughness, V, surf.skipInstance);
+    }
+}
+
+// Sky color gradient
+vec3 getSkyColor(vec3 direction) {
+    float t = clamp(0.5 * (direction.y + 1.0), 0.0, 1.0);
+    return mix(vec3(1.0), vec3(0.5, 0.7, 1.0), t);
+}
+
+// ==================== Path Tracing ====================
+
+// Multi-bounce radiance along a camera ray. The primary hit and its albedo are
+// returned so kernels can write auxiliary outputs without re-tracing.
+// The ray carries a cone of pixelSpread radians (see pixelSpreadAngle) whose width at each hit
+// picks the texture mip. Mirror bounces keep the spread, so the cone keeps widening along
+// the path and reflections sample smaller mips.
+vec3 tracePath(Ray ray, float pixelSpread, out HitInfo primaryHit, out vec3 primaryAlbedo) {
+    vec3 accumulatedColor = vec3(0.0);
+    vec3 throughput = vec3(1.0);
+    uint maxBounces = max(pc.maxBounces, 1u);
+    float coneWidth = 0.0;
+    primaryAlbedo = vec3(0.0);
+
+    for (uint bounce = 0; bounce < maxBounces; bounce++) {
+        HitInfo hit = traceScene(ray);
+        if (bounce == 0) primaryHit = hit;
+
+        if (!hit.hit) {
+            accumulatedColor += throughput * getSkyColor(ray.direction);
+            break;
+        }
+
+        // Footprint on the surface grows as the cone meets it at a grazing angle
+        coneWidth += pixelSpread * hit.t;
+        float cosIncidence = max(abs(dot(hit.normal, ray.direction)), 0.05);
+        SurfaceInfo surf = getSurfaceInfo(hit, coneWidth * hit.uvPerWorld / cosIncidence);
+        if (bounce == 0) primaryAlbedo = surf.albedo;
+        vec3 ambient = 0.03 * surf.albedo;
+        vec3 directLight = computeDirectLighting(hit, surf, ray.direction);
+        accumulatedColor += throughput * (ambient + directLight);
+
+        // Continue only if reflective enough
+        if (surf.reflectivity < 0.01) break;
+
+        // Setup reflection ray
+        ray.origin = hit.position + hit.normal * SHADOW_BIAS;
+        ray.direction = normalize(reflect(ray.direction, hit.normal));
+
+        // Attenuate throughput
+        vec3 reflectColor = mix(vec3(1.0), surf.albedo, surf.metallic);
+        throughput *= surf.reflectivity * reflectColor;
+
+        if (max(max(throughput.r, throughput.g), throughput.b) < 0.01) break;
+    }
+
+    return accumulatedColor;
+}
+
+#endif // SHADING_GLSL
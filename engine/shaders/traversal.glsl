@@ -0,0 +1,307 @@
+// Scene traversal - BVH and primitive queries shared by compute kernels
+// The including shader must declare a push constant block named `pc` that
+// provides triangleCount, sphereCount, planeCount, instanceCount and planeTileScale
+
+#ifndef TRAVERSAL_GLSL
+#define TRAVERSAL_GLSL
+
+// Scene buffers (descriptor set 0, shared with the raytracer pipeline)
+layout (binding = 1) readonly buffer VertexBuffer { uint vertexWords[]; };
+layout (binding = 2) readonly buffer IndexBuffer { Triangle triangles[]; };
+layout (binding = 3) readonly buffer SphereBuffer { Sphere spheres[]; };
+layout (binding = 4) readonly buffer PlaneBuffer { Plane planes[]; };
+layout (binding = 7) readonly buffer BVHNodeBuffer { BVHNode bvhNodes[]; };
+layout (binding = 8) readonly buffer BVHTriIdxBuffer { uint bvhTriIndices[]; };
+layout (binding = 10) readonly buffer InstanceBuffer { MeshInstance instances[]; };
+layout (binding = 11) readonly buffer MeshInfoBuffer { MeshInfo meshInfos[]; };
+
+// Set by VulkanRenderer::EnableCompactVertices - selects the vertex buffer layout
+layout (constant_id = 2) const bool COMPACT_VERTICES = false;
+
+// ==================== Vertex Access ====================
+
+const uint VERTEX_STRIDE = COMPACT_VERTICES ? 4u : 8u;  // In 32-bit words
+
+// Inverse of VertexPacking::PackOctahedral
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+    return normalize(n);
+}
+
+// Object-space position; meshId selects the dequantization for compact vertices
+vec3 getVertexPosition(uint vertexIndex, uint meshId) {
+    uint base = vertexIndex * VERTEX_STRIDE;
+    if (COMPACT_VERTICES) {
+        uint xy = vertexWords[base];
+        vec3 q = vec3(float(xy & 0xFFFFu), float(xy >> 16), float(vertexWords[base + 1] & 0xFFFFu));
+        return meshInfos[meshId].quantOrigin + q * meshInfos[meshId].quantScale;
+    }
+    return uintBitsToFloat(uvec3(vertexWords[base], vertexWords[base + 1], vertexWords[base + 2]));
+}
+
+vec3 getVertexNormal(uint vertexIndex) {
+    uint base = vertexIndex * VERTEX_STRIDE;
+    if (COMPACT_VERTICES) {
+        return octDecode(unpackSnorm2x16(vertexWords[base + 2]));
+    }
+    return uintBitsToFloat(uvec3(vertexWords[base + 4], vertexWords[base + 5], vertexWords[base + 6]));
+}
+
+vec2 getVertexTexCoord(uint vertexIndex) {
+    uint base = vertexIndex * VERTEX_STRIDE;
+    if (COMPACT_VERTICES) {
+        return unpackHalf2x16(vertexWords[base + 3]);
+    }
+    return uintBitsToFloat(uvec2(vertexWords[base + 3], vertexWords[base + 7]));
+}
+
+// UV units per unit of length across a triangle: sqrt of the UV area over the surface area
+float uvDensity(vec3 v0, vec3 v1, vec3 v2, vec2 uv0, vec2 uv1, vec2 uv2) {
+    vec2 du = uv1 - uv0;
+    vec2 dv = uv2 - uv0;
+    float uvArea = abs(du.x * dv.y - dv.x * du.y);
+    float area = length(cross(v1 - v0, v2 - v0));
+    return sqrt(uvArea / max(area, 1e-12));
+}
+
+// ==================== BVH Traversal (Unified) ====================
+
+// Transform ray to object space - returns scale factor for t conversion
+// localT * dirScale = worldT (approximately, for uniform scale)
+float transformRayToObjectSpace(Ray worldRay, mat3x4 invTransform, out Ray localRay) {
+    localRay.origin = vec4(worldRay.origin, 1.0) * invTransform;
+    vec3 localDir = vec4(worldRay.direction, 0.0) * invTransform;
+    float dirScale = length(localDir);  // How much the direction got scaled
+    localRay.direction = localDir / dirScale;  // Normalize for intersection tests
+    return dirScale;  // Multiply local t by this to get world t
+}
+
+// BVH traversal - finds closest hit and fills in HitInfo
+// worldRay: the untransformed ray, used to place the hit point in world space
+// dirScale: factor to convert local t to world t (local_t / dirScale = world_t)
+// meshId: which mesh's BVH to traverse (used to get root node offset)
+// Returns true if any triangle was hit
+bool traverseBVH(Ray worldRay, Ray localRay, float dirScale, inout HitInfo hit, uint instIdx, mat3x4 invTransform, uint meshId) {
+    bool anyHit = false;
+    int stack[32];
+    int stackPtr = 0;
+    // Start at the root node for this mesh
+    int rootNode = int(meshInfos[meshId].bvhNodeOffset);
+    stack[stackPtr++] = rootNode;
+
+    // Convert world-space t threshold to local-space for comparisons
+    float localMaxT = hit.t * dirScale;
+
+    while (stackPtr > 0) {
+        int nodeIdx = stack[--stackPtr];
+        BVHNode node = bvhNodes[nodeIdx];
+
+        if (!intersectAABB(localRay, node.minBounds, node.maxBounds, localMaxT)) continue;
+
+        if (node.triCount > 0) {
+            // Leaf node
+            for (int i = 0; i < node.triCount; i++) {
+                uint triIdx = bvhTriIndices[node.leftFirst + i];
+                Triangle tri = triangles[triIdx];
+                vec3 v0 = getVertexPosition(tri.indices[0], meshId);
+                vec3 v1 = getVertexPosition(tri.indices[1], meshId);
+                vec3 v2 = getVertexPosition(tri.indices[2], meshId);
+
+                float t = localMaxT;
+                vec3 bary;
+                if (intersectTriangle(localRay, v0, v1, v2, t, bary)) {
+                    anyHit = true;
+                    localMaxT = t;  // Update local threshold
+                    hit.hit = true;
+                    hit.t = t / dirScale;  // Convert back to world-space t
+                    hit.position = worldRay.origin + hit.t * worldRay.direction;
+
+                    vec3 n0 = getVertexNormal(tri.indices[0]);
+                    vec3 n1 = getVertexNormal(tri.indices[1]);
+                    vec3 n2 = getVertexNormal(tri.indices[2]);
+                    vec3 localNormal = normalize(bary.x * n0 + bary.y * n1 + bary.z * n2);
+
+                    // Ensure normal faces toward the incoming ray (double-sided rendering)
+                    // This handles meshes with inconsistent winding or inward-facing normals
+                    if (dot(localNormal, localRay.direction) > 0.0) {
+                        localNormal = -localNormal;
+                    }
+
+                    // Inverse transpose of the object-to-world transform
+                    hit.normal = normalize((invTransform * localNormal).xyz);
+
+                    vec2 uv0 = getVertexTexCoord(tri.indices[0]);
+                    vec2 uv1 = getVertexTexCoord(tri.indices[1]);
+                    vec2 uv2 = getVertexTexCoord(tri.indices[2]);
+                    hit.uv = bary.x * uv0 + bary.y * uv1 + bary.z * uv2;
+                    // Local lengths are dirScale times world lengths
+                    hit.uvPerWorld = uvDensity(v0, v1, v2, uv0, uv1, uv2) * dirScale;
+
+                    hit.primitiveType = PRIMITIVE_TRIANGLE;
+                    hit.triangleIndex = triIdx;
+                    hit.materialIndex = tri.materialIndex;
+                    hit.instanceIndex = instIdx;
+                }
+            }
+        } else if (stackPtr < 31) {
+            stack[stackPtr++] = node.leftFirst + 1;
+            stack[stackPtr++] = node.leftFirst;
+        }
+    }
+    return anyHit;
+}
+
+// BVH any-hit query - returns true as soon as any intersection is found (for shadows)
+// meshId: which mesh's BVH to traverse (used to get root node offset)
+bool traverseBVHAnyHit(Ray localRay, float maxDist, uint meshId) {
+    int stack[16];
+    int stackPtr = 0;
+    // Start at the root node for this mesh
+    int rootNode = int(meshInfos[meshId].bvhNodeOffset);
+    stack[stackPtr++] = rootNode;
+
+    while (stackPtr > 0) {
+        int nodeIdx = stack[--stackPtr];
+        BVHNode node = bvhNodes[nodeIdx];
+
+        if (!intersectAABB(localRay, node.minBounds, node.maxBounds, maxDist)) continue;
+
+        if (node.triCount > 0) {
+            for (int i = 0; i < node.triCount; i++) {
+                uint triIdx = bvhTriIndices[node.leftFirst + i];
+                Triangle tri = triangles[triIdx];
+                vec3 v0 = getVertexPosition(tri.indices[0], meshId);
+                vec3 v1 = getVertexPosition(tri.indices[1], meshId);
+                vec3 v2 = getVertexPosition(tri.indices[2], meshId);
+
+                float t = maxDist;
+                vec3 bary;
+                if (intersectTriangle(localRay, v0, v1, v2, t, bary)) {
+                    return true;  // Early exit on any hit
+                }
+            }
+        } else if (stackPtr < 15) {
+            stack[stackPtr++] = node.leftFirst + 1;
+            stack[stackPtr++] = node.leftFirst;
+        }
+    }
+    return false;
+}
+
+// ==================== Scene Tracing ====================
+
+// Full scene trace - finds closest hit across all primitives
+HitInfo traceScene(Ray ray) {
+    HitInfo hit;
+    hit.hit = false;
+    hit.t = MAX_DIST;
+    hit.uvPerWorld = 0.0;
+    hit.instanceIndex = 0;
+
+    // Spheres
+    for (uint i = 0; i < pc.sphereCount; i++) {
+        Sphere s = spheres[i];
+        vec3 center = vec3(s.center_x, s.center_y, s.center_z);
+        float t = hit.t;
+        if (intersectSphere(ray, center, s.radius, t)) {
+            hit.hit = true;
+            hit.t = t;
+            hit.position = ray.origin + t * ray.direction;
+            hit.normal = normalize(hit.position - center);
+            hit.primitiveType = PRIMITIVE_SPHERE;
+            hit.materialIndex = i;
+        }
+    }
+
+    // Planes
+    for (uint i = 0; i < pc.planeCount; i++) {
+        Plane p = planes[i];
+        vec3 normal = vec3(p.normal_x, p.normal_y, p.normal_z);
+        float t = hit.t;
+        if (intersectPlane(ray, normal, p.distance, t)) {
+            hit.hit = true;
+            hit.t = t;
+            hit.position = ray.origin + t * ray.direction;
+            hit.normal = normal;
+            hit.primitiveType = PRIMITIVE_PLANE;
+            hit.materialIndex = i;
+            hit.uv = computePlaneUV(hit.position, normal, pc.planeTileScale);
+        }
+    }
+
+    // Mesh instances with BVH
+    for (uint instIdx = 0; instIdx < pc.instanceCount; instIdx++) {
+        MeshInstance inst = instances[instIdx];
+        if (inst.visible == 0) continue;
+        Ray localRay;
+        float dirScale = transformRayToObjectSpace(ray, inst.invTransform, localRay);
+        traverseBVH(ray, localRay, dirScale, hit, instIdx, inst.invTransform, inst.meshId);
+    }
+
+    // Fallback: direct triangle testing if the scene has no instances (triangleCount is 0
+    // when it has some but culling removed them all). It only covers the first mesh, whose
+    // triangles start the packed array, so its quantization is meshInfos[0]'s
+    if (pc.instanceCount == 0) {
+        for (uint i = 0; i < pc.triangleCount; i++) {
+            Triangle tri = triangles[i];
+            const uint meshId = 0u;
+            vec3 v0 = getVertexPosition(tri.indices[0], meshId);
+            vec3 v1 = getVertexPosition(tri.indices[1], meshId);
+            vec3 v2 = getVertexPosition(tri.indices[2], meshId);
+
+            float t = hit.t;
+            vec3 bary;
+            if (intersectTriangle(ray, v0, v1, v2, t, bary)) {
+                hit.hit = true;
+                hit.t = t;
+                hit.position = ray.origin + t * ray.direction;
+                vec3 n0 = getVertexNormal(tri.indices[0]);
+                vec3 n1 = getVertexNormal(tri.indices[1]);
+                vec3 n2 = getVertexNormal(tri.indices[2]);
+                hit.normal = normalize(bary.x * n0 + bary.y * n1 + bary.z * n2);
+                vec2 uv0 = getVertexTexCoord(tri.indices[0]);
+                vec2 uv1 = getVertexTexCoord(tri.indices[1]);
+                vec2 uv2 = getVertexTexCoord(tri.indices[2]);
+                hit.uv = bary.x * uv0 + bary.y * uv1 + bary.z * uv2;
+                hit.uvPerWorld = uvDensity(v0, v1, v2, uv0, uv1, uv2);
+                hit.primitiveType = PRIMITIVE_TRIANGLE;
+                hit.triangleIndex = i;
+                hit.materialIndex = tri.materialIndex;
+            }
+        }
+    }
+
+    return hit;
+}
+
+// Any-hit scene query - true if a sphere or visible mesh instance blocks the ray before maxDist
+// Planes are not tested (ground planes would otherwise occlude everything below the horizon)
+// skipInstance: instance index to ignore (-1 to test all)
+// shadowProxies: trace each mesh's shadow proxy (MeshInfo::shadowMeshId) instead of the mesh
+bool traceAnyHit(Ray ray, float maxDist, int skipInstance, bool shadowProxies) {
+    // Test spheres
+    for (uint i = 0; i < pc.sphereCount; i++) {
+        Sphere s = spheres[i];
+        vec3 center = vec3(s.center_x, s.center_y, s.center_z);
+        float t = maxDist;
+        if (intersectSphere(ray, center, s.radius, t)) return true;
+    }
+
+    // Test mesh instances using unified BVH any-hit
+    for (uint instIdx = 0; instIdx < pc.instanceCount; instIdx++) {
+        if (int(instIdx) == skipInstance) continue;
+        MeshInstance inst = instances[instIdx];
+        if (inst.visible == 0) continue;
+        Ray localRay;
+        float dirScale = transformRayToObjectSpace(ray, inst.invTransform, localRay);
+        // Convert world maxDist to local space for comparison
+        uint meshId = shadowProxies ? meshInfos[inst.meshId].shadowMeshId : inst.meshId;
+        if (traverseBVHAnyHit(localRay, maxDist * dirScale, meshId)) return true;
+    }
+
+    return false;
+}
+
+#endif // TRAVERSAL_GLSL
@@ -0,0 +1,287 @@
+#include "Animation.h"
+#include "detail/Simd8.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr uint32_t kMotorFloats = 8;
+
+template <typename Key>
+void validateKeys(std::span<const Key> keys, const char* kind) {
+    if (keys.empty()) {
+        throw std::invalid_argument(std::string(kind) + " track needs at least one key");
+    }
+    for (size_t i = 1; i < keys.size(); ++i) {
+        if (!(keys[i].time > keys[i - 1].time)) {
+            throw std::invalid_argument(std::string(kind) + " track key " + std::to_string(i) +
+                                        " is not later than the key before it");
+        }
+    }
+}
+
+// Blend of two keys, normalized: the rotor part scaled to unit length and the dual part made
+// orthogonal to it (removing the one direction that does not move points, as in
+// GPUMeshInstance::FromMotor). Components in m_motorKeys order.
+void blendMotor(const float* a, const float* b, float weight, float* out) noexcept {
+    float c[kMotorFloats];
+    for (uint32_t k = 0; k < kMotorFloats; ++k) {
+        c[k] = a[k] + weight * (b[k] - a[k]);
+    }
+    const float rotorNorm2 = c[0] * c[0] + c[4] * c[4] + c[5] * c[5] + c[6] * c[6];
+    const float inv = 1.0f / std::sqrt(rotorNorm2);
+    const float dual = (c[7] * c[0] - (c[1] * c[4] + c[2] * c[5] + c[3] * c[6])) / rotorNorm2;
+    out[0] = c[0] * inv;
+    out[1] = (c[1] + c[4] * dual) * inv;
+    out[2] = (c[2] + c[5] * dual) * inv;
+    out[3] = (c[3] + c[6] * dual) * inv;
+    out[4] = c[4] * inv;
+    out[5] = c[5] * inv;
+    out[6] = c[6] * inv;
+    out[7] = (c[7] - c[0] * dual) * inv;
+}
+
+Motor toMotor(const float* c) noexcept {
+    return Motor(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]);
+}
+
+#if defined(__AVX2__)
+// blendMotor for tracks [first, first + 8): each track's two keys are blended as one row, then
+// the rows are transposed so the normalization runs one track per lane
+void blendMotors8(const float* keys, const uint32_t* from, const float* weights, size_t first, Motor* out) noexcept {
+    __m256 c[kMotorFloats];
+    for (int k = 0; k < 8; ++k) {
+        const float* key = keys + size_t{from[first + k]} * kMotorFloats;
+        const __m256 a = _mm256_loadu_ps(key);
+        const __m256 b = _mm256_loadu_ps(key + kMotorFloats);
+        c[k] = _mm256_add_ps(a, _mm256_mul_ps(_mm256_set1_ps(weights[first + k]), _mm256_sub_ps(b, a)));
+    }
+    Simd8::Transpose8x8(c);
+
+    auto mul = [](__m256 a, __m256 b) { return _mm256_mul_ps(a, b); };
+    auto add = [](__m256 a, __m256 b) { return _mm256_add_ps(a, b); };
+    auto sub = [](__m256 a, __m256 b) { return _mm256_sub_ps(a, b); };
+
+    const __m256 rotorNorm2 = add(add(add(mul(c[0], c[0]), mul(c[4], c[4])), mul(c[5], c[5])), mul(c[6], c[6]));
+    const __m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(rotorNorm2));
+    const __m256 dual = _mm256_div_ps(
+        sub(mul(c[7], c[0]), add(add(mul(c[1], c[4]), mul(c[2], c[5])), mul(c[3], c[6]))), rotorNorm2);
+
+    alignas(32) float lanes[kMotorFloats][8];
+    _mm256_store_ps(lanes[0], mul(c[0], inv));
+    _mm256_store_ps(lanes[1], mul(add(c[1], mul(c[4], dual)), inv));
+    _mm256_store_ps(lanes[2], mul(add(c[2], mul(c[5], dual)), inv));
+    _mm256_store_ps(lanes[3], mul(add(c[3], mul(c[6], dual)), inv));
+    _mm256_store_ps(lanes[4], mul(c[4], inv));
+    _mm256_store_ps(lanes[5], mul(c[5], inv));
+    _mm256_store_ps(lanes[6], mul(c[6], inv));
+    _mm256_store_ps(lanes[7], mul(sub(c[7], mul(c[0], dual)), inv));
+
+    // Written through the constructor, as FlyFish's storage order is not assumed
+    for (int k = 0; k < 8; ++k) {
+        out[first + k] = Motor(lanes[0][k], lanes[1][k], lanes[2][k], lanes[3][k],
+                               lanes[4][k], lanes[5][k], lanes[6][k], lanes[7][k]);
+    }
+}
+#endif
+
+} // namespace
+
+// === Track clocks ===
+
+void AnimationTracks::TrackClocks::Add(std::span<const float> times, AnimationWrap wrap, float timeOffset) {
+    const auto first = static_cast<uint32_t>(keyTimes.size());
+    keyTimes.insert(keyTimes.end(), times.begin(), times.end());
+    if (times.size() == 1) {
+        keyTimes.push_back(times.front() + 1.0f);
+    }
+    const auto last = static_cast<uint32_t>(keyTimes.size() - 1);
+    for (uint32_t k = first; k < last; ++k) {
+        keyInvSpan.push_back(1.0f / (keyTimes[k + 1] - keyTimes[k]));
+    }
+    keyInvSpan.push_back(0.0f);
+
+    const float trackLength = times.back() - times.front();
+    offset.push_back(timeOffset);
+    start.push_back(times.front());
+    end.push_back(times.back());
+    length.push_back(trackLength);
+    invLength.push_back(wrap == AnimationWrap::Loop && trackLength > 0.0f ? 1.0f / trackLength : 0.0f);
+    firstKey.push_back(first);
+    lastKey.push_back(last);
+    cursor.push_back(first);
+    from.push_back(first);
+    weight.push_back(0.0f);
+}
+
+void AnimationTracks::TrackClocks::Clear() {
+    *this = TrackClocks{};
+}
+
+float AnimationTracks::TrackClocks::wrap(size_t track, float time) const noexcept {
+    const float u = time + offset[track] - start[track];
+    const float t = start[track] + (u - std::floor(u * invLength[track]) * length[track]);
+    return std::clamp(t, start[track], end[track]);
+}
+
+void AnimationTracks::TrackClocks::relocate(size_t track, float t) noexcept {
+    // Usually the clock has moved on to the next segment; anything else (a loop wrapping
+    // round, a seek) is a binary search over the track's segment starts
+    uint32_t k = cursor[track];
+    if (k + 1 < lastKey[track] && t >= keyTimes[k + 1] && t <= keyTimes[k + 2]) {
+        ++k;
+    } else {
+        const float* keys = keyTimes.data();
+        k = static_cast<uint32_t>(std::upper_bound(keys + firstKey[track], keys + lastKey[track], t) - keys);
+        k = std::max(k, firstKey[track] + 1) - 1;
+    }
+    cursor[track] = k;
+}
+
+void AnimationTracks::TrackClocks::locateOne(size_t track, float time) noexcept {
+    const float t = wrap(track, time);
+    if (!(t >= keyTimes[cursor[track]] && t <= keyTimes[cursor[track] + 1])) {
+        relocate(track, t);
+    }
+    const uint32_t k = cursor[track];
+    from[track] = k;
+    weight[track] = std::clamp((t - keyTimes[k]) * keyInvSpan[k], 0.0f, 1.0f);
+}
+
+void AnimationTracks::TrackClocks::LocateScalar(float time) noexcept {
+    for (size_t i = 0; i < Size(); ++i) {
+        locateOne(i, time);
+    }
+}
+
+void AnimationTracks::TrackClocks::Locate(float time) noexcept {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 clock = _mm256_set1_ps(time);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= Size(); i += 8) {
+        // wrap(), eight tracks at once
+        const __m256 trackStart = _mm256_loadu_ps(start.data() + i);
+        const __m256 u = _mm256_sub_ps(_mm256_add_ps(clock, _mm256_loadu_ps(offset.data() + i)), trackStart);
+        const __m256 loops = _mm256_floor_ps(_mm256_mul_ps(u, _mm256_loadu_ps(invLength.data() + i)));
+        __m256 t = _mm256_add_ps(trackStart, _mm256_sub_ps(u, _mm256_mul_ps(loops, _mm256_loadu_ps(length.data() + i))));
+        t = _mm256_min_ps(_mm256_max_ps(t, trackStart), _mm256_loadu_ps(end.data() + i));
+
+        // Lanes that left their cursor's segment are moved on one at a time
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cursor.data() + i));
+        __m256 t0 = _mm256_i32gather_ps(keyTimes.data(), k, 4);
+        const __m256 t1 = _mm256_i32gather_ps(keyTimes.data() + 1, k, 4);
+        const int inside = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(t, t0, _CMP_GE_OQ), _mm256_cmp_ps(t, t1, _CMP_LE_OQ)));
+        if (inside != 0xFF) {
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, t);
+            for (int lane = 0; lane < 8; ++lane) {
+                if (!(inside & (1 << lane))) {
+                    relocate(i + lane, lanes[lane]);
+                }
+            }
+            k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cursor.data() + i));
+            t0 = _mm256_i32gather_ps(keyTimes.data(), k, 4);
+        }
+
+        const __m256 w = _mm256_mul_ps(_mm256_sub_ps(t, t0), _mm256_i32gather_ps(keyInvSpan.data(), k, 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(from.data() + i), k);
+        _mm256_storeu_ps(weight.data() + i, _mm256_min_ps(_mm256_max_ps(w, zero), one));
+    }
+#endif
+    for (; i < Size(); ++i) {
+        locateOne(i, time);
+    }
+}
+
+// === Tracks ===
+
+uint32_t AnimationTracks::AddMotorTrack(std::span<const MotorKey> keys, AnimationWrap wrap, float timeOffset) {
+    validateKeys(keys, "Motor");
+
+    m_keyTimes.clear();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const Motor& m = keys[i].motor;
+        float c[kMotorFloats] = {m.s(), m.e01(), m.e02(), m.e03(), m.e23(), m.e31(), m.e12(), m.e0123()};
+
+        // M and -M are the same transform; pick the sign nearer the previous key so the blend
+        // between them takes the short way round
+        if (i > 0) {
+            const float* prev = m_motorKeys.data() + m_motorKeys.size() - kMotorFloats;
+            if (prev[0] * c[0] + prev[4] * c[4] + prev[5] * c[5] + prev[6] * c[6] < 0.0f) {
+                for (float& component : c) {
+                    component = -component;
+                }
+            }
+        }
+        m_keyTimes.push_back(keys[i].time);
+        m_motorKeys.insert(m_motorKeys.end(), c, c + kMotorFloats);
+    }
+    if (keys.size() == 1) {
+        m_motorKeys.insert(m_motorKeys.end(), m_motorKeys.end() - kMotorFloats, m_motorKeys.end());
+    }
+    m_motorClocks.Add(m_keyTimes, wrap, timeOffset);
+    return static_cast<uint32_t>(m_motorClocks.Size() - 1);
+}
+
+uint32_t AnimationTracks::AddScalarTrack(std::span<const ScalarKey> keys, AnimationWrap wrap, float timeOffset) {
+    validateKeys(keys, "Scalar");
+
+    m_keyTimes.clear();
+    for (const ScalarKey& key : keys) {
+        m_keyTimes.push_back(key.time);
+        m_scalarKeys.push_back(key.value);
+    }
+    if (keys.size() == 1) {
+        m_scalarKeys.push_back(keys.front().value);
+    }
+    m_scalarClocks.Add(m_keyTimes, wrap, timeOffset);
+    return static_cast<uint32_t>(m_scalarClocks.Size() - 1);
+}
+
+void AnimationTracks::Clear() {
+    m_motorClocks.Clear();
+    m_motorKeys.clear();
+    m_scalarClocks.Clear();
+    m_scalarKeys.clear();
+}
+
+void AnimationTracks::EvaluateMotorsScalar(float time, std::vector<Motor>& out) {
+    m_motorClocks.LocateScalar(time);
+    out.resize(m_motorClocks.Size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        float c[kMotorFloats];
+        const float* a = m_motorKeys.data() + size_t{m_motorClocks.from[i]} * kMotorFloats;
+        blendMotor(a, a + kMotorFloats, m_motorClocks.weight[i], c);
+        out[i] = toMotor(c);
+    }
+}
+
+void AnimationTracks::EvaluateMotors(float time, std::vector<Motor>& out) {
+    m_motorClocks.Locate(time);
+    out.resize(m_motorClocks.Size());
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= out.size(); i += 8) {
+        blendMotors8(m_motorKeys.data(), m_motorClocks.from.data(), m_motorClocks.weight.data(), i, out.data());
+    }
+#endif
+    for (; i < out.size(); ++i) {
+        float c[kMotorFloats];
+        const float* a = m_motorKeys.data() + size_t{m_motorClocks.from[i]} * kMotorFloats;
+        blendMotor(a, a + kMotorFloats, m_motorClocks.weight[i], c);
+        out[i] = toMotor(c);
+    }
+}
+
+void AnimationTracks::EvaluateScalars(float time, std::vector<float>& out) {
+    m_scalarClocks.Locate(time);
+    out.resize(m_scalarClocks.Size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        const float a = m_scalarKeys[m_scalarClocks.from[i]];
+        out[i] = a + m_scalarClocks.weight[i] * (m_scalarKeys[m_scalarClocks.from[i] + 1] - a);
+    }
+}
@@ -6,9 +6,8 @@
 #include <vector>
 #include <stdexcept>
 #include <algorithm>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include <chrono>
+#include <utility>
 
 Application::Application(int width, int height, const std::string& title,
                          std::unique_ptr<GameScene> scene,
@@ -37,22 +36,53 @@ Application::Application(int width, int height, const std::string& title,
     // Initialize scene (scene loads its own meshes)
     m_gameScene->OnInit(m_renderer.get());
 
-    // Get scene data and mesh instances from the scene
-    m_sceneData = m_gameScene->GetSceneData();
-    m_meshInstances = m_gameScene->GetMeshInstances();
+    // First snapshot of the scene's render state
+    m_gameScene->PublishRenderSnapshot();
+    const RenderSnapshot& snapshot = m_gameScene->GetRenderSnapshot();
 
     // Update camera from scene
-    m_cameraEye = m_gameScene->GetCameraEye();
-    m_cameraTarget = m_gameScene->GetCameraTarget();
-    m_cameraUp = m_gameScene->GetCameraUp();
+    m_cameraEye = snapshot.cameraEye;
+    m_cameraTarget = snapshot.cameraTarget;
+    m_cameraUp = snapshot.cameraUp;
 
     // Upload meshes (includes materials and textures), scene data, instances to GPU
+    if (m_gameScene->IsCompactVerticesEnabled()) {
+        m_renderer->EnableCompactVertices();
+    }
+    if (m_gameScene->IsSampledTexturesEnabled()) {
+        m_renderer->EnableSampledTextures();
+    }
+    if (!m_gameScene->GetTextureCacheDirectory().empty()) {
+        m_renderer->SetTextureCacheDirectory(m_gameScene->GetTextureCacheDirectory());
+    }
+    if (m_gameScene->IsVirtualTexturesEnabled()) {
+        const uint32_t pages = m_gameScene->GetVirtualTexturePages();
+        m_renderer->EnableVirtualTextures(pages != 0 ? pages : VulkanRenderer::kDefaultVirtualTexturePages);
+    }
+    if (m_gameScene->IsShadowProxiesEnabled()) {
+        m_gameScene->BuildShadowProxies();
+        m_renderer->EnableShadowProxies(m_gameScene->GetShadowProxyTolerance());
+    }
     uploadMeshes(m_gameScene->GetMeshes());
-    m_renderer->UploadSceneData(m_sceneData);
-    m_renderer->UploadInstances(m_meshInstances);
+    m_renderer->UploadSceneData(m_gameScene->GetSceneData());
+    m_renderer->UploadInstances(snapshot.instances);
 
     // Note: Textures are now uploaded by UploadMeshes from mesh materials
 
+    // Object-ID buffer for GPU picking (compiled out of the shader unless the scene asks for it)
+    if (m_gameScene->IsPickingEnabled()) {
+        m_renderer->EnableObjectIds();
+    }
+    if (m_gameScene->IsAOVOutputEnabled()) {
+        m_renderer->EnableAOVs();
+    }
+    if (m_gameScene->IsVisibilityQueriesEnabled()) {
+        m_renderer->EnableVisibilityQueries();
+    }
+    if (m_gameScene->IsMultiViewEnabled()) {
+        m_renderer->EnableMultiView();
+    }
+
     // Create descriptor set and compute pipeline
     m_renderer->CreateDescriptorSet();
     m_renderer->CreateComputePipeline();
@@ -63,7 +93,7 @@ Application::~Application() noexcept {
 }
 
 void Application::setScene(const Scene::SceneData& scene) {
-    m_sceneData = scene;
+    m_gameScene->GetSceneData() = scene;
     // In a production app, you'd want to update buffers here
     // For now, scene is set at initialization
 }
@@ -76,6 +106,14 @@ void Application::setCamera(const TriVector& eye, const TriVector& target, const
 
 void Application::uploadMeshes(const std::vector<std::unique_ptr<Mesh>>& meshes) {
     m_renderer->UploadMeshes(meshes);
+
+    // Object-space boxes for instance culling (BVHs survive FreeMeshCPUData)
+    m_meshBounds.clear();
+    for (const auto& mesh : meshes) {
+        m_meshBounds.push_back(mesh && !mesh->BVHNodes().empty()
+                                   ? InstanceCulling::LocalBounds::FromBVHRoot(mesh->BVHNodes().front())
+                                   : InstanceCulling::LocalBounds{});
+    }
 }
 
 void Application::initSDL() {
@@ -92,6 +130,17 @@ void Application::initSDL() {
 
 
 void Application::run() {
+    if (m_frameLoop.renderThread) {
+        // These record and read back on the calling thread, which the render thread would not be
+        if (m_gameScene->IsAOVOutputEnabled() || m_gameScene->IsVisibilityQueriesEnabled() ||
+            m_gameScene->IsMultiViewEnabled()) {
+            throw std::runtime_error("The render thread cannot be used with a scene that enables AOV "
+                                     "output, visibility queries or multi-view rendering");
+        }
+        runThreaded();
+        return;
+    }
+
     m_running = true;
     Uint64 lastTime = SDL_GetPerformanceCounter();
     const Uint64 frequency = SDL_GetPerformanceFrequency();
@@ -111,7 +160,17 @@ void Application::run() {
             continue;
         }
 
-        update(deltaTime);
+        if (m_frameLoop.simulationRate > 0.0f) {
+            // Fixed steps; a hitch drops time beyond a quarter second instead of spiralling
+            const float step = 1.0f / m_frameLoop.simulationRate;
+            m_simulationAccumulator = std::min(m_simulationAccumulator + deltaTime, 0.25f);
+            while (m_simulationAccumulator >= step) {
+                update(step);
+                m_simulationAccumulator -= step;
+            }
+        } else {
+            update(deltaTime);
+        }
         render();
     }
 
@@ -119,6 +178,275 @@ void Application::run() {
     m_renderer->WaitIdle();
 }
 
+void Application::waitRendererIdle() {
+    // With a render thread only that thread records and submits (VulkanRenderer refuses the
+    // scene-facing readbacks from this one), so the wait rides along with the next queued frame
+    if (m_renderThread.joinable()) {
+        m_pendingWaitIdle = true;
+    } else {
+        m_renderer->WaitIdle();
+    }
+}
+
+namespace {
+
+// Deep copy of ImGui's output into buffers owned by a queued frame. ImGui reuses its own draw
+// lists on the next NewFrame, so the render thread cannot read them directly. Vectors keep
+// their capacity between laps of the queue.
+void copyDrawData(const ImDrawData& src, ImDrawData& dst, std::vector<std::unique_ptr<ImDrawList>>& lists) {
+    while (lists.size() < static_cast<size_t>(src.CmdListsCount)) {
+        lists.push_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+    }
+
+    auto copyVector = [](const auto& from, auto& to) {
+        to.resize(from.Size);
+        std::copy_n(from.Data, from.Size, to.Data);
+    };
+
+    dst.CmdLists.resize(src.CmdListsCount);
+    for (int i = 0; i < src.CmdListsCount; ++i) {
+        const ImDrawList& from = *src.CmdLists[i];
+        ImDrawList& to = *lists[static_cast<size_t>(i)];
+        copyVector(from.CmdBuffer, to.CmdBuffer);
+        copyVector(from.IdxBuffer, to.IdxBuffer);
+        copyVector(from.VtxBuffer, to.VtxBuffer);
+        to.Flags = from.Flags;
+        dst.CmdLists[i] = &to;
+    }
+    dst.Valid = src.Valid;
+    dst.CmdListsCount = src.CmdListsCount;
+    dst.TotalIdxCount = src.TotalIdxCount;
+    dst.TotalVtxCount = src.TotalVtxCount;
+    dst.DisplayPos = src.DisplayPos;
+    dst.DisplaySize = src.DisplaySize;
+    dst.FramebufferScale = src.FramebufferScale;
+    dst.OwnerViewport = src.OwnerViewport;
+}
+
+} // anonymous namespace
+
+void Application::runThreaded() {
+    m_frameQueue = std::make_unique<SpscQueue<QueuedFrame>>(std::max(m_frameLoop.queuedFrames, 1u));
+    m_pickQueue = std::make_unique<SpscQueue<PickResult>>(4);
+    m_renderThread = std::jthread([this] { renderThreadMain(); });
+
+    const bool fixedRate = m_frameLoop.simulationRate > 0.0f;
+    const auto tick = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(fixedRate ? 1.0 / m_frameLoop.simulationRate : 0.0));
+    auto nextTick = std::chrono::steady_clock::now();
+
+    m_running = true;
+    Uint64 lastTime = SDL_GetPerformanceCounter();
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    try {
+        while (m_running && !m_renderFailed.load(std::memory_order_acquire)) {
+            if (fixedRate) {
+                // Tick on a fixed schedule whatever the render thread is doing. After a hitch the
+                // schedule restarts from now instead of running catch-up ticks back to back.
+                std::this_thread::sleep_until(nextTick);
+                nextTick += tick;
+                const auto now = std::chrono::steady_clock::now();
+                if (now - nextTick > std::chrono::milliseconds(250)) {
+                    nextTick = now;
+                }
+            } else {
+                // Lockstep: wait for a free slot so the game thread is never more than
+                // queuedFrames ahead of what is on screen
+                m_frameQueue->WaitForSpace();
+            }
+
+            const Uint64 currentTime = SDL_GetPerformanceCounter();
+            const float deltaTime = fixedRate
+                ? 1.0f / m_frameLoop.simulationRate
+                : static_cast<float>(currentTime - lastTime) / static_cast<float>(frequency);
+            lastTime = currentTime;
+
+            handleEvents();
+            processInput(deltaTime);
+
+            if (m_windowMinimized) {
+                SDL_Delay(10);
+                continue;
+            }
+
+            update(deltaTime);
+            publishFrame();
+        }
+    } catch (...) {
+        stopRenderThread();
+        throw;
+    }
+
+    stopRenderThread();
+    m_renderer->WaitIdle();
+    if (m_renderError) {
+        std::rethrow_exception(m_renderError);
+    }
+}
+
+void Application::publishFrame() {
+    // The UI frame is built every tick, drawn or not, so ImGui keeps seeing input
+    updateCameraRotation();
+    m_renderer->BeginUiFrame();
+    buildUi();
+    ImGui::Render();
+
+    QueuedFrame* frame = m_frameQueue->TryBeginPush();
+    if (!frame) {
+        return;  // Render thread is behind: this tick is simulated but not drawn
+    }
+
+    frame->scene = m_gameScene->GetRenderSnapshot();  // Vector assignment reuses the slot's capacity
+    frame->scene.instancesChanged = std::exchange(m_instanceChanges, InstanceRange{});  // Including skipped ticks
+    frame->cameraRotation = m_cameraRotation;
+    frame->cameraPosition = {m_cameraEye.e032(), m_cameraEye.e013(), m_cameraEye.e021()};
+    frame->time = m_time;
+    frame->cameraFov = m_cameraFov;
+    frame->cameraAspect = static_cast<float>(m_width) / static_cast<float>(m_height);
+    frame->requestPick = m_renderer->ObjectIdsEnabled();
+    frame->pickX = m_lastMouseX;
+    frame->pickY = m_lastMouseY;
+    frame->waitIdle = std::exchange(m_pendingWaitIdle, false);
+    frame->quit = false;
+    copyDrawData(*ImGui::GetDrawData(), frame->ui, frame->uiLists);
+    m_frameQueue->EndPush();
+}
+
+void Application::stopRenderThread() {
+    if (!m_renderThread.joinable()) {
+        return;
+    }
+
+    // The render thread keeps consuming until it pops the quit frame, so a slot always frees up
+    m_frameQueue->WaitForSpace();
+    QueuedFrame* frame = m_frameQueue->TryBeginPush();
+    frame->quit = true;
+    m_frameQueue->EndPush();
+    m_renderThread.join();
+    m_renderer->BindToCurrentThread();  // Back to the game thread for the final WaitIdle
+}
+
+void Application::renderThreadMain() {
+    m_renderer->BindToCurrentThread();
+    bool failed = false;
+    while (true) {
+        m_frameQueue->WaitForItem();
+        QueuedFrame& frame = *m_frameQueue->Front();
+        const bool quit = frame.quit;
+
+        // After an error, frames are still popped (not drawn) so the game thread never blocks
+        if (!quit && !failed) {
+            try {
+                renderQueuedFrame(frame);
+                m_renderedFrames.fetch_add(1, std::memory_order_relaxed);
+            } catch (...) {
+                m_renderError = std::current_exception();
+                m_renderFailed.store(true, std::memory_order_release);
+                failed = true;
+            }
+        }
+
+        m_frameQueue->Pop();
+        if (quit) {
+            return;
+        }
+    }
+}
+
+void Application::renderQueuedFrame(QueuedFrame& frame) {
+    if (frame.waitIdle) {
+        m_renderer->WaitIdle();
+    }
+
+    // Changes from frames that never started still have to reach the device buffer
+    InstanceRange changed = frame.scene.instancesChanged;
+    changed.Merge(std::exchange(m_droppedInstanceChanges, InstanceRange{}));
+
+    m_renderer->AcquireFrame();
+    if (!m_renderer->FrameStarted()) {
+        m_droppedInstanceChanges = changed;
+        return;
+    }
+
+    if (frame.requestPick) {
+        PickResult pick;
+        if (m_renderer->GetPickResult(pick)) {
+            if (PickResult* slot = m_pickQueue->TryBeginPush()) {
+                *slot = pick;
+                m_pickQueue->EndPush();
+            }
+        }
+        m_renderer->RequestPick(frame.pickX, frame.pickY);
+    }
+
+    uploadInstances(frame.scene, changed, frame.cameraRotation.data(),
+                    frame.cameraPosition.data(), frame.cameraFov, frame.cameraAspect);
+    m_renderer->UpdateSpheres(frame.scene.spheres);
+    m_renderer->UpdatePlanes(frame.scene.planes);
+    m_renderer->UpdateLights(frame.scene.lights);
+
+    // Meshes are only loaded in OnInit, so reading the list from this thread is safe
+    m_renderer->RenderScene(frame.scene, m_gameScene->GetMeshes(),
+                           frame.cameraRotation.data(), frame.cameraPosition.data(),
+                           frame.time, frame.cameraFov);
+    m_renderer->SubmitFrame(&frame.ui);
+}
+
+FlyTracer::BenchmarkReport Application::runBenchmark(const FlyTracer::BenchmarkSpec& spec) {
+    std::vector<double> cpuTimes;
+    std::vector<double> gpuTimes;
+    cpuTimes.reserve(static_cast<size_t>(spec.frames));
+    gpuTimes.reserve(static_cast<size_t>(spec.frames));
+
+    std::cout << "Benchmark: " << spec.warmupFrames << " warmup + " << spec.frames
+              << " frames at dt=" << spec.timestep << "s\n";
+
+    m_running = true;
+    m_cameraPath = spec.cameraPath.empty() ? nullptr : &spec.cameraPath;
+    const int totalFrames = spec.warmupFrames + spec.frames;
+    for (int frame = 0; frame < totalFrames && m_running; ++frame) {
+        // Events keep the window responsive (ESC aborts); input is not forwarded to the scene
+        handleEvents();
+
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        update(spec.timestep);
+        render();
+
+        const auto frameEnd = std::chrono::steady_clock::now();
+        const bool measured = frame >= spec.warmupFrames;
+        if (measured) {
+            cpuTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+        }
+
+        // GPU samples arrive frames-in-flight later; attribute them to the frame that read them back
+        double gpuMs = 0.0;
+        if (m_renderer->TakeGpuFrameTime(gpuMs) && measured) {
+            gpuTimes.push_back(gpuMs);
+        }
+    }
+    m_cameraPath = nullptr;
+
+    m_renderer->WaitIdle();
+
+    FlyTracer::BenchmarkReport report;
+    report.scene = spec.scene;
+    report.width = m_width;
+    report.height = m_height;
+    report.frames = static_cast<int>(cpuTimes.size());
+    report.timestep = spec.timestep;
+    report.cpu = FlyTracer::FrameTimeStats::Compute(std::move(cpuTimes));
+    report.gpu = FlyTracer::FrameTimeStats::Compute(std::move(gpuTimes));
+
+    std::cout << "Benchmark: CPU p50 " << report.cpu.p50 << " ms, p95 " << report.cpu.p95 << " ms";
+    if (report.gpu.samples > 0) {
+        std::cout << " | GPU p50 " << report.gpu.p50 << " ms, p95 " << report.gpu.p95 << " ms";
+    }
+    std::cout << "\n";
+    return report;
+}
+
 void Application::handleEvents() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
@@ -238,10 +566,10 @@ void Application::handleEvents() {
         } else if (event.type == SDL_EVENT_WINDOW_SHOWN || event.type == SDL_EVENT_WINDOW_EXPOSED) {
             if (m_windowMinimized) {
                 m_windowMinimized = false;
-                m_renderer->WaitIdle();
+                waitRendererIdle();
             }
         } else if (event.type == SDL_EVENT_WINDOW_FOCUS_LOST) {
-            m_renderer->WaitIdle();
+            waitRendererIdle();
             // Reset all key states when focus is lost
             m_keyW = m_keyA = m_keyS = m_keyD = m_keyQ = m_keyE = false;
             m_keyUp = m_keyDown = m_keyLeft = m_keyRight = false;
@@ -250,7 +578,7 @@ void Application::handleEvents() {
             m_key6 = m_key7 = m_key8 = m_key9 = m_key0 = false;
             m_keyR = m_keyP = m_keyG = m_keyV = m_keyF = m_keyT = m_keyEsc = false;
         } else if (event.type == SDL_EVENT_WINDOW_FOCUS_GAINED) {
-            m_renderer->WaitIdle();
+            waitRendererIdle();
         }
     }
 }
@@ -307,6 +635,21 @@ void Application::processInput(float deltaTime) {
         input.keyT = m_keyT;
         input.keyEsc = m_keyEsc;
 
+        // Object under the cursor from the GPU readback, and request the current pixel
+        if (m_renderer->ObjectIdsEnabled()) {
+            if (m_renderThread.joinable()) {
+                // The render thread reads back and requests picks; keep the newest result
+                while (const PickResult* pick = m_pickQueue->Front()) {
+                    m_lastPick = *pick;
+                    m_pickQueue->Pop();
+                }
+                input.pick = m_lastPick;
+            } else {
+                (void)m_renderer->GetPickResult(input.pick);
+                m_renderer->RequestPick(m_lastMouseX, m_lastMouseY);
+            }
+        }
+
         input.deltaTime = deltaTime;
         m_gameScene->OnInput(input);
 
@@ -324,19 +667,30 @@ void Application::update(float deltaTime) {
     // Update game scene
     if (m_gameScene) {
         m_gameScene->ClearDebugDraw();  // Clear debug lines from previous frame
+        m_gameScene->UpdateAnimations(deltaTime);
         m_gameScene->OnUpdate(deltaTime);
 
-        // Get updated scene data
-        m_sceneData = m_gameScene->GetSceneData();
-        m_meshInstances = m_gameScene->GetMeshInstances();
+        // Scripted camera overrides whatever the scene did, before LOD selection sees it
+        if (m_cameraPath) {
+            const auto key = FlyTracer::SampleCameraPath(*m_cameraPath, m_time);
+            m_gameScene->SetCamera(TriVector(key.eye[0], key.eye[1], key.eye[2]),
+                                   TriVector(key.target[0], key.target[1], key.target[2]),
+                                   TriVector(key.up[0], key.up[1], key.up[2]));
+        }
+
+        // Publish this frame's render state (POD copy into the scene's back snapshot,
+        // no per-frame allocations once the buffers have grown to fit)
+        m_gameScene->PublishRenderSnapshot();
 
         // NOTE: Instance upload moved to render() after beginFrame() fence wait
         // to avoid updating the buffer while GPU is still reading it
 
-        // Update camera from scene
-        m_cameraEye = m_gameScene->GetCameraEye();
-        m_cameraTarget = m_gameScene->GetCameraTarget();
-        m_cameraUp = m_gameScene->GetCameraUp();
+        // Update camera from scene; instance changes add up until a frame uploads them
+        const RenderSnapshot& snapshot = m_gameScene->GetRenderSnapshot();
+        m_instanceChanges.Merge(snapshot.instancesChanged);
+        m_cameraEye = snapshot.cameraEye;
+        m_cameraTarget = snapshot.cameraTarget;
+        m_cameraUp = snapshot.cameraUp;
     }
 
     // FPS calculation
@@ -344,12 +698,57 @@ void Application::update(float deltaTime) {
     ++m_fpsFrameCount;
     if (m_fpsAccumulator >= 0.5f) {
         m_fps = static_cast<float>(m_fpsFrameCount) / m_fpsAccumulator;
+        m_renderFps = static_cast<float>(m_renderedFrames.exchange(0, std::memory_order_relaxed)) / m_fpsAccumulator;
         m_fpsAccumulator = 0.0f;
         m_fpsFrameCount = 0;
     }
 }
 
 void Application::render() {
+    updateCameraRotation();
+    const float cameraPosition[3] = {m_cameraEye.e032(), m_cameraEye.e013(), m_cameraEye.e021()};
+
+    // Begin frame (waits for previous frame's fence)
+    m_renderer->BeginFrame();
+
+    // Upload instances AFTER fence wait to avoid updating while GPU is reading
+    // This ensures the previous frame has finished using the buffer
+    const RenderSnapshot& snapshot = m_gameScene->GetRenderSnapshot();
+    uploadInstances(snapshot, std::exchange(m_instanceChanges, InstanceRange{}), m_cameraRotation.data(),
+                    cameraPosition, m_cameraFov, static_cast<float>(m_width) / static_cast<float>(m_height));
+    m_renderer->UpdateSpheres(snapshot.spheres);
+    m_renderer->UpdatePlanes(snapshot.planes);
+    m_renderer->UpdateLights(snapshot.lights);
+
+    buildUi();
+
+    // Render scene with camera rotation matrix and position
+    // Use game scene's meshes (m_meshes is not populated - it's a legacy member)
+    m_renderer->RenderScene(snapshot, m_gameScene->GetMeshes(),
+                           m_cameraRotation.data(), cameraPosition, m_time, m_cameraFov);
+
+    // End frame
+    m_renderer->EndFrame();
+}
+
+void Application::uploadInstances(const RenderSnapshot& scene, InstanceRange changed, const float cameraRotation[9],
+                                  const float cameraPosition[3], float cameraFov, float cameraAspect) {
+    if (scene.cullMode == InstanceCullMode::Off) {
+        m_renderer->UploadInstances(scene.instances, changed);
+        m_uploadedInstances.store(static_cast<uint32_t>(scene.instances.Size()), std::memory_order_relaxed);
+        return;
+    }
+
+    const float margin = scene.cullMode == InstanceCullMode::Padded ? scene.cullMargin : 0.0f;
+    const auto frustum = InstanceCulling::Frustum::FromCamera(
+        cameraRotation, cameraPosition, cameraFov, cameraAspect, margin);
+    InstanceCulling::ComputeWorldBounds(scene.instances, m_meshBounds, m_instanceBounds);
+    InstanceCulling::CullInstances(scene.instances, m_instanceBounds, frustum, m_visibleInstances);
+    m_renderer->UploadInstances(scene.instances, m_visibleInstances);
+    m_uploadedInstances.store(static_cast<uint32_t>(m_visibleInstances.size()), std::memory_order_relaxed);
+}
+
+void Application::updateCameraRotation() {
     // Compute camera basis vectors from the three PGA points (GLU-style camera)
     // Extract x, y, z coordinates from the stored TriVectors
     float eyeX = m_cameraEye.e032();
@@ -403,25 +802,34 @@ void Application::render() {
     m_cameraRotation[6] = -fx;  // -forward because camera looks down -Z
     m_cameraRotation[7] = -fy;
     m_cameraRotation[8] = -fz;
+}
 
-    // Package camera position
-    float cameraPosition[3] = {eyeX, eyeY, eyeZ};
-
-    // Begin frame (waits for previous frame's fence)
-    m_renderer->BeginFrame();
-
-    // Upload instances AFTER fence wait to avoid updating while GPU is reading
-    // This ensures the previous frame has finished using the buffer
-    m_renderer->UploadInstances(m_meshInstances);
-    m_renderer->UpdateSpheres(m_sceneData.spheres);
-    m_renderer->UpdatePlanes(m_sceneData.planes);
-
+void Application::buildUi() {
     // Build ImGui UI
     ImGui::Begin("Controls");
-    ImGui::Text("FPS: %.1f", m_fps);
+    if (m_renderThread.joinable()) {
+        ImGui::Text("FPS: %.1f (simulation %.1f Hz)", m_renderFps, m_fps);
+    } else {
+        ImGui::Text("FPS: %.1f", m_fps);
+    }
     ImGui::Text("Frame: %u", m_frameCount);
-    ImGui::Text("Camera: (%.2f, %.2f, %.2f)", eyeX, eyeY, eyeZ);
+    ImGui::Text("Camera: (%.2f, %.2f, %.2f)", m_cameraEye.e032(), m_cameraEye.e013(), m_cameraEye.e021());
     ImGui::SliderFloat("FOV", &m_cameraFov, 20.0f, 120.0f);
+
+    if (m_gameScene) {
+        static constexpr const char* kCullModes[] = {"Off", "Frustum", "Padded"};
+        int cullMode = static_cast<int>(m_gameScene->GetInstanceCullMode());
+        float cullMargin = m_gameScene->GetInstanceCullMargin();
+        bool cullChanged = ImGui::Combo("Instance culling", &cullMode, kCullModes, IM_ARRAYSIZE(kCullModes));
+        if (cullMode == static_cast<int>(InstanceCullMode::Padded)) {
+            cullChanged |= ImGui::SliderFloat("Cull margin", &cullMargin, 0.0f, 100.0f);
+        }
+        if (cullChanged) {
+            m_gameScene->SetInstanceCulling(static_cast<InstanceCullMode>(cullMode), cullMargin);
+        }
+        ImGui::Text("Instances: %u / %zu uploaded", m_uploadedInstances.load(std::memory_order_relaxed),
+                    m_gameScene->GetInstances().Size());
+    }
     ImGui::End();
 
     // Call scene's custom ImGui
@@ -429,14 +837,6 @@ void Application::render() {
         m_gameScene->SetCameraFov(m_cameraFov);
         m_gameScene->OnGui();
     }
-
-    // Render scene with camera rotation matrix and position
-    // Use game scene's meshes (m_meshes is not populated - it's a legacy member)
-    m_renderer->RenderScene(m_sceneData, m_gameScene->GetMeshes(), m_meshInstances,
-                           m_cameraRotation.data(), cameraPosition, m_time, m_cameraFov);
-
-    // End frame
-    m_renderer->EndFrame();
 }
 
 void Application::cleanup() {
@@ -1,8 +1,11 @@
 #include "GameScene.h"
 #include "VulkanRenderer.h"
+#include "MotorTransforms.h"
+#include "WorkerPool.h"
 #include <imgui.h>
 #include <cmath>
 #include <algorithm>
+#include <iostream>
 #include <stdexcept>
 
 GameScene::GameScene(const std::string& resourceDir)
@@ -54,12 +57,68 @@ uint32_t GameScene::LoadMesh(std::string_view objFilename, std::string_view text
         }
     }
 
+    return AddMesh(std::move(mesh));
+}
+
+uint32_t GameScene::AddMesh(std::unique_ptr<Mesh> mesh) {
+    if (!mesh || mesh->Empty()) {
+        throw std::runtime_error("Cannot add an empty mesh");
+    }
+
+    if (mesh->BVHNodes().empty()) {
+        mesh->BuildBVH();
+    }
+
     const auto meshId = static_cast<uint32_t>(m_meshes.size());
     m_meshes.push_back(std::move(mesh));
     m_meshCPUDataFreed.push_back(false);
     return meshId;
 }
 
+std::vector<uint32_t> GameScene::GenerateMeshLods(uint32_t meshId, std::span<const float> ratios) {
+    if (meshId >= m_meshes.size() || IsMeshCPUDataFreed(meshId)) {
+        throw std::runtime_error("Cannot generate LODs of mesh " + std::to_string(meshId) +
+                                 ": unknown or CPU data freed");
+    }
+
+    std::vector<uint32_t> levels = {meshId};
+    std::vector<float> levelRatios = {1.0f};
+    for (auto& level : MeshLod::GenerateLevels(*m_meshes[meshId], ratios)) {
+        levels.push_back(AddMesh(std::move(level)));
+    }
+    for (const float ratio : ratios) {
+        if (ratio < 1.0f) levelRatios.push_back(ratio);
+    }
+    m_lodTable.Add(levels, levelRatios, m_meshes[meshId]->BVHNodes().front());
+    return levels;
+}
+
+void GameScene::BuildMeshShadowProxy(uint32_t meshId, float ratio) {
+    if (meshId >= m_meshes.size() || IsMeshCPUDataFreed(meshId)) {
+        throw std::runtime_error("Cannot build a shadow proxy of mesh " + std::to_string(meshId) +
+                                 ": unknown or CPU data freed");
+    }
+    m_meshes[meshId]->BuildShadowProxy(ratio);
+}
+
+void GameScene::BuildShadowProxies() {
+    if (!m_shadowProxiesEnabled || m_shadowProxyRatio <= 0.0f) return;
+
+    std::vector<Mesh*> pending;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_meshes.size()); ++i) {
+        Mesh* mesh = m_meshes[i].get();
+        if (mesh && !IsMeshCPUDataFreed(i) && !mesh->ShadowProxy() &&
+            mesh->TriangleCount() >= kMinShadowProxyTriangles) {
+            pending.push_back(mesh);
+        }
+    }
+
+    // Meshes are decimated independently
+    WorkerPool::Shared().ParallelFor(pending.size(), [&](size_t k) {
+        pending[k]->BuildShadowProxy(m_shadowProxyRatio);
+    });
+}
+
 void GameScene::FreeMeshCPUData(uint32_t meshId) {
     if (meshId >= m_meshes.size() || !m_meshes[meshId]) {
         return;
@@ -83,7 +142,7 @@ bool GameScene::IsMeshCPUDataFreed(uint32_t meshId) const noexcept {
 
 // === Mesh Instance Management ===
 
-uint32_t GameScene::AddMeshInstance(uint32_t meshId, const TriVector& position, std::string_view name) {
+InstanceHandle GameScene::AddMeshInstance(uint32_t meshId, const TriVector& position, std::string_view name) {
     Motor transform(
         1.0f,
         position.e032() * 0.5f,
@@ -94,57 +153,98 @@ uint32_t GameScene::AddMeshInstance(uint32_t meshId, const TriVector& position,
     return AddMeshInstance(meshId, transform, name);
 }
 
-uint32_t GameScene::AddMeshInstance(uint32_t meshId, const Motor& transform, std::string_view name) {
+InstanceHandle GameScene::AddMeshInstance(uint32_t meshId, const Motor& transform, std::string_view name) {
     if (meshId >= m_meshes.size()) {
         throw std::runtime_error("Invalid mesh ID: " + std::to_string(meshId));
     }
 
-    MeshInstance instance;
-    instance.meshId = meshId;
-    instance.transform = transform;
-    instance.visible = true;
-    instance.name = std::string(name);
+    const InstanceHandle instance = m_instances.Create(meshId, transform);
+    if (!name.empty() && !m_instances.SetName(instance, name)) {
+        std::cerr << "Warning: Instance name '" << name << "' is already in use, instance left unnamed\n";
+    }
+    return instance;
+}
 
-    const auto instanceId = static_cast<uint32_t>(m_meshInstances.size());
-    m_meshInstances.push_back(std::move(instance));
+bool GameScene::RemoveMeshInstance(InstanceHandle instance) {
+    const uint32_t dense = m_instances.DenseIndex(instance);
+    if (!m_instances.Destroy(instance)) return false;
+    MeshLod::RemoveInstance(m_lodLevels, dense, static_cast<uint32_t>(m_instances.Size()));
+    return true;
+}
 
-    if (!name.empty()) {
-        m_namedInstances[std::string(name)] = instanceId;
+InstanceHandle GameScene::AddChildInstance(InstanceHandle parent, uint32_t meshId, const Motor& localTransform,
+                                           std::string_view name) {
+    if (!m_instances.IsAlive(parent)) {
+        throw std::runtime_error("Invalid parent instance for child of mesh " + std::to_string(meshId));
     }
+    const InstanceHandle instance = AddMeshInstance(meshId, localTransform, name);
+    (void)m_instances.SetParent(instance, parent);
+    (void)m_instances.SetLocalTransform(instance, localTransform);
+    return instance;
+}
+
+bool GameScene::SetInstanceParent(InstanceHandle child, InstanceHandle parent) {
+    return m_instances.SetParent(child, parent);
+}
+
+void GameScene::PublishRenderSnapshot() {
+    RenderSnapshot& back = m_snapshots[m_frontSnapshot ^ 1];
+    back.spheres.assign(m_sceneData.spheres.begin(), m_sceneData.spheres.end());
+    back.planes.assign(m_sceneData.planes.begin(), m_sceneData.planes.end());
+    m_instances.UpdateWorldTransforms();
+    back.instances = m_instances.Arrays();
+    back.instancesChanged = m_instances.TakeChangedRange();
+    back.lights.assign(m_sceneData.lights.begin(), m_sceneData.lights.end());
+    back.cameraEye = m_cameraEye;
+    back.cameraTarget = m_cameraTarget;
+    back.cameraUp = m_cameraUp;
+    back.cameraFov = m_cameraFov;
+    // Levels follow the camera this snapshot is rendered from
+    if (!m_lodTable.Empty()) {
+        const float eye[3] = {back.cameraEye.e032(), back.cameraEye.e013(), back.cameraEye.e021()};
+        back.instancesChanged.Merge(MeshLod::SelectLevels(m_lodTable, back.instances, eye, back.cameraFov,
+                                                          m_lodHysteresis, m_lodLevels));
+    }
+    back.cullMode = m_instanceCullMode;
+    back.cullMargin = m_instanceCullMargin;
+    m_frontSnapshot ^= 1;
+}
 
-    return instanceId;
+std::optional<InstanceRef> GameScene::GetInstance(InstanceHandle instance) noexcept {
+    return m_instances.Get(instance);
 }
 
-MeshInstance* GameScene::GetInstance(uint32_t instanceId) noexcept {
-    return instanceId < m_meshInstances.size() ? &m_meshInstances[instanceId] : nullptr;
+std::optional<InstanceRef> GameScene::FindInstance(std::string_view name) noexcept {
+    return m_instances.Get(m_instances.Find(name));
 }
 
-MeshInstance* GameScene::FindInstance(std::string_view name) noexcept {
-    const auto it = m_namedInstances.find(std::string(name));
-    return it != m_namedInstances.end() ? &m_meshInstances[it->second] : nullptr;
+InstanceHandle GameScene::FindInstanceHandle(std::string_view name) const noexcept {
+    return m_instances.Find(name);
 }
 
-void GameScene::SetInstanceTransform(uint32_t instanceId, const Motor& transform) {
-    if (auto* instance = GetInstance(instanceId)) {
-        instance->transform = transform;
-    }
+void GameScene::SetInstanceTransform(InstanceHandle instance, const Motor& transform) {
+    (void)m_instances.SetLocalTransform(instance, transform);
 }
 
-void GameScene::SetInstancePosition(uint32_t instanceId, const TriVector& position) {
-    if (auto* instance = GetInstance(instanceId)) {
-        instance->transform = Motor(
-            1.0f,
-            position.e032() * 0.5f,
-            position.e013() * 0.5f,
-            position.e021() * 0.5f,
-            0.0f, 0.0f, 0.0f, 0.0f
-        );
+void GameScene::SetInstancePosition(InstanceHandle instance, const TriVector& position) {
+    (void)m_instances.SetLocalTransform(instance, Motor(
+        1.0f,
+        position.e032() * 0.5f,
+        position.e013() * 0.5f,
+        position.e021() * 0.5f,
+        0.0f, 0.0f, 0.0f, 0.0f
+    ));
+}
+
+void GameScene::SetInstanceScale(InstanceHandle instance, float scale) {
+    if (auto ref = GetInstance(instance)) {
+        ref->scale = scale;
     }
 }
 
-void GameScene::SetInstanceVisible(uint32_t instanceId, bool visible) {
-    if (auto* instance = GetInstance(instanceId)) {
-        instance->visible = visible;
+void GameScene::SetInstanceVisible(InstanceHandle instance, bool visible) {
+    if (auto ref = GetInstance(instance)) {
+        ref->visible = visible ? 1 : 0;
     }
 }
 
@@ -251,6 +351,88 @@ Scene::GPULight* GameScene::GetLight(uint32_t id) noexcept {
     return id < m_sceneData.lights.size() ? &m_sceneData.lights[id] : nullptr;
 }
 
+// === Keyframe Animation ===
+
+void GameScene::AnimateInstance(InstanceHandle instance, std::span<const MotorKey> keys, AnimationWrap wrap,
+                                float timeOffset) {
+    (void)m_animations.AddMotorTrack(keys, wrap, timeOffset);
+    m_motorBindings.push_back({AnimationTarget::InstanceTransform, instance});
+}
+
+void GameScene::AnimateInstanceScale(InstanceHandle instance, std::span<const ScalarKey> keys, AnimationWrap wrap,
+                                     float timeOffset) {
+    (void)m_animations.AddScalarTrack(keys, wrap, timeOffset);
+    m_scalarBindings.push_back({AnimationTarget::InstanceScale, instance});
+}
+
+void GameScene::AnimateSphere(uint32_t id, std::span<const MotorKey> keys, AnimationWrap wrap, float timeOffset) {
+    (void)m_animations.AddMotorTrack(keys, wrap, timeOffset);
+    m_motorBindings.push_back({AnimationTarget::SphereCenter, {}, id});
+}
+
+void GameScene::AnimateSphereRadius(uint32_t id, std::span<const ScalarKey> keys, AnimationWrap wrap,
+                                    float timeOffset) {
+    (void)m_animations.AddScalarTrack(keys, wrap, timeOffset);
+    m_scalarBindings.push_back({AnimationTarget::SphereRadius, {}, id});
+}
+
+void GameScene::AnimateLightIntensity(uint32_t id, std::span<const ScalarKey> keys, AnimationWrap wrap,
+                                      float timeOffset) {
+    (void)m_animations.AddScalarTrack(keys, wrap, timeOffset);
+    m_scalarBindings.push_back({AnimationTarget::LightIntensity, {}, id});
+}
+
+void GameScene::ClearAnimations() {
+    m_animations.Clear();
+    m_motorBindings.clear();
+    m_scalarBindings.clear();
+}
+
+void GameScene::UpdateAnimations(float deltaTime) {
+    if (m_motorBindings.empty() && m_scalarBindings.empty()) {
+        return;
+    }
+    m_animationTime += deltaTime * m_animationSpeed;
+
+    m_animations.EvaluateMotors(m_animationTime, m_animatedMotors);
+    for (size_t i = 0; i < m_motorBindings.size(); ++i) {
+        const AnimationBinding& binding = m_motorBindings[i];
+        const Motor& motor = m_animatedMotors[i];
+        if (binding.target == AnimationTarget::InstanceTransform) {
+            (void)m_instances.SetLocalTransform(binding.instance, motor);
+        } else if (auto* sphere = GetSphere(binding.id)) {
+            // The motor applied to the origin is its translation
+            const auto rigid = MotorTransforms::RigidTransform::FromMotor(motor);
+            std::copy(std::begin(rigid.translation), std::end(rigid.translation), sphere->center);
+        }
+    }
+
+    m_animations.EvaluateScalars(m_animationTime, m_animatedScalars);
+    for (size_t i = 0; i < m_scalarBindings.size(); ++i) {
+        const AnimationBinding& binding = m_scalarBindings[i];
+        const float value = m_animatedScalars[i];
+        switch (binding.target) {
+            case AnimationTarget::InstanceScale:
+                if (auto ref = m_instances.Get(binding.instance)) {
+                    ref->scale = value;
+                }
+                break;
+            case AnimationTarget::SphereRadius:
+                if (auto* sphere = GetSphere(binding.id)) {
+                    sphere->radius = value;
+                }
+                break;
+            case AnimationTarget::LightIntensity:
+                if (auto* light = GetLight(binding.id)) {
+                    light->intensity = value;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
 // === Debug Visualization ===
 
 void GameScene::DrawDebugLine(const TriVector& from, const TriVector& to, const Scene::Color& color) {
@@ -0,0 +1,222 @@
+#include "InstanceCulling.h"
+#include "MotorTransforms.h"
+#include "detail/Simd8.h"
+#include <bit>
+#include <cmath>
+
+namespace InstanceCulling {
+
+namespace {
+
+// Box k against every plane, summed in the same order as the AVX2 path so both agree exactly
+bool boxInFrustum(const WorldBounds& bounds, size_t k, const Frustum& frustum) noexcept {
+    for (const auto& p : frustum.planes) {
+        float distance = p[0] * bounds.centerX[k] + p[3];
+        distance += p[1] * bounds.centerY[k];
+        distance += p[2] * bounds.centerZ[k];
+        distance += std::abs(p[0]) * bounds.extentX[k];
+        distance += std::abs(p[1]) * bounds.extentY[k];
+        distance += std::abs(p[2]) * bounds.extentZ[k];
+        if (!(distance >= 0.0f)) return false;
+    }
+    return true;
+}
+
+void cullScalar(const InstanceArrays& instances, const WorldBounds& bounds, const Frustum& frustum,
+                size_t first, std::vector<uint32_t>& visibleIndices) {
+    for (size_t k = first; k < bounds.Size(); ++k) {
+        if (instances.visible[k] != 0 && boxInFrustum(bounds, k, frustum)) {
+            visibleIndices.push_back(static_cast<uint32_t>(k));
+        }
+    }
+}
+
+void boundsScalar(const InstanceArrays& instances, std::span<const LocalBounds> meshBounds, size_t first,
+                  WorldBounds& out) noexcept {
+    const LocalBounds empty;
+    for (size_t i = first; i < instances.Size(); ++i) {
+        const uint32_t meshId = instances.meshIds[i];
+        const LocalBounds& local = meshId < meshBounds.size() ? meshBounds[meshId] : empty;
+
+        // Forward rotation and translation of the motor
+        const auto rigid = MotorTransforms::RigidTransform::FromMotor(instances.transforms[i]);
+        const auto& r = rigid.rotation;
+        const auto& t = rigid.translation;
+
+        // world = scale * R * local + t; the extent goes through |R|
+        const float scale = instances.scales[i];
+        float center[3];
+        float extent[3];
+        for (int a = 0; a < 3; ++a) {
+            center[a] = scale * (r[a][0] * local.center[0] + r[a][1] * local.center[1] + r[a][2] * local.center[2]) + t[a];
+            extent[a] = std::abs(scale) * (std::abs(r[a][0]) * local.extent[0] + std::abs(r[a][1]) * local.extent[1] +
+                                           std::abs(r[a][2]) * local.extent[2]);
+        }
+        out.centerX[i] = center[0];
+        out.centerY[i] = center[1];
+        out.centerZ[i] = center[2];
+        out.extentX[i] = extent[0];
+        out.extentY[i] = extent[1];
+        out.extentZ[i] = extent[2];
+    }
+}
+
+#if defined(__AVX2__)
+// boundsScalar for instances [first, first + 8), one lane each
+void bounds8(const InstanceArrays& instances, std::span<const LocalBounds> meshBounds, size_t first,
+             WorldBounds& out) noexcept {
+    const auto rigid = Simd8::RigidTransform8::Gather(instances.transforms.data(), nullptr, first);
+    const auto& r = rigid.rotation;
+    const auto& t = rigid.translation;
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    auto mul = [](__m256 a, __m256 b) { return _mm256_mul_ps(a, b); };
+    auto add = [](__m256 a, __m256 b) { return _mm256_add_ps(a, b); };
+    auto abs = [&](__m256 a) { return _mm256_andnot_ps(signMask, a); };
+
+    // Mesh boxes gathered by mesh ID; IDs past the end get the empty box (unsigned compare)
+    const __m256i meshIds = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(instances.meshIds.data() + first));
+    const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    const __m256 known = _mm256_castsi256_ps(_mm256_cmpgt_epi32(
+        _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(meshBounds.size())), bias), _mm256_xor_si256(meshIds, bias)));
+    static_assert(sizeof(LocalBounds) == 6 * sizeof(float));
+    const __m256i offsets = _mm256_mullo_epi32(meshIds, _mm256_set1_epi32(6));
+    const auto* base = reinterpret_cast<const float*>(meshBounds.data());
+    __m256 localCenter[3];
+    __m256 localExtent[3];
+    for (int a = 0; a < 3; ++a) {
+        localCenter[a] = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), base + a, offsets, known, 4);
+        localExtent[a] = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), base + 3 + a, offsets, known, 4);
+    }
+
+    const __m256 scale = _mm256_loadu_ps(instances.scales.data() + first);
+    float* centers[3] = {out.centerX.data(), out.centerY.data(), out.centerZ.data()};
+    float* extents[3] = {out.extentX.data(), out.extentY.data(), out.extentZ.data()};
+    for (int a = 0; a < 3; ++a) {
+        const __m256 rotated = add(add(mul(r[a][0], localCenter[0]), mul(r[a][1], localCenter[1])), mul(r[a][2], localCenter[2]));
+        const __m256 spread = add(add(mul(abs(r[a][0]), localExtent[0]), mul(abs(r[a][1]), localExtent[1])),
+                                  mul(abs(r[a][2]), localExtent[2]));
+        _mm256_storeu_ps(centers[a] + first, add(mul(scale, rotated), t[a]));
+        _mm256_storeu_ps(extents[a] + first, mul(abs(scale), spread));
+    }
+}
+#endif
+
+} // namespace
+
+LocalBounds LocalBounds::FromBVHRoot(const Scene::BVHNode& root) noexcept {
+    LocalBounds local;
+    if (root.minBounds[0] > root.maxBounds[0]) {
+        return local;  // Empty tree
+    }
+    for (int a = 0; a < 3; ++a) {
+        local.center[a] = (root.minBounds[a] + root.maxBounds[a]) * 0.5f;
+        local.extent[a] = (root.maxBounds[a] - root.minBounds[a]) * 0.5f;
+    }
+    return local;
+}
+
+Frustum Frustum::FromCamera(const float cameraRotation[9], const float cameraPosition[3],
+                            float fovDegrees, float aspect, float margin) noexcept {
+    const float* right = cameraRotation;
+    const float* up = cameraRotation + 3;
+    const float forward[3] = {-cameraRotation[6], -cameraRotation[7], -cameraRotation[8]};
+
+    // Edge rays of generateCameraRay: forward + tan(fov/2) * up, forward + aspect * tan(fov/2) * right
+    const float halfHeight = std::tan(fovDegrees * 3.14159265f / 360.0f);
+    const float halfWidth = halfHeight * aspect;
+
+    Frustum frustum;
+    auto setPlane = [&](int i, float slope, const float* side, float sign) {
+        float n[3];
+        for (int a = 0; a < 3; ++a) {
+            n[a] = slope * forward[a] + sign * side[a];
+        }
+        const float invLength = 1.0f / std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int a = 0; a < 3; ++a) {
+            frustum.planes[i][a] = n[a] * invLength;
+        }
+        frustum.planes[i][3] = margin - (frustum.planes[i][0] * cameraPosition[0] +
+                                         frustum.planes[i][1] * cameraPosition[1] +
+                                         frustum.planes[i][2] * cameraPosition[2]);
+    };
+    setPlane(0, halfWidth, right, -1.0f);   // Right
+    setPlane(1, halfWidth, right, 1.0f);    // Left
+    setPlane(2, halfHeight, up, -1.0f);     // Top
+    setPlane(3, halfHeight, up, 1.0f);      // Bottom
+    return frustum;
+}
+
+void ComputeWorldBounds(const InstanceArrays& instances, std::span<const LocalBounds> meshBounds,
+                        WorldBounds& out) {
+    const size_t count = instances.Size();
+    out.centerX.resize(count);
+    out.centerY.resize(count);
+    out.centerZ.resize(count);
+    out.extentX.resize(count);
+    out.extentY.resize(count);
+    out.extentZ.resize(count);
+
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8) {
+        bounds8(instances, meshBounds, i, out);
+    }
+#endif
+    boundsScalar(instances, meshBounds, i, out);
+}
+
+void CullInstancesScalar(const InstanceArrays& instances, const WorldBounds& bounds,
+                         const Frustum& frustum, std::vector<uint32_t>& visibleIndices) {
+    visibleIndices.clear();
+    cullScalar(instances, bounds, frustum, 0, visibleIndices);
+}
+
+void CullInstances(const InstanceArrays& instances, const WorldBounds& bounds,
+                   const Frustum& frustum, std::vector<uint32_t>& visibleIndices) {
+    visibleIndices.clear();
+    size_t k = 0;
+#if defined(__AVX2__)
+    __m256 normal[4][3];
+    __m256 absNormal[4][3];
+    __m256 offset[4];
+    for (int i = 0; i < 4; ++i) {
+        for (int a = 0; a < 3; ++a) {
+            normal[i][a] = _mm256_set1_ps(frustum.planes[i][a]);
+            absNormal[i][a] = _mm256_set1_ps(std::abs(frustum.planes[i][a]));
+        }
+        offset[i] = _mm256_set1_ps(frustum.planes[i][3]);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (; k + 8 <= bounds.Size(); k += 8) {
+        const __m256 cx = _mm256_loadu_ps(bounds.centerX.data() + k);
+        const __m256 cy = _mm256_loadu_ps(bounds.centerY.data() + k);
+        const __m256 cz = _mm256_loadu_ps(bounds.centerZ.data() + k);
+        const __m256 ex = _mm256_loadu_ps(bounds.extentX.data() + k);
+        const __m256 ey = _mm256_loadu_ps(bounds.extentY.data() + k);
+        const __m256 ez = _mm256_loadu_ps(bounds.extentZ.data() + k);
+
+        // Box k survives unless it lies entirely behind some plane
+        const auto* visibleBytes = reinterpret_cast<const __m128i*>(instances.visible.data() + k);
+        __m256 inside = _mm256_castsi256_ps(_mm256_cmpgt_epi32(
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64(visibleBytes)), _mm256_setzero_si256()));
+        for (int i = 0; i < 4; ++i) {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(normal[i][0], cx), offset[i]);
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(normal[i][1], cy));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(normal[i][2], cz));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(absNormal[i][0], ex));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(absNormal[i][1], ey));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(absNormal[i][2], ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+        }
+
+        for (auto mask = static_cast<unsigned>(_mm256_movemask_ps(inside)); mask != 0; mask &= mask - 1) {
+            visibleIndices.push_back(static_cast<uint32_t>(k + std::countr_zero(mask)));
+        }
+    }
+#endif
+    cullScalar(instances, bounds, frustum, k, visibleIndices);
+}
+
+} // namespace InstanceCulling
@@ -0,0 +1,146 @@
+#include "InstancePacking.h"
+#include "WorkerPool.h"
+#include "detail/Simd8.h"
+#include <algorithm>
+
+namespace InstancePacking {
+
+namespace {
+
+#if defined(__AVX2__)
+// GPUMeshInstance::FromMotor for records [first, first + 8), one lane each. Record i holds
+// instance indices[i] when Indexed, instance i otherwise (the dense path keeps plain loads).
+template <bool Indexed>
+void pack8(const InstanceArrays& instances, const uint32_t* indices, size_t first, Scene::GPUMeshInstance* out) noexcept {
+    static_assert(sizeof(Scene::GPUMeshInstance) == 16 * sizeof(float));
+
+    // The motors go through the shared 8-wide RigidTransform; the other columns are SoA,
+    // loaded directly or gathered by index
+    const __m256i source = Indexed
+        ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + first))
+        : _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const auto rigid = Simd8::RigidTransform8::Gather(instances.transforms.data(), Indexed ? indices : nullptr, first);
+    const auto& r = rigid.rotation;
+    const __m256 tx = rigid.translation[0];
+    const __m256 ty = rigid.translation[1];
+    const __m256 tz = rigid.translation[2];
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    auto mul = [](__m256 a, __m256 b) { return _mm256_mul_ps(a, b); };
+    auto add = [](__m256 a, __m256 b) { return _mm256_add_ps(a, b); };
+    auto sub = [](__m256 a, __m256 b) { return _mm256_sub_ps(a, b); };
+
+    // Inverse rows, then the record's trailing words: meshId, visible, sourceIndex, padding
+    __m256 scales;
+    __m256i meshIds;
+    __m256i visible;
+    if constexpr (Indexed) {
+        scales = _mm256_i32gather_ps(instances.scales.data(), source, 4);
+        meshIds = _mm256_i32gather_epi32(reinterpret_cast<const int*>(instances.meshIds.data()), source, 4);
+        alignas(32) uint32_t visibleLanes[8];
+        for (int k = 0; k < 8; ++k) {
+            visibleLanes[k] = instances.visible[indices[first + k]];
+        }
+        visible = _mm256_load_si256(reinterpret_cast<const __m256i*>(visibleLanes));
+    } else {
+        scales = _mm256_loadu_ps(instances.scales.data() + first);
+        meshIds = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(instances.meshIds.data() + first));
+        visible = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(instances.visible.data() + first)));
+    }
+    const __m256 invScale = _mm256_div_ps(one, scales);
+    auto invTranslation = [&](__m256 a, __m256 b, __m256 c) {
+        return mul(sub(zero, add(add(mul(a, tx), mul(b, ty)), mul(c, tz))), invScale);
+    };
+    __m256 fields[16] = {
+        mul(r[0][0], invScale), mul(r[1][0], invScale), mul(r[2][0], invScale), invTranslation(r[0][0], r[1][0], r[2][0]),
+        mul(r[0][1], invScale), mul(r[1][1], invScale), mul(r[2][1], invScale), invTranslation(r[0][1], r[1][1], r[2][1]),
+        mul(r[0][2], invScale), mul(r[1][2], invScale), mul(r[2][2], invScale), invTranslation(r[0][2], r[1][2], r[2][2]),
+        _mm256_castsi256_ps(meshIds),
+        _mm256_castsi256_ps(visible),
+        _mm256_castsi256_ps(source),
+        zero,
+    };
+
+    // Fields x instances -> instances x fields, two 8-float halves per record
+    Simd8::Transpose8x8(fields);
+    Simd8::Transpose8x8(fields + 8);
+    for (int k = 0; k < 8; ++k) {
+        auto* dst = reinterpret_cast<float*>(out + k);
+        _mm256_storeu_ps(dst, fields[k]);
+        _mm256_storeu_ps(dst + 8, fields[8 + k]);
+    }
+}
+#endif
+
+void packScalar(const InstanceArrays& instances, const uint32_t* indices, size_t first, size_t last,
+                Scene::GPUMeshInstance* out) noexcept {
+    for (size_t i = first; i < last; ++i) {
+        const uint32_t src = indices ? indices[i] : static_cast<uint32_t>(i);
+        out[i] = Scene::GPUMeshInstance::FromMotor(instances.transforms[src], instances.scales[src],
+                                                   instances.meshIds[src], instances.visible[src] != 0);
+        out[i].sourceIndex = src;
+    }
+}
+
+void packRange(const InstanceArrays& instances, const uint32_t* indices, size_t first, size_t last,
+               Scene::GPUMeshInstance* out) noexcept {
+    size_t i = first;
+#if defined(__AVX2__)
+    for (; i + 8 <= last; i += 8) {
+        if (indices) {
+            pack8<true>(instances, indices, i, out + i);
+        } else {
+            pack8<false>(instances, nullptr, i, out + i);
+        }
+    }
+#endif
+    packScalar(instances, indices, i, last, out);
+}
+
+void packParallel(const InstanceArrays& instances, const uint32_t* indices, size_t first, size_t last,
+                  Scene::GPUMeshInstance* out) {
+    WorkerPool& pool = WorkerPool::Shared();
+    const size_t count = last - first;
+    const size_t threadCount = std::min<size_t>(pool.ThreadCount(), count / kInstancesPerThread);
+    if (threadCount <= 1) {
+        packRange(instances, indices, first, last, out);
+        return;
+    }
+
+    // Chunks are whole 8-instance blocks, one per thread
+    const size_t chunk = (count / threadCount + 7) & ~size_t{7};
+    const size_t chunkCount = (count + chunk - 1) / chunk;
+    pool.ParallelFor(chunkCount, [&](size_t c) {
+        const size_t begin = first + c * chunk;
+        packRange(instances, indices, begin, std::min(begin + chunk, last), out);
+    });
+}
+
+} // namespace
+
+void PackInstancesScalar(const InstanceArrays& instances, Scene::GPUMeshInstance* out) noexcept {
+    packScalar(instances, nullptr, 0, instances.Size(), out);
+}
+
+void PackInstancesScalar(const InstanceArrays& instances, std::span<const uint32_t> indices,
+                         Scene::GPUMeshInstance* out) noexcept {
+    packScalar(instances, indices.data(), 0, indices.size(), out);
+}
+
+void PackInstances(const InstanceArrays& instances, Scene::GPUMeshInstance* out) {
+    packParallel(instances, nullptr, 0, instances.Size(), out);
+}
+
+void PackInstances(const InstanceArrays& instances, InstanceRange range, Scene::GPUMeshInstance* out) {
+    const size_t last = std::min<size_t>(range.last, instances.Size());
+    if (range.first < last) {
+        packParallel(instances, nullptr, range.first, last, out);
+    }
+}
+
+void PackInstances(const InstanceArrays& instances, std::span<const uint32_t> indices, Scene::GPUMeshInstance* out) {
+    packParallel(instances, indices.data(), 0, indices.size(), out);
+}
+
+} // namespace InstancePacking
@@ -0,0 +1,302 @@
+#include "InstanceStore.h"
+#include <utility>
+
+InstanceHandle InstanceStore::Create(uint32_t meshId, const Motor& transform, float scale, bool visible) {
+    uint32_t slotIndex = m_freeHead;
+    if (slotIndex != InstanceHandle::kInvalidIndex) {
+        m_freeHead = m_slots[slotIndex].nextFree;
+    } else {
+        slotIndex = static_cast<uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+        m_slotNames.emplace_back();
+        m_links.emplace_back();
+        m_locals.emplace_back();
+        m_slotNode.push_back(InstanceHandle::kInvalidIndex);
+    }
+
+    Slot& slot = m_slots[slotIndex];
+    slot.dense = static_cast<uint32_t>(m_arrays.Size());
+    slot.nextFree = InstanceHandle::kInvalidIndex;
+
+    m_arrays.transforms.push_back(transform);
+    m_arrays.scales.push_back(scale);
+    m_arrays.meshIds.push_back(meshId);
+    m_arrays.visible.push_back(visible ? 1 : 0);
+    m_denseToSlot.push_back(slotIndex);
+    markChanged(slot.dense);
+
+    return InstanceHandle{slotIndex, slot.generation};
+}
+
+bool InstanceStore::Destroy(InstanceHandle handle) {
+    if (!IsAlive(handle)) return false;
+
+    (void)SetName(handle, {});
+
+    // Children keep their world transforms and become roots
+    Link& link = m_links[handle.index];
+    if (link.parent != InstanceHandle::kInvalidIndex || link.firstChild != InstanceHandle::kInvalidIndex) {
+        while (link.firstChild != InstanceHandle::kInvalidIndex) {
+            unlink(link.firstChild);
+        }
+        unlink(handle.index);
+        m_hierarchyChanged = true;
+    }
+
+    // Move the last instance into the hole so the columns stay dense
+    Slot& slot = m_slots[handle.index];
+    const uint32_t hole = slot.dense;
+    const uint32_t last = static_cast<uint32_t>(m_arrays.Size() - 1);
+    if (hole != last) {
+        m_arrays.transforms[hole] = m_arrays.transforms[last];
+        m_arrays.scales[hole] = m_arrays.scales[last];
+        m_arrays.meshIds[hole] = m_arrays.meshIds[last];
+        m_arrays.visible[hole] = m_arrays.visible[last];
+        m_denseToSlot[hole] = m_denseToSlot[last];
+        m_slots[m_denseToSlot[hole]].dense = hole;
+        const uint32_t node = m_slotNode[m_denseToSlot[hole]];
+        if (node < m_nodes.size()) {
+            m_nodes[node].dense = hole;
+        }
+        markChanged(hole);
+    }
+    m_arrays.transforms.pop_back();
+    m_arrays.scales.pop_back();
+    m_arrays.meshIds.pop_back();
+    m_arrays.visible.pop_back();
+    m_denseToSlot.pop_back();
+
+    // Bumping the generation invalidates every outstanding handle to this slot
+    slot.dense = InstanceHandle::kInvalidIndex;
+    ++slot.generation;
+    slot.nextFree = m_freeHead;
+    m_freeHead = handle.index;
+    return true;
+}
+
+void InstanceStore::Clear() {
+    m_arrays = InstanceArrays{};
+    m_denseToSlot.clear();
+    m_nameToHandle.clear();
+
+    // Slots are kept so their generations survive: a handle from before the Clear must not
+    // match the instance that reuses its slot
+    m_freeHead = InstanceHandle::kInvalidIndex;
+    for (uint32_t i = static_cast<uint32_t>(m_slots.size()); i-- > 0;) {
+        Slot& slot = m_slots[i];
+        if (slot.dense != InstanceHandle::kInvalidIndex) {
+            slot.dense = InstanceHandle::kInvalidIndex;
+            ++slot.generation;
+        }
+        slot.nextFree = m_freeHead;
+        m_freeHead = i;
+        m_slotNames[i].clear();
+        m_links[i] = Link{};
+        m_slotNode[i] = InstanceHandle::kInvalidIndex;
+    }
+    m_nodes.clear();
+    m_nodeDirty.clear();
+    m_hierarchyChanged = false;
+    m_changed = InstanceRange{};
+}
+
+bool InstanceStore::IsAlive(InstanceHandle handle) const noexcept {
+    return handle.index < m_slots.size() &&
+           m_slots[handle.index].generation == handle.generation &&
+           m_slots[handle.index].dense != InstanceHandle::kInvalidIndex;
+}
+
+uint32_t InstanceStore::DenseIndex(InstanceHandle handle) const noexcept {
+    return IsAlive(handle) ? m_slots[handle.index].dense : InstanceHandle::kInvalidIndex;
+}
+
+InstanceHandle InstanceStore::HandleAt(uint32_t denseIndex) const noexcept {
+    if (denseIndex >= m_denseToSlot.size()) return InstanceHandle{};
+    const uint32_t slotIndex = m_denseToSlot[denseIndex];
+    return InstanceHandle{slotIndex, m_slots[slotIndex].generation};
+}
+
+std::optional<InstanceRef> InstanceStore::Get(InstanceHandle handle) noexcept {
+    const uint32_t i = DenseIndex(handle);
+    if (i == InstanceHandle::kInvalidIndex) return std::nullopt;
+    markChanged(i);
+    markNodeDirty(handle.index);
+    return InstanceRef{m_arrays.transforms[i], m_arrays.scales[i], m_arrays.visible[i], m_arrays.meshIds[i]};
+}
+
+InstanceArrays& InstanceStore::MutableArrays() noexcept {
+    markChanged(0);
+    if (m_arrays.Size() > 0) {
+        markChanged(static_cast<uint32_t>(m_arrays.Size() - 1));
+    }
+    std::fill(m_nodeDirty.begin(), m_nodeDirty.end(), uint8_t{1});
+    return m_arrays;
+}
+
+bool InstanceStore::SetParent(InstanceHandle child, InstanceHandle parent) {
+    if (!IsAlive(child) || (parent.IsValid() && !IsAlive(parent))) return false;
+
+    const uint32_t c = child.index;
+    const uint32_t p = parent.IsValid() ? parent.index : InstanceHandle::kInvalidIndex;
+    if (m_links[c].parent == p) return true;
+    for (uint32_t ancestor = p; ancestor != InstanceHandle::kInvalidIndex; ancestor = m_links[ancestor].parent) {
+        if (ancestor == c) return false;
+    }
+
+    unlink(c);
+    if (p != InstanceHandle::kInvalidIndex) {
+        // world = parentWorld * local, so local = ~parentWorld * world
+        m_locals[c] = ~m_arrays.transforms[m_slots[p].dense] * m_arrays.transforms[m_slots[c].dense];
+        Link& link = m_links[c];
+        link.parent = p;
+        link.nextSibling = m_links[p].firstChild;
+        if (link.nextSibling != InstanceHandle::kInvalidIndex) {
+            m_links[link.nextSibling].prevSibling = c;
+        }
+        m_links[p].firstChild = c;
+    }
+    m_hierarchyChanged = true;
+    return true;
+}
+
+InstanceHandle InstanceStore::Parent(InstanceHandle child) const noexcept {
+    if (!IsAlive(child)) return InstanceHandle{};
+    const uint32_t p = m_links[child.index].parent;
+    return p != InstanceHandle::kInvalidIndex ? InstanceHandle{p, m_slots[p].generation} : InstanceHandle{};
+}
+
+bool InstanceStore::SetLocalTransform(InstanceHandle handle, const Motor& local) {
+    const uint32_t i = DenseIndex(handle);
+    if (i == InstanceHandle::kInvalidIndex) return false;
+
+    if (m_links[handle.index].parent == InstanceHandle::kInvalidIndex) {
+        m_arrays.transforms[i] = local;
+        markChanged(i);
+    } else {
+        m_locals[handle.index] = local;
+        const uint32_t node = m_slotNode[handle.index];
+        if (!m_hierarchyChanged && node < m_nodes.size()) {
+            m_nodes[node].local = local;
+        }
+    }
+    markNodeDirty(handle.index);
+    return true;
+}
+
+std::optional<Motor> InstanceStore::LocalTransform(InstanceHandle handle) const noexcept {
+    const uint32_t i = DenseIndex(handle);
+    if (i == InstanceHandle::kInvalidIndex) return std::nullopt;
+    return m_links[handle.index].parent == InstanceHandle::kInvalidIndex ? m_arrays.transforms[i] : m_locals[handle.index];
+}
+
+void InstanceStore::UpdateWorldTransforms() {
+    if (m_hierarchyChanged) {
+        rebuildNodes();
+    }
+
+    // Parents come first, so a node's parent has already been updated (or skipped) when it is reached
+    m_nodeChanged.resize(m_nodes.size());
+    for (size_t k = 0; k < m_nodes.size(); ++k) {
+        const Node& node = m_nodes[k];
+        bool changed = m_nodeDirty[k] != 0;
+        if (node.parent != InstanceHandle::kInvalidIndex) {
+            changed = changed || m_nodeChanged[node.parent] != 0;
+            if (changed) {
+                m_arrays.transforms[node.dense] = m_arrays.transforms[m_nodes[node.parent].dense] * node.local;
+                markChanged(node.dense);
+            }
+        }
+        m_nodeChanged[k] = changed ? 1 : 0;
+        m_nodeDirty[k] = 0;
+    }
+}
+
+InstanceRange InstanceStore::TakeChangedRange() noexcept {
+    InstanceRange changed = std::exchange(m_changed, InstanceRange{});
+    changed.last = std::min(changed.last, static_cast<uint32_t>(m_arrays.Size()));
+    return changed;
+}
+
+void InstanceStore::markChanged(uint32_t dense) noexcept {
+    m_changed.Merge(InstanceRange{dense, dense + 1});
+}
+
+void InstanceStore::markNodeDirty(uint32_t slot) noexcept {
+    const uint32_t node = m_slotNode[slot];
+    if (!m_hierarchyChanged && node < m_nodes.size()) {
+        m_nodeDirty[node] = 1;
+    }
+}
+
+void InstanceStore::unlink(uint32_t slot) noexcept {
+    Link& link = m_links[slot];
+    if (link.parent != InstanceHandle::kInvalidIndex) {
+        if (link.prevSibling != InstanceHandle::kInvalidIndex) {
+            m_links[link.prevSibling].nextSibling = link.nextSibling;
+        } else {
+            m_links[link.parent].firstChild = link.nextSibling;
+        }
+        if (link.nextSibling != InstanceHandle::kInvalidIndex) {
+            m_links[link.nextSibling].prevSibling = link.prevSibling;
+        }
+    }
+    link.parent = InstanceHandle::kInvalidIndex;
+    link.nextSibling = InstanceHandle::kInvalidIndex;
+    link.prevSibling = InstanceHandle::kInvalidIndex;
+}
+
+void InstanceStore::rebuildNodes() {
+    m_nodes.clear();
+    std::fill(m_slotNode.begin(), m_slotNode.end(), InstanceHandle::kInvalidIndex);
+
+    // Depth-first from every root that has children, so each subtree is contiguous
+    std::vector<std::pair<uint32_t, uint32_t>> stack;  // (slot, parent node)
+    for (const uint32_t root : m_denseToSlot) {
+        if (m_links[root].parent != InstanceHandle::kInvalidIndex ||
+            m_links[root].firstChild == InstanceHandle::kInvalidIndex) {
+            continue;
+        }
+        stack.emplace_back(root, InstanceHandle::kInvalidIndex);
+        while (!stack.empty()) {
+            const auto [slot, parentNode] = stack.back();
+            stack.pop_back();
+            const auto node = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.push_back(Node{m_locals[slot], m_slots[slot].dense, parentNode});
+            m_slotNode[slot] = node;
+            for (uint32_t child = m_links[slot].firstChild; child != InstanceHandle::kInvalidIndex;
+                 child = m_links[child].nextSibling) {
+                stack.emplace_back(child, node);
+            }
+        }
+    }
+
+    // A new order has no per-node history: recompute everything once
+    m_nodeDirty.assign(m_nodes.size(), 1);
+    m_hierarchyChanged = false;
+}
+
+bool InstanceStore::SetName(InstanceHandle handle, std::string_view name) {
+    if (!IsAlive(handle)) return false;
+
+    std::string& current = m_slotNames[handle.index];
+    if (current == name) return true;
+    if (!name.empty() && m_nameToHandle.find(name) != m_nameToHandle.end()) return false;
+
+    if (!current.empty()) {
+        m_nameToHandle.erase(m_nameToHandle.find(std::string_view(current)));
+    }
+    current.assign(name);
+    if (!current.empty()) {
+        m_nameToHandle.emplace(current, handle);
+    }
+    return true;
+}
+
+InstanceHandle InstanceStore::Find(std::string_view name) const noexcept {
+    const auto it = m_nameToHandle.find(name);
+    return it != m_nameToHandle.end() ? it->second : InstanceHandle{};
+}
+
+std::string_view InstanceStore::Name(InstanceHandle handle) const noexcept {
+    return IsAlive(handle) ? std::string_view(m_slotNames[handle.index]) : std::string_view{};
+}
@@ -1,15 +1,15 @@
 #include "Mesh.h"
+#include "MotorTransforms.h"
 #include <tiny_obj_loader.h>
 #include <iostream>
 #include <unordered_map>
-#include <unordered_set>
 #include <cmath>
 #include <filesystem>
-#include <queue>
 #include <algorithm>
 #include <array>
+#include <limits>
 #include <stdexcept>
-#include <functional>
+#include <random>
 
 bool Mesh::LoadFromFile(const std::string& filename) {
     // Extract the directory for material file lookup
@@ -205,6 +205,7 @@ void Mesh::Clear() {
     m_vertices.clear();
     m_triangles.clear();
     m_materials.clear();
+    ClearShadowProxy();
 }
 
 void Mesh::ClearCPUData() {
@@ -214,6 +215,7 @@ void Mesh::ClearCPUData() {
     m_vertices.shrink_to_fit();
     m_triangles.clear();
     m_triangles.shrink_to_fit();
+    if (m_shadowProxy) m_shadowProxy->ClearCPUData();
     // Keep materials as they're small and may be needed for updates
     // Keep physics data (bounding box, face normals) for collision detection
 }
@@ -427,6 +429,10 @@ void Mesh::Translate(float x, float y, float z) {
     }
 }
 
+void Mesh::Transform(const Motor& motor) {
+    MotorTransforms::TransformVertices(motor, m_vertices);
+}
+
 void Mesh::CenterOnOrigin() {
     if (m_vertices.empty()) return;
 
@@ -453,190 +459,660 @@ void Mesh::CenterOnOrigin() {
     Translate(-centerX, -centerY, -centerZ);
 }
 
-void Mesh::Decimate(float targetRatio) {
-    if (m_triangles.empty() || targetRatio >= 1.0f) return;
+// === Decimation ===
+
+namespace {
+
+// Error quadric (Garland & Heckbert): a weighted sum of squared distances to planes, kept as the
+// upper triangle of its symmetric 4x4 matrix - a2 ab ac ad b2 bc bd c2 cd d2 - plus the weight
+// sum, so errors are mean squared distances whatever the mesh's triangle density. Stored in
+// floats to halve the working set; Decimate keeps the planes near the origin so that is enough,
+// and evaluates in doubles.
+struct Quadric {
+    float q[10]{};
+    float weight{0.0f};
+
+    void AddPlane(const double n[3], double d, double w) noexcept {
+        const double terms[10] = {n[0] * n[0], n[0] * n[1], n[0] * n[2], n[0] * d, n[1] * n[1],
+                                  n[1] * n[2], n[1] * d, n[2] * n[2], n[2] * d, d * d};
+        for (int i = 0; i < 10; ++i) q[i] += static_cast<float>(w * terms[i]);
+        weight += static_cast<float>(w);
+    }
+
+    Quadric& operator+=(const Quadric& other) noexcept {
+        for (int i = 0; i < 10; ++i) q[i] += other.q[i];
+        weight += other.weight;
+        return *this;
+    }
+
+    [[nodiscard]] double Error(const double p[3]) const noexcept {
+        const double x = p[0], y = p[1], z = p[2];
+        const double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4];
+        const double q5 = q[5], q6 = q[6], q7 = q[7], q8 = q[8], q9 = q[9];
+        const double e = q0 * x * x + 2.0 * q1 * x * y + 2.0 * q2 * x * z + 2.0 * q3 * x +
+                         q4 * y * y + 2.0 * q5 * y * z + 2.0 * q6 * y +
+                         q7 * z * z + 2.0 * q8 * z + q9;
+        return std::max(e, 0.0) / std::max(static_cast<double>(weight), 1e-30);
+    }
+
+    // Point of least error; false when the planes do not pin one down (flat or straight regions)
+    [[nodiscard]] bool Minimize(double p[3]) const noexcept {
+        double q[10];
+        std::copy(std::begin(this->q), std::end(this->q), q);
+        const double c00 = q[4] * q[7] - q[5] * q[5];
+        const double c01 = q[2] * q[5] - q[1] * q[7];
+        const double c02 = q[1] * q[5] - q[2] * q[4];
+        const double det = q[0] * c00 + q[1] * c01 + q[2] * c02;
+        const double trace = q[0] + q[4] + q[7];
+        if (std::abs(det) <= 1e-6 * trace * trace * trace) return false;
+
+        const double c11 = q[0] * q[7] - q[2] * q[2];
+        const double c12 = q[1] * q[2] - q[0] * q[5];
+        const double c22 = q[0] * q[4] - q[1] * q[1];
+        p[0] = -(c00 * q[3] + c01 * q[6] + c02 * q[8]) / det;
+        p[1] = -(c01 * q[3] + c11 * q[6] + c12 * q[8]) / det;
+        p[2] = -(c02 * q[3] + c12 * q[6] + c22 * q[8]) / det;
+        return true;
+    }
+};
+
+// 4-ary min-heap of edge IDs keyed by collapse cost, with the cost next to the ID so sifting
+// never leaves the heap array and a node's children share a cache line. Every edge knows its
+// slot, so a cheaper collapse is one sift up instead of a duplicate entry. Dearer ones are left
+// in place: the popped key is a lower bound, and Decimate re-evaluates before collapsing.
+class EdgeHeap {
+public:
+    struct Entry {
+        float cost;
+        uint32_t edge;
+    };
+
+    explicit EdgeHeap(const std::vector<float>& costs) : m_slot(costs.size(), kAbsent) {
+        for (uint32_t edge = 0; edge < costs.size(); ++edge) {
+            if (!std::isfinite(costs[edge])) continue;
+            m_slot[edge] = static_cast<uint32_t>(m_heap.size());
+            m_heap.push_back({costs[edge], edge});
+        }
+        for (size_t i = m_heap.size() / kArity + 1; i-- > 0;) {
+            if (i < m_heap.size()) siftDown(i, m_heap[i]);
+        }
+    }
+
+    [[nodiscard]] bool Empty() const noexcept { return m_heap.empty(); }
+
+    Entry Pop() noexcept {
+        const Entry top = m_heap.front();
+        m_slot[top.edge] = kAbsent;
+        const Entry last = m_heap.back();
+        m_heap.pop_back();
+        if (!m_heap.empty()) siftDown(0, last);
+        return top;
+    }
+
+    // Insert the edge, or lower its key
+    void Lower(uint32_t edge, float cost) {
+        if (!std::isfinite(cost)) return;
+        const uint32_t slot = m_slot[edge];
+        if (slot == kAbsent) {
+            m_heap.push_back({cost, edge});
+            siftUp(m_heap.size() - 1, {cost, edge});
+        } else if (cost < m_heap[slot].cost) {
+            siftUp(slot, {cost, edge});
+        }
+    }
+
+private:
+    static constexpr uint32_t kAbsent = ~0u;
+    static constexpr size_t kArity = 4;
+
+    void place(size_t slot, Entry entry) noexcept {
+        m_heap[slot] = entry;
+        m_slot[entry.edge] = static_cast<uint32_t>(slot);
+    }
+
+    void siftUp(size_t slot, Entry entry) noexcept {
+        while (slot > 0) {
+            const size_t parent = (slot - 1) / kArity;
+            if (m_heap[parent].cost <= entry.cost) break;
+            place(slot, m_heap[parent]);
+            slot = parent;
+        }
+        place(slot, entry);
+    }
+
+    void siftDown(size_t slot, Entry entry) noexcept {
+        const size_t count = m_heap.size();
+        while (true) {
+            const size_t first = slot * kArity + 1;
+            if (first >= count) break;
+            size_t child = first;
+            for (size_t k = first + 1; k < std::min(first + kArity, count); ++k) {
+                if (m_heap[k].cost < m_heap[child].cost) child = k;
+            }
+            if (entry.cost <= m_heap[child].cost) break;
+            place(slot, m_heap[child]);
+            slot = child;
+        }
+        place(slot, entry);
+    }
+
+    std::vector<uint32_t> m_slot;
+    std::vector<Entry> m_heap;
+};
+
+using Vec3d = std::array<double, 3>;
+
+Vec3d cross(const Vec3d& a, const Vec3d& b) noexcept {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+double dot(const Vec3d& a, const Vec3d& b) noexcept {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+Vec3d sub(const Vec3d& a, const Vec3d& b) noexcept {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+// Weight of a border, seam or material boundary plane relative to the triangle planes
+constexpr double kFeatureWeight = 10.0;
+// A texture coordinate change of a whole texture costs as much as moving a tenth of the
+// mesh's bounding diagonal away from the surface
+constexpr double kTexCoordWeight = 0.01;
+// A collapse may not turn any remaining triangle further than this (cosine between normals)
+constexpr double kMinNormalCosine = 0.2;
+
+// Point flags: constrained points only collapse along their feature chain or stay put as the
+// target of a neighbor; locked points (non-manifold edges) never move
+constexpr uint8_t kConstrained = 1;
+constexpr uint8_t kLocked = 2;
+
+} // namespace
+
+float Mesh::Decimate(float targetRatio) {
+    if (m_triangles.empty() || targetRatio >= 1.0f) return 0.0f;
 
     targetRatio = std::max(0.01f, std::min(1.0f, targetRatio));
     size_t targetTriCount = static_cast<size_t>(m_triangles.size() * targetRatio);
     targetTriCount = std::max(targetTriCount, size_t(4)); // Keep at least 4 triangles
 
-    std::cout << "Decimating mesh from " << m_triangles.size() << " to ~"
-              << targetTriCount << " triangles..." << std::endl;
-
     const size_t numVertices = m_vertices.size();
     const size_t numTriangles = m_triangles.size();
+    constexpr uint32_t kNone = ~0u;
+
+    // ========== Points and wedges ==========
+    // Collapses move points (distinct positions). The vertices of a point are its wedges: one per
+    // distinct texture coordinate, so a vertex split only for its normal joins its twin (normals
+    // are recomputed at the end) while UV seams stay split.
+    struct WeldKey {
+        std::array<float, 5> key;  // Position, then texture coordinate
+        uint32_t vertex;
+    };
+    std::vector<WeldKey> welds(numVertices);
+    for (uint32_t i = 0; i < numVertices; ++i) {
+        const Vertex& v = m_vertices[i];
+        welds[i] = {{v.position.e032(), v.position.e013(), v.position.e021(), v.texCoord[0], v.texCoord[1]}, i};
+    }
+    std::sort(welds.begin(), welds.end(), [](const WeldKey& a, const WeldKey& b) { return a.key < b.key; });
 
-    // ========== Union-Find with path compression ==========
-    std::vector<uint32_t> parent(numVertices);
+    // Twins point at the first vertex of their run; points are then numbered in vertex order,
+    // which keeps the input's memory locality for the collapse loop
+    std::vector<uint32_t> pointOf(numVertices);
+    std::vector<uint32_t> wedgeOf(numVertices);
     for (size_t i = 0; i < numVertices; ++i) {
-        parent[i] = static_cast<uint32_t>(i);
+        const auto& k = welds[i].key;
+        const uint32_t v = welds[i].vertex;
+        const bool samePosition = i > 0 && std::equal(k.begin(), k.begin() + 3, welds[i - 1].key.begin());
+        pointOf[v] = samePosition ? pointOf[welds[i - 1].vertex] : v;
+        wedgeOf[v] = samePosition && k == welds[i - 1].key ? wedgeOf[welds[i - 1].vertex] : v;
     }
-
-    // Find with path compression - flattens tree for O(α(n)) amortized
-    std::function<uint32_t(uint32_t)> findRoot = [&parent, &findRoot](uint32_t v) -> uint32_t {
-        if (parent[v] != v) {
-            parent[v] = findRoot(parent[v]); // Path compression
+    welds.clear();
+    welds.shrink_to_fit();
+
+    // Positions are relative to the center of the bounds, which keeps the planes of the float
+    // quadrics near the origin
+    Vec3d center{};
+    double diagonalSquared = 0.0;
+    {
+        float minBounds[3] = {1e30f, 1e30f, 1e30f};
+        float maxBounds[3] = {-1e30f, -1e30f, -1e30f};
+        for (const Vertex& v : m_vertices) {
+            const float p[3] = {v.position.e032(), v.position.e013(), v.position.e021()};
+            for (int a = 0; a < 3; ++a) {
+                minBounds[a] = std::min(minBounds[a], p[a]);
+                maxBounds[a] = std::max(maxBounds[a], p[a]);
+            }
+        }
+        for (int a = 0; a < 3; ++a) {
+            center[a] = (static_cast<double>(minBounds[a]) + maxBounds[a]) * 0.5;
+            const double extent = static_cast<double>(maxBounds[a]) - minBounds[a];
+            diagonalSquared += extent * extent;
         }
-        return parent[v];
+    }
+
+    // Everything a collapse reads about a point
+    struct Point {
+        Quadric quadric;
+        Vec3d position;
+        uint32_t firstCorner{kNone};  // Head of the point's fan
+        uint32_t firstEdge{kNone};    // Head of the point's edge list
+        uint8_t flags{0};
     };
+    std::vector<uint32_t> pointIds(numVertices, kNone);
+    std::vector<Point> points;
+    points.reserve(numVertices);
+    for (uint32_t v = 0; v < numVertices; ++v) {
+        uint32_t& id = pointIds[pointOf[v]];
+        if (id == kNone) {
+            id = static_cast<uint32_t>(points.size());
+            const TriVector& p = m_vertices[v].position;
+            points.emplace_back().position = {p.e032() - center[0], p.e013() - center[1], p.e021() - center[2]};
+        }
+        pointOf[v] = id;
+    }
+    pointIds.clear();
+    pointIds.shrink_to_fit();
+    const size_t numPoints = points.size();
 
-    // ========== Vertex-to-triangle adjacency ==========
-    // This allows O(degree) updates instead of O(n) full scans
-    std::vector<std::vector<uint32_t>> vertexTriangles(numVertices);
-    for (size_t ti = 0; ti < numTriangles; ++ti) {
-        const Triangle& tri = m_triangles[ti];
-        vertexTriangles[tri.indices[0]].push_back(static_cast<uint32_t>(ti));
-        vertexTriangles[tri.indices[1]].push_back(static_cast<uint32_t>(ti));
-        vertexTriangles[tri.indices[2]].push_back(static_cast<uint32_t>(ti));
+    std::vector<std::array<float, 2>> texCoords(numVertices);
+    for (size_t i = 0; i < numVertices; ++i) {
+        texCoords[i] = {m_vertices[i].texCoord[0], m_vertices[i].texCoord[1]};
     }
 
-    // Track which triangles are still valid
-    std::vector<bool> triangleValid(numTriangles, true);
+    // ========== Triangles ==========
+    // Wedge and point of every corner side by side, plus the next corner (triangle * 3 + corner)
+    // of the same point: fans are lists threaded through the triangles, so walking one reads one
+    // record per triangle and merging two is a splice. Zero-length edges are dropped up front.
+    struct Corners {
+        uint32_t wedges[3];
+        uint32_t points[3];
+        uint32_t next[3];
+    };
+    std::vector<Corners> tris(numTriangles);
+    std::vector<uint8_t> triangleValid(numTriangles, 1);
     size_t validTriCount = numTriangles;
-
-    // Copy vertex positions (modified during collapse)
-    // Using GA types: TriVector for position (e032=x, e013=y, e021=z), Vector for normal (e1=nx, e2=ny, e3=nz)
-    std::vector<std::array<float, 3>> positions(numVertices);
-    std::vector<std::array<float, 3>> normals(numVertices);
-    for (size_t i = 0; i < numVertices; ++i) {
-        positions[i] = {m_vertices[i].position.e032(), m_vertices[i].position.e013(), m_vertices[i].position.e021()};
-        normals[i] = {m_vertices[i].normal.e1(), m_vertices[i].normal.e2(), m_vertices[i].normal.e3()};
+    for (uint32_t ti = 0; ti < numTriangles; ++ti) {
+        Corners& tri = tris[ti];
+        for (int c = 0; c < 3; ++c) {
+            tri.wedges[c] = wedgeOf[m_triangles[ti].indices[c]];
+            tri.points[c] = pointOf[tri.wedges[c]];
+        }
+        if (tri.points[0] == tri.points[1] || tri.points[1] == tri.points[2] || tri.points[2] == tri.points[0]) {
+            triangleValid[ti] = 0;
+            --validTriCount;
+            continue;
+        }
+        for (uint32_t c = 0; c < 3; ++c) {
+            tri.next[c] = points[tri.points[c]].firstCorner;
+            points[tri.points[c]].firstCorner = ti * 3 + c;
+        }
     }
+    wedgeOf.clear();
+    wedgeOf.shrink_to_fit();
+
+    auto nextCorner = [&tris](uint32_t corner) -> uint32_t& { return tris[corner / 3].next[corner % 3]; };
+    auto faceNormal = [&](uint32_t ti) {
+        const Corners& tri = tris[ti];
+        const Vec3d& p0 = points[tri.points[0]].position;
+        return cross(sub(points[tri.points[1]].position, p0), sub(points[tri.points[2]].position, p0));
+    };
 
-    // Edge key packing
-    auto makeEdgeKey = [](uint32_t v1, uint32_t v2) -> uint64_t {
-        if (v1 > v2) std::swap(v1, v2);
-        return (static_cast<uint64_t>(v1) << 32) | static_cast<uint64_t>(v2);
+    // ========== Edges ==========
+    // One per pair of points, gathered from the fan of the lower point and threaded through both
+    // points' edge lists. An edge is a feature when it does not join exactly two triangles
+    // through the same wedges and material.
+    struct Edge {
+        uint32_t points[2];
+        uint32_t next[2];  // Next edge of points[0] and of points[1]
+        uint8_t feature;
+        uint8_t alive;
+    };
+    std::vector<Edge> edges;
+    edges.reserve(validTriCount * 3 / 2 + numPoints / 8);
+    auto nextEdge = [&edges](uint32_t e, uint32_t p) -> uint32_t& { return edges[e].next[edges[e].points[1] == p]; };
+    auto otherPoint = [&edges](uint32_t e, uint32_t p) {
+        return edges[e].points[0] == p ? edges[e].points[1] : edges[e].points[0];
     };
 
-    // Calculate edge collapse cost (edge length)
-    auto calcEdgeCost = [&positions](uint32_t v1, uint32_t v2) -> float {
-        float dx = positions[v1][0] - positions[v2][0];
-        float dy = positions[v1][1] - positions[v2][1];
-        float dz = positions[v1][2] - positions[v2][2];
-        return dx*dx + dy*dy + dz*dz; // Squared distance (avoid sqrt in inner loop)
+    struct FanEdge {
+        uint32_t point;
+        uint32_t wedges[2];    // Of both points, in the first triangle
+        uint32_t triangles[2];
+        uint32_t count;
+        bool seam;             // Triangles through other wedges or of another material
     };
+    std::vector<FanEdge> fanEdges;
+    for (uint32_t p0 = 0; p0 < numPoints; ++p0) {
+        fanEdges.clear();
+        for (uint32_t k = points[p0].firstCorner; k != kNone; k = nextCorner(k)) {
+            const Corners& tri = tris[k / 3];
+            for (int c = 0; c < 3; ++c) {
+                const uint32_t p1 = tri.points[c];
+                if (p1 <= p0) continue;
+                const auto it = std::find_if(fanEdges.begin(), fanEdges.end(),
+                                             [p1](const FanEdge& f) { return f.point == p1; });
+                const uint32_t wedges[2] = {tri.wedges[k % 3], tri.wedges[c]};
+                if (it == fanEdges.end()) {
+                    fanEdges.push_back({p1, {wedges[0], wedges[1]}, {k / 3, k / 3}, 1, false});
+                    continue;
+                }
+                if (it->count++ == 1) it->triangles[1] = k / 3;
+                it->seam |= wedges[0] != it->wedges[0] || wedges[1] != it->wedges[1] ||
+                            m_triangles[k / 3].materialIndex != m_triangles[it->triangles[0]].materialIndex;
+            }
+        }
 
-    // Priority queue: (cost, v1, v2)
-    using EdgeEntry = std::tuple<float, uint32_t, uint32_t>;
-    std::priority_queue<EdgeEntry, std::vector<EdgeEntry>, std::greater<EdgeEntry>> edgeQueue;
+        for (const FanEdge& f : fanEdges) {
+            const uint32_t p1 = f.point;
+            const bool feature = f.count != 2 || f.seam;
+            if (f.count > 2) {
+                points[p0].flags |= kLocked;
+                points[p1].flags |= kLocked;
+            }
 
-    // Build initial edge queue (deduplicated)
-    std::unordered_set<uint64_t> addedEdges;
-    addedEdges.reserve(numTriangles * 3);
-    for (size_t ti = 0; ti < numTriangles; ++ti) {
-        const Triangle& tri = m_triangles[ti];
-        for (int e = 0; e < 3; ++e) {
-            uint32_t v1 = tri.indices[e];
-            uint32_t v2 = tri.indices[(e + 1) % 3];
-            uint64_t edgeKey = makeEdgeKey(v1, v2);
-            if (addedEdges.insert(edgeKey).second) {
-                float cost = calcEdgeCost(v1, v2);
-                edgeQueue.push({cost, v1, v2});
+            if (feature) {
+                points[p0].flags |= kConstrained;
+                points[p1].flags |= kConstrained;
+                // Plane through the edge, perpendicular to each triangle beside it
+                const Vec3d edgeVector = sub(points[p1].position, points[p0].position);
+                const double lengthSquared = dot(edgeVector, edgeVector);
+                for (uint32_t k = 0; k < (f.count == 1 ? 1u : 2u); ++k) {
+                    Vec3d n = cross(edgeVector, faceNormal(f.triangles[k]));
+                    const double length = std::sqrt(dot(n, n));
+                    if (length <= 0.0) continue;
+                    for (double& component : n) component /= length;
+                    const double d = -dot(n, points[p0].position);
+                    points[p0].quadric.AddPlane(n.data(), d, kFeatureWeight * lengthSquared);
+                    points[p1].quadric.AddPlane(n.data(), d, kFeatureWeight * lengthSquared);
+                }
             }
+
+            const auto id = static_cast<uint32_t>(edges.size());
+            edges.push_back({{p0, p1}, {points[p0].firstEdge, points[p1].firstEdge}, static_cast<uint8_t>(feature), 1});
+            points[p0].firstEdge = id;
+            points[p1].firstEdge = id;
         }
     }
-    addedEdges.clear(); // Free memory, no longer needed
-
-    // Working triangle indices (avoid repeated allocation)
-    std::vector<uint32_t> affectedTriangles;
-    affectedTriangles.reserve(64);
-
-    // Edge collapse loop
-    while (validTriCount > targetTriCount && !edgeQueue.empty()) {
-        auto [cost, origV1, origV2] = edgeQueue.top();
-        edgeQueue.pop();
 
-        // Find current roots (with path compression)
-        uint32_t v1 = findRoot(origV1);
-        uint32_t v2 = findRoot(origV2);
+    // Triangle planes, weighted by area; more than one wedge also constrains a point
+    std::vector<uint32_t> firstWedge(numPoints, kNone);
+    for (uint32_t ti = 0; ti < numTriangles; ++ti) {
+        if (!triangleValid[ti]) continue;
+        const Corners& tri = tris[ti];
+        for (int c = 0; c < 3; ++c) {
+            uint32_t& first = firstWedge[tri.points[c]];
+            if (first == kNone) first = tri.wedges[c];
+            else if (first != tri.wedges[c]) points[tri.points[c]].flags |= kConstrained;
+        }
+        Vec3d n = faceNormal(ti);
+        const double length = std::sqrt(dot(n, n));
+        if (length <= 0.0) continue;
+        for (double& component : n) component /= length;
+        const double d = -dot(n, points[tri.points[0]].position);
+        for (const uint32_t p : tri.points) {
+            points[p].quadric.AddPlane(n.data(), d, length * 0.5);
+        }
+    }
+    firstWedge.clear();
+    firstWedge.shrink_to_fit();
+
+    const double texCoordScale = kTexCoordWeight * diagonalSquared;
+
+    // Each wedge of the removed point joins the wedge of the kept point it shares a triangle
+    // across the edge with. False when a wedge has none or two - collapsing would tear a seam.
+    std::vector<std::pair<uint32_t, uint32_t>> wedgeMap;
+    std::vector<uint32_t> edgeTriangles;
+    auto mappedWedge = [&wedgeMap](uint32_t wedge) {
+        const auto it = std::find_if(wedgeMap.begin(), wedgeMap.end(), [wedge](const auto& m) { return m.first == wedge; });
+        return it == wedgeMap.end() ? kNone : it->second;
+    };
+    auto mapWedges = [&](uint32_t remove, uint32_t keep) {
+        wedgeMap.clear();
+        edgeTriangles.clear();
+        uint32_t firstWedge = kNone;
+        bool split = false;  // More than one wedge at the removed point
+        for (uint32_t k = points[remove].firstCorner; k != kNone; k = nextCorner(k)) {
+            const uint32_t ti = k / 3;
+            if (!triangleValid[ti]) continue;
+            const Corners& tri = tris[ti];
+            const uint32_t removeWedge = tri.wedges[k % 3];
+            if (firstWedge == kNone) firstWedge = removeWedge;
+            split |= removeWedge != firstWedge;
+            for (int c = 0; c < 3; ++c) {
+                if (tri.points[c] != keep) continue;
+                edgeTriangles.push_back(ti);
+                const uint32_t mapped = mappedWedge(removeWedge);
+                if (mapped == kNone) wedgeMap.push_back({removeWedge, tri.wedges[c]});
+                else if (mapped != tri.wedges[c]) return false;
+            }
+        }
+        if (edgeTriangles.empty()) return false;
+        if (!split) return true;
+        for (uint32_t k = points[remove].firstCorner; k != kNone; k = nextCorner(k)) {
+            if (triangleValid[k / 3] && mappedWedge(tris[k / 3].wedges[k % 3]) == kNone) return false;
+        }
+        return true;
+    };
 
-        // Skip if already merged
-        if (v1 == v2) continue;
+    auto featureCount = [&](uint32_t p) {
+        int count = 0;
+        for (uint32_t e = points[p].firstEdge; e != kNone; e = nextEdge(e, p)) {
+            count += edges[e].alive && edges[e].feature;
+        }
+        return count;
+    };
 
-        // Ensure v1 < v2 for consistent merging
-        if (v1 > v2) std::swap(v1, v2);
+    // ========== Collapse costs ==========
+    // The point that goes, the point that stays and where the survivor ends up. Two free points
+    // meet at the quadric's optimum with texture coordinates interpolated along the edge; a free
+    // point next to a constrained one moves onto it; two constrained points only merge along
+    // their feature chain. Collapses onto a fixed point pay for the texture coordinates the
+    // removed wedges lose. Only the cost is kept per edge; the rest is worked out again for the
+    // edge being collapsed.
+    struct Collapse {
+        uint32_t remove;
+        uint32_t keep;
+        Vec3d position;
+        float t;  // Position along keep -> remove, for interpolating texture coordinates
+        float cost;
+    };
+    std::vector<float> costs(edges.size());
+
+    auto texCoordError = [&]() {
+        double error = 0.0;
+        for (const auto& [from, to] : wedgeMap) {
+            const double du = texCoords[from][0] - texCoords[to][0];
+            const double dv = texCoords[from][1] - texCoords[to][1];
+            error += du * du + dv * dv;
+        }
+        return error * texCoordScale;
+    };
 
-        // Recalculate cost - skip if significantly changed (lazy update)
-        float newCost = calcEdgeCost(v1, v2);
-        if (newCost > cost * 2.25f) { // 1.5^2 since we use squared distance
-            edgeQueue.push({newCost, v1, v2});
-            continue;
+    auto evaluate = [&](uint32_t e) {
+        Collapse best{0, 0, {}, 0.0f, std::numeric_limits<float>::infinity()};
+        const uint32_t p0 = edges[e].points[0], p1 = edges[e].points[1];
+        Quadric q = points[p0].quadric;
+        q += points[p1].quadric;
+
+        if (points[p0].flags == 0 && points[p1].flags == 0) {
+            const Vec3d& a = points[p0].position;
+            const Vec3d& b = points[p1].position;
+            const Vec3d ab = sub(b, a);
+            const double lengthSquared = dot(ab, ab);
+            const Vec3d mid{(a[0] + b[0]) * 0.5, (a[1] + b[1]) * 0.5, (a[2] + b[2]) * 0.5};
+            Vec3d x;
+            // The optimum, unless it lies off beyond the edge (a nearly singular quadric)
+            if (!q.Minimize(x.data()) || dot(sub(x, mid), sub(x, mid)) > lengthSquared) {
+                x = mid;
+                double bestError = q.Error(mid.data());
+                for (const Vec3d* candidate : {&a, &b}) {
+                    const double error = q.Error(candidate->data());
+                    if (error < bestError) {
+                        bestError = error;
+                        x = *candidate;
+                    }
+                }
+            }
+            const double t = lengthSquared > 0.0 ? std::clamp(dot(sub(x, a), ab) / lengthSquared, 0.0, 1.0) : 0.0;
+            best = {p1, p0, x, static_cast<float>(t), static_cast<float>(q.Error(x.data()))};
+        } else {
+            // Onto a fixed point: try both directions, as both ends may be constrained
+            for (const auto& [remove, keep] : {std::pair{p1, p0}, std::pair{p0, p1}}) {
+                const uint8_t flags = points[remove].flags;
+                if (flags & kLocked) continue;
+                if (flags & kConstrained) {
+                    if (!edges[e].feature || featureCount(remove) != 2) continue;
+                } else if (points[keep].flags == 0) {
+                    continue;
+                }
+                if (!mapWedges(remove, keep)) continue;
+                const auto cost = static_cast<float>(q.Error(points[keep].position.data()) + texCoordError());
+                if (cost < best.cost) best = {remove, keep, points[keep].position, 0.0f, cost};
+            }
         }
+        costs[e] = best.cost;
+        return best;
+    };
 
-        // ========== Collapse edge: merge v2 into v1 ==========
-        // Update position to midpoint
-        positions[v1][0] = (positions[v1][0] + positions[v2][0]) * 0.5f;
-        positions[v1][1] = (positions[v1][1] + positions[v2][1]) * 0.5f;
-        positions[v1][2] = (positions[v1][2] + positions[v2][2]) * 0.5f;
+    for (uint32_t e = 0; e < edges.size(); ++e) (void)evaluate(e);
+    EdgeHeap heap(costs);
+
+    // ========== Validity ==========
+    // Link condition: the two points may only share the neighbors across their shared
+    // triangles, or the collapse pinches the surface
+    std::vector<uint32_t> neighbors;
+    auto keepsManifold = [&](const Collapse& c) {
+        neighbors.clear();
+        for (uint32_t e = points[c.keep].firstEdge; e != kNone; e = nextEdge(e, c.keep)) {
+            if (edges[e].alive) neighbors.push_back(otherPoint(e, c.keep));
+        }
+        size_t common = 0;
+        size_t removeDegree = 0;
+        for (uint32_t e = points[c.remove].firstEdge; e != kNone; e = nextEdge(e, c.remove)) {
+            if (!edges[e].alive) continue;
+            ++removeDegree;
+            common += std::find(neighbors.begin(), neighbors.end(), otherPoint(e, c.remove)) != neighbors.end();
+        }
+        if (common != edgeTriangles.size()) return false;
+        // Two closed fans of three (a tetrahedron) would fold onto each other
+        return !(edgeTriangles.size() == 2 && neighbors.size() <= 3 && removeDegree <= 3);
+    };
 
-        // Average and normalize normals
-        normals[v1][0] = normals[v1][0] + normals[v2][0];
-        normals[v1][1] = normals[v1][1] + normals[v2][1];
-        normals[v1][2] = normals[v1][2] + normals[v2][2];
-        float nlen = std::sqrt(normals[v1][0]*normals[v1][0] +
-                               normals[v1][1]*normals[v1][1] +
-                               normals[v1][2]*normals[v1][2]);
-        if (nlen > 1e-6f) {
-            normals[v1][0] /= nlen;
-            normals[v1][1] /= nlen;
-            normals[v1][2] /= nlen;
+    // No remaining triangle around a moved point may flip or collapse to a sliver
+    auto keepsOrientation = [&](uint32_t moved, uint32_t other, const Vec3d& target) {
+        for (uint32_t k = points[moved].firstCorner; k != kNone; k = nextCorner(k)) {
+            const uint32_t ti = k / 3;
+            if (!triangleValid[ti]) continue;
+            const Corners& tri = tris[ti];
+            if (tri.points[0] == other || tri.points[1] == other || tri.points[2] == other) continue;
+            Vec3d p[3];
+            for (int c = 0; c < 3; ++c) p[c] = points[tri.points[c]].position;
+            const Vec3d before = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+            p[k % 3] = target;
+            const Vec3d after = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+            if (dot(before, after) <= kMinNormalCosine * std::sqrt(dot(before, before) * dot(after, after))) {
+                return false;
+            }
         }
+        return true;
+    };
 
-        // Union: v2 -> v1
-        parent[v2] = v1;
+    // ========== Edge collapse loop ==========
+    float maxError = 0.0f;
+    while (validTriCount > targetTriCount && !heap.Empty()) {
+        const auto [popped, e] = heap.Pop();
+        if (!edges[e].alive) continue;
 
-        // ========== Update only affected triangles ==========
-        // Collect triangles touching v1 or v2
-        affectedTriangles.clear();
-        for (uint32_t ti : vertexTriangles[v1]) {
-            if (triangleValid[ti]) affectedTriangles.push_back(ti);
+        // The key may be stale: neighbors' collapses raise costs without sifting. They may also
+        // have reshaped the fans, so the plan is worked out afresh; requeue if it got dearer.
+        if (costs[e] > popped) {
+            heap.Lower(e, costs[e]);
+            continue;
         }
-        for (uint32_t ti : vertexTriangles[v2]) {
-            if (triangleValid[ti]) affectedTriangles.push_back(ti);
+        const Collapse c = evaluate(e);
+        if (c.cost > popped) {
+            heap.Lower(e, c.cost);
+            continue;
         }
 
-        // Merge v2's triangle list into v1's
-        vertexTriangles[v1].insert(vertexTriangles[v1].end(),
-                                   vertexTriangles[v2].begin(),
-                                   vertexTriangles[v2].end());
-        vertexTriangles[v2].clear();
-        vertexTriangles[v2].shrink_to_fit();
+        if (!mapWedges(c.remove, c.keep) || !keepsManifold(c)) continue;
+        const bool keepMoves = c.position != points[c.keep].position;
+        if (!keepsOrientation(c.remove, c.keep, c.position) ||
+            (keepMoves && !keepsOrientation(c.keep, c.remove, c.position))) {
+            continue;
+        }
+        maxError = std::max(maxError, c.cost);
 
-        // Update affected triangles
-        for (uint32_t ti : affectedTriangles) {
-            if (!triangleValid[ti]) continue;
+        // ========== Collapse: remove -> keep ==========
+        for (const uint32_t ti : edgeTriangles) {
+            triangleValid[ti] = 0;
+            --validTriCount;
+        }
+        if (keepMoves) {
+            // Free points have one wedge each
+            const auto [from, to] = wedgeMap.front();
+            for (int k = 0; k < 2; ++k) {
+                texCoords[to][k] += (texCoords[from][k] - texCoords[to][k]) * c.t;
+            }
+        }
+        Point& keep = points[c.keep];
+        Point& remove = points[c.remove];
+        keep.position = c.position;
+        keep.quadric += remove.quadric;
+
+        // Unlink the kept point's dead triangles, then splice in the removed point's live ones
+        for (uint32_t* link = &keep.firstCorner; *link != kNone;) {
+            if (triangleValid[*link / 3]) link = &nextCorner(*link);
+            else *link = nextCorner(*link);
+        }
+        for (uint32_t k = remove.firstCorner; k != kNone;) {
+            const uint32_t next = nextCorner(k);
+            Corners& tri = tris[k / 3];
+            if (triangleValid[k / 3]) {
+                tri.points[k % 3] = c.keep;
+                tri.wedges[k % 3] = mappedWedge(tri.wedges[k % 3]);
+                tri.next[k % 3] = keep.firstCorner;
+                keep.firstCorner = k;
+            }
+            k = next;
+        }
+        remove.firstCorner = kNone;
 
-            Triangle& tri = m_triangles[ti];
-
-            // Remap all vertices to their roots
-            tri.indices[0] = findRoot(tri.indices[0]);
-            tri.indices[1] = findRoot(tri.indices[1]);
-            tri.indices[2] = findRoot(tri.indices[2]);
-
-            // Check for degenerate triangle
-            if (tri.indices[0] == tri.indices[1] ||
-                tri.indices[1] == tri.indices[2] ||
-                tri.indices[2] == tri.indices[0]) {
-                triangleValid[ti] = false;
-                --validTriCount;
-            } else {
-                // Add new edges involving v1 to queue
-                for (int e = 0; e < 3; ++e) {
-                    uint32_t ev1 = tri.indices[e];
-                    uint32_t ev2 = tri.indices[(e + 1) % 3];
-                    if (ev1 == v1 || ev2 == v1) {
-                        float edgeCost = calcEdgeCost(ev1, ev2);
-                        edgeQueue.push({edgeCost, ev1, ev2});
-                    }
+        // The removed point's edges move to the kept point, merging with the ones it already has
+        edges[e].alive = 0;
+        for (uint32_t* link = &keep.firstEdge; *link != kNone;) {
+            if (edges[*link].alive) link = &nextEdge(*link, c.keep);
+            else *link = nextEdge(*link, c.keep);
+        }
+        const uint32_t keepEdges = keep.firstEdge;
+        for (uint32_t f = remove.firstEdge; f != kNone;) {
+            Edge& edge = edges[f];
+            const int side = edge.points[1] == c.remove;
+            const uint32_t next = edge.next[side];
+            if (edge.alive) {
+                const uint32_t n = edge.points[1 - side];
+                uint32_t twin = keepEdges;
+                while (twin != kNone && otherPoint(twin, c.keep) != n) twin = nextEdge(twin, c.keep);
+                if (twin != kNone) {
+                    edges[twin].feature |= edge.feature;
+                    edge.alive = 0;
+                } else {
+                    edge.points[side] = c.keep;
+                    edge.next[side] = keep.firstEdge;
+                    keep.firstEdge = f;
                 }
             }
+            f = next;
+        }
+        remove.firstEdge = kNone;
+
+        for (uint32_t f = keep.firstEdge; f != kNone; f = nextEdge(f, c.keep)) {
+            heap.Lower(f, evaluate(f).cost);
         }
     }
 
     // ========== Rebuild mesh with valid triangles ==========
-    std::unordered_map<uint32_t, uint32_t> usedVertices;
-    usedVertices.reserve(numVertices / 4);
+    std::vector<uint32_t> newIndex(numVertices, kNone);
     std::vector<Vertex> newVertices;
     newVertices.reserve(numVertices / 4);
     std::vector<Triangle> newTriangles;
@@ -647,36 +1123,22 @@ void Mesh::Decimate(float targetRatio) {
 
         Triangle newTri;
         newTri.materialIndex = m_triangles[ti].materialIndex;
-
         for (int i = 0; i < 3; ++i) {
-            uint32_t oldIdx = findRoot(m_triangles[ti].indices[i]);
-
-            auto it = usedVertices.find(oldIdx);
-            if (it == usedVertices.end()) {
-                uint32_t newIdx = static_cast<uint32_t>(newVertices.size());
-                usedVertices[oldIdx] = newIdx;
-
-                Vertex v;
+            const uint32_t oldIdx = tris[ti].wedges[i];
+            if (newIndex[oldIdx] == kNone) {
+                newIndex[oldIdx] = static_cast<uint32_t>(newVertices.size());
+                const Vec3d& p = points[tris[ti].points[i]].position;
+                Vertex v{};
                 // Rebuild TriVector position (x=e032, y=e013, z=e021, w=e123=1)
-                v.position = TriVector(positions[oldIdx][0], positions[oldIdx][1], positions[oldIdx][2]);
-                // Rebuild Vector normal (e0=0, e1=nx, e2=ny, e3=nz)
-                v.normal = Vector(0.0f, normals[oldIdx][0], normals[oldIdx][1], normals[oldIdx][2]);
-                v.texCoord[0] = m_vertices[oldIdx].texCoord[0];
-                v.texCoord[1] = m_vertices[oldIdx].texCoord[1];
+                v.position = TriVector(static_cast<float>(p[0] + center[0]), static_cast<float>(p[1] + center[1]),
+                                       static_cast<float>(p[2] + center[2]));
+                v.texCoord[0] = texCoords[oldIdx][0];
+                v.texCoord[1] = texCoords[oldIdx][1];
                 newVertices.push_back(v);
-
-                newTri.indices[i] = newIdx;
-            } else {
-                newTri.indices[i] = it->second;
             }
+            newTri.indices[i] = newIndex[oldIdx];
         }
-
-        // Final degenerate check
-        if (newTri.indices[0] != newTri.indices[1] &&
-            newTri.indices[1] != newTri.indices[2] &&
-            newTri.indices[2] != newTri.indices[0]) {
-            newTriangles.push_back(newTri);
-        }
+        newTriangles.push_back(newTri);
     }
 
     m_vertices = std::move(newVertices);
@@ -685,8 +1147,32 @@ void Mesh::Decimate(float targetRatio) {
     // Recompute normals for smooth shading
     ComputeNormals();
 
-    std::cout << "Decimation complete: " << m_vertices.size() << " vertices, "
-              << m_triangles.size() << " triangles" << std::endl;
+    return std::sqrt(maxError);
+}
+
+void Mesh::BuildShadowProxy(float ratio) {
+    if (Empty()) {
+        throw std::runtime_error("Cannot build a shadow proxy of a mesh without CPU data");
+    }
+
+    // Shadow rays only need the shape: without texture coordinates or materials, nothing but
+    // open borders holds the decimation back
+    auto proxy = std::make_unique<Mesh>();
+    proxy->m_vertices.resize(m_vertices.size());
+    for (size_t i = 0; i < m_vertices.size(); ++i) {
+        proxy->m_vertices[i].position = m_vertices[i].position;
+    }
+    proxy->m_triangles = m_triangles;
+    for (Triangle& tri : proxy->m_triangles) tri.materialIndex = 0;
+    proxy->Decimate(ratio);
+    proxy->BuildBVH();
+
+    float error = 0.0f;
+    for (const Vertex& v : m_vertices) {
+        error = std::max(error, proxy->DistanceToSurface(v.position));
+    }
+    m_shadowProxyError = error;
+    m_shadowProxy = std::move(proxy);
 }
 
 void Mesh::ComputePhysicsData() {
@@ -813,6 +1299,7 @@ void Mesh::BuildBVH() {
         m_triCentroids[i * 3 + 2] = (v0.position.e021() + v1.position.e021() + v2.position.e021()) / 3.0f;
     }
 
+    m_degenerateTriangleCount = degenerateCount;
     if (degenerateCount > 0) {
         std::cerr << "WARNING: Found " << degenerateCount << " degenerate triangles (zero area)" << std::endl;
     }
@@ -988,3 +1475,301 @@ void Mesh::subdivideNode(uint32_t nodeIdx) {
     subdivideNode(leftChildIdx);
     subdivideNode(leftChildIdx + 1);
 }
+
+// === BVH Analysis ===
+
+namespace {
+
+float boxArea(const float minB[3], const float maxB[3]) noexcept {
+    const float dx = std::max(0.0f, maxB[0] - minB[0]);
+    const float dy = std::max(0.0f, maxB[1] - minB[1]);
+    const float dz = std::max(0.0f, maxB[2] - minB[2]);
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+// Same slab test as intersectAABB in intersections.glsl
+bool rayHitsBox(const float origin[3], const float invDir[3], const float minB[3], const float maxB[3],
+                float tMax) noexcept {
+    float enter = -1e30f;
+    float exit = 1e30f;
+    for (int a = 0; a < 3; ++a) {
+        const float t0 = (minB[a] - origin[a]) * invDir[a];
+        const float t1 = (maxB[a] - origin[a]) * invDir[a];
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    }
+    return enter <= exit && exit >= 0.0f && enter < tMax;
+}
+
+// Same Moller-Trumbore test as intersectTriangle in intersections.glsl
+bool rayHitsTriangle(const float origin[3], const float dir[3],
+                     const TriVector& p0, const TriVector& p1, const TriVector& p2, float& t) noexcept {
+    constexpr float epsilon = 0.0001f;
+    const float v0[3] = {p0.e032(), p0.e013(), p0.e021()};
+    const float e1[3] = {p1.e032() - v0[0], p1.e013() - v0[1], p1.e021() - v0[2]};
+    const float e2[3] = {p2.e032() - v0[0], p2.e013() - v0[1], p2.e021() - v0[2]};
+
+    const float h[3] = {dir[1] * e2[2] - dir[2] * e2[1], dir[2] * e2[0] - dir[0] * e2[2], dir[0] * e2[1] - dir[1] * e2[0]};
+    const float a = e1[0] * h[0] + e1[1] * h[1] + e1[2] * h[2];
+    if (std::abs(a) < epsilon) return false;
+
+    const float f = 1.0f / a;
+    const float sv[3] = {origin[0] - v0[0], origin[1] - v0[1], origin[2] - v0[2]};
+    const float u = f * (sv[0] * h[0] + sv[1] * h[1] + sv[2] * h[2]);
+    if (u < 0.0f || u > 1.0f) return false;
+
+    const float q[3] = {sv[1] * e1[2] - sv[2] * e1[1], sv[2] * e1[0] - sv[0] * e1[2], sv[0] * e1[1] - sv[1] * e1[0]};
+    const float v = f * (dir[0] * q[0] + dir[1] * q[1] + dir[2] * q[2]);
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    const float tHit = f * (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]);
+    if (tHit > epsilon && tHit < t) {
+        t = tHit;
+        return true;
+    }
+    return false;
+}
+
+float pointBoxDistanceSquared(const float p[3], const float minB[3], const float maxB[3]) noexcept {
+    float distance = 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        const float d = std::max({minB[a] - p[a], 0.0f, p[a] - maxB[a]});
+        distance += d * d;
+    }
+    return distance;
+}
+
+// Closest point on a triangle by Voronoi region (Ericson, Real-Time Collision Detection 5.1.5)
+float pointTriangleDistanceSquared(const float p[3], const TriVector& p0, const TriVector& p1,
+                                   const TriVector& p2) noexcept {
+    using Vec3 = std::array<float, 3>;
+    const Vec3 a{p0.e032(), p0.e013(), p0.e021()};
+    const Vec3 b{p1.e032(), p1.e013(), p1.e021()};
+    const Vec3 c{p2.e032(), p2.e013(), p2.e021()};
+    auto sub = [](const Vec3& u, const Vec3& v) { return Vec3{u[0] - v[0], u[1] - v[1], u[2] - v[2]}; };
+    auto dot = [](const Vec3& u, const Vec3& v) { return u[0] * v[0] + u[1] * v[1] + u[2] * v[2]; };
+    auto distanceTo = [&](const Vec3& q) {
+        const Vec3 d{p[0] - q[0], p[1] - q[1], p[2] - q[2]};
+        return dot(d, d);
+    };
+    auto along = [](const Vec3& from, const Vec3& edge, float t) {
+        return Vec3{from[0] + edge[0] * t, from[1] + edge[1] * t, from[2] + edge[2] * t};
+    };
+
+    const Vec3 point{p[0], p[1], p[2]};
+    const Vec3 ab = sub(b, a), ac = sub(c, a), ap = sub(point, a);
+    const float d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return distanceTo(a);
+
+    const Vec3 bp = sub(point, b);
+    const float d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) return distanceTo(b);
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return distanceTo(along(a, ab, d1 / (d1 - d3)));
+
+    const Vec3 cp = sub(point, c);
+    const float d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) return distanceTo(c);
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return distanceTo(along(a, ac, d2 / (d2 - d6)));
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+        return distanceTo(along(b, sub(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+    }
+
+    // Inside the face; degenerate triangles fall back to their corners
+    const float denominator = va + vb + vc;
+    if (!(std::abs(denominator) > 0.0f)) return std::min({distanceTo(a), distanceTo(b), distanceTo(c)});
+    const float v = vb / denominator;
+    const float w = vc / denominator;
+    return distanceTo(along(along(a, ab, v), ac, w));
+}
+
+} // namespace
+
+float Mesh::DistanceToSurface(const TriVector& point) const {
+    if (m_bvhNodes.empty()) return std::numeric_limits<float>::infinity();
+
+    const float p[3] = {point.e032(), point.e013(), point.e021()};
+    float best = std::numeric_limits<float>::infinity();
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty()) {
+        const Scene::BVHNode& node = m_bvhNodes[stack.back()];
+        stack.pop_back();
+        if (pointBoxDistanceSquared(p, node.minBounds, node.maxBounds) >= best) continue;
+
+        if (node.triCount > 0) {
+            for (int32_t i = 0; i < node.triCount; ++i) {
+                const Triangle& tri = m_triangles[m_bvhTriIndices[node.leftFirst + i]];
+                best = std::min(best, pointTriangleDistanceSquared(p, m_vertices[tri.indices[0]].position,
+                                                                   m_vertices[tri.indices[1]].position,
+                                                                   m_vertices[tri.indices[2]].position));
+            }
+            continue;
+        }
+        // Nearer child last, so it is searched first and prunes the other
+        const auto left = static_cast<uint32_t>(node.leftFirst);
+        const float leftDistance = pointBoxDistanceSquared(p, m_bvhNodes[left].minBounds, m_bvhNodes[left].maxBounds);
+        const float rightDistance = pointBoxDistanceSquared(p, m_bvhNodes[left + 1].minBounds, m_bvhNodes[left + 1].maxBounds);
+        if (leftDistance < rightDistance) {
+            stack.push_back(left + 1);
+            stack.push_back(left);
+        } else {
+            stack.push_back(left);
+            stack.push_back(left + 1);
+        }
+    }
+    return std::sqrt(best);
+}
+
+Mesh::BVHStats Mesh::AnalyzeBVH(size_t rayCount, uint32_t seed) const {
+    BVHStats stats;
+    stats.triangleCount = m_bvhTriIndices.size();
+    stats.nodeCount = m_bvhNodes.size();
+    stats.nodeBound = stats.triangleCount > 0 ? stats.triangleCount * 2 - 1 : 0;
+    stats.degenerateTriangles = m_degenerateTriangleCount;
+    if (m_bvhNodes.empty()) return stats;
+
+    const Scene::BVHNode& root = m_bvhNodes[0];
+    const float rootArea = boxArea(root.minBounds, root.maxBounds);
+    const float invRootArea = rootArea > 0.0f ? 1.0f / rootArea : 0.0f;
+
+    // Depth-first walk for structural metrics
+    struct Entry { uint32_t node; uint32_t depth; };
+    std::vector<Entry> stack{{0, 0}};
+    uint64_t leafDepthSum = 0;
+    size_t internalCount = 0;
+    double overlapSum = 0.0;
+    double sah = 0.0;
+
+    while (!stack.empty()) {
+        const Entry entry = stack.back();
+        stack.pop_back();
+        const Scene::BVHNode& node = m_bvhNodes[entry.node];
+        const float area = boxArea(node.minBounds, node.maxBounds) * invRootArea;
+        stats.maxDepth = std::max(stats.maxDepth, entry.depth);
+
+        if (node.triCount > 0) {
+            const auto size = static_cast<uint32_t>(node.triCount);
+            ++stats.leafCount;
+            leafDepthSum += entry.depth;
+            stats.maxLeafSize = std::max(stats.maxLeafSize, size);
+            if (stats.leafSizeHistogram.size() <= size) {
+                stats.leafSizeHistogram.resize(size + 1, 0);
+            }
+            ++stats.leafSizeHistogram[size];
+            sah += kSAHIntersectionCost * area * size;
+            continue;
+        }
+
+        ++internalCount;
+        sah += kSAHTraversalCost * area;
+
+        const Scene::BVHNode& left = m_bvhNodes[node.leftFirst];
+        const Scene::BVHNode& right = m_bvhNodes[node.leftFirst + 1];
+        float overlapMin[3];
+        float overlapMax[3];
+        for (int a = 0; a < 3; ++a) {
+            overlapMin[a] = std::max(left.minBounds[a], right.minBounds[a]);
+            overlapMax[a] = std::min(left.maxBounds[a], right.maxBounds[a]);
+        }
+        const float parentArea = boxArea(node.minBounds, node.maxBounds);
+        if (parentArea > 0.0f) {
+            overlapSum += boxArea(overlapMin, overlapMax) / parentArea;
+        }
+
+        stack.push_back({static_cast<uint32_t>(node.leftFirst) + 1, entry.depth + 1});
+        stack.push_back({static_cast<uint32_t>(node.leftFirst), entry.depth + 1});
+    }
+
+    stats.sahCost = static_cast<float>(sah);
+    stats.averageLeafDepth = stats.leafCount > 0 ? static_cast<float>(leafDepthSum) / stats.leafCount : 0.0f;
+    stats.averageLeafSize = stats.leafCount > 0 ? static_cast<float>(stats.triangleCount) / stats.leafCount : 0.0f;
+    stats.siblingOverlap = internalCount > 0 ? static_cast<float>(overlapSum / internalCount) : 0.0f;
+
+    if (rayCount == 0 || m_triangles.empty() || m_vertices.empty()) return stats;
+
+    // Rays start on a sphere around the bounds and aim at a random point inside them
+    float center[3];
+    float radius = 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        center[a] = (root.minBounds[a] + root.maxBounds[a]) * 0.5f;
+        const float half = (root.maxBounds[a] - root.minBounds[a]) * 0.5f;
+        radius += half * half;
+    }
+    radius = std::max(std::sqrt(radius) * 2.0f, 1e-3f);
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    size_t hits = 0;
+    uint64_t nodesVisited = 0;
+    uint64_t trianglesTested = 0;
+    uint32_t maxVisited = 0;
+    std::vector<int32_t> traversal;
+    traversal.reserve(kTraversalStackSize);
+
+    for (size_t r = 0; r < rayCount; ++r) {
+        float origin[3];
+        float target[3];
+        float onSphere[3];
+        for (int a = 0; a < 3; ++a) onSphere[a] = normal(rng);
+        const float len = std::max(std::sqrt(onSphere[0] * onSphere[0] + onSphere[1] * onSphere[1] +
+                                             onSphere[2] * onSphere[2]), 1e-6f);
+        for (int a = 0; a < 3; ++a) {
+            origin[a] = center[a] + onSphere[a] / len * radius;
+        }
+        for (int a = 0; a < 3; ++a) {
+            target[a] = root.minBounds[a] + unit(rng) * (root.maxBounds[a] - root.minBounds[a]);
+        }
+
+        float dir[3] = {target[0] - origin[0], target[1] - origin[1], target[2] - origin[2]};
+        const float dirLen = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+        float invDir[3];
+        for (int a = 0; a < 3; ++a) {
+            dir[a] /= dirLen;
+            invDir[a] = std::abs(dir[a]) > 1e-8f ? 1.0f / dir[a] : std::copysign(1e8f, dir[a]);
+        }
+
+        // Same order and stack limit as traverseBVH
+        float tMax = 1e6f;
+        bool hit = false;
+        uint32_t visited = 0;
+        traversal.clear();
+        traversal.push_back(0);
+        while (!traversal.empty()) {
+            const Scene::BVHNode& node = m_bvhNodes[traversal.back()];
+            traversal.pop_back();
+            ++visited;
+            if (!rayHitsBox(origin, invDir, node.minBounds, node.maxBounds, tMax)) continue;
+
+            if (node.triCount > 0) {
+                for (int32_t i = 0; i < node.triCount; ++i) {
+                    const Triangle& tri = m_triangles[m_bvhTriIndices[node.leftFirst + i]];
+                    ++trianglesTested;
+                    hit |= rayHitsTriangle(origin, dir, m_vertices[tri.indices[0]].position,
+                                           m_vertices[tri.indices[1]].position,
+                                           m_vertices[tri.indices[2]].position, tMax);
+                }
+            } else if (traversal.size() < kTraversalStackSize - 1) {
+                traversal.push_back(node.leftFirst + 1);
+                traversal.push_back(node.leftFirst);
+            }
+        }
+
+        hits += hit ? 1 : 0;
+        nodesVisited += visited;
+        maxVisited = std::max(maxVisited, visited);
+    }
+
+    stats.sampledRays = rayCount;
+    stats.hitRatio = static_cast<float>(hits) / static_cast<float>(rayCount);
+    stats.averageNodesVisited = static_cast<float>(nodesVisited) / static_cast<float>(rayCount);
+    stats.averageTrianglesTested = static_cast<float>(trianglesTested) / static_cast<float>(rayCount);
+    stats.maxNodesVisited = maxVisited;
+    return stats;
+}
@@ -0,0 +1,141 @@
+#include "MeshLod.h"
+#include "MotorTransforms.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace MeshLod {
+
+namespace {
+
+std::unique_ptr<Mesh> decimatedCopy(const Mesh& mesh, float ratio) {
+    auto level = std::make_unique<Mesh>();
+    level->SetVertices(std::vector<Vertex>(mesh.Vertices()));
+    level->SetTriangles(std::vector<Triangle>(mesh.Triangles()));
+    for (const auto& material : mesh.Materials()) {
+        level->AddMaterial(material);
+    }
+    level->Decimate(ratio);
+    level->BuildBVH();
+    return level;
+}
+
+} // namespace
+
+std::vector<std::unique_ptr<Mesh>> GenerateLevels(const Mesh& mesh, std::span<const float> ratios) {
+    if (mesh.Empty()) {
+        throw std::invalid_argument("Cannot generate LODs of a mesh without CPU data");
+    }
+
+    std::vector<float> reducedRatios;
+    for (const float ratio : ratios) {
+        if (ratio < 1.0f) reducedRatios.push_back(ratio);
+    }
+
+    // Every level decimates the base mesh independently; the mesh is only read
+    std::vector<std::unique_ptr<Mesh>> levels(reducedRatios.size());
+    WorkerPool::Shared().ParallelFor(reducedRatios.size(), [&](size_t k) {
+        levels[k] = decimatedCopy(mesh, reducedRatios[k]);
+    });
+    return levels;
+}
+
+float MaxScreenSize(float ratio) noexcept {
+    return kFullDetailScreenSize * std::sqrt(std::clamp(ratio, 0.0f, 1.0f));
+}
+
+void LodTable::Add(std::span<const uint32_t> levels, std::span<const float> ratios, const Scene::BVHNode& bounds) {
+    if (levels.empty() || levels.size() != ratios.size()) {
+        throw std::invalid_argument("LOD chain needs one ratio per level");
+    }
+
+    Chain chain;
+    chain.meshes.assign(levels.begin(), levels.end());
+    chain.maxScreenSizes.push_back(std::numeric_limits<float>::infinity());
+    for (size_t k = 1; k < ratios.size(); ++k) {
+        chain.maxScreenSizes.push_back(MaxScreenSize(ratios[k]));
+    }
+    if (bounds.minBounds[0] <= bounds.maxBounds[0]) {
+        float radiusSquared = 0.0f;
+        for (int a = 0; a < 3; ++a) {
+            chain.center[a] = (bounds.minBounds[a] + bounds.maxBounds[a]) * 0.5f;
+            const float half = (bounds.maxBounds[a] - bounds.minBounds[a]) * 0.5f;
+            radiusSquared += half * half;
+        }
+        chain.radius = std::sqrt(radiusSquared);
+    }
+
+    const uint32_t baseMesh = levels[0];
+    if (baseMesh >= m_chainOfMesh.size()) {
+        m_chainOfMesh.resize(baseMesh + 1, kNoChain);
+    }
+    if (m_chainOfMesh[baseMesh] != kNoChain) {
+        m_chains[m_chainOfMesh[baseMesh]] = std::move(chain);
+        return;
+    }
+    m_chainOfMesh[baseMesh] = static_cast<uint32_t>(m_chains.size());
+    m_chains.push_back(std::move(chain));
+}
+
+InstanceRange SelectLevels(const LodTable& table, InstanceArrays& instances, const float cameraPosition[3],
+                           float fovDegrees, float hysteresis, std::vector<uint8_t>& levels) {
+    const size_t count = instances.Size();
+    levels.resize(count, 0);
+
+    // Sphere diameter over the screen height at its distance: 2r / (2 * d * tan(fov / 2))
+    const float invTanHalfFov = 1.0f / std::tan(fovDegrees * 0.5f * 3.14159265f / 180.0f);
+    const float coarser = 1.0f - hysteresis;
+    const float finer = 1.0f + hysteresis;
+
+    InstanceRange changed;
+    for (size_t i = 0; i < count; ++i) {
+        const Chain* chain = table.Find(instances.meshIds[i]);
+        if (!chain) continue;
+
+        // World center = scale * R * center + t, as in InstanceCulling::ComputeWorldBounds
+        const auto rigid = MotorTransforms::RigidTransform::FromMotor(instances.transforms[i]);
+        const auto& r = rigid.rotation;
+        const float scale = instances.scales[i];
+        float distanceSquared = 0.0f;
+        for (int a = 0; a < 3; ++a) {
+            const float world = scale * (r[a][0] * chain->center[0] + r[a][1] * chain->center[1] +
+                                         r[a][2] * chain->center[2]) + rigid.translation[a];
+            const float d = world - cameraPosition[a];
+            distanceSquared += d * d;
+        }
+        const float radius = std::abs(scale) * chain->radius;
+        const float distance = std::sqrt(distanceSquared);
+        const float screenSize = distance > radius ? radius * invTanHalfFov / distance
+                                                   : std::numeric_limits<float>::infinity();
+
+        // Step from the previous level, past boundaries by the hysteresis margin only
+        const auto levelCount = static_cast<uint32_t>(chain->meshes.size());
+        uint32_t level = std::min<uint32_t>(levels[i], levelCount - 1);
+        while (level + 1 < levelCount && screenSize < chain->maxScreenSizes[level + 1] * coarser) {
+            ++level;
+        }
+        while (level > 0 && screenSize > chain->maxScreenSizes[level] * finer) {
+            --level;
+        }
+
+        instances.meshIds[i] = chain->meshes[level];
+        if (level != levels[i]) {
+            levels[i] = static_cast<uint8_t>(level);
+            const auto index = static_cast<uint32_t>(i);
+            changed.Merge({index, index + 1});
+        }
+    }
+    return changed;
+}
+
+void RemoveInstance(std::vector<uint8_t>& levels, uint32_t denseIndex, uint32_t instanceCount) noexcept {
+    // Instances added since the last selection have no history yet, as in SelectLevels
+    if (denseIndex < levels.size()) {
+        levels[denseIndex] = instanceCount < levels.size() ? levels[instanceCount] : 0;
+    }
+    if (levels.size() > instanceCount) levels.resize(instanceCount);
+}
+
+} // namespace MeshLod
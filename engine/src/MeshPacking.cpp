@@ -0,0 +1,312 @@
+#include "MeshPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace MeshPacking {
+
+VertexQuantization ComputeQuantization(const Mesh& mesh) noexcept {
+    const auto& vertices = mesh.Vertices();
+    if (vertices.empty()) return VertexQuantization{};
+
+    float minBounds[3] = {1e30f, 1e30f, 1e30f};
+    float maxBounds[3] = {-1e30f, -1e30f, -1e30f};
+    for (const auto& v : vertices) {
+        const float p[3] = {v.position.e032(), v.position.e013(), v.position.e021()};
+        for (int a = 0; a < 3; ++a) {
+            minBounds[a] = std::min(minBounds[a], p[a]);
+            maxBounds[a] = std::max(maxBounds[a], p[a]);
+        }
+    }
+    return VertexQuantization::FromBounds(minBounds, maxBounds);
+}
+
+CompactVertexError MeasureCompactVertexError(const Mesh& mesh) {
+    CompactVertexError error;
+    const auto& vertices = mesh.Vertices();
+    if (vertices.empty()) return error;
+
+    const VertexQuantization quantization = ComputeQuantization(mesh);
+    float diagonal = 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        const float extent = quantization.scale[a] * VertexQuantization::kMaxValue;
+        diagonal += extent * extent;
+    }
+    diagonal = std::sqrt(diagonal);
+
+    float minNormalCos = 1.0f;
+    for (const auto& v : vertices) {
+        const GPUCompactVertex packed = v.ToGPU(quantization);
+
+        const float position[3] = {v.position.e032(), v.position.e013(), v.position.e021()};
+        float positionError = 0.0f;
+        for (int a = 0; a < 3; ++a) {
+            const float d = quantization.Decode(a, packed.pos[a]) - position[a];
+            positionError += d * d;
+        }
+        error.maxPositionError = std::max(error.maxPositionError, std::sqrt(positionError));
+
+        const float normal[3] = {v.normal.e1(), v.normal.e2(), v.normal.e3()};
+        const float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (normalLength > 0.0f) {
+            float decoded[3];
+            VertexPacking::UnpackOctahedral(packed.normal, decoded);
+            const float cosAngle = (normal[0] * decoded[0] + normal[1] * decoded[1] + normal[2] * decoded[2]) / normalLength;
+            minNormalCos = std::min(minNormalCos, cosAngle);
+        }
+
+        for (int c = 0; c < 2; ++c) {
+            const auto half = static_cast<uint16_t>(packed.texCoord >> (16 * c));
+            const float d = std::abs(VertexPacking::HalfToFloat(half) - v.texCoord[c]);
+            error.maxTexCoordError = std::max(error.maxTexCoordError, d);
+        }
+    }
+
+    constexpr float radToDeg = 57.29577951308232f;
+    error.maxNormalErrorDegrees = std::acos(std::clamp(minNormalCos, -1.0f, 1.0f)) * radToDeg;
+    error.relativePositionError = diagonal > 0.0f ? error.maxPositionError / diagonal : 0.0f;
+    return error;
+}
+
+namespace {
+
+// Diagonal of the mesh's bounds, from its BVH root
+float boundsDiagonal(const Mesh& mesh) noexcept {
+    if (mesh.BVHNodes().empty()) return 0.0f;
+    const Scene::BVHNode& root = mesh.BVHNodes().front();
+    float diagonal = 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        const float extent = std::max(root.maxBounds[a] - root.minBounds[a], 0.0f);
+        diagonal += extent * extent;
+    }
+    return std::sqrt(diagonal);
+}
+
+} // namespace
+
+const Mesh* UsableShadowProxy(const Mesh& mesh, float tolerance) noexcept {
+    const Mesh* proxy = mesh.ShadowProxy();
+    if (!proxy || proxy->Empty() || proxy->BVHNodes().empty() || tolerance < 0.0f) return nullptr;
+    return mesh.ShadowProxyError() <= tolerance * boundsDiagonal(mesh) ? proxy : nullptr;
+}
+
+PackedMeshes PackMeshes(const std::vector<std::unique_ptr<Mesh>>& meshes, bool compactVertices,
+                        float shadowProxyTolerance) {
+    PackedMeshes packed;
+
+    // Shadow proxies go after all the meshes, so mesh IDs keep indexing meshInfos
+    struct ProxyOwner {
+        const Mesh* proxy;
+        uint32_t meshInfo;
+        uint32_t materialOffset;
+    };
+    std::vector<ProxyOwner> proxies;
+
+    // Size everything up front so the copy loops never reallocate
+    size_t totalVertices = 0;
+    size_t totalTriangles = 0;
+    size_t totalBvhNodes = 0;
+    size_t totalBvhTriIndices = 0;
+    size_t totalMaterials = 0;
+    size_t totalMeshes = 0;
+    for (const auto& mesh : meshes) {
+        if (!mesh) continue;
+        const Mesh* parts[] = {mesh.get(), UsableShadowProxy(*mesh, shadowProxyTolerance)};
+        for (const Mesh* part : parts) {
+            if (!part) continue;
+            totalVertices += part->VertexCount();
+            totalTriangles += part->TriangleCount();
+            totalBvhNodes += part->BVHNodes().size();
+            totalBvhTriIndices += part->BVHTriIndices().size();
+            ++totalMeshes;
+        }
+        totalMaterials += mesh->MaterialCount();
+    }
+    if (compactVertices) {
+        packed.compactVertices.reserve(totalVertices);
+    } else {
+        packed.vertices.reserve(totalVertices);
+    }
+    packed.triangles.reserve(totalTriangles);
+    packed.bvhNodes.reserve(totalBvhNodes);
+    packed.bvhTriIndices.reserve(totalBvhTriIndices);
+    packed.materials.reserve(totalMaterials);
+    packed.meshInfos.reserve(totalMeshes);
+
+    // Collect unique texture paths and map to indices
+    std::unordered_map<std::string, int32_t> texturePathToIndex;
+
+    uint32_t vertexOffset = 0;
+    uint32_t triangleOffset = 0;
+    uint32_t bvhNodeOffset = 0;
+    uint32_t bvhTriIdxOffset = 0;
+    uint32_t materialOffset = 0;
+
+    // Vertices, triangles and BVH of one mesh; its triangles index the materials at materialBase
+    auto appendGeometry = [&](const Mesh& mesh, uint32_t materialBase) {
+        Scene::GPUMeshInfo info{};
+        info.vertexOffset = vertexOffset;
+        info.triangleOffset = triangleOffset;
+        info.bvhNodeOffset = bvhNodeOffset;
+        info.bvhTriIdxOffset = bvhTriIdxOffset;
+        info.shadowMeshId = static_cast<uint32_t>(packed.meshInfos.size());
+
+        // Add vertices
+        const auto& vertices = mesh.Vertices();
+        float boundsPadding[3] = {0.0f, 0.0f, 0.0f};
+        if (compactVertices) {
+            const VertexQuantization quantization = ComputeQuantization(mesh);
+            for (int a = 0; a < 3; ++a) {
+                // Encoding rounds, so dequantized positions stray up to half a step from the
+                // float positions the BVH was built from; the rest covers float rounding in Decode
+                const float magnitude = std::abs(quantization.origin[a]) + quantization.scale[a] * VertexQuantization::kMaxValue;
+                boundsPadding[a] = 0.5f * quantization.scale[a] + 4.0f * std::numeric_limits<float>::epsilon() * magnitude;
+                info.quantOrigin[a] = quantization.origin[a];
+                info.quantScale[a] = quantization.scale[a];
+            }
+            for (const auto& v : vertices) {
+                packed.compactVertices.push_back(v.ToGPU(quantization));
+            }
+        } else {
+            for (const auto& v : vertices) {
+                packed.vertices.push_back(v.ToGPU());
+            }
+        }
+
+        // Add triangles with adjusted vertex AND material indices
+        const auto& triangles = mesh.Triangles();
+        for (const auto& tri : triangles) {
+            Triangle adjustedTri = tri;
+            adjustedTri.indices[0] += vertexOffset;
+            adjustedTri.indices[1] += vertexOffset;
+            adjustedTri.indices[2] += vertexOffset;
+            adjustedTri.materialIndex += materialBase;
+            packed.triangles.push_back(adjustedTri);
+        }
+        info.triangleCount = static_cast<uint32_t>(triangles.size());
+
+        // Add BVH nodes with adjusted child/triangle indices
+        const auto& bvhNodes = mesh.BVHNodes();
+        for (const auto& node : bvhNodes) {
+            Scene::BVHNode adjustedNode = node;
+            if (node.triCount > 0) {
+                // Leaf node: leftFirst is index into bvhTriIndices
+                adjustedNode.leftFirst += static_cast<int32_t>(bvhTriIdxOffset);
+            } else {
+                // Internal node: leftFirst is index of left child node
+                adjustedNode.leftFirst += static_cast<int32_t>(bvhNodeOffset);
+            }
+            for (int a = 0; a < 3; ++a) {
+                adjustedNode.minBounds[a] -= boundsPadding[a];
+                adjustedNode.maxBounds[a] += boundsPadding[a];
+            }
+            packed.bvhNodes.push_back(adjustedNode);
+        }
+        info.bvhNodeCount = static_cast<uint32_t>(bvhNodes.size());
+
+        // Add BVH triangle indices with adjusted triangle offsets
+        const auto& bvhTriIndices = mesh.BVHTriIndices();
+        for (uint32_t idx : bvhTriIndices) {
+            packed.bvhTriIndices.push_back(idx + triangleOffset);
+        }
+
+        // Update offsets for next mesh
+        vertexOffset += static_cast<uint32_t>(vertices.size());
+        triangleOffset += static_cast<uint32_t>(triangles.size());
+        bvhNodeOffset += static_cast<uint32_t>(bvhNodes.size());
+        bvhTriIdxOffset += static_cast<uint32_t>(bvhTriIndices.size());
+
+        packed.meshInfos.push_back(info);
+    };
+
+    for (const auto& mesh : meshes) {
+        if (!mesh) continue;
+
+        // Add materials and track texture indices
+        for (size_t i = 0; i < mesh->MaterialCount(); ++i) {
+            const auto& mat = mesh->GetMaterial(i);
+            Scene::GPUMaterial gpuMat = mat.ToGPU();
+
+            if (!mat.diffuseTexturePath.empty()) {
+                const auto [it, inserted] = texturePathToIndex.try_emplace(
+                    mat.diffuseTexturePath, static_cast<int32_t>(packed.texturePaths.size()));
+                if (inserted) {
+                    packed.texturePaths.push_back(mat.diffuseTexturePath);
+                }
+                gpuMat.diffuseTextureIndex = it->second;
+            } else {
+                gpuMat.diffuseTextureIndex = -1;
+            }
+
+            packed.materials.push_back(gpuMat);
+        }
+
+        if (const Mesh* proxy = UsableShadowProxy(*mesh, shadowProxyTolerance)) {
+            proxies.push_back({proxy, static_cast<uint32_t>(packed.meshInfos.size()), materialOffset});
+        }
+        appendGeometry(*mesh, materialOffset);
+        materialOffset += static_cast<uint32_t>(mesh->MaterialCount());
+    }
+
+    // Shadow rays never shade a proxy; its triangles all point at its mesh's first material
+    for (const auto& owner : proxies) {
+        packed.meshInfos[owner.meshInfo].shadowMeshId = static_cast<uint32_t>(packed.meshInfos.size());
+        appendGeometry(*owner.proxy, owner.materialOffset);
+    }
+    packed.shadowProxyCount = static_cast<uint32_t>(proxies.size());
+
+    // Ensure we have at least one mesh info entry and one material
+    if (packed.meshInfos.empty()) {
+        packed.meshInfos.push_back(Scene::GPUMeshInfo{});
+    }
+    if (packed.materials.empty()) {
+        Scene::GPUMaterial defaultMat{};
+        defaultMat.diffuse[0] = 0.8f;
+        defaultMat.diffuse[1] = 0.8f;
+        defaultMat.diffuse[2] = 0.8f;
+        defaultMat.shininess = 32.0f;
+        defaultMat.shadingMode = static_cast<int32_t>(Scene::ShadingMode::PBR);
+        defaultMat.diffuseTextureIndex = -1;
+        defaultMat.metalness = 0.0f;
+        defaultMat.roughness = 0.5f;
+        packed.materials.push_back(defaultMat);
+    }
+
+    return packed;
+}
+
+size_t LayoutTextures(std::span<const TexelSource> sources, std::vector<Scene::GPUTextureInfo>& infos) {
+    infos.clear();
+    infos.reserve(sources.size());
+    size_t words = 0;
+    uint32_t imageSlots = 0;
+    for (const auto& source : sources) {
+        Scene::GPUTextureInfo info{};
+        if (source.format == Scene::TextureFormat::SampledImage) {
+            info.offset = imageSlots++;
+        } else if (source.format != Scene::TextureFormat::Virtual) {
+            info.offset = static_cast<uint32_t>(words);
+        }
+        info.width = source.width;
+        info.height = source.height;
+        info.format = static_cast<uint32_t>(source.format);
+        infos.push_back(info);
+        words += static_cast<size_t>(source.width) * source.height * TexelWords(source.format);
+    }
+    return words;
+}
+
+void WriteTexels(std::span<const TexelSource> sources, std::span<const Scene::GPUTextureInfo> infos,
+                 void* dst) noexcept {
+    auto* words = static_cast<uint32_t*>(dst);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const auto& source = sources[i];
+        const size_t count = static_cast<size_t>(source.width) * source.height * TexelWords(source.format);
+        if (count == 0) continue;
+        std::memcpy(words + infos[i].offset, source.texels, count * sizeof(uint32_t));
+    }
+}
+
+} // namespace MeshPacking
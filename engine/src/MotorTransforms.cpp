@@ -0,0 +1,192 @@
+#include "MotorTransforms.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace MotorTransforms {
+
+namespace {
+
+// Rotate (x, y, z) and add w times the translation; w = 0 rotates a direction
+inline void apply(const RigidTransform& rt, float& x, float& y, float& z, float w) noexcept {
+    const float rx = rt.rotation[0][0] * x + rt.rotation[0][1] * y + rt.rotation[0][2] * z + rt.translation[0] * w;
+    const float ry = rt.rotation[1][0] * x + rt.rotation[1][1] * y + rt.rotation[1][2] * z + rt.translation[1] * w;
+    const float rz = rt.rotation[2][0] * x + rt.rotation[2][1] * y + rt.rotation[2][2] * z + rt.translation[2] * w;
+    x = rx;
+    y = ry;
+    z = rz;
+}
+
+// Plane: rotate the normal, then move it along itself by the translation
+inline void applyPlane(const RigidTransform& rt, Vector& plane) noexcept {
+    float nx = plane.e1();
+    float ny = plane.e2();
+    float nz = plane.e3();
+    apply(rt, nx, ny, nz, 0.0f);
+    plane.e0() -= nx * rt.translation[0] + ny * rt.translation[1] + nz * rt.translation[2];
+    plane.e1() = nx;
+    plane.e2() = ny;
+    plane.e3() = nz;
+}
+
+#if defined(__AVX2__)
+// apply() for eight lanes
+struct Matrix8 {
+    __m256 r[3][3];
+    __m256 t[3];
+
+    explicit Matrix8(const RigidTransform& rt) noexcept {
+        for (int row = 0; row < 3; ++row) {
+            for (int col = 0; col < 3; ++col) {
+                r[row][col] = _mm256_set1_ps(rt.rotation[row][col]);
+            }
+            t[row] = _mm256_set1_ps(rt.translation[row]);
+        }
+    }
+
+    void Apply(__m256& x, __m256& y, __m256& z, __m256 w) const noexcept {
+        __m256 out[3];
+        for (int row = 0; row < 3; ++row) {
+            out[row] = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(r[row][0], x), _mm256_mul_ps(r[row][1], y)),
+                _mm256_add_ps(_mm256_mul_ps(r[row][2], z), _mm256_mul_ps(t[row], w)));
+        }
+        x = out[0];
+        y = out[1];
+        z = out[2];
+    }
+};
+
+// Components go through the accessors into lanes and back, as FlyFish's storage order is not
+// assumed (see InstancePacking::pack8)
+void transformPoints8(const Matrix8& m, TriVector* points) noexcept {
+    alignas(32) float lanes[4][8];
+    for (int k = 0; k < 8; ++k) {
+        lanes[0][k] = points[k].e032();
+        lanes[1][k] = points[k].e013();
+        lanes[2][k] = points[k].e021();
+        lanes[3][k] = points[k].e123();
+    }
+    __m256 x = _mm256_load_ps(lanes[0]);
+    __m256 y = _mm256_load_ps(lanes[1]);
+    __m256 z = _mm256_load_ps(lanes[2]);
+    m.Apply(x, y, z, _mm256_load_ps(lanes[3]));
+    _mm256_store_ps(lanes[0], x);
+    _mm256_store_ps(lanes[1], y);
+    _mm256_store_ps(lanes[2], z);
+    for (int k = 0; k < 8; ++k) {
+        points[k].e032() = lanes[0][k];
+        points[k].e013() = lanes[1][k];
+        points[k].e021() = lanes[2][k];
+    }
+}
+
+void transformPlanes8(const Matrix8& m, Vector* planes) noexcept {
+    alignas(32) float lanes[4][8];
+    for (int k = 0; k < 8; ++k) {
+        lanes[0][k] = planes[k].e1();
+        lanes[1][k] = planes[k].e2();
+        lanes[2][k] = planes[k].e3();
+        lanes[3][k] = planes[k].e0();
+    }
+    __m256 x = _mm256_load_ps(lanes[0]);
+    __m256 y = _mm256_load_ps(lanes[1]);
+    __m256 z = _mm256_load_ps(lanes[2]);
+    m.Apply(x, y, z, _mm256_setzero_ps());
+    const __m256 shift = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m.t[0]), _mm256_mul_ps(y, m.t[1])),
+                                       _mm256_mul_ps(z, m.t[2]));
+    _mm256_store_ps(lanes[0], x);
+    _mm256_store_ps(lanes[1], y);
+    _mm256_store_ps(lanes[2], z);
+    _mm256_store_ps(lanes[3], _mm256_sub_ps(_mm256_load_ps(lanes[3]), shift));
+    for (int k = 0; k < 8; ++k) {
+        planes[k].e1() = lanes[0][k];
+        planes[k].e2() = lanes[1][k];
+        planes[k].e3() = lanes[2][k];
+        planes[k].e0() = lanes[3][k];
+    }
+}
+
+// Seven input columns: built with inserts rather than through a lane array, whose scalar
+// stores would stall the vector loads
+void transformVertices8(const Matrix8& m, Vertex* v) noexcept {
+    auto gather = [v](auto component) {
+        return _mm256_setr_ps(component(v[0]), component(v[1]), component(v[2]), component(v[3]),
+                              component(v[4]), component(v[5]), component(v[6]), component(v[7]));
+    };
+    __m256 px = gather([](const Vertex& x) { return x.position.e032(); });
+    __m256 py = gather([](const Vertex& x) { return x.position.e013(); });
+    __m256 pz = gather([](const Vertex& x) { return x.position.e021(); });
+    m.Apply(px, py, pz, gather([](const Vertex& x) { return x.position.e123(); }));
+    __m256 nx = gather([](const Vertex& x) { return x.normal.e1(); });
+    __m256 ny = gather([](const Vertex& x) { return x.normal.e2(); });
+    __m256 nz = gather([](const Vertex& x) { return x.normal.e3(); });
+    m.Apply(nx, ny, nz, _mm256_setzero_ps());
+
+    alignas(32) float lanes[6][8];
+    _mm256_store_ps(lanes[0], px);
+    _mm256_store_ps(lanes[1], py);
+    _mm256_store_ps(lanes[2], pz);
+    _mm256_store_ps(lanes[3], nx);
+    _mm256_store_ps(lanes[4], ny);
+    _mm256_store_ps(lanes[5], nz);
+    for (int k = 0; k < 8; ++k) {
+        v[k].position.e032() = lanes[0][k];
+        v[k].position.e013() = lanes[1][k];
+        v[k].position.e021() = lanes[2][k];
+        v[k].normal.e1() = lanes[3][k];
+        v[k].normal.e2() = lanes[4][k];
+        v[k].normal.e3() = lanes[5][k];
+    }
+}
+#endif
+
+} // namespace
+
+void TransformPoints(const Motor& motor, std::span<TriVector> points) {
+    const RigidTransform rt = RigidTransform::FromMotor(motor);
+    size_t i = 0;
+#if defined(__AVX2__)
+    const Matrix8 m(rt);
+    for (; i + 8 <= points.size(); i += 8) {
+        transformPoints8(m, points.data() + i);
+    }
+#endif
+    for (; i < points.size(); ++i) {
+        TriVector& p = points[i];
+        apply(rt, p.e032(), p.e013(), p.e021(), p.e123());
+    }
+}
+
+void TransformPlanes(const Motor& motor, std::span<Vector> planes) {
+    const RigidTransform rt = RigidTransform::FromMotor(motor);
+    size_t i = 0;
+#if defined(__AVX2__)
+    const Matrix8 m(rt);
+    for (; i + 8 <= planes.size(); i += 8) {
+        transformPlanes8(m, planes.data() + i);
+    }
+#endif
+    for (; i < planes.size(); ++i) {
+        applyPlane(rt, planes[i]);
+    }
+}
+
+void TransformVertices(const Motor& motor, std::span<Vertex> vertices) {
+    const RigidTransform rt = RigidTransform::FromMotor(motor);
+    size_t i = 0;
+#if defined(__AVX2__)
+    const Matrix8 m(rt);
+    for (; i + 8 <= vertices.size(); i += 8) {
+        transformVertices8(m, vertices.data() + i);
+    }
+#endif
+    for (; i < vertices.size(); ++i) {
+        Vertex& v = vertices[i];
+        apply(rt, v.position.e032(), v.position.e013(), v.position.e021(), v.position.e123());
+        apply(rt, v.normal.e1(), v.normal.e2(), v.normal.e3(), 0.0f);
+    }
+}
+
+} // namespace MotorTransforms
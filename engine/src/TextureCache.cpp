@@ -0,0 +1,354 @@
+#include "TextureCache.h"
+#include "TextureMips.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace TextureCache {
+
+namespace {
+
+// White texel standing in for textures that cannot be loaded
+constexpr uint8_t whiteTexel[4] = {255, 255, 255, 255};
+
+// A read-only mapping of a whole file
+class MappedFile {
+public:
+    // Null for missing and empty files
+    static std::shared_ptr<const MappedFile> Open(const std::filesystem::path& path) {
+        auto file = std::make_shared<MappedFile>();
+#if defined(_WIN32)
+        file->m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file->m_file == INVALID_HANDLE_VALUE) return nullptr;
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file->m_file, &size) || size.QuadPart == 0) return nullptr;
+        file->m_mapping = CreateFileMappingW(file->m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!file->m_mapping) return nullptr;
+        file->m_data = MapViewOfFile(file->m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!file->m_data) return nullptr;
+        file->m_size = static_cast<size_t>(size.QuadPart);
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            close(fd);
+            return nullptr;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);  // The mapping keeps the file open
+        if (data == MAP_FAILED) return nullptr;
+        file->m_data = data;
+        file->m_size = static_cast<size_t>(info.st_size);
+#endif
+        return file;
+    }
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+        if (m_data) munmap(m_data, m_size);
+#endif
+    }
+
+    [[nodiscard]] std::span<const std::byte> Bytes() const noexcept {
+        return {static_cast<const std::byte*>(m_data), m_size};
+    }
+
+private:
+#if defined(_WIN32)
+    HANDLE m_file{INVALID_HANDLE_VALUE};
+    HANDLE m_mapping{nullptr};
+#endif
+    void* m_data{nullptr};
+    size_t m_size{0};
+};
+
+bool sameContents(const MappedFile* a, const MappedFile* b) noexcept {
+    if (!a || !b) return a == b;
+    const auto bytesA = a->Bytes();
+    const auto bytesB = b->Bytes();
+    return bytesA.size() == bytesB.size() && std::memcmp(bytesA.data(), bytesB.data(), bytesA.size()) == 0;
+}
+
+// Header of a cache file; the texels follow it, 32-byte aligned in the mapping
+struct CacheHeader {
+    uint32_t magic{kCacheMagic};
+    uint32_t version{kCacheVersion};
+    uint64_t contentHash{0};
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t format{0};       // Scene::TextureFormat
+    uint32_t hasMipChain{0};
+    uint64_t encodedSize{0};  // Bytes of the encoded file, checked along with the hash
+    uint64_t reserved[3]{};
+
+    static constexpr uint32_t kCacheMagic = 0x43585446;  // "FTXC"
+    static constexpr uint32_t kCacheVersion = 2;
+};
+static_assert(sizeof(CacheHeader) == 64);
+
+size_t texelBytes(Scene::TextureFormat format, uint32_t width, uint32_t height, bool mipChain) {
+    if (mipChain) {
+        return TextureMips::ChainTexels(TextureMips::LayoutMipChain(width, height)) * 4;
+    }
+    return static_cast<size_t>(width) * height * MeshPacking::TexelWords(format) * sizeof(uint32_t);
+}
+
+std::filesystem::path cachePath(const std::string& directory, uint64_t contentHash) {
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.ftex", static_cast<unsigned long long>(contentHash));
+    return std::filesystem::path(directory) / name;
+}
+
+// A cache entry for contentHash, if there is a valid one for a file of encodedSize bytes that
+// has mips when they are needed
+bool readCached(const std::string& directory, uint64_t contentHash, uint64_t encodedSize, bool needMips,
+                Texture& texture) {
+    auto file = MappedFile::Open(cachePath(directory, contentHash));
+    if (!file || file->Bytes().size() < sizeof(CacheHeader)) return false;
+
+    CacheHeader header;
+    std::memcpy(&header, file->Bytes().data(), sizeof(header));
+    const auto format = static_cast<Scene::TextureFormat>(header.format);
+    if (header.magic != CacheHeader::kCacheMagic || header.version != CacheHeader::kCacheVersion ||
+        header.contentHash != contentHash || header.encodedSize != encodedSize ||
+        header.width == 0 || header.height == 0 ||
+        (format != Scene::TextureFormat::RGBA8 && format != Scene::TextureFormat::RGBA32F)) {
+        return false;
+    }
+    const bool hasMipChain = header.hasMipChain != 0 && format == Scene::TextureFormat::RGBA8;
+    if (needMips && format == Scene::TextureFormat::RGBA8 && !hasMipChain) return false;
+    if (file->Bytes().size() != sizeof(CacheHeader) + texelBytes(format, header.width, header.height, hasMipChain)) {
+        return false;
+    }
+
+    texture.source = {file->Bytes().data() + sizeof(CacheHeader), header.width, header.height, format};
+    texture.hasMipChain = hasMipChain;
+    texture.contentHash = contentHash;
+    texture.storage = std::move(file);
+    return true;
+}
+
+// Written under a temporary name and renamed, so other processes never map a partial file
+void writeCached(const std::string& directory, const Texture& texture, uint64_t encodedSize) {
+    CacheHeader header;
+    header.contentHash = texture.contentHash;
+    header.encodedSize = encodedSize;
+    header.width = texture.source.width;
+    header.height = texture.source.height;
+    header.format = static_cast<uint32_t>(texture.source.format);
+    header.hasMipChain = texture.hasMipChain ? 1 : 0;
+
+    // Process id plus a per-process counter: unique across threads and concurrent runs
+    static std::atomic<uint32_t> temporaryCount{0};
+#if defined(_WIN32)
+    const unsigned long processId = GetCurrentProcessId();
+#else
+    const unsigned long processId = static_cast<unsigned long>(getpid());
+#endif
+    const std::filesystem::path path = cachePath(directory, texture.contentHash);
+    std::filesystem::path temporary = path;
+    temporary += ".tmp" + std::to_string(processId) + "-" +
+                 std::to_string(temporaryCount.fetch_add(1, std::memory_order_relaxed));
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(static_cast<const char*>(texture.source.texels),
+                  static_cast<std::streamsize>(texelBytes(texture.source.format, header.width, header.height,
+                                                          texture.hasMipChain)));
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(temporary, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) std::filesystem::remove(temporary, ec);
+}
+
+// Decode an encoded image with stb_image; HDR files stay float, everything else becomes 8-bit
+bool decode(std::span<const std::byte> bytes, bool generateMips, Texture& texture) {
+    if (bytes.size() > static_cast<size_t>(INT_MAX)) return false;
+    const auto* data = reinterpret_cast<const stbi_uc*>(bytes.data());
+    const int length = static_cast<int>(bytes.size());
+
+    int width = 0, height = 0, channels = 0;
+    Scene::TextureFormat format = Scene::TextureFormat::RGBA8;
+    void* pixels = nullptr;
+    if (stbi_is_hdr_from_memory(data, length)) {
+        format = Scene::TextureFormat::RGBA32F;
+        pixels = stbi_loadf_from_memory(data, length, &width, &height, &channels, STBI_rgb_alpha);
+    } else {
+        pixels = stbi_load_from_memory(data, length, &width, &height, &channels, STBI_rgb_alpha);
+    }
+    if (!pixels) return false;
+
+    const auto w = static_cast<uint32_t>(width);
+    const auto h = static_cast<uint32_t>(height);
+    if (generateMips && format == Scene::TextureFormat::RGBA8) {
+        const auto levels = TextureMips::LayoutMipChain(w, h);
+        std::shared_ptr<uint8_t[]> chain = std::make_shared_for_overwrite<uint8_t[]>(TextureMips::ChainTexels(levels) * 4);
+        TextureMips::GenerateMipChain(static_cast<const uint8_t*>(pixels), levels, chain.get());
+        stbi_image_free(pixels);
+        texture.source = {chain.get(), w, h, format};
+        texture.hasMipChain = true;
+        texture.storage = std::move(chain);
+    } else {
+        texture.source = {pixels, w, h, format};
+        texture.hasMipChain = false;
+        texture.storage = std::shared_ptr<void>(pixels, stbi_image_free);
+    }
+    return true;
+}
+
+Texture whiteTexture() {
+    Texture texture;
+    texture.source = {whiteTexel, 1, 1, Scene::TextureFormat::RGBA8};
+    texture.hasMipChain = true;  // A 1x1 level is its own chain
+    return texture;
+}
+
+} // namespace
+
+uint64_t ContentHash(std::span<const std::byte> bytes) noexcept {
+    // Four independent multiply-rotate lanes over 32-byte blocks, then the bytes left over
+    constexpr uint64_t k0 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t k1 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t k2 = 0x165667B19E3779F9ull;
+    uint64_t lanes[4] = {k0 + k1, k1, 0, 0 - k0};
+
+    const std::byte* data = bytes.data();
+    const size_t size = bytes.size();
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, sizeof(word));
+            lanes[lane] = std::rotl(lanes[lane] + word * k1, 31) * k0;
+        }
+    }
+    uint64_t hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) +
+                    std::rotl(lanes[3], 18) + size;
+    for (; i < size; ++i) {
+        hash = std::rotl(hash ^ (static_cast<uint64_t>(data[i]) * k2), 11) * k0;
+    }
+
+    hash ^= hash >> 33;
+    hash *= k1;
+    hash ^= hash >> 29;
+    hash *= k2;
+    hash ^= hash >> 32;
+    return hash != 0 ? hash : 1;  // 0 marks the white fallback
+}
+
+LoadedTextures LoadTextures(std::span<const std::string> paths, const Options& options) {
+    // Handed out one texture at a time; they vary too much in size for fixed chunks
+    WorkerPool& pool = WorkerPool::Shared();
+
+    // Map and hash every file; the mappings stay open until the textures are decoded
+    std::vector<std::shared_ptr<const MappedFile>> files(paths.size());
+    std::vector<uint64_t> hashes(paths.size(), 0);
+    pool.ParallelFor(paths.size(), [&](size_t i) {
+        files[i] = MappedFile::Open(paths[i]);
+        if (files[i]) hashes[i] = ContentHash(files[i]->Bytes());
+    }, options.threadCount);
+
+    // One texture per distinct content; unreadable files share the white fallback. The hash
+    // only picks candidates, the bytes decide.
+    LoadedTextures loaded;
+    loaded.textureOfPath.resize(paths.size());
+    std::vector<size_t> firstPath;
+    std::unordered_multimap<uint64_t, uint32_t> texturesOfHash;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!files[i]) {
+            std::cerr << "Warning: Failed to load texture: " << paths[i] << "\n";
+        }
+        auto [begin, end] = texturesOfHash.equal_range(hashes[i]);
+        auto match = std::find_if(begin, end, [&](const auto& entry) {
+            return sameContents(files[firstPath[entry.second]].get(), files[i].get());
+        });
+        if (match == end) {
+            match = texturesOfHash.emplace(hashes[i], static_cast<uint32_t>(firstPath.size()));
+            firstPath.push_back(i);
+        }
+        loaded.textureOfPath[i] = match->second;
+    }
+
+    bool useCache = !options.cacheDirectory.empty();
+    if (useCache) {
+        std::error_code ec;
+        std::filesystem::create_directories(options.cacheDirectory, ec);
+        if (ec) {
+            std::cerr << "Warning: Cannot create texture cache directory " << options.cacheDirectory
+                      << ": " << ec.message() << "\n";
+            useCache = false;
+        }
+    }
+
+    // Decode (or map from the cache) each distinct texture
+    loaded.textures.resize(firstPath.size());
+    std::vector<uint8_t> decodeFailed(firstPath.size(), 0);
+    std::atomic<size_t> cacheHits{0};
+    pool.ParallelFor(firstPath.size(), [&](size_t t) {
+        const size_t path = firstPath[t];
+        Texture& texture = loaded.textures[t];
+        if (!files[path]) {
+            texture = whiteTexture();
+            return;
+        }
+        const uint64_t encodedSize = files[path]->Bytes().size();
+        if (useCache && readCached(options.cacheDirectory, hashes[path], encodedSize, options.generateMips, texture)) {
+            cacheHits.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (!decode(files[path]->Bytes(), options.generateMips, texture)) {
+            decodeFailed[t] = 1;
+            texture = whiteTexture();
+            return;
+        }
+        texture.contentHash = hashes[path];
+        if (useCache) writeCached(options.cacheDirectory, texture, encodedSize);
+    }, options.threadCount);
+    for (size_t t = 0; t < firstPath.size(); ++t) {
+        if (decodeFailed[t]) {
+            std::cerr << "Warning: Failed to decode texture: " << paths[firstPath[t]] << "\n";
+        }
+    }
+    loaded.cacheHits = cacheHits.load();
+    return loaded;
+}
+
+} // namespace TextureCache
@@ -0,0 +1,112 @@
+#include "TextureMips.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace TextureMips {
+
+std::vector<MipLevel> LayoutMipChain(uint32_t width, uint32_t height) {
+    std::vector<MipLevel> levels;
+    MipLevel level{std::max(width, 1u), std::max(height, 1u), 0};
+    while (true) {
+        levels.push_back(level);
+        if (level.width == 1 && level.height == 1) break;
+        level.offset += static_cast<size_t>(level.width) * level.height;
+        level.width = std::max(level.width / 2, 1u);
+        level.height = std::max(level.height / 2, 1u);
+    }
+    return levels;
+}
+
+size_t ChainTexels(std::span<const MipLevel> levels) noexcept {
+    if (levels.empty()) return 0;
+    return levels.back().offset + static_cast<size_t>(levels.back().width) * levels.back().height;
+}
+
+namespace {
+
+// Output texels [first, last) of one row, from the two source rows under it
+void downsampleRowScalar(const uint8_t* row0, const uint8_t* row1, uint32_t srcWidth,
+                         uint32_t first, uint32_t last, uint8_t* dst) noexcept {
+    for (uint32_t x = first; x < last; ++x) {
+        const uint32_t x0 = 2 * x;
+        const uint32_t x1 = std::min(x0 + 1, srcWidth - 1);
+        for (uint32_t c = 0; c < 4; ++c) {
+            const uint32_t sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+            dst[x * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+        }
+    }
+}
+
+#if defined(__AVX2__)
+// Sums of horizontally adjacent texels, 16 bits per channel: within each 128-bit lane the
+// channels of a texel pair are made neighbours and added by maddubs
+inline __m256i pairSums(__m256i texels) noexcept {
+    const __m256i interleave = _mm256_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15,
+                                                0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+    return _mm256_maddubs_epi16(_mm256_shuffle_epi8(texels, interleave), _mm256_set1_epi8(1));
+}
+
+// Eight output texels from sixteen source texels of each row
+inline void downsample8(const uint8_t* row0, const uint8_t* row1, uint8_t* dst) noexcept {
+    const __m256i two = _mm256_set1_epi16(2);
+    __m256i half[2];
+    for (int h = 0; h < 2; ++h) {
+        const auto* a = reinterpret_cast<const __m256i*>(row0 + h * 32);
+        const auto* b = reinterpret_cast<const __m256i*>(row1 + h * 32);
+        const __m256i sum = _mm256_add_epi16(pairSums(_mm256_loadu_si256(a)), pairSums(_mm256_loadu_si256(b)));
+        half[h] = _mm256_srli_epi16(_mm256_add_epi16(sum, two), 2);
+    }
+    // packus interleaves the halves per lane as texels 0-1, 4-5, 2-3, 6-7
+    const __m256i packed = _mm256_packus_epi16(half[0], half[1]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+}
+#endif
+
+} // namespace
+
+void DownsampleScalar(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst) noexcept {
+    const uint32_t width = std::max(srcWidth / 2, 1u);
+    const uint32_t height = std::max(srcHeight / 2, 1u);
+    const size_t srcStride = static_cast<size_t>(srcWidth) * 4;
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row0 = src + 2 * y * srcStride;
+        const uint8_t* row1 = src + std::min(2 * y + 1, srcHeight - 1) * srcStride;
+        downsampleRowScalar(row0, row1, srcWidth, 0, width, dst + static_cast<size_t>(y) * width * 4);
+    }
+}
+
+void Downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst) noexcept {
+#if defined(__AVX2__)
+    const uint32_t width = std::max(srcWidth / 2, 1u);
+    const uint32_t height = std::max(srcHeight / 2, 1u);
+    const size_t srcStride = static_cast<size_t>(srcWidth) * 4;
+    // Blocks whose sixteen source texels are all inside the row; the rest go scalar
+    const uint32_t simdWidth = srcWidth / 16 * 8;
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row0 = src + 2 * y * srcStride;
+        const uint8_t* row1 = src + std::min(2 * y + 1, srcHeight - 1) * srcStride;
+        uint8_t* out = dst + static_cast<size_t>(y) * width * 4;
+        for (uint32_t x = 0; x < simdWidth; x += 8) {
+            downsample8(row0 + x * 8, row1 + x * 8, out + x * 4);
+        }
+        downsampleRowScalar(row0, row1, srcWidth, simdWidth, width, out);
+    }
+#else
+    DownsampleScalar(src, srcWidth, srcHeight, dst);
+#endif
+}
+
+void GenerateMipChain(const uint8_t* rgba, std::span<const MipLevel> levels, uint8_t* dst) noexcept {
+    if (levels.empty()) return;
+    std::memcpy(dst, rgba, static_cast<size_t>(levels[0].width) * levels[0].height * 4);
+    for (size_t i = 1; i < levels.size(); ++i) {
+        const MipLevel& above = levels[i - 1];
+        Downsample(dst + above.offset * 4, above.width, above.height, dst + levels[i].offset * 4);
+    }
+}
+
+} // namespace TextureMips
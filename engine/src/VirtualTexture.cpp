@@ -0,0 +1,270 @@
+#include "VirtualTexture.h"
+#include "TextureMips.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+
+namespace VirtualTexture {
+
+// ============================================================================
+// TileSet
+// ============================================================================
+
+uint32_t TileSet::Add(uint32_t width, uint32_t height) {
+    const uint32_t firstTile = m_tileCount;
+    m_firstLevel.push_back(static_cast<uint32_t>(m_levels.size()));
+    for (const auto& mip : TextureMips::LayoutMipChain(width, height)) {
+        TileLevel level;
+        level.width = mip.width;
+        level.height = mip.height;
+        level.tilesX = (mip.width + kTileSize - 1) / kTileSize;
+        level.tilesY = (mip.height + kTileSize - 1) / kTileSize;
+        level.firstTile = m_tileCount;
+        level.texelOffset = mip.offset;
+        m_levels.push_back(level);
+        m_tileCount += level.tilesX * level.tilesY;
+        if (level.tilesX == 1 && level.tilesY == 1) break;
+    }
+    return firstTile;
+}
+
+std::span<const TileLevel> TileSet::Levels(uint32_t texture) const noexcept {
+    const uint32_t first = m_firstLevel[texture];
+    const uint32_t last = texture + 1 < m_firstLevel.size() ? m_firstLevel[texture + 1]
+                                                             : static_cast<uint32_t>(m_levels.size());
+    return {m_levels.data() + first, last - first};
+}
+
+TileSet::TileAddress TileSet::Locate(uint32_t tile) const noexcept {
+    // Last level starting at or before the tile; levels are stored in page table order
+    const auto it = std::upper_bound(m_levels.begin(), m_levels.end(), tile,
+                                     [](uint32_t t, const TileLevel& level) { return t < level.firstTile; });
+    const auto levelIndex = static_cast<uint32_t>(it - m_levels.begin()) - 1;
+    const auto textureIt = std::upper_bound(m_firstLevel.begin(), m_firstLevel.end(), levelIndex);
+
+    TileAddress address;
+    address.texture = static_cast<uint32_t>(textureIt - m_firstLevel.begin()) - 1;
+    address.level = levelIndex - m_firstLevel[address.texture];
+    const TileLevel& level = m_levels[levelIndex];
+    const uint32_t index = tile - level.firstTile;
+    address.x = index % level.tilesX;
+    address.y = index / level.tilesX;
+    return address;
+}
+
+void ExtractTile(const void* level, uint32_t width, uint32_t height, uint32_t x, uint32_t y,
+                 uint32_t* page) noexcept {
+    const auto* texels = static_cast<const uint8_t*>(level);
+    const uint32_t x0 = x * kTileSize;
+    for (uint32_t row = 0; row < kPageSide; ++row) {
+        const uint8_t* src = texels + static_cast<size_t>((y * kTileSize + row) % height) * width * 4;
+        uint32_t* dst = page + row * kPageSide;
+        // Runs of the source row, wrapping back to column 0 at the right edge
+        uint32_t column = 0;
+        while (column < kPageSide) {
+            const uint32_t sx = (x0 + column) % width;
+            const uint32_t run = std::min(kPageSide - column, width - sx);
+            std::memcpy(dst + column, src + static_cast<size_t>(sx) * 4, run * 4);
+            column += run;
+        }
+    }
+}
+
+// ============================================================================
+// PageCache
+// ============================================================================
+
+PageCache::PageCache(uint32_t pageCount, uint32_t tileCount)
+    : m_pageOfTile(tileCount, kNoPage)
+    , m_tileOfPage(pageCount, kNoPage)
+    , m_lastUsed(pageCount, 0)
+    , m_pinned(pageCount, 0)
+    , m_prev(pageCount, kNoPage)
+    , m_next(pageCount, kNoPage) {}
+
+void PageCache::unlink(uint32_t page) noexcept {
+    const uint32_t prev = m_prev[page];
+    const uint32_t next = m_next[page];
+    (prev != kNoPage ? m_next[prev] : m_head) = next;
+    (next != kNoPage ? m_prev[next] : m_tail) = prev;
+    m_prev[page] = m_next[page] = kNoPage;
+}
+
+void PageCache::pushFront(uint32_t page) noexcept {
+    m_prev[page] = kNoPage;
+    m_next[page] = m_head;
+    (m_head != kNoPage ? m_prev[m_head] : m_tail) = page;
+    m_head = page;
+}
+
+bool PageCache::Touch(uint32_t tile, uint64_t frame) noexcept {
+    const uint32_t page = m_pageOfTile[tile];
+    if (page == kNoPage) return false;
+    m_lastUsed[page] = frame;
+    if (!m_pinned[page] && m_head != page) {
+        unlink(page);
+        pushFront(page);
+    }
+    return true;
+}
+
+PageCache::Placement PageCache::Place(uint32_t tile, uint64_t frame, bool pinned) noexcept {
+    Placement placement;
+    if (m_freePages < m_tileOfPage.size()) {
+        placement.page = m_freePages++;
+    } else {
+        const uint32_t page = m_tail;
+        if (page == kNoPage || m_lastUsed[page] == frame) return placement;
+        placement.page = page;
+        placement.evictedTile = m_tileOfPage[page];
+        m_pageOfTile[placement.evictedTile] = kNoPage;
+        unlink(page);
+    }
+
+    m_tileOfPage[placement.page] = tile;
+    m_pageOfTile[tile] = placement.page;
+    m_lastUsed[placement.page] = frame;
+    m_pinned[placement.page] = pinned ? 1 : 0;
+    if (!pinned) pushFront(placement.page);
+    return placement;
+}
+
+// ============================================================================
+// TileStreamer
+// ============================================================================
+
+namespace {
+
+// Textures without a mip chain get one here, as tiles are cut from every level
+std::vector<TextureCache::Texture> withMipChains(std::vector<TextureCache::Texture> textures) {
+    for (auto& texture : textures) {
+        if (texture.hasMipChain) continue;
+        const auto levels = TextureMips::LayoutMipChain(texture.source.width, texture.source.height);
+        std::shared_ptr<uint8_t[]> chain = std::make_shared_for_overwrite<uint8_t[]>(TextureMips::ChainTexels(levels) * 4);
+        TextureMips::GenerateMipChain(static_cast<const uint8_t*>(texture.source.texels), levels, chain.get());
+        texture.source.texels = chain.get();
+        texture.storage = std::move(chain);
+        texture.hasMipChain = true;
+    }
+    return textures;
+}
+
+TileSet layoutTiles(const std::vector<TextureCache::Texture>& textures) {
+    TileSet tiles;
+    for (const auto& texture : textures) {
+        tiles.Add(texture.source.width, texture.source.height);
+    }
+    return tiles;
+}
+
+constexpr size_t kRequestSlots = 1024;
+constexpr size_t kArrivedSlots = 64;
+
+} // namespace
+
+TileStreamer::TileStreamer(std::vector<TextureCache::Texture> textures, uint32_t pageCount)
+    : m_textures(withMipChains(std::move(textures)))
+    , m_tiles(layoutTiles(m_textures))
+    , m_cache(std::max(pageCount, m_tiles.TextureCount() + kMinStreamingPages), m_tiles.TileCount())
+    , m_pending(m_tiles.TileCount(), 0)
+    , m_requests(kRequestSlots)
+    , m_arrived(kArrivedSlots) {
+    // Pages [0, textureCount) hold the pinned tiles, in texture order
+    for (uint32_t texture = 0; texture < m_tiles.TextureCount(); ++texture) {
+        (void)m_cache.Place(m_tiles.PinnedTile(texture), 0, true);
+    }
+    m_worker = std::jthread([this] { workerMain(); });
+}
+
+TileStreamer::~TileStreamer() {
+    // The worker may be blocked on a full arrival queue, so keep draining it until it has seen
+    // the stop request and returned
+    Request* request = nullptr;
+    while (!(request = m_requests.TryBeginPush())) {
+        while (m_arrived.Front()) m_arrived.Pop();
+        std::this_thread::yield();
+    }
+    request->tile = kStop;
+    m_requests.EndPush();
+    while (!m_workerDone.load(std::memory_order_acquire)) {
+        while (m_arrived.Front()) m_arrived.Pop();
+        std::this_thread::yield();
+    }
+}
+
+void TileStreamer::cutTile(uint32_t tile, uint32_t* page) const noexcept {
+    const TileSet::TileAddress address = m_tiles.Locate(tile);
+    const TileLevel& level = m_tiles.Levels(address.texture)[address.level];
+    const auto* chain = static_cast<const uint8_t*>(m_textures[address.texture].source.texels);
+    ExtractTile(chain + level.texelOffset * 4, level.width, level.height, address.x, address.y, page);
+}
+
+void TileStreamer::workerMain() {
+    while (true) {
+        m_requests.WaitForItem();
+        const uint32_t tile = m_requests.Front()->tile;
+        m_requests.Pop();
+        if (tile == kStop) break;
+
+        m_arrived.WaitForSpace();
+        ArrivedTile* arrived = m_arrived.TryBeginPush();
+        arrived->tile = tile;
+        arrived->texels.resize(kPageTexels);
+        cutTile(tile, arrived->texels.data());
+        m_arrived.EndPush();
+    }
+    m_workerDone.store(true, std::memory_order_release);
+}
+
+void TileStreamer::WriteInitialPages(uint32_t* pages, uint32_t* pageTable) const noexcept {
+    std::fill_n(pageTable, m_tiles.TileCount(), 0u);
+    for (uint32_t texture = 0; texture < m_tiles.TextureCount(); ++texture) {
+        const uint32_t tile = m_tiles.PinnedTile(texture);
+        cutTile(tile, pages + static_cast<size_t>(texture) * kPageTexels);
+        pageTable[tile] = texture + 1;
+    }
+}
+
+void TileStreamer::ProcessFeedback(std::span<const uint32_t> feedback, uint64_t frame) {
+    const size_t words = std::min<size_t>(feedback.size(), (m_tiles.TileCount() + 31) / 32);
+    for (size_t word = 0; word < words; ++word) {
+        for (uint32_t bits = feedback[word]; bits != 0; bits &= bits - 1) {
+            const auto tile = static_cast<uint32_t>(word * 32 + std::countr_zero(bits));
+            if (tile >= m_tiles.TileCount() || m_cache.Touch(tile, frame) || m_pending[tile]) continue;
+
+            // A full queue drops the request; the shader asks again next frame
+            Request* request = m_requests.TryBeginPush();
+            if (!request) return;
+            request->tile = tile;
+            m_requests.EndPush();
+            m_pending[tile] = 1;
+            ++m_pendingCount;
+        }
+    }
+}
+
+size_t TileStreamer::PlaceArrivedTiles(uint64_t frame, size_t maxTiles, uint32_t* staging,
+                                       std::vector<PageUpload>& uploads, std::vector<PageTableWrite>& tableWrites) {
+    size_t placed = 0;
+    while (placed < maxTiles) {
+        ArrivedTile* arrived = m_arrived.Front();
+        if (!arrived) break;
+        const PageCache::Placement placement = m_cache.Place(arrived->tile, frame);
+        if (placement.page == PageCache::kNoPage) break;  // Every page is in use; retry next frame
+
+        std::memcpy(staging + placed * kPageTexels, arrived->texels.data(), kPageTexels * sizeof(uint32_t));
+        uploads.push_back({placement.page, static_cast<uint32_t>(placed)});
+        if (placement.evictedTile != PageCache::kNoPage) {
+            tableWrites.push_back({placement.evictedTile, 0});
+        }
+        tableWrites.push_back({arrived->tile, placement.page + 1});
+        m_pending[arrived->tile] = 0;
+        --m_pendingCount;
+        m_arrived.Pop();
+        ++placed;
+    }
+    return placed;
+}
+
+} // namespace VirtualTexture
@@ -1,6 +1,12 @@
 #define NOMINMAX
 #include "VulkanRenderer.h"
 #include "Mesh.h"
+#include "MeshPacking.h"
+#include "InstanceCulling.h"
+#include "InstancePacking.h"
+#include "TextureCache.h"
+#include "TextureMips.h"
+#include "VirtualTexture.h"
 #include "Scene.h"
 #include "GameScene.h"
 #include "VulkanHelpers.h"
@@ -8,11 +14,12 @@
 #include <imgui.h>
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_vulkan.h>
-#include "stb_image.h"
 #include <stdexcept>
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <memory>
+#include <cstring>
 #include <algorithm>
 #include <set>
 #include <unordered_map>
@@ -226,6 +233,9 @@ static bool checkValidationLayerSupport() {
     return coreValidationAvailable;
 }
 
+// White texel standing in for missing textures
+static constexpr uint8_t whiteTexel[4] = {255, 255, 255, 255};
+
 // ============================================================================
 // VulkanRenderer Implementation
 // ============================================================================
@@ -253,6 +263,13 @@ VulkanRenderer::~VulkanRenderer() noexcept {
 }
 
 void VulkanRenderer::BeginFrame() {
+    AcquireFrame();
+    if (m_frameStarted) {
+        BeginUiFrame();
+    }
+}
+
+void VulkanRenderer::AcquireFrame() {
     // Wait for the previous frame using this slot to complete
     // Use a reasonable timeout (5 seconds) to detect GPU hangs instead of infinite wait
     constexpr uint64_t kFenceTimeoutNs = 5'000'000'000ULL;  // 5 seconds
@@ -269,6 +286,36 @@ void VulkanRenderer::BeginFrame() {
         throw std::runtime_error("Failed to wait for fence: " + std::to_string(fenceResult));
     }
 
+    // The frame that last used this slot has finished, so its pick readback is complete
+    if (!m_picksInFlight.empty() && m_picksInFlight[m_currentFrame].pending) {
+        const uint32_t* ids = m_pickReadbackMapped + m_currentFrame * 2;
+        m_lastPickIds = {ids[0], ids[1]};
+        m_lastPick = m_picksInFlight[m_currentFrame];
+        m_picksInFlight[m_currentFrame].pending = false;
+        m_hasPickResult = true;
+    }
+
+    // And its virtual texture feedback: the tiles it wanted are touched or requested
+    if (!m_tileFeedbackWritten.empty() && m_tileFeedbackWritten[m_currentFrame]) {
+        m_tileStreamer->ProcessFeedback({m_tileFeedbackReadbackMapped + m_currentFrame * m_tileFeedbackWords,
+                                         m_tileFeedbackWords},
+                                        ++m_virtualTextureFrame);
+        m_tileFeedbackWritten[m_currentFrame] = false;
+    }
+
+    // Same for the dispatch timestamps written by that frame
+    if (!m_timestampsWritten.empty() && m_timestampsWritten[m_currentFrame]) {
+        std::array<uint64_t, 2> ticks{};
+        if (vkGetQueryPoolResults(m_device, m_timestampQueryPool, m_currentFrame * 2, 2,
+                                  sizeof(ticks), ticks.data(), sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+            const uint64_t elapsed = (ticks[1] - ticks[0]) & m_timestampMask;
+            m_lastGpuFrameMs = static_cast<double>(elapsed) * m_timestampPeriodNs * 1e-6;
+            m_hasNewGpuFrameTime = true;
+        }
+        m_timestampsWritten[m_currentFrame] = false;
+    }
+
     VkResult result = vkAcquireNextImageKHR(m_device, m_swapchain, kFenceTimeoutNs,
                                            m_imageAvailableSemaphores[m_currentFrame],
                                            VK_NULL_HANDLE, &m_imageIndex);
@@ -297,17 +344,18 @@ void VulkanRenderer::BeginFrame() {
     // Only reset fence after we know we'll submit work
     vkResetFences(m_device, 1, &m_inFlightFences[m_currentFrame]);
 
-    // Start ImGui frame
+    m_frameStarted = true;
+}
+
+void VulkanRenderer::BeginUiFrame() {
+    // The font texture is created in createImGuiResources, so this never touches a queue
     ImGui_ImplVulkan_NewFrame();
     ImGui_ImplSDL3_NewFrame();
     ImGui::NewFrame();
-
-    m_frameStarted = true;
 }
 
-void VulkanRenderer::RenderScene(const Scene::SceneData& sceneData,
+void VulkanRenderer::RenderScene(const RenderSnapshot& snapshot,
                                   const std::vector<std::unique_ptr<Mesh>>& meshes,
-                                  const std::vector<MeshInstance>& instances,
                                   const float cameraRotation[9],
                                   const float cameraPosition[3],
                                   float time, float cameraFov) {
@@ -317,14 +365,14 @@ void VulkanRenderer::RenderScene(const Scene::SceneData& sceneData,
 
     // Update push constants
     m_pushConstants.time = time;
-    m_pushConstants.triangleCount = meshes.empty() || !meshes[0] ? 0 : static_cast<uint32_t>(meshes[0]->TriangleCount());
-    m_pushConstants.sphereCount = static_cast<uint32_t>(sceneData.spheres.size());
-    m_pushConstants.planeCount = static_cast<uint32_t>(sceneData.planes.size());
-    m_pushConstants.lightCount = static_cast<uint32_t>(sceneData.lights.size());
-    // Use material count from UploadMeshes if available, otherwise fall back to scene data
-    m_pushConstants.materialCount = m_uploadedMaterialCount > 0 ? m_uploadedMaterialCount :
-        (sceneData.materials.empty() ? 1 : static_cast<uint32_t>(sceneData.materials.size()));
-    m_pushConstants.instanceCount = static_cast<uint32_t>(instances.size());
+    m_pushConstants.triangleCount = InstanceCulling::FallbackTriangleCount(
+        m_sceneInstanceCount, meshes.empty() || !meshes[0] ? 0 : static_cast<uint32_t>(meshes[0]->TriangleCount()));
+    m_pushConstants.sphereCount = static_cast<uint32_t>(snapshot.spheres.size());
+    m_pushConstants.planeCount = static_cast<uint32_t>(snapshot.planes.size());
+    m_pushConstants.lightCount = static_cast<uint32_t>(snapshot.lights.size());
+    // Material count from UploadMeshes, or from UploadSceneData when no mesh materials were uploaded
+    m_pushConstants.materialCount = std::max(m_uploadedMaterialCount, 1u);
+    m_pushConstants.instanceCount = m_instanceCount;  // From the last UploadInstances (culled or not)
     m_pushConstants.planeTileScale = 0.1f;  // Tile scale for plane UV mapping
 
     // Camera rotation matrix is row-major: row 0 = right, row 1 = up, row 2 = forward
@@ -369,6 +417,24 @@ void VulkanRenderer::RenderScene(const Scene::SceneData& sceneData,
         return;
     }
 
+    // Instances packed by UploadInstances this frame
+    if (m_pendingInstanceCopy > 0) {
+        recordInstanceCopy(cmdBuffer, m_pendingInstanceSlot, m_pendingInstanceFirst, m_pendingInstanceCopy);
+        m_pendingInstanceCopy = 0;
+    }
+
+    // Virtual texture tiles that arrived since the last frame
+    if (m_tileStreamer) {
+        recordTileUploads(cmdBuffer);
+    }
+
+    const bool writeTimestamps = m_timestampQueryPool != VK_NULL_HANDLE;
+    if (writeTimestamps) {
+        vkCmdResetQueryPool(cmdBuffer, m_timestampQueryPool, m_currentFrame * 2, 2);
+        vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                            m_timestampQueryPool, m_currentFrame * 2);
+    }
+
     // Bind compute pipeline
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
     vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
@@ -385,6 +451,64 @@ void VulkanRenderer::RenderScene(const Scene::SceneData& sceneData,
                  (m_config.height + 15) / 16,
                  1);
 
+    if (writeTimestamps) {
+        vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            m_timestampQueryPool, m_currentFrame * 2 + 1);
+        m_timestampsWritten[m_currentFrame] = true;
+    }
+
+    // Tiles the shader wanted this frame, read back once the frame's fence signals
+    if (m_tileStreamer) {
+        recordTileFeedbackReadback(cmdBuffer);
+    }
+
+    // Copy the requested object-ID pixel into this frame's readback slot
+    if (m_objectIdsEnabled && m_nextPick.pending) {
+        VulkanHelpers::transitionImageLayout2(cmdBuffer, m_objectIdImage,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                             VK_ACCESS_2_SHADER_WRITE_BIT,
+                             VK_PIPELINE_STAGE_2_COPY_BIT,
+                             VK_ACCESS_2_TRANSFER_READ_BIT,
+                             m_vkCmdPipelineBarrier2KHR);
+
+        VkBufferImageCopy pickRegion{};
+        pickRegion.bufferOffset = static_cast<VkDeviceSize>(m_currentFrame) * 2 * sizeof(uint32_t);
+        pickRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        pickRegion.imageSubresource.layerCount = 1;
+        pickRegion.imageOffset = {static_cast<int32_t>(m_nextPick.x), static_cast<int32_t>(m_nextPick.y), 0};
+        pickRegion.imageExtent = {1, 1, 1};
+        vkCmdCopyImageToBuffer(cmdBuffer, m_objectIdImage, VK_IMAGE_LAYOUT_GENERAL,
+                               m_pickReadbackBuffer, 1, &pickRegion);
+
+        // Next frame's shader writes must wait for the copy
+        VulkanHelpers::transitionImageLayout2(cmdBuffer, m_objectIdImage,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_PIPELINE_STAGE_2_COPY_BIT,
+                             VK_ACCESS_2_TRANSFER_READ_BIT,
+                             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                             VK_ACCESS_2_SHADER_WRITE_BIT,
+                             m_vkCmdPipelineBarrier2KHR);
+
+        VkMemoryBarrier2 hostBarrier{};
+        hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        hostBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        hostBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        hostBarrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+        hostBarrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+        VkDependencyInfo depInfo{};
+        depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        depInfo.memoryBarrierCount = 1;
+        depInfo.pMemoryBarriers = &hostBarrier;
+        m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+
+        m_picksInFlight[m_currentFrame] = m_nextPick;
+        m_nextPick.pending = false;
+    }
+
     // Modern Vulkan 1.3: Use synchronization2 barriers with 64-bit flags
     // Transition storage image for transfer
     VulkanHelpers::transitionImageLayout2(cmdBuffer, m_storageImage,
@@ -475,6 +599,13 @@ void VulkanRenderer::EndFrame() {
 
     // Render ImGui (Application should have built UI between beginFrame and endFrame)
     ImGui::Render();
+    SubmitFrame(ImGui::GetDrawData());
+}
+
+void VulkanRenderer::SubmitFrame(ImDrawData* uiDrawData) {
+    if (!m_frameStarted) {
+        return;
+    }
 
     // Record ImGui commands
     // Use m_currentFrame for consistent synchronization (not m_imageIndex which comes from swapchain)
@@ -508,7 +639,7 @@ void VulkanRenderer::EndFrame() {
     // No clear values needed since loadOp is LOAD (preserves raytraced image)
 
     vkCmdBeginRenderPass(imguiCmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), imguiCmd);
+    ImGui_ImplVulkan_RenderDrawData(uiDrawData, imguiCmd);
     vkCmdEndRenderPass(imguiCmd);
 
     VkResult endResult = vkEndCommandBuffer(imguiCmd);
@@ -661,123 +792,32 @@ void VulkanRenderer::UploadMeshes(const std::vector<std::unique_ptr<Mesh>>& mesh
     }
 
     // Concatenate all mesh data and track per-mesh offsets
-    std::vector<GPUVertex> allVertices;
-    std::vector<Triangle> allTriangles;
-    std::vector<Scene::BVHNode> allBvhNodes;
-    std::vector<uint32_t> allBvhTriIndices;
-    std::vector<Scene::GPUMeshInfo> meshInfos;
-    std::vector<Scene::GPUMaterial> allMaterials;
-
-    // Collect unique texture paths and map to indices
-    std::vector<std::string> texturePaths;
-    std::unordered_map<std::string, int32_t> texturePathToIndex;
-
-    uint32_t vertexOffset = 0;
-    uint32_t triangleOffset = 0;
-    uint32_t bvhNodeOffset = 0;
-    uint32_t bvhTriIdxOffset = 0;
-    uint32_t materialOffset = 0;
-
-    for (const auto& mesh : meshes) {
-        if (!mesh) continue;
-
-        Scene::GPUMeshInfo info{};
-        info.vertexOffset = vertexOffset;
-        info.triangleOffset = triangleOffset;
-        info.bvhNodeOffset = bvhNodeOffset;
-        info.bvhTriIdxOffset = bvhTriIdxOffset;
-
-        // Add vertices
-        const auto& vertices = mesh->Vertices();
-        for (const auto& v : vertices) {
-            allVertices.push_back(v.ToGPU());
-        }
-
-        // Add materials and track texture indices
-        for (size_t i = 0; i < mesh->MaterialCount(); ++i) {
-            const auto& mat = mesh->GetMaterial(i);
-            Scene::GPUMaterial gpuMat = mat.ToGPU();
-
-            // Handle texture path
-            if (!mat.diffuseTexturePath.empty()) {
-                auto it = texturePathToIndex.find(mat.diffuseTexturePath);
-                if (it == texturePathToIndex.end()) {
-                    // New texture - add to list
-                    int32_t texIdx = static_cast<int32_t>(texturePaths.size());
-                    texturePaths.push_back(mat.diffuseTexturePath);
-                    texturePathToIndex[mat.diffuseTexturePath] = texIdx;
-                    gpuMat.diffuseTextureIndex = texIdx;
-                } else {
-                    gpuMat.diffuseTextureIndex = it->second;
-                }
-            } else {
-                gpuMat.diffuseTextureIndex = -1;
-            }
-
-            allMaterials.push_back(gpuMat);
-        }
-
-        // Add triangles with adjusted vertex AND material indices
-        const auto& triangles = mesh->Triangles();
-        for (const auto& tri : triangles) {
-            Triangle adjustedTri = tri;
-            adjustedTri.indices[0] += vertexOffset;
-            adjustedTri.indices[1] += vertexOffset;
-            adjustedTri.indices[2] += vertexOffset;
-            adjustedTri.materialIndex += materialOffset;
-            allTriangles.push_back(adjustedTri);
-        }
-        info.triangleCount = static_cast<uint32_t>(triangles.size());
-
-        // Add BVH nodes with adjusted child/triangle indices
-        const auto& bvhNodes = mesh->BVHNodes();
-        for (const auto& node : bvhNodes) {
-            Scene::BVHNode adjustedNode = node;
-            if (node.triCount > 0) {
-                // Leaf node: leftFirst is index into bvhTriIndices
-                adjustedNode.leftFirst += static_cast<int32_t>(bvhTriIdxOffset);
-            } else {
-                // Internal node: leftFirst is index of left child node
-                adjustedNode.leftFirst += static_cast<int32_t>(bvhNodeOffset);
-            }
-            allBvhNodes.push_back(adjustedNode);
+    MeshPacking::PackedMeshes packed = MeshPacking::PackMeshes(meshes, m_compactVerticesEnabled, m_shadowProxyTolerance);
+
+    // Decode the textures in parallel; paths with identical contents share one texture, so
+    // the materials are pointed at the deduplicated list before they are uploaded
+    TextureCache::Options textureOptions;
+    textureOptions.cacheDirectory = m_textureCacheDirectory;
+    textureOptions.generateMips = m_sampledTexturesEnabled || m_virtualTexturesEnabled;
+    TextureCache::LoadedTextures loadedTextures = TextureCache::LoadTextures(packed.texturePaths, textureOptions);
+    for (auto& material : packed.materials) {
+        if (material.diffuseTextureIndex >= 0) {
+            material.diffuseTextureIndex = static_cast<int32_t>(loadedTextures.textureOfPath[material.diffuseTextureIndex]);
         }
-        info.bvhNodeCount = static_cast<uint32_t>(bvhNodes.size());
-
-        // Add BVH triangle indices with adjusted triangle offsets
-        const auto& bvhTriIndices = mesh->BVHTriIndices();
-        for (uint32_t idx : bvhTriIndices) {
-            allBvhTriIndices.push_back(idx + triangleOffset);
-        }
-
-        // Update offsets for next mesh
-        vertexOffset += static_cast<uint32_t>(vertices.size());
-        triangleOffset += static_cast<uint32_t>(triangles.size());
-        bvhNodeOffset += static_cast<uint32_t>(bvhNodes.size());
-        bvhTriIdxOffset += static_cast<uint32_t>(bvhTriIndices.size());
-        materialOffset += static_cast<uint32_t>(mesh->MaterialCount());
-
-        meshInfos.push_back(info);
     }
-
-    // Ensure we have at least one mesh info entry and one material
-    if (meshInfos.empty()) {
-        meshInfos.push_back(Scene::GPUMeshInfo{});
-    }
-    if (allMaterials.empty()) {
-        Scene::GPUMaterial defaultMat{};
-        defaultMat.diffuse[0] = 0.8f;
-        defaultMat.diffuse[1] = 0.8f;
-        defaultMat.diffuse[2] = 0.8f;
-        defaultMat.shininess = 32.0f;
-        defaultMat.shadingMode = static_cast<int32_t>(Scene::ShadingMode::PBR);
-        defaultMat.diffuseTextureIndex = -1;
-        defaultMat.metalness = 0.0f;
-        defaultMat.roughness = 0.5f;
-        allMaterials.push_back(defaultMat);
-    }
-
-    VkDeviceSize vertexBufferSize = sizeof(GPUVertex) * allVertices.size();
+    const auto& allTriangles = packed.triangles;
+    const auto& allBvhNodes = packed.bvhNodes;
+    const auto& allBvhTriIndices = packed.bvhTriIndices;
+    const auto& meshInfos = packed.meshInfos;
+    const auto& allMaterials = packed.materials;
+
+    // Only one vertex stream is filled; the shaders pick the layout via COMPACT_VERTICES
+    const void* vertexData = m_compactVerticesEnabled
+        ? static_cast<const void*>(packed.compactVertices.data())
+        : static_cast<const void*>(packed.vertices.data());
+    VkDeviceSize vertexBufferSize = m_compactVerticesEnabled
+        ? sizeof(GPUCompactVertex) * packed.compactVertices.size()
+        : sizeof(GPUVertex) * packed.vertices.size();
     VkDeviceSize indexBufferSize = sizeof(Triangle) * allTriangles.size();
 
     // Create staging buffers
@@ -795,7 +835,7 @@ void VulkanRenderer::UploadMeshes(const std::vector<std::unique_ptr<Mesh>>& mesh
     // Copy GPU-compatible vertex data to staging buffer
     void* data;
     vkMapMemory(m_device, vertexStagingMemory, 0, vertexBufferSize, 0, &data);
-    std::memcpy(data, allVertices.data(), vertexBufferSize);
+    std::memcpy(data, vertexData, vertexBufferSize);
     vkUnmapMemory(m_device, vertexStagingMemory);
 
     vkMapMemory(m_device, indexStagingMemory, 0, indexBufferSize, 0, &data);
@@ -867,61 +907,63 @@ void VulkanRenderer::UploadMeshes(const std::vector<std::unique_ptr<Mesh>>& mesh
     VulkanHelpers::uploadToBuffer(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
                                    allMaterials, m_materialBuffer, m_materialBufferMemory);
 
-    // Load and concatenate all textures
-    std::vector<float> allTextureData;
-    std::vector<Scene::GPUTextureInfo> textureInfos;
-    uint32_t textureOffset = 0;
-
-    for (size_t i = 0; i < texturePaths.size(); ++i) {
-        const auto& texPath = texturePaths[i];
-        int texWidth, texHeight, texChannels;
-        stbi_uc* pixels = stbi_load(texPath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-
-        Scene::GPUTextureInfo texInfo{};
-        texInfo.offset = textureOffset;
-
-        if (pixels) {
-            texInfo.width = static_cast<uint32_t>(texWidth);
-            texInfo.height = static_cast<uint32_t>(texHeight);
-
-            // Convert to vec4 floats and append
-            for (int i = 0; i < texWidth * texHeight; ++i) {
-                allTextureData.push_back(pixels[i * 4 + 0] / 255.0f);  // R
-                allTextureData.push_back(pixels[i * 4 + 1] / 255.0f);  // G
-                allTextureData.push_back(pixels[i * 4 + 2] / 255.0f);  // B
-                allTextureData.push_back(pixels[i * 4 + 3] / 255.0f);  // A
-            }
-            stbi_image_free(pixels);
+    // The texel buffer is sized and filled in place from the decoded textures. 8-bit textures
+    // stay packed (one word per texel); at least one texture always exists.
+    auto& textures = loadedTextures.textures;
+    if (textures.empty()) {
+        textures.push_back({{whiteTexel, 1, 1, Scene::TextureFormat::RGBA8}, true});  // Single white pixel
+    }
 
-            textureOffset += static_cast<uint32_t>(texWidth * texHeight);
-        } else {
-            std::cerr << "Warning: Failed to load texture: " << texPath << "\n";
-            // Add a single white pixel as fallback
-            texInfo.width = 1;
-            texInfo.height = 1;
-            allTextureData.push_back(1.0f);
-            allTextureData.push_back(1.0f);
-            allTextureData.push_back(1.0f);
-            allTextureData.push_back(1.0f);
-            textureOffset += 1;
+    std::vector<MeshPacking::TexelSource> texelSources;
+    texelSources.reserve(textures.size());
+    for (const auto& texture : textures) {
+        texelSources.push_back(texture.source);
+    }
+
+    // Sampled textures: 8-bit textures become mipmapped images, as many as there are slots.
+    // HDR textures and any past the last slot stay in the buffer.
+    if (m_sampledTexturesEnabled) {
+        std::vector<TextureCache::Texture> sampledTextures;
+        for (size_t i = 0; i < textures.size(); ++i) {
+            if (texelSources[i].format != Scene::TextureFormat::RGBA8) continue;
+            if (sampledTextures.size() == m_sampledTextureSlots) {
+                std::cerr << "Warning: more textures than sampled texture slots (" << m_sampledTextureSlots
+                          << "), the rest are not mipmapped\n";
+                break;
+            }
+            sampledTextures.push_back(textures[i]);
+            texelSources[i].format = Scene::TextureFormat::SampledImage;
         }
+        uploadSampledTextures(sampledTextures);
+    }
 
-        textureInfos.push_back(texInfo);
+    // Virtual textures: the 8-bit textures left over are paged in by tile, so only what the
+    // shader samples takes device memory
+    std::vector<uint32_t> virtualTextureIndices;
+    if (m_virtualTexturesEnabled) {
+        std::vector<TextureCache::Texture> virtualTextures;
+        for (size_t i = 0; i < textures.size(); ++i) {
+            if (texelSources[i].format != Scene::TextureFormat::RGBA8) continue;
+            virtualTextureIndices.push_back(static_cast<uint32_t>(i));
+            virtualTextures.push_back(textures[i]);
+            texelSources[i].format = Scene::TextureFormat::Virtual;
+        }
+        createVirtualTextures(std::move(virtualTextures));
     }
 
-    // Ensure we have at least a dummy texture
-    if (textureInfos.empty()) {
-        Scene::GPUTextureInfo dummyInfo{};
-        dummyInfo.offset = 0;
-        dummyInfo.width = 1;
-        dummyInfo.height = 1;
-        textureInfos.push_back(dummyInfo);
-        allTextureData = {1.0f, 1.0f, 1.0f, 1.0f};  // Single white pixel
+    std::vector<Scene::GPUTextureInfo> textureInfos;
+    const size_t textureWords = MeshPacking::LayoutTextures(texelSources, textureInfos);
+    for (size_t k = 0; k < virtualTextureIndices.size(); ++k) {
+        textureInfos[virtualTextureIndices[k]].offset =
+            m_tileStreamer->Tiles().Levels(static_cast<uint32_t>(k))[0].firstTile;
     }
 
-    // Upload texture data and info buffers
-    VulkanHelpers::uploadToBuffer(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
-                                   allTextureData, m_textureBuffer, m_textureBufferMemory);
+    // Upload texture data and info buffers (the texel buffer is never empty, even when every
+    // texture is a sampled image)
+    VulkanHelpers::uploadToBufferWith(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
+                                      std::max<size_t>(textureWords, 1) * sizeof(uint32_t),
+                                      [&](void* mapped) { MeshPacking::WriteTexels(texelSources, textureInfos, mapped); },
+                                      m_textureBuffer, m_textureBufferMemory);
     VulkanHelpers::uploadToBuffer(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
                                    textureInfos, m_textureInfoBuffer, m_textureInfoBufferMemory);
 
@@ -934,36 +976,416 @@ void VulkanRenderer::UploadMeshes(const std::vector<std::unique_ptr<Mesh>>& mesh
     m_meshesUploaded = true;
 }
 
-void VulkanRenderer::UploadTexture(const std::string& filename) {
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load(filename.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+void VulkanRenderer::EnableCompactVertices() {
+    if (m_meshesUploaded || m_computePipeline != VK_NULL_HANDLE) {
+        std::cerr << "Warning: EnableCompactVertices must be called before UploadMeshes, ignored\n";
+        return;
+    }
+    m_compactVerticesEnabled = true;
+}
+
+void VulkanRenderer::EnableShadowProxies(float tolerance) {
+    if (m_meshesUploaded) {
+        std::cerr << "Warning: EnableShadowProxies must be called before UploadMeshes, ignored\n";
+        return;
+    }
+    m_shadowProxyTolerance = std::max(tolerance, 0.0f);
+}
 
-    if (pixels) {
-        m_textureWidth = static_cast<uint32_t>(texWidth);
-        m_textureHeight = static_cast<uint32_t>(texHeight);
+void VulkanRenderer::EnableSampledTextures() {
+    if (m_meshesUploaded || m_computePipeline != VK_NULL_HANDLE) {
+        std::cerr << "Warning: EnableSampledTextures must be called before UploadMeshes, ignored\n";
+        return;
+    }
+    if (!m_nonUniformSamplingSupported) {
+        std::cerr << "Warning: EnableSampledTextures needs shaderSampledImageArrayNonUniformIndexing, ignored\n";
+        return;
+    }
+    m_sampledTexturesEnabled = true;
+}
+
+void VulkanRenderer::SetTextureCacheDirectory(const std::string& directory) {
+    if (m_meshesUploaded) {
+        std::cerr << "Warning: SetTextureCacheDirectory must be called before UploadMeshes, ignored\n";
+        return;
+    }
+    m_textureCacheDirectory = directory;
+}
+
+void VulkanRenderer::EnableVirtualTextures(uint32_t pageCount) {
+    if (m_meshesUploaded || m_computePipeline != VK_NULL_HANDLE) {
+        std::cerr << "Warning: EnableVirtualTextures must be called before UploadMeshes, ignored\n";
+        return;
+    }
+    m_virtualTexturesEnabled = true;
+    m_virtualTexturePages = pageCount;
+}
+
+void VulkanRenderer::uploadSampledTextures(const std::vector<TextureCache::Texture>& textures) {
+    destroySampledTextures();
+    if (textures.empty()) return;
+
+    // Every mip chain is copied (when the loader built it) or generated straight into one
+    // staging buffer
+    std::vector<std::vector<TextureMips::MipLevel>> chains;
+    std::vector<VkDeviceSize> chainOffsets;
+    chains.reserve(textures.size());
+    chainOffsets.reserve(textures.size());
+    VkDeviceSize stagingSize = 0;
+    for (const auto& texture : textures) {
+        chains.push_back(TextureMips::LayoutMipChain(texture.source.width, texture.source.height));
+        chainOffsets.push_back(stagingSize);
+        stagingSize += TextureMips::ChainTexels(chains.back()) * 4;
+    }
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 stagingBuffer, stagingMemory);
+    void* mapped = nullptr;
+    vkMapMemory(m_device, stagingMemory, 0, stagingSize, 0, &mapped);
+    for (size_t i = 0; i < textures.size(); ++i) {
+        auto* dst = static_cast<uint8_t*>(mapped) + chainOffsets[i];
+        const auto* texels = static_cast<const uint8_t*>(textures[i].source.texels);
+        if (textures[i].hasMipChain) {
+            std::memcpy(dst, texels, TextureMips::ChainTexels(chains[i]) * 4);
+        } else {
+            TextureMips::GenerateMipChain(texels, chains[i], dst);
+        }
+    }
+    vkUnmapMemory(m_device, stagingMemory);
+
+    VkCommandBuffer cmdBuffer = m_commandBuffers[0];
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(cmdBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin command buffer for sampled texture upload");
+    }
 
-        // Convert to vec4 floats for shader (RGBA normalized)
-        std::vector<float> textureData(texWidth * texHeight * 4);
-        for (int i = 0; i < texWidth * texHeight; ++i) {
-            textureData[i * 4 + 0] = pixels[i * 4 + 0] / 255.0f;  // R
-            textureData[i * 4 + 1] = pixels[i * 4 + 1] / 255.0f;  // G
-            textureData[i * 4 + 2] = pixels[i * 4 + 2] / 255.0f;  // B
-            textureData[i * 4 + 3] = pixels[i * 4 + 3] / 255.0f;  // A
+    m_sampledTextures.resize(textures.size());
+    std::vector<VkBufferImageCopy> regions;
+    for (size_t i = 0; i < textures.size(); ++i) {
+        const auto& chain = chains[i];
+        const auto levelCount = static_cast<uint32_t>(chain.size());
+        SampledTexture& texture = m_sampledTextures[i];
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width = chain[0].width;
+        imageInfo.extent.height = chain[0].height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = levelCount;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;  // Same values as unpackUnorm4x8 on the buffer path
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateImage(m_device, &imageInfo, nullptr, &texture.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create sampled texture image");
         }
-        stbi_image_free(pixels);
 
-        // Upload texture data to buffer
-        VulkanHelpers::uploadToBuffer(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
-                                       textureData, m_textureBuffer, m_textureBufferMemory);
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(m_device, texture.image, &memRequirements);
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits,
+                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (vkAllocateMemory(m_device, &allocInfo, nullptr, &texture.memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate sampled texture memory");
+        }
+        vkBindImageMemory(m_device, texture.image, texture.memory, 0);
+        texture.view = VulkanHelpers::createImageView(m_device, texture.image, VK_FORMAT_R8G8B8A8_UNORM,
+                                                      VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D, 1, levelCount);
+
+        VulkanHelpers::transitionImageLayout2(cmdBuffer, texture.image,
+                             VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             VK_PIPELINE_STAGE_2_NONE,
+                             VK_ACCESS_2_NONE,
+                             VK_PIPELINE_STAGE_2_COPY_BIT,
+                             VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                             m_vkCmdPipelineBarrier2KHR, 1, levelCount);
+
+        regions.assign(levelCount, VkBufferImageCopy{});
+        for (uint32_t level = 0; level < levelCount; ++level) {
+            regions[level].bufferOffset = chainOffsets[i] + chain[level].offset * 4;
+            regions[level].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            regions[level].imageSubresource.mipLevel = level;
+            regions[level].imageSubresource.layerCount = 1;
+            regions[level].imageExtent = {chain[level].width, chain[level].height, 1};
+        }
+        vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               levelCount, regions.data());
+
+        VulkanHelpers::transitionImageLayout2(cmdBuffer, texture.image,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_PIPELINE_STAGE_2_COPY_BIT,
+                             VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                             VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                             m_vkCmdPipelineBarrier2KHR, 1, levelCount);
+    }
 
-    } else {
-        // Create dummy texture buffer
-        std::vector<float> dummyTexture(4, 1.0f);  // Single white pixel
-        m_textureWidth = 1;
-        m_textureHeight = 1;
-        VulkanHelpers::uploadToBuffer(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
-                                       dummyTexture, m_textureBuffer, m_textureBufferMemory);
+    if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to end command buffer for sampled texture upload");
+    }
+    VkCommandBufferSubmitInfo cmdBufferSubmitInfo{};
+    cmdBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    cmdBufferSubmitInfo.commandBuffer = cmdBuffer;
+
+    VkSubmitInfo2 submitInfo2{};
+    submitInfo2.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo2.commandBufferInfoCount = 1;
+    submitInfo2.pCommandBufferInfos = &cmdBufferSubmitInfo;
+
+    if (m_vkQueueSubmit2KHR(m_computeQueue, 1, &submitInfo2, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit sampled texture upload");
+    }
+    vkQueueWaitIdle(m_computeQueue);
+
+    vkDestroyBuffer(m_device, stagingBuffer, nullptr);
+    vkFreeMemory(m_device, stagingMemory, nullptr);
+}
+
+void VulkanRenderer::destroySampledTextures() {
+    for (auto& texture : m_sampledTextures) {
+        if (texture.view != VK_NULL_HANDLE) vkDestroyImageView(m_device, texture.view, nullptr);
+        if (texture.image != VK_NULL_HANDLE) vkDestroyImage(m_device, texture.image, nullptr);
+        if (texture.memory != VK_NULL_HANDLE) vkFreeMemory(m_device, texture.memory, nullptr);
+    }
+    m_sampledTextures.clear();
+}
+
+void VulkanRenderer::createVirtualTextures(std::vector<TextureCache::Texture> textures) {
+    destroyVirtualTextures();
+    if (textures.empty()) return;
+
+    m_tileStreamer = std::make_unique<VirtualTexture::TileStreamer>(std::move(textures), m_virtualTexturePages);
+    const VirtualTexture::TileStreamer& streamer = *m_tileStreamer;
+    constexpr VkDeviceSize pageBytes = VirtualTexture::kPageTexels * sizeof(uint32_t);
+
+    // The pool starts out with every texture's single-tile level pinned, and the page table
+    // pointing at those pages only
+    std::vector<uint32_t> pageTable(streamer.Tiles().TileCount());
+    VulkanHelpers::uploadToBufferWith(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
+                                      streamer.PageCount() * pageBytes,
+                                      [&](void* mapped) { streamer.WriteInitialPages(static_cast<uint32_t*>(mapped), pageTable.data()); },
+                                      m_pageBuffer, m_pageBufferMemory);
+    VulkanHelpers::uploadToBuffer(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
+                                   pageTable, m_pageTableBuffer, m_pageTableBufferMemory);
+
+    // One feedback bit per tile; RenderScene clears the buffer before its first dispatch
+    m_tileFeedbackWords = (streamer.Tiles().TileCount() + 31) / 32;
+    const VkDeviceSize feedbackSize = m_tileFeedbackWords * sizeof(uint32_t);
+    createBuffer(feedbackSize,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_tileFeedbackBuffer, m_tileFeedbackBufferMemory);
+    m_tileFeedbackCleared = false;
+
+    // Feedback readback and tile staging, one slot per frame in flight, persistently mapped
+    const VkDeviceSize frameCount = m_swapchainImages.size();
+    createBuffer(frameCount * feedbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 m_tileFeedbackReadbackBuffer, m_tileFeedbackReadbackMemory);
+    void* mapped = nullptr;
+    vkMapMemory(m_device, m_tileFeedbackReadbackMemory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    m_tileFeedbackReadbackMapped = static_cast<const uint32_t*>(mapped);
+    m_tileFeedbackWritten.assign(frameCount, false);
+
+    createBuffer(frameCount * kMaxTileUploadsPerFrame * pageBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 m_tileStagingBuffer, m_tileStagingMemory);
+    vkMapMemory(m_device, m_tileStagingMemory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    m_tileStagingMapped = static_cast<uint32_t*>(mapped);
+
+    std::cout << "Virtual textures: " << streamer.Tiles().TextureCount() << " textures, "
+              << streamer.Tiles().TileCount() << " tiles, " << streamer.PageCount() << " pages\n";
+}
+
+void VulkanRenderer::recordTileUploads(VkCommandBuffer cmdBuffer) {
+    constexpr VkDeviceSize pageBytes = VirtualTexture::kPageTexels * sizeof(uint32_t);
+    const size_t firstStagingPage = static_cast<size_t>(m_currentFrame) * kMaxTileUploadsPerFrame;
+
+    m_tileUploads.clear();
+    m_pageTableWrites.clear();
+    const size_t placed = m_tileStreamer->PlaceArrivedTiles(m_virtualTextureFrame, kMaxTileUploadsPerFrame,
+                                                            m_tileStagingMapped + firstStagingPage * VirtualTexture::kPageTexels,
+                                                            m_tileUploads, m_pageTableWrites);
+    if (placed == 0 && m_tileFeedbackCleared) {
+        return;
+    }
+
+    // Earlier dispatches may still be sampling the pages that are reused
+    VkMemoryBarrier2 readBarrier{};
+    readBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    readBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    readBarrier.srcAccessMask = VK_ACCESS_2_NONE;
+    readBarrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+    readBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    VkDependencyInfo depInfo{};
+    depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &readBarrier;
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+
+    if (!m_tileFeedbackCleared) {
+        vkCmdFillBuffer(cmdBuffer, m_tileFeedbackBuffer, 0, VK_WHOLE_SIZE, 0);
+        m_tileFeedbackCleared = true;
+    }
+
+    if (placed > 0) {
+        std::array<VkBufferCopy, kMaxTileUploadsPerFrame> regions{};
+        for (size_t i = 0; i < placed; ++i) {
+            regions[i].srcOffset = (firstStagingPage + m_tileUploads[i].source) * pageBytes;
+            regions[i].dstOffset = m_tileUploads[i].page * pageBytes;
+            regions[i].size = pageBytes;
+        }
+        vkCmdCopyBuffer(cmdBuffer, m_tileStagingBuffer, m_pageBuffer, static_cast<uint32_t>(placed), regions.data());
+
+        // A handful of words each frame; evictions come before the placements that reuse the page
+        for (const auto& write : m_pageTableWrites) {
+            vkCmdUpdateBuffer(cmdBuffer, m_pageTableBuffer, write.entry * sizeof(uint32_t), sizeof(uint32_t), &write.value);
+        }
     }
+
+    VkMemoryBarrier2 writeBarrier{};
+    writeBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    writeBarrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+    writeBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    writeBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    writeBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+    depInfo.pMemoryBarriers = &writeBarrier;
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+}
+
+void VulkanRenderer::recordTileFeedbackReadback(VkCommandBuffer cmdBuffer) {
+    const VkDeviceSize feedbackSize = m_tileFeedbackWords * sizeof(uint32_t);
+
+    VkMemoryBarrier2 shaderBarrier{};
+    shaderBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    shaderBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    shaderBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    shaderBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    shaderBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+
+    VkDependencyInfo depInfo{};
+    depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &shaderBarrier;
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+
+    VkBufferCopy region{};
+    region.dstOffset = m_currentFrame * feedbackSize;
+    region.size = feedbackSize;
+    vkCmdCopyBuffer(cmdBuffer, m_tileFeedbackBuffer, m_tileFeedbackReadbackBuffer, 1, &region);
+
+    // The clear must wait for the copy to have read the bits
+    VkMemoryBarrier2 copyBarrier{};
+    copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    copyBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    copyBarrier.srcAccessMask = VK_ACCESS_2_NONE;
+    copyBarrier.dstStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT;
+    copyBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    depInfo.pMemoryBarriers = &copyBarrier;
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+
+    vkCmdFillBuffer(cmdBuffer, m_tileFeedbackBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    // Later dispatches set bits in the cleared buffer; the host reads the copy after the fence
+    std::array<VkMemoryBarrier2, 2> doneBarriers{};
+    doneBarriers[0].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    doneBarriers[0].srcStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT;
+    doneBarriers[0].srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    doneBarriers[0].dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    doneBarriers[0].dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    doneBarriers[1].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    doneBarriers[1].srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    doneBarriers[1].srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    doneBarriers[1].dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+    doneBarriers[1].dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+    depInfo.memoryBarrierCount = static_cast<uint32_t>(doneBarriers.size());
+    depInfo.pMemoryBarriers = doneBarriers.data();
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+
+    m_tileFeedbackWritten[m_currentFrame] = true;
+}
+
+void VulkanRenderer::destroyVirtualTextures() {
+    m_tileStreamer.reset();
+    m_tileFeedbackWritten.clear();
+    m_tileFeedbackWords = 0;
+    if (m_tileFeedbackReadbackMapped != nullptr) {
+        vkUnmapMemory(m_device, m_tileFeedbackReadbackMemory);
+        m_tileFeedbackReadbackMapped = nullptr;
+    }
+    if (m_tileStagingMapped != nullptr) {
+        vkUnmapMemory(m_device, m_tileStagingMemory);
+        m_tileStagingMapped = nullptr;
+    }
+    if (m_pageTableBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, m_pageTableBuffer, nullptr);
+        m_pageTableBuffer = VK_NULL_HANDLE;
+    }
+    if (m_pageTableBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, m_pageTableBufferMemory, nullptr);
+        m_pageTableBufferMemory = VK_NULL_HANDLE;
+    }
+    if (m_pageBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, m_pageBuffer, nullptr);
+        m_pageBuffer = VK_NULL_HANDLE;
+    }
+    if (m_pageBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, m_pageBufferMemory, nullptr);
+        m_pageBufferMemory = VK_NULL_HANDLE;
+    }
+    if (m_tileFeedbackBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, m_tileFeedbackBuffer, nullptr);
+        m_tileFeedbackBuffer = VK_NULL_HANDLE;
+    }
+    if (m_tileFeedbackBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, m_tileFeedbackBufferMemory, nullptr);
+        m_tileFeedbackBufferMemory = VK_NULL_HANDLE;
+    }
+    if (m_tileFeedbackReadbackBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, m_tileFeedbackReadbackBuffer, nullptr);
+        m_tileFeedbackReadbackBuffer = VK_NULL_HANDLE;
+    }
+    if (m_tileFeedbackReadbackMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, m_tileFeedbackReadbackMemory, nullptr);
+        m_tileFeedbackReadbackMemory = VK_NULL_HANDLE;
+    }
+    if (m_tileStagingBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, m_tileStagingBuffer, nullptr);
+        m_tileStagingBuffer = VK_NULL_HANDLE;
+    }
+    if (m_tileStagingMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, m_tileStagingMemory, nullptr);
+        m_tileStagingMemory = VK_NULL_HANDLE;
+    }
+}
+
+void VulkanRenderer::UploadTexture(const std::string& filename) {
+    const std::string paths[] = {filename};
+    const TextureCache::LoadedTextures loaded = TextureCache::LoadTextures(paths, {m_textureCacheDirectory});
+    const MeshPacking::TexelSource sources[] = {loaded.textures[0].source};
+    std::vector<Scene::GPUTextureInfo> infos;
+    const size_t words = MeshPacking::LayoutTextures(sources, infos);
+
+    m_textureWidth = sources[0].width;
+    m_textureHeight = sources[0].height;
+    VulkanHelpers::uploadToBufferWith(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
+                                      words * sizeof(uint32_t),
+                                      [&](void* mapped) { MeshPacking::WriteTexels(sources, infos, mapped); },
+                                      m_textureBuffer, m_textureBufferMemory);
 }
 
 void VulkanRenderer::UploadSceneData(const Scene::SceneData& sceneData) {
@@ -1001,6 +1423,7 @@ void VulkanRenderer::UploadSceneData(const Scene::SceneData& sceneData) {
 
         VulkanHelpers::uploadToBuffer(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
                                        gpuMaterials, m_materialBuffer, m_materialBufferMemory);
+        m_uploadedMaterialCount = static_cast<uint32_t>(gpuMaterials.size());
     }
 
     // Create minimal instance buffer for descriptor set binding
@@ -1012,173 +1435,195 @@ void VulkanRenderer::UploadSceneData(const Scene::SceneData& sceneData) {
     m_instanceBufferCapacity = 1;
 }
 
-void VulkanRenderer::UploadInstances(const std::vector<MeshInstance>& instances) {
-    if (instances.empty()) {
-        return;  // Keep default identity instance
-    }
+void VulkanRenderer::UploadInstances(const InstanceArrays& instances) {
+    uploadInstanceRecords(instances, nullptr, nullptr);
+}
+
+void VulkanRenderer::UploadInstances(const InstanceArrays& instances, InstanceRange changed) {
+    uploadInstanceRecords(instances, nullptr, &changed);
+}
 
-    const auto instanceCount = static_cast<uint32_t>(instances.size());
+void VulkanRenderer::UploadInstances(const InstanceArrays& instances, std::span<const uint32_t> visibleIndices) {
+    uploadInstanceRecords(instances, &visibleIndices, nullptr);
+}
 
-    // Check if we need to reallocate the buffer (instance count exceeds capacity)
-    if (instanceCount > m_instanceBufferCapacity) {
-        // Wait for GPU to finish using the old buffer
-        vkDeviceWaitIdle(m_device);
+void VulkanRenderer::uploadInstanceRecords(const InstanceArrays& instances,
+                                           const std::span<const uint32_t>* visibleIndices,
+                                           const InstanceRange* changed) {
+    const auto instanceCount = static_cast<uint32_t>(visibleIndices ? visibleIndices->size() : instances.Size());
+    m_instanceCount = instanceCount;
+    m_sceneInstanceCount = instances.Size();
+    if (instanceCount == 0) {
+        m_instanceBufferDense = false;
+        return;  // Keep default identity instance; it is not traced
+    }
 
-        // Free old buffer
-        if (m_instanceMotorBuffer != VK_NULL_HANDLE) {
-            vkDestroyBuffer(m_device, m_instanceMotorBuffer, nullptr);
-            m_instanceMotorBuffer = VK_NULL_HANDLE;
-        }
-        if (m_instanceMotorBufferMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(m_device, m_instanceMotorBufferMemory, nullptr);
-            m_instanceMotorBufferMemory = VK_NULL_HANDLE;
-        }
-    }
-
-    std::vector<Scene::GPUMeshInstance> gpuInstances;
-    gpuInstances.reserve(instances.size());
-
-    for (const auto& inst : instances) {
-        Scene::GPUMeshInstance gpuInst{};
-        gpuInst.meshId = inst.meshId;
-        gpuInst.visible = inst.visible ? 1 : 0;
-
-        // Convert PGA Motor to 4x4 transformation matrix
-        // Motor = s + e01*d1 + e02*d2 + e03*d3 + e23*b1 + e31*b2 + e12*b3 + e0123*p
-        // For translation + rotation motor:
-        // Translation: d1=tx/2, d2=ty/2, d3=tz/2
-        // Rotation: s=cos(angle/2), bivector part = sin(angle/2) * axis
-        //
-        // NOTE: PGA convention uses -sin(angle/2) for rotation (see Motor::Rotation in FlyFish)
-        // The rotation matrix formulas use quaternion convention which expects +sin(angle/2)
-        // So we NEGATE the bivector components for the ROTATION MATRIX only
-        // The TRANSLATION formula needs the ORIGINAL PGA bivector values
-        const Motor& m = inst.transform;
-        float s = m.s();
-
-        // Original PGA bivector values (for translation formula)
-        float b1_pga = m.e23();
-        float b2_pga = m.e31();
-        float b3_pga = m.e12();
-
-        // Negated bivector values (for quaternion-style rotation matrix)
-        float b1 = -b1_pga;
-        float b2 = -b2_pga;
-        float b3 = -b3_pga;
-
-        float d1 = m.e01();   // Translation X / 2
-        float d2 = m.e02();   // Translation Y / 2
-        float d3 = m.e03();   // Translation Z / 2
-        float p = m.e0123();
-
-        // Rotation matrix from motor (rotor part) - uses NEGATED bivector (quaternion convention)
-        // R = I - 2*b^2 + 2*s*b  (quaternion-like formula)
-        // For normalized motor, s^2 + b1^2 + b2^2 + b3^2 = 1
-        float r00 = 1 - 2*(b2*b2 + b3*b3);
-        float r01 = 2*(b1*b2 - s*b3);
-        float r02 = 2*(b1*b3 + s*b2);
-        float r10 = 2*(b1*b2 + s*b3);
-        float r11 = 1 - 2*(b1*b1 + b3*b3);
-        float r12 = 2*(b2*b3 - s*b1);
-        float r20 = 2*(b1*b3 - s*b2);
-        float r21 = 2*(b2*b3 + s*b1);
-        float r22 = 1 - 2*(b1*b1 + b2*b2);
-
-        // Translation from motor - uses ORIGINAL PGA bivector values
-        // t = 2 * (s*d - d×b + p*b) where × is cross product
-        // Note: the cross product is SUBTRACTED, not added
-        float tx = 2 * (d1*s - d2*b3_pga + d3*b2_pga + p*b1_pga);
-        float ty = 2 * (d2*s - d3*b1_pga + d1*b3_pga + p*b2_pga);
-        float tz = 2 * (d3*s - d1*b2_pga + d2*b1_pga + p*b3_pga);
-
-        // Apply uniform scale to transform
-        float scl = inst.scale;
-        float invScl = 1.0f / scl;
-
-        // Build column-major 4x4 transform matrix (with scale applied to rotation)
-        // Column 0 (indices 0-3)
-        gpuInst.transform[0] = r00 * scl;
-        gpuInst.transform[1] = r10 * scl;
-        gpuInst.transform[2] = r20 * scl;
-        gpuInst.transform[3] = 0.0f;
-        // Column 1 (indices 4-7)
-        gpuInst.transform[4] = r01 * scl;
-        gpuInst.transform[5] = r11 * scl;
-        gpuInst.transform[6] = r21 * scl;
-        gpuInst.transform[7] = 0.0f;
-        // Column 2 (indices 8-11)
-        gpuInst.transform[8] = r02 * scl;
-        gpuInst.transform[9] = r12 * scl;
-        gpuInst.transform[10] = r22 * scl;
-        gpuInst.transform[11] = 0.0f;
-        // Column 3 (indices 12-15) - translation
-        gpuInst.transform[12] = tx;
-        gpuInst.transform[13] = ty;
-        gpuInst.transform[14] = tz;
-        gpuInst.transform[15] = 1.0f;
-
-        // Build inverse transform (transpose of rotation with inverse scale)
-        // For scaled rotation: (S*R)^-1 = R^T * S^-1
-        // Column 0
-        gpuInst.invTransform[0] = r00 * invScl;
-        gpuInst.invTransform[1] = r01 * invScl;
-        gpuInst.invTransform[2] = r02 * invScl;
-        gpuInst.invTransform[3] = 0.0f;
-        // Column 1
-        gpuInst.invTransform[4] = r10 * invScl;
-        gpuInst.invTransform[5] = r11 * invScl;
-        gpuInst.invTransform[6] = r12 * invScl;
-        gpuInst.invTransform[7] = 0.0f;
-        // Column 2
-        gpuInst.invTransform[8] = r20 * invScl;
-        gpuInst.invTransform[9] = r21 * invScl;
-        gpuInst.invTransform[10] = r22 * invScl;
-        gpuInst.invTransform[11] = 0.0f;
-        // Column 3 - inverse translation: -(S*R)^-1 * t = -(1/s) * R^T * t
-        float invTx = -(r00*tx + r10*ty + r20*tz) * invScl;
-        float invTy = -(r01*tx + r11*ty + r21*tz) * invScl;
-        float invTz = -(r02*tx + r12*ty + r22*tz) * invScl;
-        gpuInst.invTransform[12] = invTx;
-        gpuInst.invTransform[13] = invTy;
-        gpuInst.invTransform[14] = invTz;
-        gpuInst.invTransform[15] = 1.0f;
-
-        gpuInstances.push_back(gpuInst);
-    }
-
-    // Upload to GPU - use updateBufferData if buffer already exists (avoids invalidating descriptor set)
-    if (m_instanceMotorBuffer != VK_NULL_HANDLE) {
-        VulkanHelpers::updateBufferData(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
-                                        gpuInstances, m_instanceMotorBuffer);
+    // The device buffer persists across frames, so a partial copy is enough when it already
+    // holds the dense layout and is not about to be reallocated
+    const bool partial = changed && !visibleIndices && m_instanceBufferDense && m_frameStarted &&
+                         m_instanceStagingMapped != nullptr && instanceCount <= m_instanceBufferCapacity;
+    ensureInstanceCapacity(instanceCount);
+    m_instanceBufferDense = !visibleIndices;
+
+    // Inside a frame, BeginFrame has already waited for the last use of this frame's slot.
+    // Outside one (initial upload), drain the queue and copy immediately.
+    if (!m_frameStarted) {
+        vkQueueWaitIdle(m_computeQueue);
+    }
+    const uint32_t slot = m_frameStarted ? m_currentFrame : 0;
+    Scene::GPUMeshInstance* staging = m_instanceStagingMapped + static_cast<size_t>(slot) * m_instanceBufferCapacity;
+    uint32_t first = 0;
+    uint32_t copyCount = instanceCount;
+    if (visibleIndices) {
+        InstancePacking::PackInstances(instances, *visibleIndices, staging);
+    } else if (partial) {
+        first = std::min(changed->first, instanceCount);
+        copyCount = std::min(changed->last, instanceCount) - first;
+        if (copyCount > 0) {
+            InstancePacking::PackInstances(instances, InstanceRange{first, first + copyCount}, staging);
+        }
     } else {
-        // Buffer was reallocated - create new buffer and update descriptor set
-        VulkanHelpers::uploadToBuffer(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
-                                       gpuInstances, m_instanceMotorBuffer, m_instanceMotorBufferMemory);
+        InstancePacking::PackInstances(instances, staging);
+    }
+
+    if (m_frameStarted) {
+        m_pendingInstanceCopy = copyCount;
+        m_pendingInstanceFirst = first;
+        m_pendingInstanceSlot = slot;
+        return;
+    }
 
-        // Track the new buffer capacity
-        m_instanceBufferCapacity = instanceCount;
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = m_commandPool;
+    allocInfo.commandBufferCount = 1;
 
-        // Update descriptor set to point to new buffer (binding 10)
-        // Only if descriptor set already exists (not during initial setup)
-        if (m_descriptorSet != VK_NULL_HANDLE) {
-            VkDescriptorBufferInfo instanceMotorBufferInfo{};
-            instanceMotorBufferInfo.buffer = m_instanceMotorBuffer;
-            instanceMotorBufferInfo.offset = 0;
-            instanceMotorBufferInfo.range = VK_WHOLE_SIZE;
+    VkCommandBuffer cmdBuffer;
+    if (vkAllocateCommandBuffers(m_device, &allocInfo, &cmdBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate command buffer for instance upload");
+    }
 
-            VkWriteDescriptorSet descriptorWrite{};
-            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrite.dstSet = m_descriptorSet;
-            descriptorWrite.dstBinding = 10;
-            descriptorWrite.dstArrayElement = 0;
-            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            descriptorWrite.descriptorCount = 1;
-            descriptorWrite.pBufferInfo = &instanceMotorBufferInfo;
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cmdBuffer, &beginInfo);
+    recordInstanceCopy(cmdBuffer, slot, first, copyCount);
+    vkEndCommandBuffer(cmdBuffer);
 
-            vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
-        }
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmdBuffer;
+    vkQueueSubmit(m_computeQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(m_computeQueue);
+
+    vkFreeCommandBuffers(m_device, m_commandPool, 1, &cmdBuffer);
+}
+
+void VulkanRenderer::ensureInstanceCapacity(uint32_t instanceCount) {
+    if (instanceCount <= m_instanceBufferCapacity && m_instanceStagingMapped != nullptr) {
+        return;
+    }
+
+    // Wait for GPU to finish using the old buffers
+    vkDeviceWaitIdle(m_device);
+    destroyInstanceBuffers();
+    m_pendingInstanceCopy = 0;
+
+    const uint32_t capacity = std::max(instanceCount, m_instanceBufferCapacity);
+    const VkDeviceSize slotSize = sizeof(Scene::GPUMeshInstance) * capacity;
+    const size_t slotCount = std::max<size_t>(m_swapchainImages.size(), 1);
+
+    createBuffer(slotSize,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                m_instanceMotorBuffer, m_instanceMotorBufferMemory);
+    createBuffer(slotSize * slotCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                m_instanceStagingBuffer, m_instanceStagingMemory);
+
+    void* mapped = nullptr;
+    if (vkMapMemory(m_device, m_instanceStagingMemory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to map instance staging buffer");
     }
+    m_instanceStagingMapped = static_cast<Scene::GPUMeshInstance*>(mapped);
+    m_instanceBufferCapacity = capacity;
+
+    // Update descriptor set to point to new buffer (binding 10)
+    // Only if descriptor set already exists (not during initial setup)
+    if (m_descriptorSet != VK_NULL_HANDLE) {
+        VkDescriptorBufferInfo instanceMotorBufferInfo{};
+        instanceMotorBufferInfo.buffer = m_instanceMotorBuffer;
+        instanceMotorBufferInfo.offset = 0;
+        instanceMotorBufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = m_descriptorSet;
+        descriptorWrite.dstBinding = 10;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pBufferInfo = &instanceMotorBufferInfo;
+
+        vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+    }
+}
+
+void VulkanRenderer::destroyInstanceBuffers() {
+    if (m_instanceStagingMapped != nullptr) {
+        vkUnmapMemory(m_device, m_instanceStagingMemory);
+        m_instanceStagingMapped = nullptr;
+    }
+    if (m_instanceStagingBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, m_instanceStagingBuffer, nullptr);
+        m_instanceStagingBuffer = VK_NULL_HANDLE;
+    }
+    if (m_instanceStagingMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, m_instanceStagingMemory, nullptr);
+        m_instanceStagingMemory = VK_NULL_HANDLE;
+    }
+    if (m_instanceMotorBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, m_instanceMotorBuffer, nullptr);
+        m_instanceMotorBuffer = VK_NULL_HANDLE;
+    }
+    if (m_instanceMotorBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, m_instanceMotorBufferMemory, nullptr);
+        m_instanceMotorBufferMemory = VK_NULL_HANDLE;
+    }
+}
 
+void VulkanRenderer::recordInstanceCopy(VkCommandBuffer cmdBuffer, uint32_t slot, uint32_t first, uint32_t instanceCount) {
+    // Earlier dispatches still reading the instance buffer must finish before it is overwritten
+    VkMemoryBarrier2 readBarrier{};
+    readBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    readBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    readBarrier.srcAccessMask = VK_ACCESS_2_NONE;
+    readBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    readBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    VkDependencyInfo depInfo{};
+    depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &readBarrier;
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+
+    VkBufferCopy region{};
+    region.srcOffset = sizeof(Scene::GPUMeshInstance) * (static_cast<VkDeviceSize>(slot) * m_instanceBufferCapacity + first);
+    region.dstOffset = sizeof(Scene::GPUMeshInstance) * static_cast<VkDeviceSize>(first);
+    region.size = sizeof(Scene::GPUMeshInstance) * static_cast<VkDeviceSize>(instanceCount);
+    vkCmdCopyBuffer(cmdBuffer, m_instanceStagingBuffer, m_instanceMotorBuffer, 1, &region);
+
+    VkMemoryBarrier2 writeBarrier{};
+    writeBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    writeBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    writeBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    writeBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    writeBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+
+    depInfo.pMemoryBarriers = &writeBarrier;
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
 }
 
 void VulkanRenderer::UpdateSpheres(const std::vector<Scene::GPUSphere>& spheres) {
@@ -1197,56 +1642,482 @@ void VulkanRenderer::UpdatePlanes(const std::vector<Scene::GPUPlane>& planes) {
                                     planes, m_planeBuffer);
 }
 
+void VulkanRenderer::UpdateLights(const std::vector<Scene::GPULight>& lights) {
+    if (lights.empty() || m_lightBuffer == VK_NULL_HANDLE) {
+        return;
+    }
+    // Lights rarely change (only when animated), and each update is a blocking transfer
+    if (lights.size() == m_uploadedLights.size() &&
+        std::memcmp(lights.data(), m_uploadedLights.data(), sizeof(Scene::GPULight) * lights.size()) == 0) {
+        return;
+    }
+    VulkanHelpers::updateBufferData(m_device, m_physicalDevice, m_commandPool, m_computeQueue,
+                                    lights, m_lightBuffer);
+    m_uploadedLights.assign(lights.begin(), lights.end());
+}
+
 void VulkanRenderer::WaitIdle() {
     if (m_device != VK_NULL_HANDLE) {
         vkDeviceWaitIdle(m_device);
     }
 }
 
+bool VulkanRenderer::TakeGpuFrameTime(double& milliseconds) {
+    if (!m_hasNewGpuFrameTime) {
+        return false;
+    }
+    milliseconds = m_lastGpuFrameMs;
+    m_hasNewGpuFrameTime = false;
+    return true;
+}
+
 // ============================================================================
-// Core Initialization Methods
+// Visibility Queries
 // ============================================================================
 
-void VulkanRenderer::createInstance() {
-    // Check for validation layer support if enabled
-    if (ENABLE_VALIDATION_LAYERS && !checkValidationLayerSupport()) {
-        std::cerr << "Warning: Validation layers requested but not available!\n";
+bool VulkanRenderer::onOwnerThread(const char* call) const {
+    if (m_ownerThread.load(std::memory_order_acquire) == std::this_thread::get_id()) {
+        return true;
     }
+    if (!m_warnedOffThread.exchange(true, std::memory_order_relaxed)) {
+        std::cerr << "Warning: " << call << " called from a thread that does not own the renderer "
+                  << "(not supported with the render thread), ignored\n";
+    }
+    return false;
+}
 
-    VkApplicationInfo appInfo{};
-    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    appInfo.pApplicationName = "FlyTracer";
-    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.pEngineName = "No Engine";
-    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_3;
-
-    // Get SDL required extensions
-    uint32_t sdlExtensionCount = 0;
-    const char* const* sdlExtensions = SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount);
-    if (sdlExtensions == nullptr) {
-        throw std::runtime_error("Failed to get SDL Vulkan extensions: " + std::string(SDL_GetError()));
+void VulkanRenderer::EnableVisibilityQueries() {
+    if (m_computePipeline != VK_NULL_HANDLE) {
+        std::cerr << "Warning: EnableVisibilityQueries must be called before CreateComputePipeline, ignored\n";
+        return;
     }
+    m_visibilityQueriesEnabled = true;
+}
 
-    std::vector<const char*> extensions(sdlExtensions, sdlExtensions + sdlExtensionCount);
+uint32_t VulkanRenderer::SubmitVisibilityQuery(const std::vector<Scene::GPUVisibilityRay>& rays,
+                                               VisibilityQueryMode mode) {
+    if (!onOwnerThread("SubmitVisibilityQuery")) {
+        return 0;
+    }
+    if (!m_visibilityQueriesEnabled) {
+        std::cerr << "Warning: SubmitVisibilityQuery called without EnableVisibilityQueries\n";
+        return 0;
+    }
+    if (rays.empty() || m_visibilityPipeline == VK_NULL_HANDLE) {
+        return 0;
+    }
 
-    // Add debug utils extension for validation layer messages
-    if (ENABLE_VALIDATION_LAYERS) {
-        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-        // Add layer settings extension for configuring validation features
-        extensions.push_back(VK_EXT_LAYER_SETTINGS_EXTENSION_NAME);
+    // Find a free slot - never wait for an in-flight query to make room
+    VisibilityQuerySlot* slot = nullptr;
+    for (auto& candidate : m_visibilitySlots) {
+        if (candidate.queryId == 0) {
+            slot = &candidate;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        std::cerr << "Warning: All " << kMaxVisibilityQueries
+                  << " visibility query slots are in flight, query dropped\n";
+        return 0;
     }
 
-#ifdef __APPLE__
-    // Required for MoltenVK on macOS
-    extensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
-    extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
-#endif
+    const auto rayCount = static_cast<uint32_t>(rays.size());
+    ensureVisibilitySlotCapacity(*slot, rayCount);
+    std::memcpy(slot->mappedRays, rays.data(), sizeof(Scene::GPUVisibilityRay) * rays.size());
 
-    // Setup validation features
-    VkValidationFeatureEnableEXT enabledFeatures[] = {
-        VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT,
-        VK_VALIDATION_FEATURE_ENABLE_DEBUG_PRINTF_EXT
+    // Scene counts come from the last rendered frame so queries see the same scene as the image
+    VisibilityPushConstants pushConstants{};
+    pushConstants.rayCount = rayCount;
+    pushConstants.queryMode = static_cast<uint32_t>(mode);
+    pushConstants.triangleCount = m_pushConstants.triangleCount;
+    pushConstants.sphereCount = m_pushConstants.sphereCount;
+    pushConstants.planeCount = m_pushConstants.planeCount;
+    pushConstants.instanceCount = m_pushConstants.instanceCount;
+    pushConstants.planeTileScale = m_pushConstants.planeTileScale;
+
+    VkCommandBuffer cmdBuffer = slot->commandBuffer;
+    vkResetCommandBuffer(cmdBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(cmdBuffer, &beginInfo) != VK_SUCCESS) {
+        std::cerr << "Warning: Failed to begin visibility query command buffer\n";
+        return 0;
+    }
+
+    const std::array<VkDescriptorSet, 2> descriptorSets = {m_descriptorSet, slot->descriptorSet};
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_visibilityPipeline);
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_visibilityPipelineLayout,
+                           0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+    vkCmdPushConstants(cmdBuffer, m_visibilityPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                      sizeof(VisibilityPushConstants), &pushConstants);
+    vkCmdDispatch(cmdBuffer, (rayCount + 63) / 64, 1, 1);
+
+    // Make shader writes to the result buffer visible to host reads after the fence signals
+    VkMemoryBarrier2 hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    hostBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    hostBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+    hostBarrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+    VkDependencyInfo depInfo{};
+    depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &hostBarrier;
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+
+    if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS) {
+        std::cerr << "Warning: Failed to end visibility query command buffer\n";
+        return 0;
+    }
+
+    VkCommandBufferSubmitInfo cmdBufferSubmitInfo{};
+    cmdBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    cmdBufferSubmitInfo.commandBuffer = cmdBuffer;
+
+    VkSubmitInfo2 submitInfo2{};
+    submitInfo2.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo2.commandBufferInfoCount = 1;
+    submitInfo2.pCommandBufferInfos = &cmdBufferSubmitInfo;
+
+    vkResetFences(m_device, 1, &slot->fence);
+    if (m_vkQueueSubmit2KHR(m_computeQueue, 1, &submitInfo2, slot->fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit visibility query");
+    }
+
+    slot->rayCount = rayCount;
+    slot->queryId = m_nextVisibilityQueryId++;
+    if (m_nextVisibilityQueryId == 0) {
+        m_nextVisibilityQueryId = 1;  // 0 is reserved for "no query"
+    }
+    return slot->queryId;
+}
+
+bool VulkanRenderer::PollVisibilityQuery(uint32_t queryId, std::vector<Scene::GPUVisibilityResult>& results) {
+    if (queryId == 0 || !onOwnerThread("PollVisibilityQuery")) {
+        return false;
+    }
+
+    for (auto& slot : m_visibilitySlots) {
+        if (slot.queryId != queryId) {
+            continue;
+        }
+
+        // Non-blocking: the fence is only queried, never waited on
+        const VkResult status = vkGetFenceStatus(m_device, slot.fence);
+        if (status == VK_NOT_READY) {
+            return false;
+        }
+        if (status != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query visibility fence status: " + std::to_string(status));
+        }
+
+        const auto* gpuResults = static_cast<const Scene::GPUVisibilityResult*>(slot.mappedResults);
+        results.assign(gpuResults, gpuResults + slot.rayCount);
+
+        slot.queryId = 0;
+        slot.rayCount = 0;
+        return true;
+    }
+
+    std::cerr << "Warning: Unknown visibility query id " << queryId << "\n";
+    return false;
+}
+
+bool VulkanRenderer::IsVisibilityQueryPending(uint32_t queryId) const {
+    if (queryId == 0 || !onOwnerThread("IsVisibilityQueryPending")) {
+        return false;
+    }
+    for (const auto& slot : m_visibilitySlots) {
+        if (slot.queryId == queryId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// GPU Picking
+// ============================================================================
+
+void VulkanRenderer::EnableObjectIds() {
+    if (m_descriptorSet != VK_NULL_HANDLE) {
+        std::cerr << "Warning: EnableObjectIds must be called before CreateDescriptorSet, ignored\n";
+        return;
+    }
+    m_objectIdsEnabled = true;
+}
+
+void VulkanRenderer::RequestPick(float x, float y) {
+    if (!m_objectIdsEnabled || x < 0.0f || y < 0.0f) {
+        return;
+    }
+    const auto px = static_cast<uint32_t>(x);
+    const auto py = static_cast<uint32_t>(y);
+    if (px >= static_cast<uint32_t>(m_config.width) || py >= static_cast<uint32_t>(m_config.height)) {
+        return;
+    }
+    m_nextPick = {true, px, py};
+}
+
+bool VulkanRenderer::GetPickResult(PickResult& out) const {
+    if (!m_hasPickResult) {
+        out = PickResult{};
+        return false;
+    }
+
+    // Decode - must match encodeObjectId in raytracer.comp
+    const uint32_t typeBits = m_lastPickIds[0] >> 30;
+    out.valid = true;
+    out.hit = typeBits != 0;
+    out.primitiveType = static_cast<int32_t>(typeBits) - 1;
+    out.index = m_lastPickIds[0] & 0x3FFFFFFFu;
+    out.triangleIndex = m_lastPickIds[1];
+    out.pixelX = m_lastPick.x;
+    out.pixelY = m_lastPick.y;
+    return true;
+}
+
+// ============================================================================
+// AOV Outputs
+// ============================================================================
+
+void VulkanRenderer::EnableAOVs() {
+    if (m_descriptorSet != VK_NULL_HANDLE) {
+        std::cerr << "Warning: EnableAOVs must be called before CreateDescriptorSet, ignored\n";
+        return;
+    }
+    m_aovsEnabled = true;
+}
+
+bool VulkanRenderer::ReadbackAOVs(AOVReadback& out) {
+    if (!onOwnerThread("ReadbackAOVs")) {
+        return false;
+    }
+    if (!m_aovsEnabled) {
+        std::cerr << "Warning: ReadbackAOVs called without EnableAOVs\n";
+        return false;
+    }
+
+    // Readback is for offline capture: make sure the last frame's writes are complete
+    WaitIdle();
+
+    const auto width = static_cast<uint32_t>(m_config.width);
+    const auto height = static_cast<uint32_t>(m_config.height);
+    const VkDeviceSize pixelCount = static_cast<VkDeviceSize>(width) * height;
+
+    struct Target {
+        VkImage image;
+        VkDeviceSize bytesPerPixel;
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VkDeviceMemory memory{VK_NULL_HANDLE};
+    };
+    std::array<Target, 3> targets = {{
+        {m_aovNormalDepthImage, 4 * sizeof(float)},
+        {m_aovAlbedoImage, 4 * sizeof(uint8_t)},
+        {m_aovIdImage, 2 * sizeof(uint32_t)},
+    }};
+
+    for (auto& target : targets) {
+        createBuffer(pixelCount * target.bytesPerPixel, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     target.buffer, target.memory);
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = m_commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer cmdBuffer;
+    vkAllocateCommandBuffers(m_device, &allocInfo, &cmdBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cmdBuffer, &beginInfo);
+
+    for (const auto& target : targets) {
+        VulkanHelpers::transitionImageLayout2(cmdBuffer, target.image,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                             VK_ACCESS_2_SHADER_WRITE_BIT,
+                             VK_PIPELINE_STAGE_2_COPY_BIT,
+                             VK_ACCESS_2_TRANSFER_READ_BIT,
+                             m_vkCmdPipelineBarrier2KHR);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {width, height, 1};
+        vkCmdCopyImageToBuffer(cmdBuffer, target.image, VK_IMAGE_LAYOUT_GENERAL,
+                               target.buffer, 1, &region);
+    }
+
+    vkEndCommandBuffer(cmdBuffer);
+
+    VkCommandBufferSubmitInfo cmdBufferSubmitInfo{};
+    cmdBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    cmdBufferSubmitInfo.commandBuffer = cmdBuffer;
+
+    VkSubmitInfo2 submitInfo2{};
+    submitInfo2.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo2.commandBufferInfoCount = 1;
+    submitInfo2.pCommandBufferInfos = &cmdBufferSubmitInfo;
+
+    const bool submitted = m_vkQueueSubmit2KHR(m_computeQueue, 1, &submitInfo2, VK_NULL_HANDLE) == VK_SUCCESS;
+    if (submitted) {
+        vkQueueWaitIdle(m_computeQueue);
+
+        out.width = width;
+        out.height = height;
+        out.normalDepth.resize(pixelCount * 4);
+        out.albedo.resize(pixelCount * 4);
+        out.ids.resize(pixelCount * 2);
+
+        void* mapped = nullptr;
+        vkMapMemory(m_device, targets[0].memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+        std::memcpy(out.normalDepth.data(), mapped, pixelCount * targets[0].bytesPerPixel);
+        vkUnmapMemory(m_device, targets[0].memory);
+
+        vkMapMemory(m_device, targets[1].memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+        std::memcpy(out.albedo.data(), mapped, pixelCount * targets[1].bytesPerPixel);
+        vkUnmapMemory(m_device, targets[1].memory);
+
+        vkMapMemory(m_device, targets[2].memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+        std::memcpy(out.ids.data(), mapped, pixelCount * targets[2].bytesPerPixel);
+        vkUnmapMemory(m_device, targets[2].memory);
+    } else {
+        std::cerr << "Warning: Failed to submit AOV readback\n";
+    }
+
+    vkFreeCommandBuffers(m_device, m_commandPool, 1, &cmdBuffer);
+    for (auto& target : targets) {
+        vkDestroyBuffer(m_device, target.buffer, nullptr);
+        vkFreeMemory(m_device, target.memory, nullptr);
+    }
+
+    return submitted;
+}
+
+// ============================================================================
+// Multi-View Rendering
+// ============================================================================
+
+void VulkanRenderer::EnableMultiView() {
+    if (m_computePipeline != VK_NULL_HANDLE) {
+        std::cerr << "Warning: EnableMultiView must be called before CreateComputePipeline, ignored\n";
+        return;
+    }
+    m_multiViewEnabled = true;
+}
+
+bool VulkanRenderer::RenderMultiView(const std::vector<Scene::GPUCameraView>& views,
+                                     uint32_t width, uint32_t height, MultiViewReadback& out) {
+    if (!onOwnerThread("RenderMultiView")) {
+        return false;
+    }
+    if (!m_multiViewEnabled) {
+        std::cerr << "Warning: RenderMultiView called without EnableMultiView\n";
+        return false;
+    }
+    if (views.empty() || width == 0 || height == 0 || m_multiViewPipeline == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    const auto viewCount = static_cast<uint32_t>(views.size());
+    ensureMultiViewCapacity(width, height, viewCount);
+
+    const VkDeviceSize viewBytes = static_cast<VkDeviceSize>(width) * height * 4;
+    out.width = width;
+    out.height = height;
+    out.viewCount = viewCount;
+    out.pixels.resize(viewBytes * viewCount);
+
+    // Copy a finished batch out of its readback buffer and mark the slot idle
+    auto drainSlot = [&](MultiViewBatchSlot& slot) {
+        if (slot.viewCount == 0) {
+            return;
+        }
+        vkWaitForFences(m_device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+        std::memcpy(out.pixels.data() + slot.firstView * viewBytes, slot.mappedReadback,
+                    slot.viewCount * viewBytes);
+        slot.viewCount = 0;
+    };
+
+    // Alternate between slots so batch N is copied out while batch N+1 renders
+    bool submitted = true;
+    uint32_t slotIndex = 0;
+    for (uint32_t firstView = 0; firstView < viewCount && submitted; firstView += m_multiViewLayers) {
+        MultiViewBatchSlot& slot = m_multiViewSlots[slotIndex];
+        slotIndex = (slotIndex + 1) % kMultiViewBatchSlots;
+        drainSlot(slot);
+
+        slot.firstView = firstView;
+        slot.viewCount = std::min(m_multiViewLayers, viewCount - firstView);
+        std::memcpy(slot.mappedCameras, views.data() + firstView,
+                    sizeof(Scene::GPUCameraView) * slot.viewCount);
+
+        submitted = submitMultiViewBatch(slot);
+        if (!submitted) {
+            slot.viewCount = 0;
+        }
+    }
+
+    for (auto& slot : m_multiViewSlots) {
+        drainSlot(slot);
+    }
+    return submitted;
+}
+
+// ============================================================================
+// Core Initialization Methods
+// ============================================================================
+
+void VulkanRenderer::createInstance() {
+    // Check for validation layer support if enabled
+    if (ENABLE_VALIDATION_LAYERS && !checkValidationLayerSupport()) {
+        std::cerr << "Warning: Validation layers requested but not available!\n";
+    }
+
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "FlyTracer";
+    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.pEngineName = "No Engine";
+    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.apiVersion = VK_API_VERSION_1_3;
+
+    // Get SDL required extensions
+    uint32_t sdlExtensionCount = 0;
+    const char* const* sdlExtensions = SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount);
+    if (sdlExtensions == nullptr) {
+        throw std::runtime_error("Failed to get SDL Vulkan extensions: " + std::string(SDL_GetError()));
+    }
+
+    std::vector<const char*> extensions(sdlExtensions, sdlExtensions + sdlExtensionCount);
+
+    // Add debug utils extension for validation layer messages
+    if (ENABLE_VALIDATION_LAYERS) {
+        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        // Add layer settings extension for configuring validation features
+        extensions.push_back(VK_EXT_LAYER_SETTINGS_EXTENSION_NAME);
+    }
+
+#ifdef __APPLE__
+    // Required for MoltenVK on macOS
+    extensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+    extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+#endif
+
+    // Setup validation features
+    VkValidationFeatureEnableEXT enabledFeatures[] = {
+        VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT,
+        VK_VALIDATION_FEATURE_ENABLE_DEBUG_PRINTF_EXT
     };
 
     // Disable best practices warnings (can be noisy)
@@ -1477,10 +2348,24 @@ void VulkanRenderer::createDevice() {
     dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
     dynamicRenderingFeatures.pNext = &sync2Features;
 
+    // Non-uniform indexing of the sampled texture array, where supported (EnableSampledTextures)
+    VkPhysicalDeviceDescriptorIndexingFeatures supportedIndexing{};
+    supportedIndexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &supportedIndexing;
+    vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures);
+    m_nonUniformSamplingSupported = supportedIndexing.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
+
+    VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{};
+    descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = supportedIndexing.shaderSampledImageArrayNonUniformIndexing;
+    descriptorIndexingFeatures.pNext = &dynamicRenderingFeatures;
+
     VkPhysicalDeviceFeatures2 deviceFeatures2{};
     deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     deviceFeatures2.features = deviceFeatures;
-    deviceFeatures2.pNext = &dynamicRenderingFeatures;
+    deviceFeatures2.pNext = &descriptorIndexingFeatures;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -1614,10 +2499,13 @@ void VulkanRenderer::createRenderResources() {
     createDescriptorSetLayout();
     createDescriptorPool();
     createSyncObjects();
+    createTimestampQueryPool();
     createSwapchainImageViews();
     createRenderPass();
     createFramebuffers();
     createImGuiResources();
+    createVisibilityResources();
+    createMultiViewResources();
 
     std::cout << "Render resources created\n";
 }
@@ -1734,8 +2622,126 @@ void VulkanRenderer::createStorageImage() {
     std::cout << "Storage image created\n";
 }
 
+void VulkanRenderer::createOutputImage(VkFormat format, uint32_t width, uint32_t height,
+                                       VkImage& image, VkDeviceMemory& memory, VkImageView& view) {
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = width;
+    imageInfo.extent.height = height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateImage(m_device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create output image");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(m_device, image, &memRequirements);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (vkAllocateMemory(m_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate output image memory");
+    }
+
+    vkBindImageMemory(m_device, image, memory, 0);
+
+    view = VulkanHelpers::createImageView(m_device, image, format);
+
+    // Transition to GENERAL layout once, like the color storage image
+    VkCommandBuffer cmdBuffer = m_commandBuffers[0];
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(cmdBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin command buffer for output image transition");
+    }
+    VulkanHelpers::transitionImageLayout2(cmdBuffer, image,
+                         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                         VK_PIPELINE_STAGE_2_NONE,
+                         VK_ACCESS_2_NONE,
+                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_2_SHADER_WRITE_BIT,
+                         m_vkCmdPipelineBarrier2KHR);
+    if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to end command buffer for output image transition");
+    }
+
+    VkCommandBufferSubmitInfo cmdBufferSubmitInfo{};
+    cmdBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    cmdBufferSubmitInfo.commandBuffer = cmdBuffer;
+
+    VkSubmitInfo2 submitInfo2{};
+    submitInfo2.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo2.commandBufferInfoCount = 1;
+    submitInfo2.pCommandBufferInfos = &cmdBufferSubmitInfo;
+
+    if (m_vkQueueSubmit2KHR(m_computeQueue, 1, &submitInfo2, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit output image layout transition");
+    }
+    vkQueueWaitIdle(m_computeQueue);
+}
+
+void VulkanRenderer::createObjectIdImage() {
+    // The binding always exists; without picking a 1x1 image keeps the descriptor valid
+    const uint32_t width = m_objectIdsEnabled ? static_cast<uint32_t>(m_config.width) : 1;
+    const uint32_t height = m_objectIdsEnabled ? static_cast<uint32_t>(m_config.height) : 1;
+
+    createOutputImage(VK_FORMAT_R32G32_UINT, width, height,
+                      m_objectIdImage, m_objectIdImageMemory, m_objectIdImageView);
+
+    if (m_objectIdsEnabled) {
+        // One RG32 texel per frame in flight, persistently mapped
+        const VkDeviceSize readbackSize = m_swapchainImages.size() * 2 * sizeof(uint32_t);
+        createBuffer(readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     m_pickReadbackBuffer, m_pickReadbackBufferMemory);
+
+        void* mapped = nullptr;
+        vkMapMemory(m_device, m_pickReadbackBufferMemory, 0, readbackSize, 0, &mapped);
+        m_pickReadbackMapped = static_cast<const uint32_t*>(mapped);
+        m_picksInFlight.assign(m_swapchainImages.size(), PickRequest{});
+    }
+
+    std::cout << "Object ID image created (" << width << "x" << height << ")\n";
+}
+
+void VulkanRenderer::createAOVImages() {
+    // Same placeholder scheme as the object-ID image: full resolution only when enabled
+    const uint32_t width = m_aovsEnabled ? static_cast<uint32_t>(m_config.width) : 1;
+    const uint32_t height = m_aovsEnabled ? static_cast<uint32_t>(m_config.height) : 1;
+
+    createOutputImage(VK_FORMAT_R32G32B32A32_SFLOAT, width, height,
+                      m_aovNormalDepthImage, m_aovNormalDepthImageMemory, m_aovNormalDepthImageView);
+    createOutputImage(VK_FORMAT_R8G8B8A8_UNORM, width, height,
+                      m_aovAlbedoImage, m_aovAlbedoImageMemory, m_aovAlbedoImageView);
+    createOutputImage(VK_FORMAT_R32G32_UINT, width, height,
+                      m_aovIdImage, m_aovIdImageMemory, m_aovIdImageView);
+
+    std::cout << "AOV images created (" << width << "x" << height << ")\n";
+}
+
 void VulkanRenderer::createDescriptorSetLayout() {
-    // 13 bindings: storage image, vertex, index, spheres, planes, lights, materials, bvhNodes, bvhTriIdx, texture, instanceMotors, meshInfos, textureInfos
+    // Sampled texture array, as large as the device allows up to kMaxSampledTextures
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+    m_sampledTextureSlots = std::min({kMaxSampledTextures, properties.limits.maxPerStageDescriptorSamplers,
+                                      properties.limits.maxPerStageDescriptorSampledImages});
+
+    // 21 bindings: storage image, vertex, index, spheres, planes, lights, materials, bvhNodes, bvhTriIdx, texture, instanceMotors, meshInfos, textureInfos, objectIds, 3 AOVs, sampled textures, page table, pages, tile feedback
     std::vector<VulkanHelpers::DescriptorBinding> bindings = {
         {0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
         {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},  // Vertices
@@ -1750,6 +2756,14 @@ void VulkanRenderer::createDescriptorSetLayout() {
         {10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT}, // Instance motors
         {11, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT}, // Mesh infos
         {12, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT}, // Texture infos
+        {13, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},  // Object IDs
+        {14, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},  // AOV normal + depth
+        {15, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},  // AOV albedo
+        {16, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},  // AOV material/instance IDs
+        {17, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, m_sampledTextureSlots},  // Sampled textures
+        {18, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT}, // Virtual texture page table
+        {19, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT}, // Virtual texture pages
+        {20, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT}, // Tile feedback
     };
 
     m_descriptorSetLayout = VulkanHelpers::createDescriptorSetLayout(m_device, bindings);
@@ -1757,11 +2771,13 @@ void VulkanRenderer::createDescriptorSetLayout() {
 }
 
 void VulkanRenderer::createDescriptorPool() {
-    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    poolSizes[0].descriptorCount = 1;
+    poolSizes[0].descriptorCount = 5;  // output color, object IDs, normal/depth, albedo, material/instance IDs
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[1].descriptorCount = 12;  // vertex, index, spheres, planes, lights, materials, bvhNodes, bvhTriIdx, texture, instanceMotors, meshInfos, textureInfos
+    poolSizes[1].descriptorCount = 15;  // vertex, index, spheres, planes, lights, materials, bvhNodes, bvhTriIdx, texture, instanceMotors, meshInfos, textureInfos, page table, pages, tile feedback
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[2].descriptorCount = m_sampledTextureSlots;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -1787,8 +2803,32 @@ void VulkanRenderer::CreateDescriptorSet() {
         throw std::runtime_error("Failed to allocate descriptor set");
     }
 
-    // Update all 13 descriptors
-    std::array<VkWriteDescriptorSet, 13> descriptorWrites{};
+    // Optional outputs are full resolution only when enabled (1x1 placeholders otherwise)
+    createObjectIdImage();
+    createAOVImages();
+
+    // Same for sampled textures: a white texel keeps binding 17 valid when none were uploaded
+    if (m_sampledTextures.empty()) {
+        uploadSampledTextures({TextureCache::Texture{{whiteTexel, 1, 1, Scene::TextureFormat::RGBA8}, true}});
+    }
+    if (m_textureSampler == VK_NULL_HANDLE) {
+        // Trilinear; the shader picks the level itself with textureLod
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(m_device, &samplerInfo, nullptr, &m_textureSampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create texture sampler");
+        }
+    }
+
+    // Update all 21 descriptors
+    std::array<VkWriteDescriptorSet, 21> descriptorWrites{};
 
     // Storage image (binding 0)
     VkDescriptorImageInfo imageInfo{};
@@ -1971,10 +3011,82 @@ void VulkanRenderer::CreateDescriptorSet() {
     descriptorWrites[12].descriptorCount = 1;
     descriptorWrites[12].pBufferInfo = &textureInfoBufferInfo;
 
-    vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()),
-                          descriptorWrites.data(), 0, nullptr);
+    // Object-ID image (binding 13)
+    VkDescriptorImageInfo objectIdImageInfo{};
+    objectIdImageInfo.imageView = m_objectIdImageView;
+    objectIdImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    descriptorWrites[13].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[13].dstSet = m_descriptorSet;
+    descriptorWrites[13].dstBinding = 13;
+    descriptorWrites[13].dstArrayElement = 0;
+    descriptorWrites[13].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    descriptorWrites[13].descriptorCount = 1;
+    descriptorWrites[13].pImageInfo = &objectIdImageInfo;
+
+    // AOV images (bindings 14-16)
+    std::array<VkDescriptorImageInfo, 3> aovImageInfos{};
+    aovImageInfos[0].imageView = m_aovNormalDepthImageView;
+    aovImageInfos[1].imageView = m_aovAlbedoImageView;
+    aovImageInfos[2].imageView = m_aovIdImageView;
+
+    for (uint32_t i = 0; i < aovImageInfos.size(); ++i) {
+        aovImageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet& write = descriptorWrites[14 + i];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = m_descriptorSet;
+        write.dstBinding = 14 + i;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write.descriptorCount = 1;
+        write.pImageInfo = &aovImageInfos[i];
+    }
 
-    std::cout << "Descriptor set created\n";
+    // Sampled textures (binding 17) - slots past the uploaded textures repeat the first one
+    std::vector<VkDescriptorImageInfo> sampledTextureInfos(m_sampledTextureSlots);
+    for (uint32_t i = 0; i < m_sampledTextureSlots; ++i) {
+        const SampledTexture& texture = m_sampledTextures[i < m_sampledTextures.size() ? i : 0];
+        sampledTextureInfos[i].sampler = m_textureSampler;
+        sampledTextureInfos[i].imageView = texture.view;
+        sampledTextureInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+
+    descriptorWrites[17].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[17].dstSet = m_descriptorSet;
+    descriptorWrites[17].dstBinding = 17;
+    descriptorWrites[17].dstArrayElement = 0;
+    descriptorWrites[17].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrites[17].descriptorCount = m_sampledTextureSlots;
+    descriptorWrites[17].pImageInfo = sampledTextureInfos.data();
+
+    // Virtual texture buffers (bindings 18-20) - the dummy buffer when virtual textures are off
+    std::array<VkDescriptorBufferInfo, 3> virtualTextureBufferInfos{};
+    virtualTextureBufferInfos[0].buffer = m_pageTableBuffer;
+    virtualTextureBufferInfos[1].buffer = m_pageBuffer;
+    virtualTextureBufferInfos[2].buffer = m_tileFeedbackBuffer;
+
+    for (uint32_t i = 0; i < virtualTextureBufferInfos.size(); ++i) {
+        if (virtualTextureBufferInfos[i].buffer == VK_NULL_HANDLE) {
+            virtualTextureBufferInfos[i].buffer = m_vertexBuffer;
+        }
+        virtualTextureBufferInfos[i].offset = 0;
+        virtualTextureBufferInfos[i].range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet& write = descriptorWrites[18 + i];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = m_descriptorSet;
+        write.dstBinding = 18 + i;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &virtualTextureBufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()),
+                          descriptorWrites.data(), 0, nullptr);
+
+    std::cout << "Descriptor set created\n";
 }
 
 void VulkanRenderer::CreateComputePipeline() {
@@ -1982,11 +3094,32 @@ void VulkanRenderer::CreateComputePipeline() {
     auto shaderCode = readFile(shaderPath);
     VkShaderModule shaderModule = createShaderModule(shaderCode);
 
+    // Specialization constants - disabled outputs are compiled out of the shader entirely
+    const std::array<uint32_t, 4> specData = {
+        m_objectIdsEnabled ? VK_TRUE : VK_FALSE,        // constant_id 0: WRITE_OBJECT_IDS
+        m_aovsEnabled ? VK_TRUE : VK_FALSE,             // constant_id 1: WRITE_AOVS
+        m_compactVerticesEnabled ? VK_TRUE : VK_FALSE,  // constant_id 2: COMPACT_VERTICES
+        m_sampledTextureSlots,                          // constant_id 3: SAMPLED_TEXTURE_SLOTS
+    };
+    std::array<VkSpecializationMapEntry, 4> specEntries{};
+    for (uint32_t i = 0; i < specEntries.size(); ++i) {
+        specEntries[i].constantID = i;
+        specEntries[i].offset = i * sizeof(uint32_t);
+        specEntries[i].size = sizeof(uint32_t);
+    }
+
+    VkSpecializationInfo specInfo{};
+    specInfo.mapEntryCount = static_cast<uint32_t>(specEntries.size());
+    specInfo.pMapEntries = specEntries.data();
+    specInfo.dataSize = sizeof(specData);
+    specInfo.pData = specData.data();
+
     VkPipelineShaderStageCreateInfo shaderStageInfo{};
     shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
     shaderStageInfo.module = shaderModule;
     shaderStageInfo.pName = "main";
+    shaderStageInfo.pSpecializationInfo = &specInfo;
 
     VkPushConstantRange pushConstantRange{};
     pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
@@ -2017,6 +3150,13 @@ void VulkanRenderer::CreateComputePipeline() {
 
     vkDestroyShaderModule(m_device, shaderModule, nullptr);
     std::cout << "Compute pipeline created\n";
+
+    if (m_visibilityQueriesEnabled) {
+        createVisibilityPipeline();
+    }
+    if (m_multiViewEnabled) {
+        createMultiViewPipeline();
+    }
 }
 
 void VulkanRenderer::createSyncObjects() {
@@ -2050,6 +3190,39 @@ void VulkanRenderer::createSyncObjects() {
     std::cout << "Sync objects created\n";
 }
 
+void VulkanRenderer::createTimestampQueryPool() {
+    // Timestamps are optional - some queues (and software drivers) report no valid bits
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+
+    const uint32_t validBits = queueFamilies[m_computeQueueFamily].timestampValidBits;
+    if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f) {
+        std::cout << "GPU timestamps not supported on the compute queue\n";
+        return;
+    }
+
+    const auto frameCount = static_cast<uint32_t>(m_inFlightFences.size());
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = frameCount * 2;
+
+    if (vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &m_timestampQueryPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create timestamp query pool");
+    }
+
+    m_timestampPeriodNs = properties.limits.timestampPeriod;
+    m_timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+    m_timestampsWritten.assign(frameCount, false);
+    std::cout << "Timestamp query pool created\n";
+}
+
 void VulkanRenderer::createSwapchainImageViews() {
     m_swapchainImageViews.resize(m_swapchainImages.size());
 
@@ -2189,9 +3362,565 @@ void VulkanRenderer::createImGuiResources() {
 
     ImGui_ImplVulkan_Init(&initInfo);
 
+    // Upload the font atlas now rather than lazily from the first NewFrame, which would
+    // submit to the graphics queue from whichever thread builds the UI
+    ImGui_ImplVulkan_CreateFontsTexture();
+
     std::cout << "ImGui initialized with render pass\n";
 }
 
+void VulkanRenderer::createVisibilityResources() {
+    // Set 1 of the visibility pipeline: per-query ray buffer + result buffer
+    std::vector<VulkanHelpers::DescriptorBinding> bindings = {
+        {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},  // Rays
+        {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},  // Results
+    };
+    m_visibilityDescriptorSetLayout = VulkanHelpers::createDescriptorSetLayout(m_device, bindings);
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 2 * kMaxVisibilityQueries;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = kMaxVisibilityQueries;
+
+    if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_visibilityDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create visibility descriptor pool");
+    }
+
+    std::array<VkDescriptorSetLayout, kMaxVisibilityQueries> layouts;
+    layouts.fill(m_visibilityDescriptorSetLayout);
+    std::array<VkDescriptorSet, kMaxVisibilityQueries> sets{};
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_visibilityDescriptorPool;
+    allocInfo.descriptorSetCount = kMaxVisibilityQueries;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(m_device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate visibility descriptor sets");
+    }
+
+    std::array<VkCommandBuffer, kMaxVisibilityQueries> cmdBuffers{};
+    VkCommandBufferAllocateInfo cmdAllocInfo{};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = m_commandPool;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = kMaxVisibilityQueries;
+
+    if (vkAllocateCommandBuffers(m_device, &cmdAllocInfo, cmdBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate visibility command buffers");
+    }
+
+    // Fences start signaled so a never-used slot reads as idle
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    for (uint32_t i = 0; i < kMaxVisibilityQueries; ++i) {
+        m_visibilitySlots[i].descriptorSet = sets[i];
+        m_visibilitySlots[i].commandBuffer = cmdBuffers[i];
+        if (vkCreateFence(m_device, &fenceInfo, nullptr, &m_visibilitySlots[i].fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create visibility query fence");
+        }
+    }
+
+    std::cout << "Visibility query resources created\n";
+}
+
+void VulkanRenderer::createVisibilityPipeline() {
+    const std::string shaderPath = m_config.shaderDir + "/visibility.comp.spv";
+    auto shaderCode = readFile(shaderPath);
+    VkShaderModule shaderModule = createShaderModule(shaderCode);
+
+    // Vertex layout must match the raytracer pipeline (constant_id 2: COMPACT_VERTICES)
+    const VkBool32 compactVertices = m_compactVerticesEnabled ? VK_TRUE : VK_FALSE;
+    VkSpecializationMapEntry specEntry{2, 0, sizeof(VkBool32)};
+    VkSpecializationInfo specInfo{};
+    specInfo.mapEntryCount = 1;
+    specInfo.pMapEntries = &specEntry;
+    specInfo.dataSize = sizeof(compactVertices);
+    specInfo.pData = &compactVertices;
+
+    VkPipelineShaderStageCreateInfo shaderStageInfo{};
+    shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStageInfo.module = shaderModule;
+    shaderStageInfo.pName = "main";
+    shaderStageInfo.pSpecializationInfo = &specInfo;
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(VisibilityPushConstants);
+
+    // Set 0 is the raytracer's scene set, so queries read the already-resident buffers
+    const std::array<VkDescriptorSetLayout, 2> setLayouts = {m_descriptorSetLayout, m_visibilityDescriptorSetLayout};
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr,
+                              &m_visibilityPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create visibility pipeline layout");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.layout = m_visibilityPipelineLayout;
+    pipelineInfo.stage = shaderStageInfo;
+
+    if (vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo,
+                                 nullptr, &m_visibilityPipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create visibility pipeline");
+    }
+
+    vkDestroyShaderModule(m_device, shaderModule, nullptr);
+    std::cout << "Visibility pipeline created\n";
+}
+
+void VulkanRenderer::ensureVisibilitySlotCapacity(VisibilityQuerySlot& slot, uint32_t rayCount) {
+    if (rayCount <= slot.capacity) {
+        return;
+    }
+
+    // Slot is free (its fence has signaled), so the old buffers are no longer in use
+    destroyVisibilitySlotBuffers(slot);
+
+    // Grow geometrically to avoid reallocating on every slightly larger batch
+    const uint32_t capacity = std::max(rayCount, slot.capacity * 2);
+    const VkMemoryPropertyFlags hostVisible =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    createBuffer(sizeof(Scene::GPUVisibilityRay) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 hostVisible, slot.rayBuffer, slot.rayBufferMemory);
+    createBuffer(sizeof(Scene::GPUVisibilityResult) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 hostVisible, slot.resultBuffer, slot.resultBufferMemory);
+
+    vkMapMemory(m_device, slot.rayBufferMemory, 0, VK_WHOLE_SIZE, 0, &slot.mappedRays);
+    vkMapMemory(m_device, slot.resultBufferMemory, 0, VK_WHOLE_SIZE, 0, &slot.mappedResults);
+    slot.capacity = capacity;
+
+    VkDescriptorBufferInfo rayBufferInfo{};
+    rayBufferInfo.buffer = slot.rayBuffer;
+    rayBufferInfo.offset = 0;
+    rayBufferInfo.range = VK_WHOLE_SIZE;
+
+    VkDescriptorBufferInfo resultBufferInfo{};
+    resultBufferInfo.buffer = slot.resultBuffer;
+    resultBufferInfo.offset = 0;
+    resultBufferInfo.range = VK_WHOLE_SIZE;
+
+    std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[0].dstSet = slot.descriptorSet;
+    descriptorWrites[0].dstBinding = 0;
+    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[0].descriptorCount = 1;
+    descriptorWrites[0].pBufferInfo = &rayBufferInfo;
+
+    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[1].dstSet = slot.descriptorSet;
+    descriptorWrites[1].dstBinding = 1;
+    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[1].descriptorCount = 1;
+    descriptorWrites[1].pBufferInfo = &resultBufferInfo;
+
+    vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()),
+                          descriptorWrites.data(), 0, nullptr);
+}
+
+void VulkanRenderer::destroyVisibilitySlotBuffers(VisibilityQuerySlot& slot) {
+    if (slot.rayBufferMemory != VK_NULL_HANDLE && slot.mappedRays != nullptr) {
+        vkUnmapMemory(m_device, slot.rayBufferMemory);
+        slot.mappedRays = nullptr;
+    }
+    if (slot.resultBufferMemory != VK_NULL_HANDLE && slot.mappedResults != nullptr) {
+        vkUnmapMemory(m_device, slot.resultBufferMemory);
+        slot.mappedResults = nullptr;
+    }
+    if (slot.rayBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, slot.rayBuffer, nullptr);
+        slot.rayBuffer = VK_NULL_HANDLE;
+    }
+    if (slot.rayBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, slot.rayBufferMemory, nullptr);
+        slot.rayBufferMemory = VK_NULL_HANDLE;
+    }
+    if (slot.resultBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, slot.resultBuffer, nullptr);
+        slot.resultBuffer = VK_NULL_HANDLE;
+    }
+    if (slot.resultBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, slot.resultBufferMemory, nullptr);
+        slot.resultBufferMemory = VK_NULL_HANDLE;
+    }
+    slot.capacity = 0;
+}
+
+void VulkanRenderer::createMultiViewResources() {
+    // Set 1 of the multi-view pipeline: per-batch camera records + layered output image
+    std::vector<VulkanHelpers::DescriptorBinding> bindings = {
+        {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},  // Cameras
+        {1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},   // View layers
+    };
+    m_multiViewDescriptorSetLayout = VulkanHelpers::createDescriptorSetLayout(m_device, bindings);
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[0].descriptorCount = kMultiViewBatchSlots;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[1].descriptorCount = kMultiViewBatchSlots;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = kMultiViewBatchSlots;
+
+    if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_multiViewDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create multi-view descriptor pool");
+    }
+
+    std::array<VkDescriptorSetLayout, kMultiViewBatchSlots> layouts;
+    layouts.fill(m_multiViewDescriptorSetLayout);
+    std::array<VkDescriptorSet, kMultiViewBatchSlots> sets{};
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_multiViewDescriptorPool;
+    allocInfo.descriptorSetCount = kMultiViewBatchSlots;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(m_device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate multi-view descriptor sets");
+    }
+
+    std::array<VkCommandBuffer, kMultiViewBatchSlots> cmdBuffers{};
+    VkCommandBufferAllocateInfo cmdAllocInfo{};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = m_commandPool;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = kMultiViewBatchSlots;
+
+    if (vkAllocateCommandBuffers(m_device, &cmdAllocInfo, cmdBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate multi-view command buffers");
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    for (uint32_t i = 0; i < kMultiViewBatchSlots; ++i) {
+        m_multiViewSlots[i].descriptorSet = sets[i];
+        m_multiViewSlots[i].commandBuffer = cmdBuffers[i];
+        if (vkCreateFence(m_device, &fenceInfo, nullptr, &m_multiViewSlots[i].fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create multi-view fence");
+        }
+    }
+
+    std::cout << "Multi-view resources created\n";
+}
+
+void VulkanRenderer::createMultiViewPipeline() {
+    const std::string shaderPath = m_config.shaderDir + "/multiview.comp.spv";
+    auto shaderCode = readFile(shaderPath);
+    VkShaderModule shaderModule = createShaderModule(shaderCode);
+
+    // Vertex layout and texture slots must match the raytracer pipeline
+    // (constant_id 2: COMPACT_VERTICES, constant_id 3: SAMPLED_TEXTURE_SLOTS)
+    const std::array<uint32_t, 2> specData = {
+        m_compactVerticesEnabled ? VK_TRUE : VK_FALSE,
+        m_sampledTextureSlots,
+    };
+    const std::array<VkSpecializationMapEntry, 2> specEntries = {{
+        {2, 0, sizeof(uint32_t)},
+        {3, sizeof(uint32_t), sizeof(uint32_t)},
+    }};
+    VkSpecializationInfo specInfo{};
+    specInfo.mapEntryCount = static_cast<uint32_t>(specEntries.size());
+    specInfo.pMapEntries = specEntries.data();
+    specInfo.dataSize = sizeof(specData);
+    specInfo.pData = specData.data();
+
+    VkPipelineShaderStageCreateInfo shaderStageInfo{};
+    shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStageInfo.module = shaderModule;
+    shaderStageInfo.pName = "main";
+    shaderStageInfo.pSpecializationInfo = &specInfo;
+
+    // Same push constant block as the raytracer; cameras come from set 1 instead
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    const std::array<VkDescriptorSetLayout, 2> setLayouts = {m_descriptorSetLayout, m_multiViewDescriptorSetLayout};
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr,
+                              &m_multiViewPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create multi-view pipeline layout");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.layout = m_multiViewPipelineLayout;
+    pipelineInfo.stage = shaderStageInfo;
+
+    if (vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo,
+                                 nullptr, &m_multiViewPipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create multi-view pipeline");
+    }
+
+    vkDestroyShaderModule(m_device, shaderModule, nullptr);
+    std::cout << "Multi-view pipeline created\n";
+}
+
+void VulkanRenderer::ensureMultiViewCapacity(uint32_t width, uint32_t height, uint32_t viewCount) {
+    // Views per batch are bounded by the per-slot memory budget and the device layer limit
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+
+    const VkDeviceSize viewBytes = static_cast<VkDeviceSize>(width) * height * 4;
+    const VkDeviceSize budgetLayers = std::max<VkDeviceSize>(1, kMultiViewBatchBytes / viewBytes);
+    const auto layers = static_cast<uint32_t>(std::min<VkDeviceSize>(
+        {viewCount, budgetLayers, properties.limits.maxImageArrayLayers}));
+
+    if (width == m_multiViewWidth && height == m_multiViewHeight && layers <= m_multiViewLayers) {
+        return;
+    }
+
+    // Every slot is drained before RenderMultiView returns, so nothing is still in flight
+    for (auto& slot : m_multiViewSlots) {
+        destroyMultiViewSlotResources(slot);
+    }
+
+    const VkMemoryPropertyFlags hostVisible =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    for (auto& slot : m_multiViewSlots) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width = width;
+        imageInfo.extent.height = height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = layers;
+        imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(m_device, &imageInfo, nullptr, &slot.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create multi-view image");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(m_device, slot.image, &memRequirements);
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits,
+                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (vkAllocateMemory(m_device, &allocInfo, nullptr, &slot.imageMemory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate multi-view image memory");
+        }
+        vkBindImageMemory(m_device, slot.image, slot.imageMemory, 0);
+
+        slot.imageView = VulkanHelpers::createImageView(m_device, slot.image, VK_FORMAT_R8G8B8A8_UNORM,
+                                                        VK_IMAGE_ASPECT_COLOR_BIT,
+                                                        VK_IMAGE_VIEW_TYPE_2D_ARRAY, layers);
+
+        createBuffer(sizeof(Scene::GPUCameraView) * layers, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     hostVisible, slot.cameraBuffer, slot.cameraBufferMemory);
+        createBuffer(viewBytes * layers, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     hostVisible, slot.readbackBuffer, slot.readbackBufferMemory);
+
+        vkMapMemory(m_device, slot.cameraBufferMemory, 0, VK_WHOLE_SIZE, 0, &slot.mappedCameras);
+        void* mappedReadback = nullptr;
+        vkMapMemory(m_device, slot.readbackBufferMemory, 0, VK_WHOLE_SIZE, 0, &mappedReadback);
+        slot.mappedReadback = mappedReadback;
+
+        VkDescriptorBufferInfo cameraBufferInfo{};
+        cameraBufferInfo.buffer = slot.cameraBuffer;
+        cameraBufferInfo.offset = 0;
+        cameraBufferInfo.range = VK_WHOLE_SIZE;
+
+        VkDescriptorImageInfo viewImageInfo{};
+        viewImageInfo.imageView = slot.imageView;
+        viewImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = slot.descriptorSet;
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &cameraBufferInfo;
+
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = slot.descriptorSet;
+        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pImageInfo = &viewImageInfo;
+
+        vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()),
+                              descriptorWrites.data(), 0, nullptr);
+    }
+
+    m_multiViewWidth = width;
+    m_multiViewHeight = height;
+    m_multiViewLayers = layers;
+    std::cout << "Multi-view batches: " << layers << " views of " << width << "x" << height << "\n";
+}
+
+bool VulkanRenderer::submitMultiViewBatch(MultiViewBatchSlot& slot) {
+    VkCommandBuffer cmdBuffer = slot.commandBuffer;
+    vkResetCommandBuffer(cmdBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(cmdBuffer, &beginInfo) != VK_SUCCESS) {
+        std::cerr << "Warning: Failed to begin multi-view command buffer\n";
+        return false;
+    }
+
+    // Every layer that is read back gets rewritten, so previous contents can be discarded
+    VulkanHelpers::transitionImageLayout2(cmdBuffer, slot.image,
+                         VK_IMAGE_LAYOUT_UNDEFINED,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_PIPELINE_STAGE_2_COPY_BIT,
+                         VK_ACCESS_2_NONE,
+                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_2_SHADER_WRITE_BIT,
+                         m_vkCmdPipelineBarrier2KHR, m_multiViewLayers);
+
+    const std::array<VkDescriptorSet, 2> descriptorSets = {m_descriptorSet, slot.descriptorSet};
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_multiViewPipeline);
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_multiViewPipelineLayout,
+                           0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+    vkCmdPushConstants(cmdBuffer, m_multiViewPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                      sizeof(PushConstants), &m_pushConstants);
+    vkCmdDispatch(cmdBuffer,
+                 (m_multiViewWidth + 15) / 16,
+                 (m_multiViewHeight + 15) / 16,
+                 slot.viewCount);
+
+    VulkanHelpers::transitionImageLayout2(cmdBuffer, slot.image,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_2_SHADER_WRITE_BIT,
+                         VK_PIPELINE_STAGE_2_COPY_BIT,
+                         VK_ACCESS_2_TRANSFER_READ_BIT,
+                         m_vkCmdPipelineBarrier2KHR, m_multiViewLayers);
+
+    // All layers of the batch in one copy; layers are tightly packed in the buffer
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = slot.viewCount;
+    region.imageExtent = {m_multiViewWidth, m_multiViewHeight, 1};
+    vkCmdCopyImageToBuffer(cmdBuffer, slot.image, VK_IMAGE_LAYOUT_GENERAL,
+                           slot.readbackBuffer, 1, &region);
+
+    VkMemoryBarrier2 hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    hostBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    hostBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    hostBarrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+    VkDependencyInfo depInfo{};
+    depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &hostBarrier;
+    m_vkCmdPipelineBarrier2KHR(cmdBuffer, &depInfo);
+
+    if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS) {
+        std::cerr << "Warning: Failed to end multi-view command buffer\n";
+        return false;
+    }
+
+    VkCommandBufferSubmitInfo cmdBufferSubmitInfo{};
+    cmdBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    cmdBufferSubmitInfo.commandBuffer = cmdBuffer;
+
+    VkSubmitInfo2 submitInfo2{};
+    submitInfo2.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo2.commandBufferInfoCount = 1;
+    submitInfo2.pCommandBufferInfos = &cmdBufferSubmitInfo;
+
+    vkResetFences(m_device, 1, &slot.fence);
+    if (m_vkQueueSubmit2KHR(m_computeQueue, 1, &submitInfo2, slot.fence) != VK_SUCCESS) {
+        std::cerr << "Warning: Failed to submit multi-view batch\n";
+        return false;
+    }
+    return true;
+}
+
+void VulkanRenderer::destroyMultiViewSlotResources(MultiViewBatchSlot& slot) {
+    if (slot.cameraBufferMemory != VK_NULL_HANDLE && slot.mappedCameras != nullptr) {
+        vkUnmapMemory(m_device, slot.cameraBufferMemory);
+        slot.mappedCameras = nullptr;
+    }
+    if (slot.readbackBufferMemory != VK_NULL_HANDLE && slot.mappedReadback != nullptr) {
+        vkUnmapMemory(m_device, slot.readbackBufferMemory);
+        slot.mappedReadback = nullptr;
+    }
+    if (slot.cameraBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, slot.cameraBuffer, nullptr);
+        slot.cameraBuffer = VK_NULL_HANDLE;
+    }
+    if (slot.cameraBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, slot.cameraBufferMemory, nullptr);
+        slot.cameraBufferMemory = VK_NULL_HANDLE;
+    }
+    if (slot.readbackBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, slot.readbackBuffer, nullptr);
+        slot.readbackBuffer = VK_NULL_HANDLE;
+    }
+    if (slot.readbackBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, slot.readbackBufferMemory, nullptr);
+        slot.readbackBufferMemory = VK_NULL_HANDLE;
+    }
+    if (slot.imageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(m_device, slot.imageView, nullptr);
+        slot.imageView = VK_NULL_HANDLE;
+    }
+    if (slot.image != VK_NULL_HANDLE) {
+        vkDestroyImage(m_device, slot.image, nullptr);
+        slot.image = VK_NULL_HANDLE;
+    }
+    if (slot.imageMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, slot.imageMemory, nullptr);
+        slot.imageMemory = VK_NULL_HANDLE;
+    }
+}
+
 void VulkanRenderer::recreateSwapchain() {
     // Recreate swapchain (currently not implemented - window resizing not supported)
 }
@@ -2298,13 +4027,126 @@ void VulkanRenderer::cleanup() {
             vkFreeMemory(m_device, m_textureInfoBufferMemory, nullptr);
             m_textureInfoBufferMemory = VK_NULL_HANDLE;
         }
-        if (m_instanceMotorBuffer != VK_NULL_HANDLE) {
-            vkDestroyBuffer(m_device, m_instanceMotorBuffer, nullptr);
-            m_instanceMotorBuffer = VK_NULL_HANDLE;
+        destroySampledTextures();
+        if (m_textureSampler != VK_NULL_HANDLE) {
+            vkDestroySampler(m_device, m_textureSampler, nullptr);
+            m_textureSampler = VK_NULL_HANDLE;
+        }
+        destroyInstanceBuffers();
+        destroyVirtualTextures();
+
+        // Destroy visibility query resources
+        for (auto& slot : m_visibilitySlots) {
+            destroyVisibilitySlotBuffers(slot);
+            if (slot.fence != VK_NULL_HANDLE) {
+                vkDestroyFence(m_device, slot.fence, nullptr);
+                slot.fence = VK_NULL_HANDLE;
+            }
+        }
+        if (m_visibilityPipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(m_device, m_visibilityPipeline, nullptr);
+            m_visibilityPipeline = VK_NULL_HANDLE;
+        }
+        if (m_visibilityPipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(m_device, m_visibilityPipelineLayout, nullptr);
+            m_visibilityPipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_visibilityDescriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(m_device, m_visibilityDescriptorPool, nullptr);
+            m_visibilityDescriptorPool = VK_NULL_HANDLE;
         }
-        if (m_instanceMotorBufferMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(m_device, m_instanceMotorBufferMemory, nullptr);
-            m_instanceMotorBufferMemory = VK_NULL_HANDLE;
+        if (m_visibilityDescriptorSetLayout != VK_NULL_HANDLE) {
+            vkDestroyDescriptorSetLayout(m_device, m_visibilityDescriptorSetLayout, nullptr);
+            m_visibilityDescriptorSetLayout = VK_NULL_HANDLE;
+        }
+
+        // Destroy multi-view resources
+        for (auto& slot : m_multiViewSlots) {
+            destroyMultiViewSlotResources(slot);
+            if (slot.fence != VK_NULL_HANDLE) {
+                vkDestroyFence(m_device, slot.fence, nullptr);
+                slot.fence = VK_NULL_HANDLE;
+            }
+        }
+        if (m_multiViewPipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(m_device, m_multiViewPipeline, nullptr);
+            m_multiViewPipeline = VK_NULL_HANDLE;
+        }
+        if (m_multiViewPipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(m_device, m_multiViewPipelineLayout, nullptr);
+            m_multiViewPipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_multiViewDescriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(m_device, m_multiViewDescriptorPool, nullptr);
+            m_multiViewDescriptorPool = VK_NULL_HANDLE;
+        }
+        if (m_multiViewDescriptorSetLayout != VK_NULL_HANDLE) {
+            vkDestroyDescriptorSetLayout(m_device, m_multiViewDescriptorSetLayout, nullptr);
+            m_multiViewDescriptorSetLayout = VK_NULL_HANDLE;
+        }
+
+        // Destroy AOV images
+        if (m_aovNormalDepthImageView != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_device, m_aovNormalDepthImageView, nullptr);
+            m_aovNormalDepthImageView = VK_NULL_HANDLE;
+        }
+        if (m_aovNormalDepthImage != VK_NULL_HANDLE) {
+            vkDestroyImage(m_device, m_aovNormalDepthImage, nullptr);
+            m_aovNormalDepthImage = VK_NULL_HANDLE;
+        }
+        if (m_aovNormalDepthImageMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device, m_aovNormalDepthImageMemory, nullptr);
+            m_aovNormalDepthImageMemory = VK_NULL_HANDLE;
+        }
+        if (m_aovAlbedoImageView != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_device, m_aovAlbedoImageView, nullptr);
+            m_aovAlbedoImageView = VK_NULL_HANDLE;
+        }
+        if (m_aovAlbedoImage != VK_NULL_HANDLE) {
+            vkDestroyImage(m_device, m_aovAlbedoImage, nullptr);
+            m_aovAlbedoImage = VK_NULL_HANDLE;
+        }
+        if (m_aovAlbedoImageMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device, m_aovAlbedoImageMemory, nullptr);
+            m_aovAlbedoImageMemory = VK_NULL_HANDLE;
+        }
+        if (m_aovIdImageView != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_device, m_aovIdImageView, nullptr);
+            m_aovIdImageView = VK_NULL_HANDLE;
+        }
+        if (m_aovIdImage != VK_NULL_HANDLE) {
+            vkDestroyImage(m_device, m_aovIdImage, nullptr);
+            m_aovIdImage = VK_NULL_HANDLE;
+        }
+        if (m_aovIdImageMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device, m_aovIdImageMemory, nullptr);
+            m_aovIdImageMemory = VK_NULL_HANDLE;
+        }
+
+        // Destroy object-ID picking resources
+        if (m_pickReadbackBufferMemory != VK_NULL_HANDLE && m_pickReadbackMapped != nullptr) {
+            vkUnmapMemory(m_device, m_pickReadbackBufferMemory);
+            m_pickReadbackMapped = nullptr;
+        }
+        if (m_pickReadbackBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(m_device, m_pickReadbackBuffer, nullptr);
+            m_pickReadbackBuffer = VK_NULL_HANDLE;
+        }
+        if (m_pickReadbackBufferMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device, m_pickReadbackBufferMemory, nullptr);
+            m_pickReadbackBufferMemory = VK_NULL_HANDLE;
+        }
+        if (m_objectIdImageView != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_device, m_objectIdImageView, nullptr);
+            m_objectIdImageView = VK_NULL_HANDLE;
+        }
+        if (m_objectIdImage != VK_NULL_HANDLE) {
+            vkDestroyImage(m_device, m_objectIdImage, nullptr);
+            m_objectIdImage = VK_NULL_HANDLE;
+        }
+        if (m_objectIdImageMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device, m_objectIdImageMemory, nullptr);
+            m_objectIdImageMemory = VK_NULL_HANDLE;
         }
 
         // Destroy storage image resources
@@ -2341,6 +4183,11 @@ void VulkanRenderer::cleanup() {
             m_descriptorSetLayout = VK_NULL_HANDLE;
         }
 
+        if (m_timestampQueryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(m_device, m_timestampQueryPool, nullptr);
+            m_timestampQueryPool = VK_NULL_HANDLE;
+        }
+
         // Destroy sync objects
         for (auto& semaphore : m_imageAvailableSemaphores) {
             if (semaphore != VK_NULL_HANDLE) {
@@ -0,0 +1,94 @@
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+WorkerPool::WorkerPool(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    m_threads.reserve(threadCount - 1);
+    for (unsigned t = 1; t < threadCount; ++t) {
+        m_threads.emplace_back([this] { workerMain(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_threads.clear();  // Joins
+}
+
+WorkerPool& WorkerPool::Shared() {
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::run(size_t count, unsigned maxThreads, void* body, Invoke invoke) {
+    if (count == 0) return;
+
+    const size_t helpers = std::min<size_t>({m_threads.size(), maxThreads != 0 ? maxThreads - 1 : SIZE_MAX, count - 1});
+    bool idle = false;
+    if (helpers == 0 || !m_busy.compare_exchange_strong(idle, true, std::memory_order_acquire)) {
+        for (size_t i = 0; i < count; ++i) invoke(body, i);
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_body = body;
+        m_invoke = invoke;
+        m_count = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_error = nullptr;
+        m_openSlots = static_cast<unsigned>(helpers);
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    drain();
+
+    // Workers that have not picked the loop up yet no longer need to
+    std::exception_ptr error;
+    {
+        std::unique_lock lock(m_mutex);
+        m_openSlots = 0;
+        m_done.wait(lock, [this] { return m_running == 0; });
+        error = std::exchange(m_error, nullptr);
+    }
+    m_busy.store(false, std::memory_order_release);
+    if (error) std::rethrow_exception(error);
+}
+
+void WorkerPool::drain() {
+    try {
+        for (size_t i = m_next.fetch_add(1, std::memory_order_relaxed); i < m_count;
+             i = m_next.fetch_add(1, std::memory_order_relaxed)) {
+            m_invoke(m_body, i);
+        }
+    } catch (...) {
+        // Hand out no further indices; the first exception wins
+        m_next.store(m_count, std::memory_order_relaxed);
+        std::lock_guard lock(m_mutex);
+        if (!m_error) m_error = std::current_exception();
+    }
+}
+
+void WorkerPool::workerMain() {
+    uint64_t seen = 0;
+    std::unique_lock lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+        if (m_stop) return;
+        seen = m_generation;
+        if (m_openSlots == 0) continue;
+        --m_openSlots;
+        ++m_running;
+
+        lock.unlock();
+        drain();
+        lock.lock();
+        if (--m_running == 0) m_done.notify_one();
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "GameScene.h"
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+// Procedurally generated scene for scaling tests.
+// Selected with `--scene stress:instances=10000,spheres=5000,lights=256,tris=2M`;
+// every count accepts an optional K/M suffix and the same seed always builds the same scene.
+class StressScene final : public GameScene {
+public:
+    struct Params {
+        uint32_t instances{1000};   // Mesh instances (one of them is the terrain)
+        uint32_t spheres{500};      // Analytic spheres
+        uint32_t lights{16};        // Point lights
+        uint32_t tris{200000};      // Unique triangles across the generated meshes
+        uint32_t seed{1};
+
+        // Parse "key=value,key=value" (the part after "stress:"); unknown keys are reported and ignored
+        [[nodiscard]] static bool Parse(std::string_view spec, Params& out);
+    };
+
+    StressScene(const std::string& resourceDir, const Params& params);
+
+    void OnInit(VulkanRenderer* renderer) override;
+    void OnUpdate(float deltaTime) override;
+    void OnInput(const InputState& input) override;
+    void OnGui() override;
+    void OnShutdown() override;
+
+private:
+    void updateCamera();
+
+    [[nodiscard]] static std::unique_ptr<Mesh> createIcosphere(uint32_t subdivisions, const Material& material);
+    [[nodiscard]] static std::unique_ptr<Mesh> createTerrain(uint32_t resolution, float size, float height,
+                                                             uint32_t seed, const Material& material);
+
+    Params m_params;
+    float m_worldExtent{100.0f};
+
+    uint32_t m_sphereMeshTris{0};
+    uint32_t m_terrainTris{0};
+
+    // Camera orbit
+    float m_cameraYaw{0.0f};
+    float m_cameraPitch{0.5f};
+    float m_cameraDistance{150.0f};
+    float m_mouseSensitivity{0.005f};
+    float m_orbitSpeed{0.1f};
+    bool m_autoOrbit{true};
+};
@@ -1,4 +1,5 @@
 #include "DebugDemoScene.h"
+#include "MotorTransforms.h"
 #include <algorithm>
 #include <cmath>
 #include <imgui.h>
@@ -45,8 +46,13 @@ void DebugDemoScene::OnUpdate(float deltaTime) {
     {
         const float radius = 3.0f;
 
-        Motor motor{1/(deltaTime * m_rotationSpeed), std::cos(m_time) * radius, std::sin(m_time * 3), std::sin(m_time) * radius, 0, 0, 0, 0};
-        sphere->SetCenter((motor * sphere->GetCenter() * ~motor).Grade3());
+        // Normalized (the weight used to be 1 / step), so the batch transform applies
+        const float step = deltaTime * m_rotationSpeed;
+        const Motor motor{1.0f, std::cos(m_time) * radius * step, std::sin(m_time * 3) * step,
+                          std::sin(m_time) * radius * step, 0, 0, 0, 0};
+        TriVector center = sphere->GetCenter();
+        MotorTransforms::TransformPoints(motor, {&center, 1});
+        sphere->SetCenter(center);
     }
 
     // === Debug Visualization ===
@@ -0,0 +1,375 @@
+#include "StressScene.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <unordered_map>
+#include <imgui.h>
+
+namespace {
+
+constexpr float kPi = std::numbers::pi_v<float>;
+
+// Parse a count with an optional K/M suffix ("2M" -> 2000000)
+[[nodiscard]] bool parseCount(std::string_view text, uint32_t& out) noexcept {
+    uint64_t multiplier = 1;
+    if (!text.empty() && (text.back() == 'k' || text.back() == 'K')) {
+        multiplier = 1000;
+        text.remove_suffix(1);
+    } else if (!text.empty() && (text.back() == 'm' || text.back() == 'M')) {
+        multiplier = 1000000;
+        text.remove_suffix(1);
+    }
+
+    uint64_t value = 0;
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size() || text.empty()) {
+        return false;
+    }
+
+    value *= multiplier;
+    if (value > UINT32_MAX) {
+        return false;
+    }
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+// Integer lattice hash -> [0, 1)
+[[nodiscard]] float latticeValue(int32_t x, int32_t z, uint32_t seed) noexcept {
+    uint32_t h = seed * 0x9E3779B9u;
+    h ^= static_cast<uint32_t>(x) * 0x85EBCA6Bu;
+    h = (h ^ (h >> 13)) * 0xC2B2AE35u;
+    h ^= static_cast<uint32_t>(z) * 0x27D4EB2Fu;
+    h = (h ^ (h >> 16)) * 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return static_cast<float>(h & 0xFFFFFFu) / static_cast<float>(0x1000000u);
+}
+
+// Smoothed value noise, roughly in [0, 1)
+[[nodiscard]] float valueNoise(float x, float z, uint32_t seed) noexcept {
+    const float fx = std::floor(x);
+    const float fz = std::floor(z);
+    const auto ix = static_cast<int32_t>(fx);
+    const auto iz = static_cast<int32_t>(fz);
+    const float tx = x - fx;
+    const float tz = z - fz;
+    const float sx = tx * tx * (3.0f - 2.0f * tx);
+    const float sz = tz * tz * (3.0f - 2.0f * tz);
+
+    const float a = latticeValue(ix, iz, seed);
+    const float b = latticeValue(ix + 1, iz, seed);
+    const float c = latticeValue(ix, iz + 1, seed);
+    const float d = latticeValue(ix + 1, iz + 1, seed);
+    return std::lerp(std::lerp(a, b, sx), std::lerp(c, d, sx), sz);
+}
+
+// Fractal sum of value noise octaves, normalized to [-1, 1)
+[[nodiscard]] float fbm(float x, float z, uint32_t seed) noexcept {
+    constexpr int octaves = 5;
+    float sum = 0.0f;
+    float amplitude = 1.0f;
+    float norm = 0.0f;
+    for (int i = 0; i < octaves; ++i) {
+        sum += valueNoise(x, z, seed + static_cast<uint32_t>(i)) * amplitude;
+        norm += amplitude;
+        x *= 2.0f;
+        z *= 2.0f;
+        amplitude *= 0.5f;
+    }
+    return sum / norm * 2.0f - 1.0f;
+}
+
+[[nodiscard]] Scene::Color randomColor(std::mt19937& rng) {
+    // Draws are sequenced explicitly - argument evaluation order would make the scene compiler-dependent
+    std::uniform_real_distribution<float> channel(0.2f, 0.9f);
+    const float r = channel(rng);
+    const float g = channel(rng);
+    const float b = channel(rng);
+    return Scene::Color(r, g, b);
+}
+
+} // namespace
+
+bool StressScene::Params::Parse(std::string_view spec, Params& out) {
+    bool ok = true;
+    while (!spec.empty()) {
+        const size_t comma = spec.find(',');
+        const std::string_view entry = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+        if (entry.empty()) continue;
+
+        const size_t eq = entry.find('=');
+        const std::string_view key = entry.substr(0, eq);
+        const std::string_view value = eq == std::string_view::npos ? std::string_view{} : entry.substr(eq + 1);
+
+        uint32_t* target = nullptr;
+        if (key == "instances") target = &out.instances;
+        else if (key == "spheres") target = &out.spheres;
+        else if (key == "lights") target = &out.lights;
+        else if (key == "tris") target = &out.tris;
+        else if (key == "seed") target = &out.seed;
+
+        if (!target) {
+            std::cerr << "Warning: Unknown stress scene parameter '" << key << "'\n";
+            ok = false;
+        } else if (!parseCount(value, *target)) {
+            std::cerr << "Warning: Invalid value for stress scene parameter '" << key << "'\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+StressScene::StressScene(const std::string& resourceDir, const Params& params)
+    : GameScene(resourceDir), m_params(params) {}
+
+void StressScene::OnInit([[maybe_unused]] VulkanRenderer* renderer) {
+    std::mt19937 rng(m_params.seed);
+
+    // World grows with the object count so density stays roughly constant
+    const auto objectCount = static_cast<float>(m_params.instances + m_params.spheres);
+    m_worldExtent = std::max(50.0f, std::sqrt(objectCount) * 4.0f);
+    m_cameraDistance = m_worldExtent * 1.5f;
+
+    // Triangle budget: the largest icosphere within half of it, the terrain takes the rest
+    uint32_t subdivisions = 0;
+    while (subdivisions < 10 && 20ull << (2 * (subdivisions + 1)) <= m_params.tris / 2) {
+        ++subdivisions;
+    }
+    const uint32_t sphereTris = 20u << (2 * subdivisions);
+    const uint32_t terrainBudget = m_params.tris > sphereTris ? m_params.tris - sphereTris : 2u;
+    const auto terrainResolution = std::max(1u, static_cast<uint32_t>(std::sqrt(terrainBudget / 2.0)));
+
+    Material rockMaterial = Material::PBR(0.55f, 0.5f, 0.45f, 0.0f, 0.6f);
+    rockMaterial.name = "stress_rock";
+    Material groundMaterial = Material::Lambert(0.35f, 0.45f, 0.3f);
+    groundMaterial.name = "stress_ground";
+
+    const uint32_t sphereMeshId = AddMesh(createIcosphere(subdivisions, rockMaterial));
+    const uint32_t terrainMeshId = AddMesh(createTerrain(terrainResolution, m_worldExtent * 2.0f,
+                                                         m_worldExtent * 0.05f, m_params.seed, groundMaterial));
+    m_sphereMeshTris = static_cast<uint32_t>(GetMesh(sphereMeshId)->TriangleCount());
+    m_terrainTris = static_cast<uint32_t>(GetMesh(terrainMeshId)->TriangleCount());
+
+    // Terrain counts as one of the instances
+    if (m_params.instances > 0) {
+        AddMeshInstance(terrainMeshId, TriVector(0.0f, 0.0f, 0.0f), "terrain");
+    }
+
+    std::uniform_real_distribution<float> position(-m_worldExtent, m_worldExtent);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const BiVector yAxis(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+
+    for (uint32_t i = 1; i < m_params.instances; ++i) {
+        const float x = position(rng);
+        const float z = position(rng);
+        const float y = 2.0f + unit(rng) * m_worldExtent * 0.1f;
+        const Motor translation(1.0f, x * 0.5f, y * 0.5f, z * 0.5f, 0.0f, 0.0f, 0.0f, 0.0f);
+        const Motor rotation = Motor::Rotation(unit(rng) * 360.0f, yAxis);
+
+        const InstanceHandle instance = AddMeshInstance(sphereMeshId, translation * rotation);
+        SetInstanceScale(instance, 0.5f + unit(rng) * 1.5f);
+    }
+
+    for (uint32_t i = 0; i < m_params.spheres; ++i) {
+        const float radius = 0.5f + unit(rng) * 1.5f;
+        const float x = position(rng);
+        const float y = radius + unit(rng) * m_worldExtent * 0.1f;
+        const float z = position(rng);
+        const TriVector center(x, y, z);
+        const Scene::Color color = randomColor(rng);
+        const float roughness = unit(rng) * 0.5f;
+
+        switch (rng() % 3) {
+            case 0: AddSphere(center, radius, Scene::Material::Lambert(color)); break;
+            case 1: AddSphere(center, radius, Scene::Material::Metal(color, roughness)); break;
+            default: AddSphere(center, radius, Scene::Material::Glossy(color, roughness)); break;
+        }
+    }
+
+    // Enough range that each light reaches a handful of neighbours
+    const float lightRange = m_worldExtent * 2.0f / std::sqrt(static_cast<float>(std::max(1u, m_params.lights))) * 2.0f;
+    for (uint32_t i = 0; i < m_params.lights; ++i) {
+        const float x = position(rng);
+        const float y = m_worldExtent * 0.15f + unit(rng) * 10.0f;
+        const float z = position(rng);
+        const Scene::Color color = randomColor(rng);
+        const float intensity = 1.0f + unit(rng);
+        AddPointLight(TriVector(x, y, z), color, intensity, lightRange);
+    }
+
+    std::cout << "Stress scene: " << m_params.instances << " instances, "
+              << m_params.spheres << " spheres, " << m_params.lights << " lights, "
+              << (m_sphereMeshTris + m_terrainTris) << " triangles (seed " << m_params.seed << ")\n";
+
+    updateCamera();
+}
+
+void StressScene::OnUpdate(float deltaTime) {
+    UpdateFPS(deltaTime);
+
+    if (m_autoOrbit) {
+        m_cameraYaw += m_orbitSpeed * deltaTime;
+    }
+    updateCamera();
+}
+
+void StressScene::updateCamera() {
+    const float camX = std::sin(m_cameraYaw) * std::cos(m_cameraPitch) * m_cameraDistance;
+    const float camY = std::sin(m_cameraPitch) * m_cameraDistance;
+    const float camZ = std::cos(m_cameraYaw) * std::cos(m_cameraPitch) * m_cameraDistance;
+
+    m_cameraEye = TriVector(camX, camY, camZ);
+    m_cameraTarget = TriVector(0.0f, 0.0f, 0.0f);
+    m_cameraUp = TriVector(0.0f, 1.0f, 0.0f);
+}
+
+void StressScene::OnInput(const InputState& input) {
+    if (input.rightMouseDown) {
+        m_cameraYaw += input.mouseDeltaX * m_mouseSensitivity;
+        m_cameraPitch += input.mouseDeltaY * m_mouseSensitivity;
+        m_cameraPitch = std::clamp(m_cameraPitch, 0.05f, 1.4f);
+    }
+
+    m_cameraDistance -= input.scrollDelta * m_worldExtent * 0.05f;
+    m_cameraDistance = std::clamp(m_cameraDistance, 10.0f, m_worldExtent * 4.0f);
+}
+
+void StressScene::OnGui() {
+    ImGui::Begin("Stress Scene");
+    ImGui::Text("FPS: %.1f", GetFPS());
+    ImGui::Separator();
+    ImGui::Text("Instances: %u", m_params.instances);
+    ImGui::Text("Spheres: %u", m_params.spheres);
+    ImGui::Text("Lights: %u", m_params.lights);
+    ImGui::Text("Triangles: %u (sphere mesh %u, terrain %u)",
+                m_sphereMeshTris + m_terrainTris, m_sphereMeshTris, m_terrainTris);
+    ImGui::Text("Seed: %u", m_params.seed);
+    ImGui::Separator();
+    ImGui::Checkbox("Auto orbit", &m_autoOrbit);
+    ImGui::SliderFloat("Orbit speed", &m_orbitSpeed, 0.0f, 1.0f);
+    ImGui::Text("Camera Distance: %.1f", m_cameraDistance);
+    ImGui::End();
+}
+
+void StressScene::OnShutdown() {}
+
+// === Procedural Meshes ===
+
+std::unique_ptr<Mesh> StressScene::createIcosphere(uint32_t subdivisions, const Material& material) {
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+    std::vector<std::array<float, 3>> positions = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+        {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+        {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+    };
+    std::vector<std::array<uint32_t, 3>> faces = {
+        {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+        {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}
+    };
+
+    for (auto& p : positions) {
+        const float len = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        p = {p[0] / len, p[1] / len, p[2] / len};
+    }
+
+    // Split every edge at its (shared) midpoint, pushed back onto the unit sphere
+    for (uint32_t level = 0; level < subdivisions; ++level) {
+        std::unordered_map<uint64_t, uint32_t> midpoints;
+        midpoints.reserve(faces.size() * 2);
+        auto midpoint = [&](uint32_t a, uint32_t b) {
+            const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+            const auto [it, inserted] = midpoints.try_emplace(key, static_cast<uint32_t>(positions.size()));
+            if (inserted) {
+                const auto& pa = positions[a];
+                const auto& pb = positions[b];
+                std::array<float, 3> m = {pa[0] + pb[0], pa[1] + pb[1], pa[2] + pb[2]};
+                const float len = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+                positions.push_back({m[0] / len, m[1] / len, m[2] / len});
+            }
+            return it->second;
+        };
+
+        std::vector<std::array<uint32_t, 3>> next;
+        next.reserve(faces.size() * 4);
+        for (const auto& f : faces) {
+            const uint32_t ab = midpoint(f[0], f[1]);
+            const uint32_t bc = midpoint(f[1], f[2]);
+            const uint32_t ca = midpoint(f[2], f[0]);
+            next.push_back({f[0], ab, ca});
+            next.push_back({f[1], bc, ab});
+            next.push_back({f[2], ca, bc});
+            next.push_back({ab, bc, ca});
+        }
+        faces = std::move(next);
+    }
+
+    std::vector<Vertex> vertices(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto& p = positions[i];
+        vertices[i].position = TriVector(p[0], p[1], p[2]);
+        vertices[i].texCoord[0] = 0.5f + std::atan2(p[2], p[0]) / (2.0f * kPi);
+        vertices[i].texCoord[1] = 0.5f - std::asin(std::clamp(p[1], -1.0f, 1.0f)) / kPi;
+    }
+
+    // Faces above are counter-clockwise from outside; the mesh convention is clockwise
+    std::vector<Triangle> triangles(faces.size());
+    for (size_t i = 0; i < faces.size(); ++i) {
+        triangles[i] = Triangle{{faces[i][0], faces[i][2], faces[i][1]}, 0};
+    }
+
+    auto mesh = std::make_unique<Mesh>();
+    mesh->SetVertices(std::move(vertices));
+    mesh->SetTriangles(std::move(triangles));
+    mesh->AddMaterial(material);
+    mesh->ComputeNormals();
+    return mesh;
+}
+
+std::unique_ptr<Mesh> StressScene::createTerrain(uint32_t resolution, float size, float height,
+                                                 uint32_t seed, const Material& material) {
+    const uint32_t stride = resolution + 1;
+    const float step = size / static_cast<float>(resolution);
+    const float half = size * 0.5f;
+    constexpr float noiseScale = 6.0f;  // Noise periods across the terrain
+
+    std::vector<Vertex> vertices(static_cast<size_t>(stride) * stride);
+    for (uint32_t z = 0; z < stride; ++z) {
+        for (uint32_t x = 0; x < stride; ++x) {
+            const float u = static_cast<float>(x) / static_cast<float>(resolution);
+            const float v = static_cast<float>(z) / static_cast<float>(resolution);
+            Vertex& vertex = vertices[static_cast<size_t>(z) * stride + x];
+            vertex.position = TriVector(-half + static_cast<float>(x) * step,
+                                        fbm(u * noiseScale, v * noiseScale, seed) * height,
+                                        -half + static_cast<float>(z) * step);
+            vertex.texCoord[0] = u;
+            vertex.texCoord[1] = v;
+        }
+    }
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(static_cast<size_t>(resolution) * resolution * 2);
+    for (uint32_t z = 0; z < resolution; ++z) {
+        for (uint32_t x = 0; x < resolution; ++x) {
+            const uint32_t a = z * stride + x;
+            const uint32_t b = a + 1;
+            const uint32_t c = a + stride;
+            const uint32_t d = c + 1;
+            triangles.push_back(Triangle{{a, b, c}, 0});
+            triangles.push_back(Triangle{{b, d, c}, 0});
+        }
+    }
+
+    auto mesh = std::make_unique<Mesh>();
+    mesh->SetVertices(std::move(vertices));
+    mesh->SetTriangles(std::move(triangles));
+    mesh->AddMaterial(material);
+    mesh->ComputeNormals();
+    return mesh;
+}
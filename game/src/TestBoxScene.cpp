@@ -1,4 +1,5 @@
 #include "TestBoxScene.h"
+#include "MotorTransforms.h"
 #include <algorithm>
 #include <cmath>
 #include <imgui.h>
@@ -42,7 +43,7 @@ void TestBoxScene::OnInit([[maybe_unused]] VulkanRenderer* renderer) {
     int teapotMeshId = LoadMesh("teapot.obj", "teapot.png");
     AddMeshInstance(teapotMeshId, TriVector(-10.0f, 10.0f, 0.0f));
 
-    if (auto* pheasant = FindInstance("pheasant")) {
+    if (auto pheasant = FindInstance("pheasant")) {
         pheasant->scale = m_pheasantScale;
     }
 
@@ -65,17 +66,20 @@ void TestBoxScene::OnUpdate(float deltaTime) {
     const BiVector yAxis(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
     const Motor R = Motor::Rotation(incrementDegrees, yAxis);
 
-    if (auto* sphere1 = GetSphere(m_sphere1Id)) {
-        sphere1->SetCenter((R * sphere1->GetCenter() * ~R).Grade3());
+    Scene::GPUSphere* spheres[] = {GetSphere(m_sphere1Id), GetSphere(m_sphere2Id)};
+    TriVector centers[2];
+    for (size_t i = 0; i < 2; ++i) {
+        if (spheres[i]) centers[i] = spheres[i]->GetCenter();
     }
-    if (auto* sphere2 = GetSphere(m_sphere2Id)) {
-        sphere2->SetCenter((R * sphere2->GetCenter() * ~R).Grade3());
+    MotorTransforms::TransformPoints(R, centers);
+    for (size_t i = 0; i < 2; ++i) {
+        if (spheres[i]) spheres[i]->SetCenter(centers[i]);
     }
 
     // Update pheasant
     m_pheasantTime += m_pheasantSpeed * deltaTime;
 
-    if (auto* pheasant = FindInstance("pheasant")) {
+    if (auto pheasant = FindInstance("pheasant")) {
         const float pheasantX = std::sin(m_pheasantTime) / 10.0f;
         const Motor translation(1.0f, pheasantX * 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
         pheasant->transform = R * translation * pheasant->transform;
@@ -1,7 +1,10 @@
 #include "Application.h"
 #include "Config.h"
+#include "Benchmark.h"
 #include "TestBoxScene.h"
 #include "DebugDemoScene.h"
+#include "StressScene.h"
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string_view>
@@ -17,9 +20,17 @@ void printHelp() {
         "  --width <N>      Window width (default: 1280)\n"
         "  --height <N>     Window height (default: 720)\n"
         "  --title <str>    Window title\n"
-        "  --scene <name>   Scene to load: testbox, debug (default: debug)\n"
+        "  --scene <name>   Scene to load: testbox, debug, stress[:key=value,...] (default: debug)\n"
+        "                   e.g. stress:instances=10000,spheres=5000,lights=256,tris=2M,seed=1\n"
         "  --fullscreen     Run in fullscreen mode\n"
         "  --no-vsync       Disable vsync\n"
+        "  --render-thread  Render and present on a separate thread from simulation\n"
+        "  --queued-frames <N>\n"
+        "                   Frames simulation may run ahead of rendering (default: 1)\n"
+        "  --sim-rate <Hz>  Fixed simulation rate (default: 0 = one update per frame)\n"
+        "  --bench <file>   Run a benchmark spec (JSON) and write a timing report\n"
+        "  --record-baseline\n"
+        "                   With --bench, store the report as the spec's baseline instead of comparing\n"
         "  --help, -h       Show this help message\n";
 }
 
@@ -28,6 +39,12 @@ std::unique_ptr<GameScene> createScene(const std::string& name, const std::strin
         return std::make_unique<TestBoxScene>(resourceDir);
     } else if (name == "debug") {
         return std::make_unique<DebugDemoScene>(resourceDir);
+    } else if (name == "stress" || name.starts_with("stress:")) {
+        StressScene::Params params;
+        if (name.size() > 7) {
+            (void)StressScene::Params::Parse(std::string_view(name).substr(7), params);
+        }
+        return std::make_unique<StressScene>(resourceDir, params);
     }
     std::cerr << "Unknown scene '" << name << "', using debug scene\n";
     return std::make_unique<DebugDemoScene>(resourceDir);
@@ -42,6 +59,62 @@ std::unique_ptr<GameScene> createScene(const std::string& name, const std::strin
     }
 }
 
+[[nodiscard]] bool parseFloatArg(const char* value, float& out) noexcept {
+    try {
+        out = std::stof(value);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Deterministic benchmark run; exit code is non-zero if the baseline comparison fails
+int runBenchmark(const std::string& specPath, const FlyTracer::AppConfig& config, bool recordBaseline) {
+    FlyTracer::BenchmarkSpec spec;
+    if (!spec.loadFromFile(specPath)) {
+        return EXIT_FAILURE;
+    }
+    if (recordBaseline && spec.baselinePath.empty()) {
+        std::cerr << "Benchmark: --record-baseline needs a \"baseline\" path in " << specPath << "\n";
+        return EXIT_FAILURE;
+    }
+
+    auto scene = createScene(spec.scene, config.resourceDirectory);
+    Application app(spec.width, spec.height, config.windowTitle + " [benchmark]",
+                    std::move(scene), config.shaderDirectory);
+    const auto report = app.runBenchmark(spec);
+    if (report.frames < spec.frames) {
+        // A partial run would pass or replace the baseline on fewer (or no) samples
+        std::cerr << "Benchmark: Aborted after " << report.frames << " of " << spec.frames
+                  << " measured frames, no report written\n";
+        return EXIT_FAILURE;
+    }
+    if (!report.saveToFile(spec.outputPath)) {
+        return EXIT_FAILURE;
+    }
+
+    if (spec.baselinePath.empty()) {
+        return EXIT_SUCCESS;
+    }
+    if (recordBaseline) {
+        return report.saveToFile(spec.baselinePath) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    FlyTracer::JsonValue baseline;
+    if (!FlyTracer::JsonValue::ParseFile(spec.baselinePath, baseline)) {
+        std::cerr << "Benchmark: Could not load baseline " << spec.baselinePath << "\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Benchmark: Comparing against " << spec.baselinePath
+              << " (max regression " << spec.maxRegression * 100.0 << "%)\n";
+    if (!report.compareToBaseline(baseline, spec.maxRegression, std::cout)) {
+        std::cerr << "Benchmark: Performance regression detected\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
 } // anonymous namespace
 
 int main(int argc, char* argv[]) {
@@ -49,6 +122,8 @@ int main(int argc, char* argv[]) {
         FlyTracer::AppConfig config;
         (void)config.loadFromFile("resources/config.cfg");
         std::string sceneName = "debug";  // Default to debug demo scene
+        std::string benchSpecPath;
+        bool recordBaseline = false;
 
         for (int i = 1; i < argc; ++i) {
             const std::string_view arg = argv[i];
@@ -69,15 +144,38 @@ int main(int argc, char* argv[]) {
                 config.fullscreen = true;
             } else if (arg == "--no-vsync") {
                 config.vsync = false;
+            } else if (arg == "--render-thread") {
+                config.renderThread = true;
+            } else if (arg == "--queued-frames" && i + 1 < argc) {
+                if (!parseIntArg(argv[++i], config.queuedFrames)) {
+                    std::cerr << "Invalid queued frame count, using default\n";
+                }
+            } else if (arg == "--sim-rate" && i + 1 < argc) {
+                if (!parseFloatArg(argv[++i], config.simulationRate)) {
+                    std::cerr << "Invalid simulation rate, using default\n";
+                }
+            } else if (arg == "--bench" && i + 1 < argc) {
+                benchSpecPath = argv[++i];
+            } else if (arg == "--record-baseline") {
+                recordBaseline = true;
             } else if (arg == "--help" || arg == "-h") {
                 printHelp();
                 return EXIT_SUCCESS;
             }
         }
 
+        if (!benchSpecPath.empty()) {
+            return runBenchmark(benchSpecPath, config, recordBaseline);
+        }
+
         auto scene = createScene(sceneName, config.resourceDirectory);
         Application app(config.windowWidth, config.windowHeight, config.windowTitle,
                         std::move(scene), config.shaderDirectory);
+        Application::FrameLoopConfig frameLoop;
+        frameLoop.renderThread = config.renderThread;
+        frameLoop.queuedFrames = static_cast<uint32_t>(std::max(config.queuedFrames, 1));
+        frameLoop.simulationRate = std::max(config.simulationRate, 0.0f);
+        app.setFrameLoop(frameLoop);
         app.run();
 
     } catch (const std::exception& e) {
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "Animation.h"
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Test keyframe interpolation, wrapping, and that the batched evaluation matches the reference
+TEST(AnimationTest, BatchedMotorsMatchScalarReference) {
+    auto at = [](float x, float y, float z) { return Motor(1.0f, x * 0.5f, y * 0.5f, z * 0.5f, 0.0f, 0.0f, 0.0f, 0.0f); };
+    auto negated = [](const Motor& m) {
+        return Motor(-m.s(), -m.e01(), -m.e02(), -m.e03(), -m.e23(), -m.e31(), -m.e12(), -m.e0123());
+    };
+    const BiVector yAxis(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+
+    AnimationTracks tracks;
+    const MotorKey slide[] = {{0.0f, at(0, 0, 0)}, {1.0f, at(2, 0, 0)}, {3.0f, at(2, 4, 0)}};
+    const MotorKey turn[] = {{0.0f, Motor::Rotation(0.0f, yAxis)}, {1.0f, negated(Motor::Rotation(90.0f, yAxis))}};
+    EXPECT_EQ(tracks.AddMotorTrack(slide, AnimationWrap::Clamp), 0u);
+    EXPECT_EQ(tracks.AddMotorTrack(slide, AnimationWrap::Loop, 4.5f), 1u);
+    EXPECT_EQ(tracks.AddMotorTrack(turn), 2u);
+    const MotorKey unsorted[] = {{1.0f, at(0, 0, 0)}, {1.0f, at(1, 0, 0)}};
+    EXPECT_THROW((void)tracks.AddMotorTrack(unsorted), std::invalid_argument);
+    EXPECT_THROW((void)tracks.AddMotorTrack(std::span<const MotorKey>{}), std::invalid_argument);
+
+    std::vector<Motor> motors;
+    tracks.EvaluateMotors(0.5f, motors);
+    ASSERT_EQ(motors.size(), 3u);
+    EXPECT_FLOAT_EQ(motors[0].e01(), 0.5f);                    // Halfway to x = 2
+    EXPECT_NEAR(motors[1].e02(), 1.0f, 1e-5f);                 // 0.5 + 4.5 wraps to 2: (2, 2, 0)
+    // The negated key is the same rotation, so the blend takes the short way to 45 degrees
+    const Motor half = Motor::Rotation(45.0f, yAxis);
+    EXPECT_NEAR(motors[2].s(), half.s(), 1e-5f);
+    EXPECT_NEAR(motors[2].e31(), half.e31(), 1e-5f);
+
+    tracks.EvaluateMotors(10.0f, motors);
+    EXPECT_FLOAT_EQ(motors[0].e02(), 2.0f);                    // Clamped to the last key
+    tracks.EvaluateMotors(0.25f, motors);                      // Seeking back
+    EXPECT_FLOAT_EQ(motors[0].e01(), 0.25f);
+
+    // Enough random tracks for full AVX2 batches and a tail
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> value(-5.0f, 5.0f);
+    for (int t = 0; t < 37; ++t) {
+        std::vector<MotorKey> keys;
+        for (int k = 0; k < 1 + t % 5; ++k) {
+            const BiVector axis(0.0f, 0.0f, 0.0f, value(rng), value(rng), value(rng));
+            keys.push_back({static_cast<float>(k) * 0.7f, at(value(rng), value(rng), value(rng)) * Motor::Rotation(value(rng) * 30.0f, axis)});
+        }
+        (void)tracks.AddMotorTrack(keys, t % 2 ? AnimationWrap::Loop : AnimationWrap::Clamp, value(rng));
+    }
+    std::vector<Motor> reference;
+    for (float time : {0.3f, 1.9f, 2.0f, 7.3f}) {
+        tracks.EvaluateMotors(time, motors);
+        tracks.EvaluateMotorsScalar(time, reference);
+        ASSERT_EQ(motors.size(), reference.size());
+        for (size_t i = 0; i < motors.size(); ++i) {
+            EXPECT_NEAR(motors[i].s(), reference[i].s(), 1e-5f) << "track " << i;
+            EXPECT_NEAR(motors[i].e01(), reference[i].e01(), 1e-4f) << "track " << i;
+            EXPECT_NEAR(motors[i].e12(), reference[i].e12(), 1e-5f) << "track " << i;
+            EXPECT_NEAR(motors[i].e0123(), reference[i].e0123(), 1e-4f) << "track " << i;
+            // Normalized: unit rotor, dual part orthogonal to it
+            const Motor& m = motors[i];
+            EXPECT_NEAR(m.s() * m.s() + m.e23() * m.e23() + m.e31() * m.e31() + m.e12() * m.e12(), 1.0f, 1e-5f);
+            EXPECT_NEAR(m.e0123() * m.s() - (m.e01() * m.e23() + m.e02() * m.e31() + m.e03() * m.e12()), 0.0f, 1e-4f);
+        }
+    }
+
+    const ScalarKey pulse[] = {{0.0f, 1.0f}, {2.0f, 3.0f}, {4.0f, 1.0f}};
+    (void)tracks.AddScalarTrack(pulse);
+    std::vector<float> scalars;
+    tracks.EvaluateScalars(5.0f, scalars);                     // Loops to t = 1
+    ASSERT_EQ(scalars.size(), 1u);
+    EXPECT_FLOAT_EQ(scalars[0], 2.0f);
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "Benchmark.h"
+#include <sstream>
+
+using namespace FlyTracer;
+
+// Test JSON round trip
+TEST(JsonTest, ParseAndWrite) {
+    JsonValue json;
+    ASSERT_TRUE(JsonValue::Parse(R"({"name": "bench", "count": 3, "ok": true,
+                                     "list": [1.5, -2, null], "nested": {"key": "a\"b"}})", json));
+
+    EXPECT_EQ(json["name"].AsString(), "bench");
+    EXPECT_DOUBLE_EQ(json["count"].AsNumber(), 3.0);
+    EXPECT_TRUE(json["ok"].AsBool());
+    ASSERT_TRUE(json["list"].IsArray());
+    EXPECT_EQ(json["list"].Size(), 3u);
+    EXPECT_DOUBLE_EQ(json["list"][1].AsNumber(), -2.0);
+    EXPECT_TRUE(json["list"][2].IsNull());
+    EXPECT_EQ(json["nested"]["key"].AsString(), "a\"b");
+    EXPECT_TRUE(json["missing"].IsNull());
+
+    std::ostringstream out;
+    json.Write(out);
+    JsonValue reparsed;
+    ASSERT_TRUE(JsonValue::Parse(out.str(), reparsed));
+    EXPECT_EQ(reparsed["nested"]["key"].AsString(), "a\"b");
+    EXPECT_DOUBLE_EQ(reparsed["list"][0].AsNumber(), 1.5);
+}
+
+TEST(JsonTest, RejectsMalformedInput) {
+    JsonValue json;
+    EXPECT_FALSE(JsonValue::Parse("{\"a\": }", json));
+    EXPECT_FALSE(JsonValue::Parse("[1, 2", json));
+    EXPECT_FALSE(JsonValue::Parse("{} trailing", json));
+}
+
+// Test nearest-rank statistics
+TEST(FrameTimeStatsTest, Percentiles) {
+    std::vector<double> times;
+    for (int i = 100; i >= 1; --i) times.push_back(static_cast<double>(i));
+
+    const auto stats = FrameTimeStats::Compute(times);
+    EXPECT_EQ(stats.samples, 100u);
+    EXPECT_DOUBLE_EQ(stats.mean, 50.5);
+    EXPECT_DOUBLE_EQ(stats.p50, 50.0);
+    EXPECT_DOUBLE_EQ(stats.p95, 95.0);
+    EXPECT_DOUBLE_EQ(stats.p99, 99.0);
+    EXPECT_DOUBLE_EQ(stats.min, 1.0);
+    EXPECT_DOUBLE_EQ(stats.max, 100.0);
+}
+
+TEST(FrameTimeStatsTest, EmptyIsNull) {
+    const auto stats = FrameTimeStats::Compute({});
+    EXPECT_EQ(stats.samples, 0u);
+    EXPECT_TRUE(stats.ToJson().IsNull());
+}
+
+// Test camera path interpolation
+TEST(CameraPathTest, InterpolatesAndClamps) {
+    std::vector<CameraKeyframe> path(2);
+    path[0].time = 0.0f;
+    path[0].eye = {0.0f, 0.0f, 0.0f};
+    path[1].time = 2.0f;
+    path[1].eye = {4.0f, 2.0f, -2.0f};
+
+    const auto mid = SampleCameraPath(path, 1.0f);
+    EXPECT_FLOAT_EQ(mid.eye[0], 2.0f);
+    EXPECT_FLOAT_EQ(mid.eye[1], 1.0f);
+    EXPECT_FLOAT_EQ(mid.eye[2], -1.0f);
+
+    EXPECT_FLOAT_EQ(SampleCameraPath(path, -1.0f).eye[0], 0.0f);
+    EXPECT_FLOAT_EQ(SampleCameraPath(path, 5.0f).eye[0], 4.0f);
+}
+
+// Test spec parsing
+TEST(BenchmarkSpecTest, LoadFromJson) {
+    JsonValue json;
+    ASSERT_TRUE(JsonValue::Parse(R"({
+        "scene": "testbox", "width": 640, "height": 360,
+        "warmup_frames": 10, "frames": 120, "timestep": 0.02,
+        "camera_path": [
+            {"time": 1.0, "eye": [1, 2, 3]},
+            {"time": 0.0, "eye": [0, 0, 0], "target": [0, 0, -1]}
+        ]
+    })", json));
+
+    BenchmarkSpec spec;
+    ASSERT_TRUE(spec.loadFromJson(json));
+    EXPECT_EQ(spec.scene, "testbox");
+    EXPECT_EQ(spec.width, 640);
+    EXPECT_EQ(spec.height, 360);
+    EXPECT_EQ(spec.warmupFrames, 10);
+    EXPECT_EQ(spec.frames, 120);
+    EXPECT_FLOAT_EQ(spec.timestep, 0.02f);
+    ASSERT_EQ(spec.cameraPath.size(), 2u);
+    EXPECT_FLOAT_EQ(spec.cameraPath[0].time, 0.0f);  // Sorted by time
+    EXPECT_FLOAT_EQ(spec.cameraPath[1].eye[2], 3.0f);
+}
+
+TEST(BenchmarkSpecTest, RejectsNonPositiveTimestep) {
+    JsonValue json;
+    ASSERT_TRUE(JsonValue::Parse(R"({"timestep": 0})", json));
+    BenchmarkSpec spec;
+    EXPECT_FALSE(spec.loadFromJson(json));
+}
+
+// Test baseline comparison
+TEST(BenchmarkReportTest, DetectsRegression) {
+    BenchmarkReport baseline;
+    baseline.cpu = FrameTimeStats::Compute({10.0, 10.0, 10.0});
+
+    BenchmarkReport faster = baseline;
+    faster.cpu = FrameTimeStats::Compute({9.0, 9.0, 9.0});
+    BenchmarkReport slower = baseline;
+    slower.cpu = FrameTimeStats::Compute({12.0, 12.0, 12.0});
+
+    std::ostringstream log;
+    EXPECT_TRUE(faster.compareToBaseline(baseline.ToJson(), 0.10, log));
+    EXPECT_FALSE(slower.compareToBaseline(baseline.ToJson(), 0.10, log));
+    EXPECT_TRUE(slower.compareToBaseline(baseline.ToJson(), 0.25, log));
+}
+
+TEST(BenchmarkReportTest, FailsOnMismatchedRunOrMissingGroup) {
+    BenchmarkReport baseline;
+    baseline.scene = "testbox";
+    baseline.width = 1280;
+    baseline.height = 720;
+    baseline.frames = 300;
+    baseline.timestep = 1.0f / 60.0f;
+    baseline.cpu = FrameTimeStats::Compute({10.0, 10.0, 10.0});
+    baseline.gpu = FrameTimeStats::Compute({5.0, 5.0, 5.0});
+
+    std::ostringstream log;
+    EXPECT_TRUE(baseline.compareToBaseline(baseline.ToJson(), 0.10, log));
+
+    BenchmarkReport otherScene = baseline;
+    otherScene.scene = "debug";
+    EXPECT_FALSE(otherScene.compareToBaseline(baseline.ToJson(), 0.10, log));
+
+    BenchmarkReport otherSize = baseline;
+    otherSize.height = 1080;
+    EXPECT_FALSE(otherSize.compareToBaseline(baseline.ToJson(), 0.10, log));
+
+    BenchmarkReport otherFrames = baseline;
+    otherFrames.frames = 600;
+    EXPECT_FALSE(otherFrames.compareToBaseline(baseline.ToJson(), 0.10, log));
+
+    BenchmarkReport otherTimestep = baseline;
+    otherTimestep.timestep = 1.0f / 30.0f;
+    EXPECT_FALSE(otherTimestep.compareToBaseline(baseline.ToJson(), 0.10, log));
+
+    // A run without GPU samples cannot pass a baseline that has them
+    BenchmarkReport noGpu = baseline;
+    noGpu.gpu = FrameTimeStats::Compute({});
+    EXPECT_FALSE(noGpu.compareToBaseline(baseline.ToJson(), 0.10, log));
+    EXPECT_TRUE(baseline.compareToBaseline(noGpu.ToJson(), 0.10, log));
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "InstancePacking.h"
+#include "InstanceStore.h"
+#include <vector>
+
+// Test that destroyed handles go stale, slots are reused and the columns stay dense
+TEST(InstanceStoreTest, GenerationalHandlesAndSwapRemove) {
+    InstanceStore store;
+    const Motor identity(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    const InstanceHandle a = store.Create(0, identity);
+    const InstanceHandle b = store.Create(1, identity, 2.0f);
+    const InstanceHandle c = store.Create(2, identity, 3.0f, false);
+    EXPECT_TRUE(store.SetName(b, "b"));
+    EXPECT_FALSE(store.SetName(c, "b"));  // Names are unique
+
+    // Removing the first instance moves the last one into its dense index
+    EXPECT_TRUE(store.Destroy(a));
+    EXPECT_FALSE(store.Destroy(a));
+    EXPECT_FALSE(store.IsAlive(a));
+    ASSERT_EQ(store.Size(), 2u);
+    EXPECT_EQ(store.DenseIndex(c), 0u);
+    EXPECT_EQ(store.HandleAt(0), c);
+    EXPECT_EQ(store.Arrays().meshIds[0], 2u);
+    EXPECT_FLOAT_EQ(store.Arrays().scales[0], 3.0f);
+    EXPECT_EQ(store.Arrays().visible[0], 0u);
+
+    // The freed slot is reused with a new generation, so the old handle stays stale
+    const InstanceHandle d = store.Create(3, identity);
+    EXPECT_EQ(d.index, a.index);
+    EXPECT_NE(d.generation, a.generation);
+    EXPECT_FALSE(store.Get(a).has_value());
+    ASSERT_TRUE(store.Get(d).has_value());
+    EXPECT_EQ(store.Get(d)->meshId, 3u);
+
+    EXPECT_EQ(store.Find("b"), b);
+    EXPECT_EQ(store.Name(b), "b");
+    EXPECT_TRUE(store.Destroy(b));
+    EXPECT_FALSE(store.Find("b").IsValid());
+    EXPECT_EQ(store.Size(), 2u);
+}
+
+// Test that handles from before a Clear stay stale once new instances reuse their slots
+TEST(InstanceStoreTest, ClearInvalidatesOutstandingHandles) {
+    InstanceStore store;
+    const Motor identity(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    const InstanceHandle a = store.Create(0, identity);
+    const InstanceHandle b = store.Create(1, identity);
+    EXPECT_TRUE(store.SetName(a, "a"));
+
+    store.Clear();
+    EXPECT_EQ(store.Size(), 0u);
+    EXPECT_FALSE(store.IsAlive(a));
+    EXPECT_FALSE(store.Find("a").IsValid());
+
+    // New instances reuse the slots, but not the handles from before the Clear
+    const InstanceHandle c = store.Create(2, identity);
+    const InstanceHandle d = store.Create(3, identity);
+    EXPECT_EQ(c.index, a.index);
+    EXPECT_FALSE(store.IsAlive(a));
+    EXPECT_FALSE(store.IsAlive(b));
+    EXPECT_FALSE(store.Get(a).has_value());
+    ASSERT_TRUE(store.Get(c).has_value());
+    EXPECT_EQ(store.Get(c)->meshId, 2u);
+    EXPECT_EQ(store.Get(d)->meshId, 3u);
+    EXPECT_TRUE(store.SetName(c, "a"));
+}
+
+// Test world transforms of parented instances and the changed ranges they report
+TEST(InstanceStoreTest, HierarchyPropagatesDirtySubtrees) {
+    // Translations only, so the expected motors are plain sums (motors store half the translation)
+    auto at = [](float x, float y, float z) { return Motor(1.0f, x * 0.5f, y * 0.5f, z * 0.5f, 0.0f, 0.0f, 0.0f, 0.0f); };
+    InstanceStore store;
+    const InstanceHandle vehicle = store.Create(0, at(10, 0, 0));
+    const InstanceHandle wheel = store.Create(1, at(0, 0, 0));
+    const InstanceHandle bolt = store.Create(2, at(0, 0, 0));
+    const InstanceHandle bystander = store.Create(3, at(-5, 0, 0));
+    EXPECT_TRUE(store.SetParent(wheel, vehicle));
+    EXPECT_TRUE(store.SetParent(bolt, wheel));
+    EXPECT_FALSE(store.SetParent(vehicle, bolt));  // Would be a cycle
+    EXPECT_EQ(store.Parent(bolt), wheel);
+
+    // Parenting keeps the world transform; locals then place the children
+    store.UpdateWorldTransforms();
+    EXPECT_FLOAT_EQ(store.Arrays().transforms[store.DenseIndex(wheel)].e01(), 0.0f);
+    EXPECT_TRUE(store.SetLocalTransform(wheel, at(0, -1, 2)));
+    EXPECT_TRUE(store.SetLocalTransform(bolt, at(0.5f, 0, 0)));
+    store.UpdateWorldTransforms();
+    const Motor& boltWorld = store.Arrays().transforms[store.DenseIndex(bolt)];
+    EXPECT_FLOAT_EQ(boltWorld.e01(), 5.25f);
+    EXPECT_FLOAT_EQ(boltWorld.e02(), -0.5f);
+    EXPECT_FLOAT_EQ(boltWorld.e03(), 1.0f);
+    (void)store.TakeChangedRange();
+
+    // Moving the root reaches the grandchild; the bystander is not reported
+    EXPECT_TRUE(store.SetLocalTransform(vehicle, at(20, 0, 0)));
+    store.UpdateWorldTransforms();
+    EXPECT_FLOAT_EQ(store.Arrays().transforms[store.DenseIndex(bolt)].e01(), 10.25f);
+    const InstanceRange changed = store.TakeChangedRange();
+    EXPECT_EQ(changed.first, 0u);
+    EXPECT_EQ(changed.last, 3u);
+    store.UpdateWorldTransforms();
+    EXPECT_TRUE(store.TakeChangedRange().Empty());
+
+    // Destroying the middle node keeps the grandchild where it is, now as a root
+    EXPECT_TRUE(store.Destroy(wheel));
+    EXPECT_FALSE(store.Parent(bolt).IsValid());
+    EXPECT_TRUE(store.SetLocalTransform(vehicle, at(0, 0, 0)));
+    store.UpdateWorldTransforms();
+    EXPECT_FLOAT_EQ(store.Arrays().transforms[store.DenseIndex(bolt)].e01(), 10.25f);
+    EXPECT_FLOAT_EQ(store.Arrays().transforms[store.DenseIndex(bystander)].e01(), -2.5f);
+
+    // Only the changed records are repacked; the others keep what the buffer held
+    std::vector<Scene::GPUMeshInstance> packed(store.Size());
+    packed[0].meshId = 99;
+    InstancePacking::PackInstances(store.Arrays(), InstanceRange{1, 3}, packed.data());
+    EXPECT_EQ(packed[0].meshId, 99u);
+    EXPECT_EQ(packed[1].meshId, store.Arrays().meshIds[1]);
+    EXPECT_EQ(packed[2].sourceIndex, 2u);
+}
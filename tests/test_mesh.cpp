@@ -1,7 +1,27 @@
 #include <gtest/gtest.h>
 #include "Mesh.h"
+#include "MeshPacking.h"
+#include "MotorTransforms.h"
+#include "InstanceCulling.h"
+#include "InstancePacking.h"
+#include "InstanceStore.h"
+#include "MeshLod.h"
+#include "TextureCache.h"
+#include "TextureMips.h"
+#include "VirtualTexture.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <memory>
+#include <random>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 class MeshTest : public ::testing::Test {
 protected:
@@ -215,6 +235,946 @@ TEST(TriangleTest, DefaultValues) {
     EXPECT_EQ(tri.materialIndex, 0);
 }
 
+// Flat n x n grid in the XZ plane (2 * n * n triangles)
+static void buildGrid(Mesh& mesh, uint32_t n) {
+    for (uint32_t z = 0; z <= n; ++z) {
+        for (uint32_t x = 0; x <= n; ++x) {
+            Vertex v{};
+            v.position = TriVector(static_cast<float>(x), 0.0f, static_cast<float>(z), 1.0f);
+            mesh.AddVertex(v);
+        }
+    }
+    for (uint32_t z = 0; z < n; ++z) {
+        for (uint32_t x = 0; x < n; ++x) {
+            const uint32_t a = z * (n + 1) + x;
+            mesh.AddTriangle(Triangle{{a, a + 1, a + n + 1}, 0});
+            mesh.AddTriangle(Triangle{{a + 1, a + n + 2, a + n + 1}, 0});
+        }
+    }
+}
+
+// Test BVH structural metrics
+TEST(BVHStatsTest, StructureIsConsistent) {
+    Mesh mesh;
+    buildGrid(mesh, 16);
+    mesh.BuildBVH();
+
+    const auto stats = mesh.AnalyzeBVH();
+    EXPECT_EQ(stats.triangleCount, 512u);
+    EXPECT_EQ(stats.nodeBound, 1023u);
+    EXPECT_LE(stats.nodeCount, stats.nodeBound);
+    EXPECT_EQ(stats.degenerateTriangles, 0u);
+    EXPECT_LT(stats.maxDepth, Mesh::kTraversalStackSize);
+    EXPECT_GE(stats.sahCost, Mesh::kSAHTraversalCost);
+    EXPECT_EQ(stats.sampledRays, 0u);
+
+    // Every triangle sits in exactly one leaf, and a binary tree has leaves - 1 internal nodes
+    size_t leaves = 0;
+    size_t triangles = 0;
+    for (size_t k = 0; k < stats.leafSizeHistogram.size(); ++k) {
+        leaves += stats.leafSizeHistogram[k];
+        triangles += k * stats.leafSizeHistogram[k];
+    }
+    EXPECT_EQ(leaves, stats.leafCount);
+    EXPECT_EQ(triangles, stats.triangleCount);
+    EXPECT_EQ(stats.nodeCount, stats.leafCount * 2 - 1);
+    EXPECT_GE(stats.siblingOverlap, 0.0f);
+    EXPECT_LE(stats.siblingOverlap, 1.0f);
+}
+
+// Test ray-sampled traversal estimate
+TEST(BVHStatsTest, RaySampleIsDeterministic) {
+    Mesh mesh;
+    buildGrid(mesh, 8);
+    mesh.BuildBVH();
+
+    const auto a = mesh.AnalyzeBVH(256, 7);
+    const auto b = mesh.AnalyzeBVH(256, 7);
+    EXPECT_EQ(a.sampledRays, 256u);
+    EXPECT_GT(a.hitRatio, 0.0f);
+    EXPECT_GE(a.averageNodesVisited, 1.0f);
+    EXPECT_GE(a.maxNodesVisited, static_cast<uint32_t>(a.averageNodesVisited));
+    EXPECT_FLOAT_EQ(a.hitRatio, b.hitRatio);
+    EXPECT_FLOAT_EQ(a.averageTrianglesTested, b.averageTrianglesTested);
+}
+
+// Test degenerate triangles are counted
+// Test point-to-surface distances in each region around a triangle
+TEST(MeshDistanceTest, ClosestPointByRegion) {
+    Mesh mesh;
+    EXPECT_TRUE(std::isinf(mesh.DistanceToSurface(TriVector(0.0f, 0.0f, 0.0f, 1.0f))));
+
+    for (const auto& [x, y] : {std::pair{0.0f, 0.0f}, std::pair{1.0f, 0.0f}, std::pair{0.0f, 1.0f}}) {
+        Vertex v{};
+        v.position = TriVector(x, y, 0.0f, 1.0f);
+        mesh.AddVertex(v);
+    }
+    mesh.AddTriangle(Triangle{{0, 1, 2}, 0});
+    mesh.BuildBVH();
+
+    EXPECT_FLOAT_EQ(mesh.DistanceToSurface(TriVector(0.25f, 0.25f, 2.0f, 1.0f)), 2.0f);  // Face
+    EXPECT_FLOAT_EQ(mesh.DistanceToSurface(TriVector(3.0f, -4.0f, 0.0f, 1.0f)), std::sqrt(20.0f));  // Corner
+    EXPECT_FLOAT_EQ(mesh.DistanceToSurface(TriVector(0.5f, -1.0f, 0.0f, 1.0f)), 1.0f);  // Edge
+    EXPECT_FLOAT_EQ(mesh.DistanceToSurface(TriVector(1.0f, 1.0f, 0.0f, 1.0f)), std::sqrt(0.5f));  // Hypotenuse
+}
+
+TEST(BVHStatsTest, CountsDegenerateTriangles) {
+    Mesh mesh;
+    buildGrid(mesh, 2);
+    mesh.AddTriangle(Triangle{{0, 0, 1}, 0});
+    mesh.BuildBVH();
+
+    EXPECT_EQ(mesh.DegenerateTriangleCount(), 1u);
+    EXPECT_EQ(mesh.AnalyzeBVH().degenerateTriangles, 1u);
+}
+
+// Test that decimation keeps the outline, UV seams and material boundaries of a flat sheet
+TEST(MeshDecimateTest, KeepsBordersSeamsAndMaterialBoundaries) {
+    // 16 x 16 sheet in two UV charts split at x = 8 (u < 0.5 left, u >= 0.5 right), with
+    // material 1 on the far half z > 8
+    constexpr uint32_t n = 16;
+    constexpr uint32_t half = n / 2;
+    Mesh mesh;
+    auto vertexAt = [&mesh](uint32_t x, uint32_t z, bool rightChart) {
+        Vertex v{};
+        v.position = TriVector(static_cast<float>(x), 0.0f, static_cast<float>(z), 1.0f);
+        v.texCoord[0] = (rightChart ? 0.5f : 0.0f) + static_cast<float>(x) / 32.0f;
+        v.texCoord[1] = static_cast<float>(z) / 16.0f;
+        mesh.AddVertex(v);
+    };
+    for (uint32_t chart = 0; chart < 2; ++chart) {
+        for (uint32_t z = 0; z <= n; ++z) {
+            for (uint32_t x = chart * half; x <= (chart + 1) * half; ++x) vertexAt(x, z, chart == 1);
+        }
+    }
+    for (uint32_t chart = 0; chart < 2; ++chart) {
+        const uint32_t base = chart * (half + 1) * (n + 1);
+        for (uint32_t z = 0; z < n; ++z) {
+            for (uint32_t x = 0; x < half; ++x) {
+                const uint32_t a = base + z * (half + 1) + x;
+                const uint32_t material = z >= half ? 1 : 0;
+                mesh.AddTriangle(Triangle{{a, a + 1, a + half + 1}, material});
+                mesh.AddTriangle(Triangle{{a + 1, a + half + 2, a + half + 1}, material});
+            }
+        }
+    }
+
+    mesh.Decimate(0.25f);
+    ASSERT_GE(mesh.TriangleCount(), 4u);
+    EXPECT_LE(mesh.TriangleCount(), 160u);
+
+    float area = 0.0f;
+    for (const Triangle& tri : mesh.Triangles()) {
+        const Vertex* v[3];
+        for (int c = 0; c < 3; ++c) v[c] = &mesh.Vertices()[tri.indices[c]];
+        const float ax = v[1]->position.e032() - v[0]->position.e032(), az = v[1]->position.e021() - v[0]->position.e021();
+        const float bx = v[2]->position.e032() - v[0]->position.e032(), bz = v[2]->position.e021() - v[0]->position.e021();
+        const float normalY = az * bx - ax * bz;
+        EXPECT_LT(normalY, 0.0f);  // Facing -y like the input: nothing flipped
+        area += std::abs(normalY) * 0.5f;
+
+        const bool rightChart = v[0]->texCoord[0] >= 0.5f;
+        for (const Vertex* corner : v) {
+            EXPECT_FLOAT_EQ(corner->position.e013(), 0.0f);
+            EXPECT_EQ(corner->texCoord[0] >= 0.5f, rightChart);
+            EXPECT_TRUE(rightChart ? corner->position.e032() >= half : corner->position.e032() <= half);
+            EXPECT_TRUE(tri.materialIndex == 1 ? corner->position.e021() >= half : corner->position.e021() <= half);
+        }
+    }
+    // Covered exactly once: no holes along the border, seam or material boundary
+    EXPECT_NEAR(area, static_cast<float>(n * n), 1e-3f);
+}
+
+// Test that the quadric error spends the triangle budget on curvature, not on flat areas
+TEST(MeshDecimateTest, KeepsTrianglesWhereTheSurfaceBends) {
+    constexpr uint32_t n = 32;
+    Mesh mesh;
+    buildGrid(mesh, n);
+    // Flat for x < 16, a ripple beyond
+    std::vector<Vertex> vertices = mesh.Vertices();
+    for (Vertex& v : vertices) {
+        const float x = v.position.e032();
+        const float y = x > 16.0f ? std::sin(x * 1.3f) * std::cos(v.position.e021() * 0.9f) : 0.0f;
+        v.position = TriVector(x, y, v.position.e021(), 1.0f);
+    }
+    mesh.SetVertices(std::move(vertices));
+
+    mesh.Decimate(0.5f);
+    size_t flat = 0;
+    size_t curved = 0;
+    for (const Triangle& tri : mesh.Triangles()) {
+        float centroidX = 0.0f;
+        for (const uint32_t index : tri.indices) centroidX += mesh.Vertices()[index].position.e032() / 3.0f;
+        ++(centroidX < 16.0f ? flat : curved);
+    }
+    EXPECT_LE(mesh.TriangleCount(), n * n);
+    EXPECT_GT(curved, flat * 4);
+}
+
+// Test GPU packing rebases indices of later meshes
+TEST(MeshPackingTest, RebasesIndices) {
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    for (int m = 0; m < 2; ++m) {
+        auto mesh = std::make_unique<Mesh>();
+        for (int i = 0; i < 3; ++i) {
+            Vertex v{};
+            v.position = TriVector(static_cast<float>(i), static_cast<float>(i % 2), 0.0f, 1.0f);
+            mesh->AddVertex(v);
+        }
+        mesh->AddTriangle(Triangle{{0, 1, 2}, 0});
+        Material material;
+        material.diffuseTexturePath = "shared.png";
+        mesh->AddMaterial(material);
+        mesh->BuildBVH();
+        meshes.push_back(std::move(mesh));
+    }
+
+    const auto packed = MeshPacking::PackMeshes(meshes);
+    ASSERT_EQ(packed.vertices.size(), 6u);
+    ASSERT_EQ(packed.triangles.size(), 2u);
+    ASSERT_EQ(packed.meshInfos.size(), 2u);
+    EXPECT_EQ(packed.triangles[1].indices[0], 3u);
+    EXPECT_EQ(packed.triangles[1].materialIndex, 1u);
+    EXPECT_EQ(packed.meshInfos[1].vertexOffset, 3u);
+    EXPECT_EQ(packed.meshInfos[1].triangleOffset, 1u);
+    EXPECT_EQ(packed.bvhTriIndices.back(), 1u);
+
+    // Both materials share one texture slot
+    ASSERT_EQ(packed.texturePaths.size(), 1u);
+    EXPECT_EQ(packed.materials[0].diffuseTextureIndex, 0);
+    EXPECT_EQ(packed.materials[1].diffuseTextureIndex, 0);
+}
+
+TEST(MeshPackingTest, EmptyInputGetsDefaults) {
+    const auto packed = MeshPacking::PackMeshes({});
+    EXPECT_EQ(packed.meshInfos.size(), 1u);
+    EXPECT_EQ(packed.materials.size(), 1u);
+    EXPECT_TRUE(packed.vertices.empty());
+}
+
+// Test that shadow proxies within tolerance follow the meshes and share their materials
+TEST(MeshPackingTest, PacksUsableShadowProxiesAfterTheMeshes) {
+    constexpr uint32_t n = 32;
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    meshes.push_back(std::make_unique<Mesh>());
+    for (int i = 0; i < 3; ++i) {
+        Vertex v{};
+        v.position = TriVector(static_cast<float>(i), static_cast<float>(i % 2), 0.0f, 1.0f);
+        meshes[0]->AddVertex(v);
+    }
+    meshes[0]->AddTriangle(Triangle{{0, 1, 2}, 0});
+    for (int m = 1; m <= 2; ++m) {
+        auto grid = std::make_unique<Mesh>();
+        buildGrid(*grid, n);
+        if (m == 2) {
+            std::vector<Vertex> vertices = grid->Vertices();
+            for (Vertex& v : vertices) {
+                const float y = std::sin(v.position.e032() * 1.3f) * std::cos(v.position.e021() * 0.9f);
+                v.position = TriVector(v.position.e032(), y, v.position.e021(), 1.0f);
+            }
+            grid->SetVertices(std::move(vertices));
+        }
+        meshes.push_back(std::move(grid));
+    }
+    for (auto& mesh : meshes) {
+        mesh->AddMaterial(Material{});
+        mesh->BuildBVH();
+    }
+    meshes[1]->BuildShadowProxy(0.05f);
+    meshes[2]->BuildShadowProxy(0.05f);
+    ASSERT_NE(meshes[1]->ShadowProxy(), nullptr);
+    EXPECT_LT(meshes[1]->ShadowProxy()->TriangleCount(), meshes[1]->TriangleCount() / 10);
+    EXPECT_FALSE(meshes[1]->ShadowProxy()->BVHNodes().empty());
+    EXPECT_LT(meshes[1]->ShadowProxyError(), 1e-3f);
+    EXPECT_GT(meshes[2]->ShadowProxyError(), 0.1f);
+
+    // The error is the largest distance from a mesh vertex to the proxy
+    float farthest = 0.0f;
+    for (const Vertex& v : meshes[2]->Vertices()) {
+        farthest = std::max(farthest, meshes[2]->ShadowProxy()->DistanceToSurface(v.position));
+    }
+    EXPECT_FLOAT_EQ(meshes[2]->ShadowProxyError(), farthest);
+
+    // Off by default
+    const auto plain = MeshPacking::PackMeshes(meshes);
+    ASSERT_EQ(plain.meshInfos.size(), 3u);
+    EXPECT_EQ(plain.shadowProxyCount, 0u);
+    for (uint32_t m = 0; m < 3; ++m) EXPECT_EQ(plain.meshInfos[m].shadowMeshId, m);
+
+    // The rippled mesh's proxy is too coarse for the tolerance; the flat one's goes last
+    const auto packed = MeshPacking::PackMeshes(meshes, false, 1e-3f);
+    ASSERT_EQ(packed.meshInfos.size(), 4u);
+    EXPECT_EQ(packed.shadowProxyCount, 1u);
+    EXPECT_EQ(packed.materials.size(), 3u);
+    EXPECT_EQ(packed.meshInfos[0].shadowMeshId, 0u);
+    EXPECT_EQ(packed.meshInfos[1].shadowMeshId, 3u);
+    EXPECT_EQ(packed.meshInfos[2].shadowMeshId, 2u);
+    EXPECT_EQ(packed.meshInfos[3].shadowMeshId, 3u);
+
+    const Scene::GPUMeshInfo& proxy = packed.meshInfos[3];
+    EXPECT_EQ(proxy.triangleCount, meshes[1]->ShadowProxy()->TriangleCount());
+    EXPECT_EQ(proxy.triangleOffset, 1u + 4u * n * n);
+    EXPECT_EQ(proxy.bvhNodeOffset, packed.meshInfos[2].bvhNodeOffset + packed.meshInfos[2].bvhNodeCount);
+    for (uint32_t t = 0; t < proxy.triangleCount; ++t) {
+        EXPECT_EQ(packed.triangles[proxy.triangleOffset + t].materialIndex, 1u);
+    }
+    for (size_t i = proxy.bvhTriIdxOffset; i < packed.bvhTriIndices.size(); ++i) {
+        EXPECT_GE(packed.bvhTriIndices[i], proxy.triangleOffset);
+    }
+
+    // A wide enough tolerance takes both; a proxy without CPU data is never packed
+    EXPECT_EQ(MeshPacking::PackMeshes(meshes, false, 1.0f).shadowProxyCount, 2u);
+    meshes[1]->ClearCPUData();
+    EXPECT_EQ(MeshPacking::UsableShadowProxy(*meshes[1], 1.0f), nullptr);
+}
+
+TEST(MeshPackingTest, TexturesPackIntoWords) {
+    const uint8_t ldr[2 * 2 * 4] = {
+        0x10, 0x20, 0x30, 0x40,  0xFF, 0x00, 0x00, 0xFF,
+        0x00, 0xFF, 0x00, 0xFF,  0x00, 0x00, 0xFF, 0x80,
+    };
+    const float hdr[4] = {12.5f, 0.25f, 3.0f, 1.0f};
+    const MeshPacking::TexelSource sources[] = {
+        {ldr, 2, 2, Scene::TextureFormat::RGBA8},
+        {hdr, 1, 1, Scene::TextureFormat::RGBA32F},
+        {ldr, 1, 1, Scene::TextureFormat::RGBA8},
+        {nullptr, 512, 512, Scene::TextureFormat::SampledImage},
+        {nullptr, 64, 32, Scene::TextureFormat::SampledImage},
+    };
+
+    std::vector<Scene::GPUTextureInfo> infos;
+    const size_t words = MeshPacking::LayoutTextures(sources, infos);
+    ASSERT_EQ(infos.size(), 5u);
+    EXPECT_EQ(words, 4u + 4u + 1u);  // One word per 8-bit texel, four per float texel
+    EXPECT_EQ(infos[1].offset, 4u);
+    EXPECT_EQ(infos[1].format, static_cast<uint32_t>(Scene::TextureFormat::RGBA32F));
+    EXPECT_EQ(infos[2].offset, 8u);
+    EXPECT_EQ(infos[4].offset, 1u);  // Sampled images take no words; the offset is their slot
+    EXPECT_EQ(infos[4].width, 64u);
+
+    std::vector<uint32_t> buffer(words);
+    MeshPacking::WriteTexels(sources, infos, buffer.data());
+    // unpackUnorm4x8 reads red from the low byte
+    EXPECT_EQ(buffer[0], 0x40302010u);
+    EXPECT_EQ(buffer[3], 0x80FF0000u);
+    EXPECT_EQ(std::bit_cast<float>(buffer[4]), 12.5f);
+    EXPECT_EQ(std::bit_cast<float>(buffer[7]), 1.0f);
+    EXPECT_EQ(buffer[8], 0x40302010u);
+}
+
+TEST(TextureMipsTest, BatchedDownsampleMatchesScalar) {
+    const auto levels = TextureMips::LayoutMipChain(5, 3);
+    ASSERT_EQ(levels.size(), 3u);
+    EXPECT_EQ(levels[1].width, 2u);
+    EXPECT_EQ(levels[1].height, 1u);
+    EXPECT_EQ(levels[2].offset, 15u + 2u);
+    EXPECT_EQ(TextureMips::ChainTexels(levels), 18u);
+
+    // A 2x2 block averages to one texel, rounding to nearest
+    const uint8_t block[16] = {0, 10, 255, 1,  1, 10, 255, 2,  2, 10, 0, 2,  2, 11, 0, 2};
+    uint8_t averaged[4];
+    TextureMips::Downsample(block, 2, 2, averaged);
+    EXPECT_EQ(averaged[0], 1);
+    EXPECT_EQ(averaged[1], 10);
+    EXPECT_EQ(averaged[2], 128);
+    EXPECT_EQ(averaged[3], 2);
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> byte(0, 255);
+    const uint32_t sizes[][2] = {{64, 64}, {37, 5}, {33, 1}, {1, 9}, {100, 17}};
+    for (const auto& size : sizes) {
+        std::vector<uint8_t> src(static_cast<size_t>(size[0]) * size[1] * 4);
+        for (auto& b : src) b = static_cast<uint8_t>(byte(rng));
+        const size_t dstBytes = static_cast<size_t>(std::max(size[0] / 2, 1u)) * std::max(size[1] / 2, 1u) * 4;
+        std::vector<uint8_t> expected(dstBytes), actual(dstBytes);
+        TextureMips::DownsampleScalar(src.data(), size[0], size[1], expected.data());
+        TextureMips::Downsample(src.data(), size[0], size[1], actual.data());
+        EXPECT_EQ(actual, expected) << size[0] << "x" << size[1];
+    }
+}
+
+// Identical files decode once, and a second load maps the decoded texels from the cache
+TEST(TextureCacheTest, DeduplicatesAndCachesDecodedTextures) {
+    // Random suffix: concurrent test runs must not delete each other's files
+    const auto dir = std::filesystem::temp_directory_path() /
+                     ("flytracer_texture_cache_test_" + std::to_string(std::random_device{}()));
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // 4x2 binary PPMs: a and b have the same contents under different names
+    auto writePpm = [&](const char* name, uint8_t seed) {
+        std::ofstream out(dir / name, std::ios::binary);
+        out << "P6\n4 2\n255\n";
+        for (int i = 0; i < 4 * 2 * 3; ++i) out.put(static_cast<char>(seed + i * 7));
+        return (dir / name).string();
+    };
+    const std::vector<std::string> paths = {writePpm("a.ppm", 1), writePpm("b.ppm", 1), writePpm("c.ppm", 9),
+                                            (dir / "missing.png").string()};
+
+    TextureCache::Options options;
+    options.cacheDirectory = (dir / "cache").string();
+    options.generateMips = true;
+    const auto first = TextureCache::LoadTextures(paths, options);
+    ASSERT_EQ(first.textures.size(), 3u);
+    EXPECT_EQ(first.textureOfPath, (std::vector<uint32_t>{0, 0, 1, 2}));
+    EXPECT_EQ(first.cacheHits, 0u);
+
+    const auto& a = first.textures[0];
+    EXPECT_EQ(a.source.width, 4u);
+    EXPECT_EQ(a.source.height, 2u);
+    EXPECT_TRUE(a.hasMipChain);
+    const auto* texels = static_cast<const uint8_t*>(a.source.texels);
+    EXPECT_EQ(texels[4], 1 + 3 * 7);  // Second texel's red, alpha filled in after it
+    EXPECT_EQ(texels[7], 255);
+    EXPECT_EQ(first.textures[2].contentHash, 0u);  // White fallback
+    EXPECT_EQ(first.textures[2].source.width, 1u);
+
+    const auto second = TextureCache::LoadTextures(paths, options);
+    EXPECT_EQ(second.cacheHits, 2u);
+    const auto levels = TextureMips::LayoutMipChain(4, 2);
+    for (size_t t = 0; t < 2; ++t) {
+        const auto& cached = second.textures[t];
+        EXPECT_EQ(cached.contentHash, first.textures[t].contentHash);
+        ASSERT_TRUE(cached.hasMipChain);
+        EXPECT_EQ(std::memcmp(cached.source.texels, first.textures[t].source.texels,
+                              TextureMips::ChainTexels(levels) * 4), 0);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+// Tiles cover every level down to one tile, pages border-wrap, and the LRU keeps tiles in use
+TEST(VirtualTextureTest, StreamsRequestedTilesIntoPages) {
+    VirtualTexture::TileSet tiles;
+    EXPECT_EQ(tiles.Add(32, 32), 0u);     // Already a single tile
+    EXPECT_EQ(tiles.Add(200, 130), 1u);   // 4x3, 2x2 (100x65), 1x1 (50x32)
+    ASSERT_EQ(tiles.Levels(1).size(), 3u);
+    EXPECT_EQ(tiles.TileCount(), 1u + 12u + 4u + 1u);
+    EXPECT_EQ(tiles.PinnedTile(1), 17u);
+    const auto address = tiles.Locate(1 + 12 + 3);
+    EXPECT_EQ(address.texture, 1u);
+    EXPECT_EQ(address.level, 1u);
+    EXPECT_EQ(address.x, 1u);
+    EXPECT_EQ(address.y, 1u);
+
+    // Texel value = x | y << 16 makes the wrap visible
+    const uint32_t width = 100, height = 70;
+    std::vector<uint32_t> level(width * height);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) level[y * width + x] = x | y << 16;
+    }
+    std::vector<uint32_t> page(VirtualTexture::kPageTexels);
+    VirtualTexture::ExtractTile(level.data(), width, height, 1, 0, page.data());
+    EXPECT_EQ(page[0], 64u);
+    EXPECT_EQ(page[36], 0u);                                      // Column 100 wraps to 0
+    EXPECT_EQ(page[64 * VirtualTexture::kPageSide + 64], 28u | 64u << 16);  // Border row and column
+
+    VirtualTexture::PageCache cache(2, 4);
+    EXPECT_EQ(cache.Place(0, 1).page, 0u);
+    EXPECT_EQ(cache.Place(1, 1).page, 1u);
+    EXPECT_EQ(cache.Place(2, 1).page, VirtualTexture::PageCache::kNoPage);  // Both used this frame
+    EXPECT_TRUE(cache.Touch(0, 2));
+    const auto placement = cache.Place(2, 2);
+    EXPECT_EQ(placement.page, 1u);
+    EXPECT_EQ(placement.evictedTile, 1u);
+    EXPECT_EQ(cache.PageOf(1), VirtualTexture::PageCache::kNoPage);
+
+    // The streamer cuts requested tiles on its thread and reports the page table writes
+    std::vector<uint8_t> rgba(200 * 130 * 4);
+    for (size_t i = 0; i < rgba.size(); ++i) rgba[i] = static_cast<uint8_t>(i * 7);
+    TextureCache::Texture texture;
+    texture.source = {rgba.data(), 200, 130, Scene::TextureFormat::RGBA8};
+    VirtualTexture::TileStreamer streamer({texture}, 20);
+    const uint32_t tileCount = streamer.Tiles().TileCount();
+    std::vector<uint32_t> pages(streamer.PageCount() * VirtualTexture::kPageTexels);
+    std::vector<uint32_t> pageTable(tileCount);
+    streamer.WriteInitialPages(pages.data(), pageTable.data());
+    EXPECT_EQ(pageTable[tileCount - 1], 1u);
+    EXPECT_EQ(std::count(pageTable.begin(), pageTable.end(), 0u), static_cast<long>(tileCount - 1));
+
+    const uint32_t feedback[1] = {1u << 5 | 1u << (tileCount - 1)};
+    streamer.ProcessFeedback(feedback, 1);
+    EXPECT_EQ(streamer.PendingTiles(), 1u);
+    std::vector<uint32_t> staging(4 * VirtualTexture::kPageTexels);
+    std::vector<VirtualTexture::PageUpload> uploads;
+    std::vector<VirtualTexture::PageTableWrite> writes;
+    // The tile arrives whenever the streamer thread gets scheduled; give a loaded machine seconds
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (true) {
+        streamer.PlaceArrivedTiles(1, 4, staging.data(), uploads, writes);
+        if (!uploads.empty() || std::chrono::steady_clock::now() > deadline) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(uploads.size(), 1u);
+    EXPECT_EQ(uploads[0].page, 1u);  // First page after the pinned one
+    ASSERT_EQ(writes.size(), 1u);
+    EXPECT_EQ(writes[0].entry, 5u);
+    EXPECT_EQ(writes[0].value, 2u);
+    VirtualTexture::ExtractTile(rgba.data(), 200, 130, 1, 1, page.data());  // Tile 5 = (1, 1) of level 0
+    EXPECT_TRUE(std::equal(page.begin(), page.end(), staging.begin()));
+    EXPECT_EQ(streamer.PendingTiles(), 0u);
+}
+
+// Test the compact vertex bit packing against known values
+TEST(VertexPackingTest, HalfFloatRoundTrip) {
+    EXPECT_EQ(VertexPacking::FloatToHalf(1.0f), 0x3C00);
+    EXPECT_EQ(VertexPacking::FloatToHalf(-2.0f), 0xC000);
+    EXPECT_EQ(VertexPacking::FloatToHalf(1e6f), 0x7C00);  // Overflows to infinity
+    for (float value : {0.0f, 0.25f, 0.5f, 0.999f, 3.75f, -0.125f}) {
+        const float decoded = VertexPacking::HalfToFloat(VertexPacking::FloatToHalf(value));
+        EXPECT_NEAR(decoded, value, std::abs(value) * 0x1p-11f);
+    }
+}
+
+TEST(VertexPackingTest, OctahedralNormals) {
+    const float normals[][3] = {
+        {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}, {1.0f, 0.0f, 0.0f},
+        {0.577f, -0.577f, -0.577f}, {-0.267f, 0.535f, 0.802f}, {0.1f, 0.2f, -0.975f},
+    };
+    for (const auto& n : normals) {
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float decoded[3];
+        VertexPacking::UnpackOctahedral(VertexPacking::PackOctahedral(n[0], n[1], n[2]), decoded);
+        for (int a = 0; a < 3; ++a) {
+            EXPECT_NEAR(decoded[a], n[a] / length, 2e-4f);
+        }
+    }
+}
+
+TEST(VertexPackingTest, CompactErrorStaysWithinQuantizationStep) {
+    Mesh mesh;
+    buildGrid(mesh, 16);
+    mesh.ComputeNormals();
+    std::vector<Vertex> vertices = mesh.Vertices();
+    for (auto& v : vertices) {
+        v.texCoord[0] = v.position.e032() / 16.0f;
+        v.texCoord[1] = v.position.e021() / 7.0f;
+    }
+    mesh.SetVertices(std::move(vertices));
+
+    const auto error = MeshPacking::MeasureCompactVertexError(mesh);
+    const auto quantization = MeshPacking::ComputeQuantization(mesh);
+    const float halfStep = 0.5f * std::max({quantization.scale[0], quantization.scale[1], quantization.scale[2]});
+    EXPECT_LE(error.maxPositionError, halfStep * std::sqrt(3.0f) * 1.01f);
+    EXPECT_LT(error.relativePositionError, 1e-4f);
+    EXPECT_LT(error.maxNormalErrorDegrees, 0.01f);
+    EXPECT_LT(error.maxTexCoordError, 1e-3f);
+}
+
+TEST(MeshPackingTest, CompactVerticesCarryQuantization) {
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    meshes.push_back(std::make_unique<Mesh>());
+    buildGrid(*meshes.back(), 4);
+
+    const auto packed = MeshPacking::PackMeshes(meshes, true);
+    EXPECT_TRUE(packed.vertices.empty());
+    ASSERT_EQ(packed.compactVertices.size(), meshes[0]->VertexCount());
+
+    // Corners of the bounds map to the ends of the 16-bit range
+    const auto& info = packed.meshInfos[0];
+    const GPUCompactVertex& first = packed.compactVertices.front();
+    const GPUCompactVertex& last = packed.compactVertices.back();
+    EXPECT_FLOAT_EQ(info.quantOrigin[0], meshes[0]->Vertices().front().position.e032());
+    EXPECT_EQ(first.pos[0], 0);
+    EXPECT_EQ(last.pos[0], 65535);
+    EXPECT_NEAR(info.quantOrigin[0] + last.pos[0] * info.quantScale[0],
+                meshes[0]->Vertices().back().position.e032(), 1e-5f);
+}
+
+// Test that packed BVH nodes still enclose the triangles once their vertices are quantized
+TEST(MeshPackingTest, CompactVerticesStayInsideBVHNodes) {
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    meshes.push_back(std::make_unique<Mesh>());
+    Mesh& mesh = *meshes.back();
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> jitter(-0.37f, 0.37f);
+    const uint32_t n = 24;
+    for (uint32_t z = 0; z <= n; ++z) {
+        for (uint32_t x = 0; x <= n; ++x) {
+            const float px = static_cast<float>(x) + jitter(rng);
+            const float py = jitter(rng);
+            const float pz = static_cast<float>(z) + jitter(rng);
+            Vertex v{};
+            v.position = TriVector(px * 0.013f + 3.1f, py, pz * 0.017f - 1.7f, 1.0f);
+            mesh.AddVertex(v);
+        }
+    }
+    for (uint32_t z = 0; z < n; ++z) {
+        for (uint32_t x = 0; x < n; ++x) {
+            const uint32_t a = z * (n + 1) + x;
+            mesh.AddTriangle(Triangle{{a, a + 1, a + n + 1}, 0});
+            mesh.AddTriangle(Triangle{{a + 1, a + n + 2, a + n + 1}, 0});
+        }
+    }
+    mesh.BuildBVH();
+
+    const auto packed = MeshPacking::PackMeshes(meshes, true);
+    const auto& info = packed.meshInfos[0];
+    size_t checkedLeaves = 0;
+    for (uint32_t i = 0; i < info.bvhNodeCount; ++i) {
+        const Scene::BVHNode& node = packed.bvhNodes[info.bvhNodeOffset + i];
+        if (node.triCount == 0) continue;
+        ++checkedLeaves;
+        for (int32_t t = 0; t < node.triCount; ++t) {
+            const Triangle& tri = packed.triangles[packed.bvhTriIndices[node.leftFirst + t]];
+            for (uint32_t index : tri.indices) {
+                const GPUCompactVertex& v = packed.compactVertices[index];
+                for (int a = 0; a < 3; ++a) {
+                    const float decoded = info.quantOrigin[a] + static_cast<float>(v.pos[a]) * info.quantScale[a];
+                    EXPECT_GE(decoded, node.minBounds[a]);
+                    EXPECT_LE(decoded, node.maxBounds[a]);
+                }
+            }
+        }
+    }
+    EXPECT_GT(checkedLeaves, 1u);
+}
+
+// Test that visibility rays and results keep the layout visibility.comp reads and writes
+TEST(VisibilityQueryTest, RaysAndResultsMatchTheShaderLayout) {
+    static_assert(sizeof(Scene::GPUVisibilityRay) == 32);
+    static_assert(offsetof(Scene::GPUVisibilityRay, maxDistance) == 12);
+    static_assert(offsetof(Scene::GPUVisibilityRay, direction) == 16);
+    static_assert(sizeof(Scene::GPUVisibilityResult) == 16);
+    static_assert(offsetof(Scene::GPUVisibilityResult, hitDistance) == 4);
+    static_assert(offsetof(Scene::GPUVisibilityResult, primitiveType) == 8);
+    static_assert(offsetof(Scene::GPUVisibilityResult, instanceIndex) == 12);
+
+    // A segment keeps its length as the limit; the shader normalizes the direction
+    const float from[3] = {1.0f, 2.0f, 3.0f};
+    const float to[3] = {4.0f, 6.0f, 3.0f};
+    const auto ray = Scene::GPUVisibilityRay::Segment(from, to);
+    float words[8];
+    std::memcpy(words, &ray, sizeof(words));
+    const float expected[8] = {1.0f, 2.0f, 3.0f, 5.0f, 3.0f, 4.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 8; ++i) EXPECT_FLOAT_EQ(words[i], expected[i]) << "word " << i;
+    EXPECT_EQ(Scene::GPUVisibilityRay{}.maxDistance, 0.0f);  // Unbounded
+
+    // Results are copied back word for word
+    const uint32_t written[4] = {1u, std::bit_cast<uint32_t>(2.5f), 0u, 7u};
+    Scene::GPUVisibilityResult result;
+    std::memcpy(&result, written, sizeof(written));
+    EXPECT_EQ(result.occluded, 1u);
+    EXPECT_EQ(result.hitDistance, 2.5f);
+    EXPECT_EQ(result.primitiveType, 0);
+    EXPECT_EQ(result.instanceIndex, 7u);
+    EXPECT_EQ(Scene::GPUVisibilityResult{}.primitiveType, -1);
+}
+
+// Test the world-to-object matrix built from an instance motor
+TEST(GPUMeshInstanceTest, FromMotorInvertsTranslationAndScale) {
+    // Translation by (2, -4, 6): motor stores half the translation
+    const Motor motor(1.0f, 1.0f, -2.0f, 3.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    const auto inst = Scene::GPUMeshInstance::FromMotor(motor, 2.0f, 5, false);
+
+    // World point (2, -4, 6) + 2 * (1, 1, 1) maps to object point (1, 1, 1)
+    const float world[3] = {4.0f, -2.0f, 8.0f};
+    for (int row = 0; row < 3; ++row) {
+        const float* r = &inst.invTransform[row * 4];
+        EXPECT_FLOAT_EQ(r[0] * world[0] + r[1] * world[1] + r[2] * world[2] + r[3], 1.0f);
+    }
+    EXPECT_EQ(inst.meshId, 5u);
+    EXPECT_EQ(inst.visible, 0u);
+}
+
+// Test FromMotor against the sandwich product for a rotated, translated and scaled instance
+TEST(GPUMeshInstanceTest, FromMotorInvertsRotatedMotor) {
+    const float norm = std::sqrt(0.6f * 0.6f + 0.2f * 0.2f + 0.7f * 0.7f);
+    const BiVector axis(0.0f, 0.0f, 0.0f, 0.6f / norm, -0.2f / norm, 0.7f / norm);
+    const Motor motor = Motor::Translation(3.0f, -1.0f, 2.5f) * Motor::Rotation(125.0f, axis);
+    const float scale = 1.5f;
+    const auto inst = Scene::GPUMeshInstance::FromMotor(motor, scale, 0, true);
+
+    const float objectPoints[4][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {-0.8f, 2.0f, 0.3f}};
+    for (const auto& p : objectPoints) {
+        // The instance scales in object space, then the motor moves the scaled point
+        const TriVector world = (motor * TriVector(scale * p[0], scale * p[1], scale * p[2]) * ~motor).Grade3();
+        const float w[3] = {world.e032(), world.e013(), world.e021()};
+        for (int row = 0; row < 3; ++row) {
+            const float* r = &inst.invTransform[row * 4];
+            EXPECT_NEAR(r[0] * w[0] + r[1] * w[1] + r[2] * w[2] + r[3], p[row], 1e-5f) << "row " << row;
+        }
+    }
+}
+
+// Test that the batched (SIMD, threaded) instance packing matches the scalar path
+TEST(InstancePackingTest, BatchedMatchesScalar) {
+    // Enough instances for several threads, plus a tail that is not a multiple of 8
+    const size_t count = InstancePacking::kInstancesPerThread * 3 + 5;
+    InstanceStore store;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (size_t i = 0; i < count; ++i) {
+        const float c[8] = {unit(rng), unit(rng), unit(rng), unit(rng),
+                            unit(rng), unit(rng), unit(rng), unit(rng)};
+        (void)store.Create(static_cast<uint32_t>(i % 7), Motor(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]),
+                           0.5f + 0.25f * static_cast<float>(i % 4), (i % 3) != 0);
+    }
+    const InstanceArrays& instances = store.Arrays();
+
+    std::vector<Scene::GPUMeshInstance> expected(count);
+    std::vector<Scene::GPUMeshInstance> actual(count);
+    InstancePacking::PackInstancesScalar(instances, expected.data());
+    InstancePacking::PackInstances(instances, actual.data());
+
+    for (size_t i = 0; i < count; ++i) {
+        for (int k = 0; k < 12; ++k) {
+            ASSERT_NEAR(actual[i].invTransform[k], expected[i].invTransform[k],
+                        1e-5f * (1.0f + std::abs(expected[i].invTransform[k]))) << "instance " << i;
+        }
+        ASSERT_EQ(actual[i].meshId, expected[i].meshId);
+        ASSERT_EQ(actual[i].visible, expected[i].visible);
+        ASSERT_EQ(actual[i].sourceIndex, i);
+    }
+
+    // A culled upload packs only the listed instances and records where each came from
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 1; i < count; i += 3) {
+        indices.push_back(i);
+    }
+    std::vector<Scene::GPUMeshInstance> culled(indices.size());
+    InstancePacking::PackInstances(instances, indices, culled.data());
+    for (size_t k = 0; k < indices.size(); ++k) {
+        const Scene::GPUMeshInstance& full = expected[indices[k]];
+        for (int j = 0; j < 12; ++j) {
+            ASSERT_NEAR(culled[k].invTransform[j], full.invTransform[j],
+                        1e-5f * (1.0f + std::abs(full.invTransform[j]))) << "record " << k;
+        }
+        ASSERT_EQ(culled[k].meshId, full.meshId);
+        ASSERT_EQ(culled[k].visible, full.visible);
+        ASSERT_EQ(culled[k].sourceIndex, indices[k]);
+    }
+}
+
+// Test instance world bounds against the camera frustum, with and without a margin
+TEST(InstanceCullingTest, KeepsInstancesTouchingTheFrustum) {
+    // Camera at the origin looking down -Z, 90 degree FOV, square image
+    const float rotation[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    const float eye[3] = {0, 0, 0};
+    const auto tight = InstanceCulling::Frustum::FromCamera(rotation, eye, 90.0f, 1.0f);
+    const auto padded = InstanceCulling::Frustum::FromCamera(rotation, eye, 90.0f, 1.0f, 15.0f);
+
+    Scene::BVHNode root;
+    for (int a = 0; a < 3; ++a) {
+        root.minBounds[a] = -1.0f;
+        root.maxBounds[a] = 1.0f;
+    }
+    const InstanceCulling::LocalBounds meshBounds[] = {InstanceCulling::LocalBounds::FromBVHRoot(root)};
+
+    // Motors store half the translation
+    auto at = [](float x, float y, float z) { return Motor(1.0f, x * 0.5f, y * 0.5f, z * 0.5f, 0.0f, 0.0f, 0.0f, 0.0f); };
+    InstanceStore store;
+    (void)store.Create(0, at(0, 0, -10));            // 0: straight ahead
+    (void)store.Create(0, at(0, 0, 10));             // 1: behind the camera
+    (void)store.Create(0, at(20, 0, -10));           // 2: off to the right
+    (void)store.Create(0, at(0, 0, -5), 1.0f, false);  // 3: ahead but hidden
+    (void)store.Create(0, at(11.5f, 0, -10), 2.0f);  // 4: centre outside, scaled box reaches in
+    (void)store.Create(0, at(12.5f, 0, -10));        // 5: just outside the right plane
+    (void)store.Create(9, at(0, 0, -10));            // 6: unknown mesh, empty box at its origin
+    (void)store.Create(0, at(0, 0, 40));             // 7: far behind
+    (void)store.Create(0, at(11.5f, 0, -10), 2.0f);  // 8: as 4, but past the 8-wide block
+
+    InstanceCulling::WorldBounds bounds;
+    InstanceCulling::ComputeWorldBounds(store.Arrays(), meshBounds, bounds);
+    EXPECT_FLOAT_EQ(bounds.centerX[4], 11.5f);
+    EXPECT_FLOAT_EQ(bounds.extentX[4], 2.0f);
+    EXPECT_FLOAT_EQ(bounds.centerX[8], 11.5f);
+    EXPECT_FLOAT_EQ(bounds.extentX[8], 2.0f);
+    EXPECT_FLOAT_EQ(bounds.extentY[6], 0.0f);
+
+    std::vector<uint32_t> visible;
+    InstanceCulling::CullInstances(store.Arrays(), bounds, tight, visible);
+    EXPECT_EQ(visible, (std::vector<uint32_t>{0, 4, 6, 8}));
+    // The margin also keeps the box just behind the camera - it could show up in reflections
+    InstanceCulling::CullInstances(store.Arrays(), bounds, padded, visible);
+    EXPECT_EQ(visible, (std::vector<uint32_t>{0, 1, 2, 4, 5, 6, 8}));
+
+    // Looking away from all of them uploads nothing, and the renderer must not fall back to
+    // tracing mesh 0's raw triangles as it does for a scene without instances
+    const float backwards[9] = {-1, 0, 0, 0, 1, 0, 0, 0, -1};
+    const float above[3] = {0, 0, 100};
+    InstanceCulling::CullInstances(store.Arrays(), bounds,
+                                   InstanceCulling::Frustum::FromCamera(backwards, above, 90.0f, 1.0f), visible);
+    EXPECT_TRUE(visible.empty());
+    EXPECT_EQ(InstanceCulling::FallbackTriangleCount(store.Size(), 12), 0u);
+    EXPECT_EQ(InstanceCulling::FallbackTriangleCount(0, 12), 12u);
+
+    // The batched test matches the scalar one on a large random, rotated set
+    InstanceStore many;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    const BiVector yAxis(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    for (int i = 0; i < 1003; ++i) {
+        (void)many.Create(0, at(position(rng), position(rng), position(rng)) * Motor::Rotation(angle(rng), yAxis),
+                          1.0f, (i % 5) != 0);
+    }
+    InstanceCulling::ComputeWorldBounds(many.Arrays(), meshBounds, bounds);
+    std::vector<uint32_t> expected;
+    InstanceCulling::CullInstancesScalar(many.Arrays(), bounds, tight, expected);
+    InstanceCulling::CullInstances(many.Arrays(), bounds, tight, visible);
+    EXPECT_EQ(visible, expected);
+    EXPECT_GT(expected.size(), 0u);
+    EXPECT_LT(expected.size(), many.Size());
+}
+
+// Test LOD generation and per-instance level selection by projected size
+TEST(MeshLodTest, SelectsLevelsByScreenSizeWithHysteresis) {
+    Mesh mesh;
+    buildGrid(mesh, 32);
+    const float ratios[] = {1.0f, 0.5f, 0.25f};
+    const auto generated = MeshLod::GenerateLevels(mesh, ratios);
+    ASSERT_EQ(generated.size(), 2u);
+    EXPECT_LT(generated[0]->TriangleCount(), mesh.TriangleCount());
+    EXPECT_LT(generated[1]->TriangleCount(), generated[0]->TriangleCount());
+    EXPECT_FALSE(generated[1]->BVHNodes().empty());
+
+    // Unit box: bounding sphere radius sqrt(3). With a 90 degree FOV the projected size is
+    // sqrt(3) / distance; the default chain switches at 0.354, 0.25 and 0.158.
+    Scene::BVHNode root;
+    for (int a = 0; a < 3; ++a) {
+        root.minBounds[a] = -1.0f;
+        root.maxBounds[a] = 1.0f;
+    }
+    MeshLod::LodTable table;
+    const uint32_t chain[] = {0, 5, 6, 7};
+    table.Add(chain, MeshLod::kDefaultRatios, root);
+    EXPECT_EQ(table.Find(5), nullptr);
+
+    auto at = [](float z) { return Motor(1.0f, 0.0f, 0.0f, z * 0.5f, 0.0f, 0.0f, 0.0f, 0.0f); };
+    InstanceStore store;
+    const InstanceHandle near = store.Create(0, at(-2.0f));
+    const InstanceHandle middle = store.Create(0, at(-7.0f));
+    (void)store.Create(0, at(-100.0f));
+    (void)store.Create(3, at(-100.0f));  // No chain: left alone
+    (void)store.Create(0, at(-200.0f), 40.0f);  // Scaled up: full detail far away
+
+    const float eye[3] = {0.0f, 0.0f, 0.0f};
+    std::vector<uint8_t> levels;
+    InstanceArrays instances = store.Arrays();
+    const InstanceRange changed = MeshLod::SelectLevels(table, instances, eye, 90.0f, 0.15f, levels);
+    EXPECT_EQ(instances.meshIds, (std::vector<uint32_t>{0, 5, 7, 3, 0}));
+    EXPECT_EQ(changed.first, 1u);
+    EXPECT_EQ(changed.last, 3u);
+
+    // Same distance, different history: moving in to 4.5 (size 0.385) is not far enough past
+    // the 0.354 boundary to leave level 1, while an instance coming from level 0 stays there
+    (void)store.SetLocalTransform(near, at(-4.5f));
+    (void)store.SetLocalTransform(middle, at(-4.5f));
+    store.UpdateWorldTransforms();
+    instances = store.Arrays();
+    EXPECT_TRUE(MeshLod::SelectLevels(table, instances, eye, 90.0f, 0.15f, levels).Empty());
+    EXPECT_EQ(instances.meshIds[0], 0u);
+    EXPECT_EQ(instances.meshIds[1], 5u);
+
+    // Well past it, the instance goes back to full detail
+    (void)store.SetLocalTransform(middle, at(-3.0f));
+    store.UpdateWorldTransforms();
+    instances = store.Arrays();
+    const InstanceRange back = MeshLod::SelectLevels(table, instances, eye, 90.0f, 0.15f, levels);
+    EXPECT_EQ(instances.meshIds[1], 0u);
+    EXPECT_EQ(back.first, 1u);
+    EXPECT_EQ(back.last, 2u);
+}
+
+// Test that the level history follows instances through a swap-remove
+TEST(MeshLodTest, HistoryFollowsSwapRemovedInstances) {
+    Scene::BVHNode root;
+    for (int a = 0; a < 3; ++a) {
+        root.minBounds[a] = -1.0f;
+        root.maxBounds[a] = 1.0f;
+    }
+    MeshLod::LodTable table;
+    const uint32_t chain[] = {0, 5, 6, 7};
+    table.Add(chain, MeshLod::kDefaultRatios, root);
+
+    // The last instance sits at 4.5, inside the hysteresis band of the level 0/1 boundary,
+    // where its level depends on its history
+    auto at = [](float z) { return Motor(1.0f, 0.0f, 0.0f, z * 0.5f, 0.0f, 0.0f, 0.0f, 0.0f); };
+    InstanceStore store;
+    const InstanceHandle far = store.Create(0, at(-100.0f));
+    (void)store.Create(0, at(-2.0f));
+    (void)store.Create(0, at(-4.5f));
+
+    const float eye[3] = {0.0f, 0.0f, 0.0f};
+    std::vector<uint8_t> levels;
+    InstanceArrays instances = store.Arrays();
+    (void)MeshLod::SelectLevels(table, instances, eye, 90.0f, 0.15f, levels);
+    EXPECT_EQ(instances.meshIds, (std::vector<uint32_t>{7, 0, 0}));
+
+    // The 4.5 instance moves into the far one's slot and keeps level 0 rather than
+    // inheriting level 3 and stopping at level 1 on the way back
+    const uint32_t dense = store.DenseIndex(far);
+    ASSERT_TRUE(store.Destroy(far));
+    MeshLod::RemoveInstance(levels, dense, static_cast<uint32_t>(store.Size()));
+    EXPECT_EQ(levels.size(), 2u);
+    instances = store.Arrays();
+    EXPECT_TRUE(MeshLod::SelectLevels(table, instances, eye, 90.0f, 0.15f, levels).Empty());
+    EXPECT_EQ(instances.meshIds, (std::vector<uint32_t>{0, 0}));
+
+    // An instance added since the last selection starts without history
+    std::vector<uint8_t> shortHistory = {3};
+    MeshLod::RemoveInstance(shortHistory, 0, 1);
+    EXPECT_EQ(shortHistory, (std::vector<uint8_t>{0}));
+}
+
+// Test the batch motor kernels against the instance matrix the GPU uses, across a full AVX2
+// batch and a tail
+TEST(MotorTransformsTest, MatchesInstanceMatrix) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> value(-3.0f, 3.0f);
+    const float norm = std::sqrt(0.3f * 0.3f + 0.9f * 0.9f + 0.2f * 0.2f);
+    const BiVector axis(0.0f, 0.0f, 0.0f, 0.3f / norm, 0.9f / norm, -0.2f / norm);
+    const Motor translation(1.0f, 0.5f * 1.5f, 0.5f * -2.0f, 0.5f * 0.25f, 0.0f, 0.0f, 0.0f, 0.0f);
+    const Motor motor = translation * Motor::Rotation(70.0f, axis);
+    const Scene::GPUMeshInstance inverse = Scene::GPUMeshInstance::FromMotor(motor, 1.0f, 0, true);
+    auto applyInverse = [&](const float p[3], int row) {
+        return inverse.invTransform[row * 4] * p[0] + inverse.invTransform[row * 4 + 1] * p[1] +
+               inverse.invTransform[row * 4 + 2] * p[2] + inverse.invTransform[row * 4 + 3];
+    };
+
+    std::vector<TriVector> points;
+    std::vector<Vector> planes;
+    std::vector<Vertex> vertices(11);
+    for (int i = 0; i < 11; ++i) {
+        points.emplace_back(value(rng), value(rng), value(rng));
+        planes.emplace_back(value(rng), value(rng), value(rng), value(rng));
+        vertices[i].position = points.back();
+        vertices[i].normal = Vector(0.0f, planes.back().e1(), planes.back().e2(), planes.back().e3());
+    }
+    points.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);  // Ideal point: a direction, only rotated
+    const std::vector<TriVector> originalPoints = points;
+    const std::vector<Vector> originalPlanes = planes;
+
+    MotorTransforms::TransformPoints(motor, points);
+    MotorTransforms::TransformPlanes(motor, planes);
+    MotorTransforms::TransformVertices(motor, vertices);
+    for (size_t i = 0; i + 1 < points.size(); ++i) {
+        const float moved[3] = {points[i].e032(), points[i].e013(), points[i].e021()};
+        EXPECT_NEAR(applyInverse(moved, 0), originalPoints[i].e032(), 1e-4f) << "point " << i;
+        EXPECT_NEAR(applyInverse(moved, 1), originalPoints[i].e013(), 1e-4f) << "point " << i;
+        EXPECT_NEAR(applyInverse(moved, 2), originalPoints[i].e021(), 1e-4f) << "point " << i;
+        EXPECT_FLOAT_EQ(points[i].e123(), 1.0f);
+        EXPECT_FLOAT_EQ(vertices[i].position.e032(), points[i].e032());
+        EXPECT_FLOAT_EQ(vertices[i].normal.e2(), planes[i].e2());
+
+        // A point on the original plane lands on the moved plane
+        const Vector& plane = originalPlanes[i];
+        const float n2 = plane.e1() * plane.e1() + plane.e2() * plane.e2() + plane.e3() * plane.e3();
+        TriVector onPlane(-plane.e0() * plane.e1() / n2, -plane.e0() * plane.e2() / n2, -plane.e0() * plane.e3() / n2);
+        MotorTransforms::TransformPoints(motor, std::span(&onPlane, 1));
+        EXPECT_NEAR(planes[i].e1() * onPlane.e032() + planes[i].e2() * onPlane.e013() +
+                    planes[i].e3() * onPlane.e021() + planes[i].e0(), 0.0f, 1e-4f) << "plane " << i;
+    }
+    const TriVector& direction = points.back();
+    EXPECT_FLOAT_EQ(direction.e123(), 0.0f);
+    EXPECT_NEAR(direction.e032() * direction.e032() + direction.e013() * direction.e013() +
+                direction.e021() * direction.e021(), 1.0f, 1e-5f);
+    const float zero[3] = {0.0f, 0.0f, 0.0f};
+    const float rotatedBack[3] = {direction.e032(), direction.e013(), direction.e021()};
+    EXPECT_NEAR(applyInverse(rotatedBack, 0) - applyInverse(zero, 0), 1.0f, 1e-5f);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
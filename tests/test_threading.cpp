@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "SpscQueue.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Test the frame queue's capacity limit and ordering across a producer and a consumer thread
+TEST(SpscQueueTest, DeliversInOrderAcrossThreads) {
+    SpscQueue<std::vector<uint32_t>> queue(2);
+    *queue.TryBeginPush() = {0};
+    queue.EndPush();
+    *queue.TryBeginPush() = {1};
+    queue.EndPush();
+    EXPECT_EQ(queue.TryBeginPush(), nullptr);
+    ASSERT_NE(queue.Front(), nullptr);
+    EXPECT_EQ(queue.Front()->front(), 0u);
+    queue.Pop();
+    queue.Pop();
+    EXPECT_EQ(queue.Front(), nullptr);
+
+    constexpr uint32_t kItems = 100000;
+    std::jthread producer([&queue] {
+        for (uint32_t i = 0; i < kItems; ++i) {
+            queue.WaitForSpace();
+            std::vector<uint32_t>& slot = *queue.TryBeginPush();
+            slot.assign(3, i);
+            queue.EndPush();
+        }
+    });
+
+    // Count mismatches rather than asserting, so the producer is never left blocked
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < kItems; ++i) {
+        queue.WaitForItem();
+        const std::vector<uint32_t>& slot = *queue.Front();
+        if (slot.size() != 3 || slot[0] != i || slot[2] != i) {
+            ++mismatches;
+        }
+        queue.Pop();
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
+
+// Test that every index runs once, with and without a thread cap, and nested loops run inline
+TEST(WorkerPoolTest, RunsEveryIndexOnceAndNestedLoopsInline) {
+    WorkerPool pool(4);
+    EXPECT_EQ(pool.ThreadCount(), 4u);
+
+    // Reused across loops, with and without a thread cap
+    for (unsigned maxThreads : {0u, 1u, 2u, 0u}) {
+        std::vector<std::atomic<uint32_t>> calls(1000);
+        pool.ParallelFor(calls.size(), [&](size_t i) {
+            calls[i].fetch_add(1, std::memory_order_relaxed);
+        }, maxThreads);
+        EXPECT_TRUE(std::ranges::all_of(calls, [](const auto& c) { return c.load() == 1; }));
+    }
+
+    // A loop started from inside a loop body runs on that thread instead of deadlocking
+    std::atomic<uint32_t> inner{0};
+    pool.ParallelFor(8, [&](size_t) {
+        pool.ParallelFor(10, [&](size_t) { inner.fetch_add(1, std::memory_order_relaxed); });
+    });
+    EXPECT_EQ(inner.load(), 80u);
+}
+
+// Test that an exception from a parallel loop body reaches the caller
+TEST(WorkerPoolTest, RethrowsLoopBodyExceptionsToTheCaller) {
+    WorkerPool pool(4);
+    EXPECT_THROW(pool.ParallelFor(1000, [](size_t i) {
+        if (i == 500) throw std::runtime_error("loop body");
+    }), std::runtime_error);
+
+    // The pool is usable again once the failed loop has been rethrown
+    std::atomic<uint32_t> calls{0};
+    pool.ParallelFor(100, [&](size_t) { calls.fetch_add(1, std::memory_order_relaxed); });
+    EXPECT_EQ(calls.load(), 100u);
+}
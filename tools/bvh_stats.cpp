@@ -0,0 +1,171 @@
+// BVH quality report for OBJ meshes - builds each mesh's BVH the way the engine does
+// and prints the metrics from Mesh::AnalyzeBVH, optionally as JSON for diffing builds.
+//
+//   FlyTracer_BVHStats [--rays N] [--seed N] [--json report.json] mesh.obj [more.obj ...]
+
+#include "Mesh.h"
+#include "Json.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+void printHelp() {
+    std::cout <<
+        "FlyTracer BVH analysis\n\n"
+        "Usage: FlyTracer_BVHStats [options] <mesh.obj> [more.obj ...]\n\n"
+        "Options:\n"
+        "  --rays <N>       Random rays for the traversal estimate (default: 10000, 0 = off)\n"
+        "  --seed <N>       Seed for the ray sample (default: 1)\n"
+        "  --json <file>    Also write all metrics as JSON\n"
+        "  --help, -h       Show this help message\n";
+}
+
+void printStats(const std::string& name, const Mesh::BVHStats& stats, double buildMs) {
+    std::cout << std::fixed << std::setprecision(2)
+              << name << "\n"
+              << "  triangles:        " << stats.triangleCount
+              << " (" << stats.degenerateTriangles << " degenerate)\n"
+              << "  build time:       " << buildMs << " ms\n"
+              << "  nodes:            " << stats.nodeCount << " / " << stats.nodeBound << " (2N-1), "
+              << stats.leafCount << " leaves\n"
+              << "  SAH cost:         " << stats.sahCost << "\n"
+              << "  depth:            avg leaf " << stats.averageLeafDepth << ", max " << stats.maxDepth << "\n"
+              << "  leaf size:        avg " << stats.averageLeafSize << ", max " << stats.maxLeafSize << "\n"
+              << "  sibling overlap:  " << stats.siblingOverlap * 100.0f << "%\n";
+
+    std::cout << "  leaf histogram:  ";
+    for (size_t k = 1; k < stats.leafSizeHistogram.size(); ++k) {
+        std::cout << " " << k << ":" << stats.leafSizeHistogram[k];
+    }
+    std::cout << "\n";
+
+    if (stats.sampledRays > 0) {
+        std::cout << "  rays:             " << stats.sampledRays << " sampled, "
+                  << stats.hitRatio * 100.0f << "% hit\n"
+                  << "  per ray:          " << stats.averageNodesVisited << " nodes (max "
+                  << stats.maxNodesVisited << "), " << stats.averageTrianglesTested << " triangles\n";
+    }
+
+    if (stats.maxDepth + 1 >= Mesh::kTraversalStackSize) {
+        std::cout << "  Warning: depth exceeds the shader traversal stack ("
+                  << Mesh::kTraversalStackSize << "), some subtrees will be skipped on the GPU\n";
+    }
+    std::cout << "\n";
+}
+
+FlyTracer::JsonValue statsToJson(const std::string& name, const Mesh::BVHStats& stats, double buildMs) {
+    using FlyTracer::JsonValue;
+    JsonValue histogram = JsonValue::Array();
+    for (const size_t count : stats.leafSizeHistogram) {
+        histogram.Push(JsonValue::Number(static_cast<double>(count)));
+    }
+
+    JsonValue json = JsonValue::Object();
+    json.Set("mesh", JsonValue::String(name));
+    json.Set("build_ms", JsonValue::Number(buildMs));
+    json.Set("triangles", JsonValue::Number(static_cast<double>(stats.triangleCount)));
+    json.Set("degenerate_triangles", JsonValue::Number(static_cast<double>(stats.degenerateTriangles)));
+    json.Set("nodes", JsonValue::Number(static_cast<double>(stats.nodeCount)));
+    json.Set("node_bound", JsonValue::Number(static_cast<double>(stats.nodeBound)));
+    json.Set("leaves", JsonValue::Number(static_cast<double>(stats.leafCount)));
+    json.Set("sah_cost", JsonValue::Number(stats.sahCost));
+    json.Set("max_depth", JsonValue::Number(stats.maxDepth));
+    json.Set("avg_leaf_depth", JsonValue::Number(stats.averageLeafDepth));
+    json.Set("max_leaf_size", JsonValue::Number(stats.maxLeafSize));
+    json.Set("avg_leaf_size", JsonValue::Number(stats.averageLeafSize));
+    json.Set("leaf_size_histogram", std::move(histogram));
+    json.Set("sibling_overlap", JsonValue::Number(stats.siblingOverlap));
+    if (stats.sampledRays > 0) {
+        json.Set("sampled_rays", JsonValue::Number(static_cast<double>(stats.sampledRays)));
+        json.Set("hit_ratio", JsonValue::Number(stats.hitRatio));
+        json.Set("avg_nodes_visited", JsonValue::Number(stats.averageNodesVisited));
+        json.Set("max_nodes_visited", JsonValue::Number(stats.maxNodesVisited));
+        json.Set("avg_triangles_tested", JsonValue::Number(stats.averageTrianglesTested));
+    }
+    return json;
+}
+
+[[nodiscard]] bool parseUIntArg(const char* value, unsigned long& out) noexcept {
+    try {
+        out = std::stoul(value);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned long rays = 10000;
+    unsigned long seed = 1;
+    std::string jsonPath;
+    std::vector<std::string> meshPaths;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printHelp();
+            return EXIT_SUCCESS;
+        } else if (arg == "--rays" && i + 1 < argc) {
+            if (!parseUIntArg(argv[++i], rays)) {
+                std::cerr << "Invalid ray count: " << argv[i] << "\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            if (!parseUIntArg(argv[++i], seed)) {
+                std::cerr << "Invalid seed: " << argv[i] << "\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            meshPaths.emplace_back(arg);
+        }
+    }
+
+    if (meshPaths.empty()) {
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    FlyTracer::JsonValue report = FlyTracer::JsonValue::Array();
+    bool ok = true;
+
+    for (const auto& path : meshPaths) {
+        Mesh mesh;
+        if (!mesh.LoadFromFile(path)) {
+            ok = false;
+            continue;
+        }
+        mesh.CenterOnOrigin();
+
+        const auto start = std::chrono::steady_clock::now();
+        mesh.BuildBVH();
+        const double buildMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        const auto stats = mesh.AnalyzeBVH(rays, static_cast<uint32_t>(seed));
+        printStats(path, stats, buildMs);
+        report.Push(statsToJson(path, stats, buildMs));
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath);
+        if (!file) {
+            std::cerr << "Could not write to " << jsonPath << "\n";
+            return EXIT_FAILURE;
+        }
+        report.Write(file);
+        file << "\n";
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}